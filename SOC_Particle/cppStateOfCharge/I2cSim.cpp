@@ -0,0 +1,529 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "I2cSim.h"
+#include <math.h>
+#include <string.h>
+
+#define OW_RESET_US     1148.   // DS2482 1-wire reset busy time, standard speed, us
+#define OW_SLOT_US      70.     // DS2482 1-wire time slot, standard speed, us
+
+
+// class I2cDevice
+I2cDevice::I2cDevice(const char *name, const uint8_t addr)
+  : busy_us(0.), busy_us_tot(0.), busy_us_max(0.), n_xfer(0), n_xfer_tot(0), n_bytes_tot(0),
+  name_(name), addr_(addr)
+{}
+I2cDevice::~I2cDevice() {}
+
+
+// class I2cBus
+I2cBus::I2cBus(const uint32_t clock_hz)
+  : clock_hz_(clock_hz), frames_(0), frame_busy_max_(0.), nacks_(0), now_us_(0.), overruns_(0)
+{}
+I2cBus::~I2cBus() {}
+
+// Add a device.  Two devices answering the same address is an error on the real bus too
+int I2cBus::attach(I2cDevice *dev)
+{
+  I2cDevice *other = find(dev->addr());
+  if ( other )
+  {
+    fprintf(stderr, "I2cBus::attach:  %s and %s both at 0x%02X\n", other->name(), dev->name(), dev->addr());
+    return -1;
+  }
+  dev_.push_back(dev);
+  return 0;
+}
+
+I2cDevice *I2cBus::find(const uint8_t addr)
+{
+  for ( size_t i=0; i<dev_.size(); i++ )
+    if ( dev_[i]->addr()==addr ) return dev_[i];
+  return NULL;
+}
+
+// Close a frame:  one csv row, running maxima, then idle to the start of the next frame
+void I2cBus::frame_end(FILE *csv, const double frame_us)
+{
+  double busy = 0.;
+  for ( size_t i=0; i<dev_.size(); i++ ) busy += dev_[i]->busy_us;
+  if ( csv )
+  {
+    fprintf(csv, "%u, %.1f, %.1f, %.2f,", frames_, now_us_/1000., busy, busy/frame_us*100.);
+    for ( size_t i=0; i<dev_.size(); i++ ) fprintf(csv, " %.1f, %u,", dev_[i]->busy_us, dev_[i]->n_xfer);
+    fprintf(csv, "\n");
+  }
+  if ( busy>frame_busy_max_ ) frame_busy_max_ = busy;
+  for ( size_t i=0; i<dev_.size(); i++ )
+  {
+    if ( dev_[i]->busy_us>dev_[i]->busy_us_max ) dev_[i]->busy_us_max = dev_[i]->busy_us;
+    dev_[i]->busy_us = 0.;
+    dev_[i]->n_xfer = 0;
+  }
+  double t_next = double(++frames_) * frame_us;
+  if ( now_us_>t_next ) overruns_++;
+  idle_until(t_next);
+}
+
+void I2cBus::print_csv_header(FILE *csv)
+{
+  fprintf(csv, "frame, t_end_ms, busy_us, util_pct,");
+  for ( size_t i=0; i<dev_.size(); i++ ) fprintf(csv, " %s_us, %s_n,", dev_[i]->name(), dev_[i]->name());
+  fprintf(csv, "\n");
+}
+
+void I2cBus::print_summary(FILE *out, const double frame_us)
+{
+  double busy_tot = 0.;
+  for ( size_t i=0; i<dev_.size(); i++ ) busy_tot += dev_[i]->busy_us_tot;
+  uint32_t nf = frames_ ? frames_ : 1;
+  fprintf(out, "I2C bus %lu Hz, %u frames of %.0f ms\n", (unsigned long)clock_hz_, frames_, frame_us/1000.);
+  fprintf(out, "  %-8s %5s %9s %9s %11s %11s %8s %7s\n", "device", "addr", "xfer/frm", "byte/frm", "mean us/frm", "max us/frm", "mean %", "share %");
+  for ( size_t i=0; i<dev_.size(); i++ )
+  {
+    I2cDevice *d = dev_[i];
+    fprintf(out, "  %-8s  0x%02X %9.2f %9.1f %11.1f %11.1f %8.2f %7.1f\n", d->name(), d->addr(),
+      double(d->n_xfer_tot)/nf, double(d->n_bytes_tot)/nf, d->busy_us_tot/nf, d->busy_us_max,
+      d->busy_us_tot/nf/frame_us*100., busy_tot>0. ? d->busy_us_tot/busy_tot*100. : 0.);
+  }
+  fprintf(out, "  total bus mean %.2f %%, max %.2f %% of a frame;  overruns %u;  nacks %u\n",
+    busy_tot/nf/frame_us*100., frame_busy_max_/frame_us*100., overruns_, nacks_);
+}
+
+// One transaction:  start, address byte, n_data bytes, stop.  A missing device NACKs the address
+I2cDevice *I2cBus::xfer(const uint8_t addr, const size_t n_data)
+{
+  I2cDevice *dev = find(addr);
+  size_t n_bytes = dev ? n_data + 1 : 1;
+  double dur = double(1 + 9*n_bytes + 1) * 1e6 / double(clock_hz_);
+  now_us_ += dur;
+  if ( !dev )
+  {
+    nacks_++;
+    return NULL;
+  }
+  dev->busy_us += dur;
+  dev->busy_us_tot += dur;
+  dev->n_xfer++;
+  dev->n_xfer_tot++;
+  dev->n_bytes_tot += n_bytes;
+  return dev;
+}
+
+
+// class TwoWire
+TwoWire::TwoWire(I2cBus *bus)
+  : bus_(bus), rx_i_(0), rx_n_(0), truncations_(0), tx_addr_(0), tx_n_(0), tx_open_(false)
+{}
+TwoWire::~TwoWire() {}
+
+void TwoWire::beginTransmission(const uint8_t addr)
+{
+  tx_addr_ = addr;
+  tx_n_ = 0;
+  tx_open_ = true;
+}
+
+// Returns 0 success, 2 address NACK.  A stray call with nothing open (SerialRAM::read does
+// this after requestFrom) puts nothing on the bus
+uint8_t TwoWire::endTransmission(const uint8_t stop)
+{
+  if ( !tx_open_ ) return 0;
+  tx_open_ = false;
+  I2cDevice *dev = bus_->xfer(tx_addr_, tx_n_);
+  if ( !dev ) return 2;
+  dev->receive(tx_, tx_n_, bus_->now_us());
+  return 0;
+}
+
+size_t TwoWire::requestFrom(const uint8_t addr, const size_t n, const uint8_t stop)
+{
+  size_t nr = n;
+  if ( nr>I2C_SIM_BUFFER )
+  {
+    nr = I2C_SIM_BUFFER;
+    truncations_++;
+  }
+  rx_i_ = 0;
+  rx_n_ = 0;
+  I2cDevice *dev = bus_->xfer(addr, nr);
+  if ( !dev ) return 0;
+  dev->request(rx_, nr, bus_->now_us());
+  rx_n_ = nr;
+  return nr;
+}
+
+size_t TwoWire::write(const uint8_t b)
+{
+  if ( !tx_open_ ) return 0;
+  if ( tx_n_>=I2C_SIM_BUFFER )
+  {
+    truncations_++;
+    return 0;
+  }
+  tx_[tx_n_++] = b;
+  return 1;
+}
+
+size_t TwoWire::write(const uint8_t *buf, const size_t n)
+{
+  size_t i = 0;
+  while ( i<n && write(buf[i]) ) i++;
+  return i;
+}
+
+
+// class Eeram47L16
+Eeram47L16::Eeram47L16(const uint8_t addr)
+  : I2cDevice("eeram", addr), cut_left_(-1), ptr_(0)
+{
+  memset(wear, 0, sizeof(wear));
+  memset(image_, 0, sizeof(image_));
+  memset(mem_, 0, sizeof(mem_));
+}
+Eeram47L16::~Eeram47L16() {}
+
+void Eeram47L16::autostore()
+{
+  memcpy(image_, mem_, sizeof(mem_));
+  cut_left_ = -1;
+}
+
+void Eeram47L16::receive(const uint8_t *buf, const size_t n, const double t_us)
+{
+  if ( n<2 ) return;
+  ptr_ = ((uint16_t(buf[0])<<8) | buf[1]) & 0x07FF;
+  for ( size_t i=2; i<n; i++ )
+  {
+    if ( cut_left_==0 ) autostore();
+    else if ( cut_left_>0 ) cut_left_--;
+    mem_[ptr_] = buf[i];
+    wear[ptr_]++;
+    ptr_ = (ptr_+1) & 0x07FF;
+  }
+}
+
+void Eeram47L16::request(uint8_t *buf, const size_t n, const double t_us)
+{
+  for ( size_t i=0; i<n; i++ )
+  {
+    buf[i] = mem_[ptr_];
+    ptr_ = (ptr_+1) & 0x07FF;
+  }
+}
+
+
+// class Eeram47L16Ctrl
+Eeram47L16Ctrl::Eeram47L16Ctrl(const uint8_t addr)
+  : I2cDevice("eectl", addr), status_(0)
+{}
+Eeram47L16Ctrl::~Eeram47L16Ctrl() {}
+
+void Eeram47L16Ctrl::receive(const uint8_t *buf, const size_t n, const double t_us)
+{
+  if ( n>=2 && buf[0]==0x00 ) status_ = buf[1];
+}
+
+void Eeram47L16Ctrl::request(uint8_t *buf, const size_t n, const double t_us)
+{
+  for ( size_t i=0; i<n; i++ ) buf[i] = status_;
+}
+
+
+// class Ads1015
+Ads1015::Ads1015(const char *name, const uint8_t addr, const double rate_sps)
+  : I2cDevice(name, addr), counts(0), n_conv(0), config_(0x8583), ptr_(0), rate_sps_(rate_sps), t_done_(0.)
+{}
+Ads1015::~Ads1015() {}
+
+// Pointer write, or pointer + 16 bit register write.  Writing OS=1 to config starts a conversion
+void Ads1015::receive(const uint8_t *buf, const size_t n, const double t_us)
+{
+  if ( n<1 ) return;
+  ptr_ = buf[0] & 0x03;
+  if ( n<3 ) return;
+  uint16_t value = (uint16_t(buf[1])<<8) | buf[2];
+  if ( ptr_==0x01 )
+  {
+    config_ = value & 0x7FFF;
+    if ( value & 0x8000 )
+    {
+      t_done_ = t_us + 1e6/rate_sps_;
+      n_conv++;
+    }
+  }
+}
+
+void Ads1015::request(uint8_t *buf, const size_t n, const double t_us)
+{
+  uint16_t value = 0;
+  if ( ptr_==0x00 ) value = uint16_t(counts) << 4;
+  else if ( ptr_==0x01 ) value = config_ | ( t_us>=t_done_ ? 0x8000 : 0 );
+  if ( n>0 ) buf[0] = value >> 8;
+  if ( n>1 ) buf[1] = value & 0xFF;
+}
+
+
+// class Ssd1306
+Ssd1306::Ssd1306(const uint8_t addr)
+  : I2cDevice("oled", addr), n_cmd(0), n_data(0)
+{}
+Ssd1306::~Ssd1306() {}
+
+void Ssd1306::receive(const uint8_t *buf, const size_t n, const double t_us)
+{
+  if ( n<1 ) return;
+  if ( buf[0]==0x40 ) n_data += n-1;
+  else n_cmd += n-1;
+}
+
+void Ssd1306::request(uint8_t *buf, const size_t n, const double t_us)
+{
+  for ( size_t i=0; i<n; i++ ) buf[i] = 0;
+}
+
+
+// Dallas/Maxim CRC8, x^8+x^5+x^4+1, as the DS2482-RK checkCRC
+uint8_t ow_crc8(const uint8_t *buf, const size_t n)
+{
+  uint8_t crc = 0;
+  for ( size_t i=0; i<n; i++ )
+  {
+    uint8_t b = buf[i];
+    for ( int k=0; k<8; k++ )
+    {
+      uint8_t mix = (crc ^ b) & 0x01;
+      crc >>= 1;
+      if ( mix ) crc ^= 0x8C;
+      b >>= 1;
+    }
+  }
+  return crc;
+}
+
+
+// class Ds18b20
+Ds18b20::Ds18b20(const uint64_t serial)
+  : tc(25.), t_conv_us(750000.), absent(false), por(false), crc_err(0), offset(0.), n_conv(0), n_pad(0), t_done_(-1.)
+{
+  rom[0] = 0x28;
+  for ( int i=1; i<7; i++ ) rom[i] = uint8_t(serial >> (8*(i-1)));
+  rom[7] = ow_crc8(rom, 7);
+  const uint8_t por_pad[8] = {0x50, 0x05, 0x4B, 0x46, 0x7F, 0xFF, 0x0C, 0x10};  // 85 C, TH, TL, 12 bit
+  memcpy(pad_, por_pad, 8);
+  pad_[8] = ow_crc8(pad_, 8);
+}
+Ds18b20::~Ds18b20() {}
+
+void Ds18b20::convert(const double t_us)
+{
+  n_conv++;
+  t_done_ = t_us + t_conv_us;
+}
+
+// Scratchpad as read at t_us.   A conversion finished by then is latched first
+const uint8_t *Ds18b20::pad(const double t_us)
+{
+  if ( t_done_>=0. && t_us>=t_done_ )
+  {
+    t_done_ = -1.;
+    int16_t raw = por ? int16_t(0x0550) : int16_t(lround((tc + offset)*16.));
+    pad_[0] = uint8_t(raw);
+    pad_[1] = uint8_t(uint16_t(raw) >> 8);
+    pad_[8] = ow_crc8(pad_, 8);
+  }
+  n_pad++;
+  return pad_;
+}
+
+uint64_t Ds18b20::rom_u64() const
+{
+  uint64_t r = 0ULL;
+  for ( int i=7; i>=0; i-- ) r = (r << 8) | rom[i];
+  return r;
+}
+
+
+// class Ds2482
+#define OW_ROM      0       // Expecting a ROM command
+#define OW_MATCH    1       // Collecting the 8 bytes of match ROM
+#define OW_FUNC     2       // Expecting a function command
+#define OW_SEARCH   3       // Search ROM triplets
+#define OW_PAD      4       // Reading the scratchpad
+#define OW_IDLE     5       // Nothing selected
+
+Ds2482::Ds2482(const uint8_t addr)
+  : I2cDevice("ds2482", addr), n_ow(0), shorted(false), config_(0), data_(0xFF), ptr_(0xF0), status_(0x10),
+  t_done_(0.), ow_state_(OW_IDLE), i_byte_(0), i_bit_(0)
+{}
+Ds2482::~Ds2482() {}
+
+void Ds2482::receive(const uint8_t *buf, const size_t n, const double t_us)
+{
+  if ( n<1 ) return;
+  double busy = -1.;
+  switch ( buf[0] )
+  {
+    case ( 0xF0 ):  // Device reset
+      config_ = 0;
+      status_ = 0x10;   // RST
+      break;
+    case ( 0xE1 ):  // Set read pointer
+      if ( n>1 ) ptr_ = buf[1];
+      return;
+    case ( 0xD2 ):  // Write configuration
+      if ( n>1 ) config_ = buf[1] & 0x0F;
+      status_ &= ~0x10;
+      ptr_ = 0xC3;
+      return;
+    case ( 0xB4 ):  // 1-wire reset
+      busy = OW_RESET_US;
+      ow_reset_();
+      break;
+    case ( 0xA5 ):  // 1-wire write byte
+      busy = 8.*OW_SLOT_US;
+      if ( n>1 ) ow_write_(buf[1], t_us);
+      break;
+    case ( 0x96 ):  // 1-wire read byte
+      busy = 8.*OW_SLOT_US;
+      data_ = ow_read_(t_us);
+      break;
+    case ( 0x87 ):  // 1-wire single bit
+      busy = OW_SLOT_US;
+      break;
+    case ( 0x78 ):  // 1-wire triplet
+      busy = 3.*OW_SLOT_US;
+      status_ = (status_ & 0x1F) | ow_triplet_(n>1 && (buf[1] & 0x80));
+      break;
+    default:
+      return;
+  }
+  ptr_ = 0xF0;
+  if ( busy>0. )
+  {
+    t_done_ = t_us + busy;
+    n_ow++;
+  }
+}
+
+// Status bit 0 is 1WB, 1 PPD, 2 SD, 4 RST, 5-7 SBR TSB DIR of the last triplet
+void Ds2482::request(uint8_t *buf, const size_t n, const double t_us)
+{
+  uint8_t value = data_;
+  if ( ptr_==0xF0 ) value = ( t_us<t_done_ ? 0x01 : 0x00 ) | status_;
+  else if ( ptr_==0xC3 ) value = config_;
+  for ( size_t i=0; i<n; i++ ) buf[i] = value;
+}
+
+// Wired-AND of the selected probes' next scratchpad byte; the line reads high with none
+uint8_t Ds2482::ow_read_(const double t_us)
+{
+  if ( ow_.empty() || ow_state_!=OW_PAD || i_byte_>=9 ) return 0xFF;
+  uint8_t b = 0xFF;
+  for ( size_t i=0; i<ow_.size(); i++ )
+  {
+    if ( !sel_[i] ) continue;
+    Ds18b20 *p = ow_[i];
+    if ( i_byte_==0 ) p->pad(t_us);
+    uint8_t v = p->pad_byte(i_byte_);
+    if ( i_byte_==8 && p->crc_err ) { v ^= 0x01;  p->crc_err--; }
+    b &= v;
+  }
+  i_byte_++;
+  return b;
+}
+
+// Presence pulse from any probe on the line, SD if it is shorted.   All probes then wait for a ROM command
+void Ds2482::ow_reset_()
+{
+  status_ &= ~(0x02 | 0x04);
+  if ( shorted ) { status_ |= 0x04;  ow_state_ = OW_IDLE;  return; }
+  bool ppd = ow_.empty();
+  for ( size_t i=0; i<ow_.size(); i++ ) ppd = ppd || !ow_[i]->absent;
+  if ( ppd ) status_ |= 0x02;
+  sel_.assign(ow_.size(), false);
+  ow_state_ = OW_ROM;
+}
+
+// One search bit:  the probes still in the search answer the bit and its complement, the bridge writes the
+// direction and those that differ drop out.   Returns SBR, TSB and DIR in their status positions
+uint8_t Ds2482::ow_triplet_(const bool dir_in)
+{
+  if ( ow_state_!=OW_SEARCH || i_bit_>=64 ) return 0xE0;
+  bool id = true, cmp = true;
+  for ( size_t i=0; i<ow_.size(); i++ )
+  {
+    if ( !sel_[i] ) continue;
+    bool bit = (ow_[i]->rom[i_bit_/8] >> (i_bit_%8)) & 1;
+    id = id && bit;
+    cmp = cmp && !bit;
+  }
+  bool dir = ( id!=cmp ) ? id : ( id ? true : dir_in );
+  for ( size_t i=0; i<ow_.size(); i++ )
+    if ( sel_[i] && bool((ow_[i]->rom[i_bit_/8] >> (i_bit_%8)) & 1)!=dir ) sel_[i] = false;
+  i_bit_++;
+  return (id ? 0x20 : 0) | (cmp ? 0x40 : 0) | (dir ? 0x80 : 0);
+}
+
+void Ds2482::ow_write_(const uint8_t b, const double t_us)
+{
+  if ( ow_.empty() ) return;
+  switch ( ow_state_ )
+  {
+    case ( OW_ROM ):
+      if ( b==0xCC )        // Skip ROM
+      {
+        for ( size_t i=0; i<ow_.size(); i++ ) sel_[i] = !ow_[i]->absent;
+        ow_state_ = OW_FUNC;
+      }
+      else if ( b==0x55 ) { ow_state_ = OW_MATCH;  i_byte_ = 0; }
+      else if ( b==0xF0 )   // Search ROM
+      {
+        for ( size_t i=0; i<ow_.size(); i++ ) sel_[i] = !ow_[i]->absent;
+        ow_state_ = OW_SEARCH;
+        i_bit_ = 0;
+      }
+      else ow_state_ = OW_IDLE;
+      break;
+    case ( OW_MATCH ):
+      match_[i_byte_++] = b;
+      if ( i_byte_==8 )
+      {
+        for ( size_t i=0; i<ow_.size(); i++ ) sel_[i] = !ow_[i]->absent && !memcmp(ow_[i]->rom, match_, 8);
+        ow_state_ = OW_FUNC;
+      }
+      break;
+    case ( OW_FUNC ):
+      if ( b==0x44 )        // Convert T
+      {
+        for ( size_t i=0; i<ow_.size(); i++ ) if ( sel_[i] ) ow_[i]->convert(t_us);
+        ow_state_ = OW_IDLE;
+      }
+      else if ( b==0xBE ) { ow_state_ = OW_PAD;  i_byte_ = 0; }
+      else ow_state_ = OW_IDLE;
+      break;
+    default:
+      break;
+  }
+}
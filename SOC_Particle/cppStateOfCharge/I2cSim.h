@@ -0,0 +1,260 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// I2C bus simulator for bus-occupancy studies on the analysis host.  Not part of the Particle build.
+// TwoWire mirrors the Particle Wire API closely enough that drivers in src (hardware/SerialRAM.cpp)
+// compile against it unchanged through host/Wire.h.   Every transaction is charged byte-accurate
+// time at the bus clock:  start, 9 bits per byte (8 data + ack) including the address byte, stop.
+// Devices are behavioural models with just enough register logic that the drivers' polling
+// loops run as many times as they do on the hardware.
+
+#ifndef _I2C_SIM_H
+#define _I2C_SIM_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <vector>
+
+#define I2C_SIM_CLOCK_HZ    100000UL  // Photon 2 default bus clock, Hz
+#define I2C_SIM_BUFFER      32        // Particle Wire buffer (I2C_BUFFER_LENGTH), bytes
+
+// A device on the bus.  Models override receive() for master writes and request() for master reads
+class I2cDevice
+{
+public:
+  I2cDevice(const char *name, const uint8_t addr);
+  virtual ~I2cDevice();
+  // functions
+  uint8_t addr() const { return addr_; }
+  const char *name() const { return name_; }
+  virtual void receive(const uint8_t *buf, const size_t n, const double t_us) = 0;
+  virtual void request(uint8_t *buf, const size_t n, const double t_us) = 0;
+  // Bus accounting, reset each frame by I2cBus
+  double busy_us;       // Bus time in current frame, us
+  double busy_us_tot;   // Bus time all frames, us
+  double busy_us_max;   // Largest bus time in one frame, us
+  uint32_t n_xfer;      // Transactions in current frame
+  uint32_t n_xfer_tot;  // Transactions all frames
+  uint32_t n_bytes_tot; // Bytes including address all frames
+protected:
+  const char *name_;
+  uint8_t addr_;
+};
+
+// The bus:  owns simulated time and per-frame accounting
+class I2cBus
+{
+public:
+  I2cBus(const uint32_t clock_hz=I2C_SIM_CLOCK_HZ);
+  ~I2cBus();
+  // functions
+  int attach(I2cDevice *dev);
+  uint32_t clock() const { return clock_hz_; }
+  void clock(const uint32_t hz) { clock_hz_ = hz; }
+  std::vector<I2cDevice *> &devices() { return dev_; }
+  I2cDevice *find(const uint8_t addr);
+  void frame_end(FILE *csv, const double frame_us);
+  void idle_until(const double t_us) { if ( t_us>now_us_ ) now_us_ = t_us; }
+  uint32_t nacks() const { return nacks_; }
+  double now_us() const { return now_us_; }
+  void print_csv_header(FILE *csv);
+  void print_summary(FILE *out, const double frame_us);
+  I2cDevice *xfer(const uint8_t addr, const size_t n_data);
+protected:
+  uint32_t clock_hz_;             // Bus clock, Hz
+  std::vector<I2cDevice *> dev_;  // Attached devices
+  uint32_t frames_;               // Frames closed
+  double frame_busy_max_;         // Largest bus time in one frame, us
+  uint32_t nacks_;                // Transactions to an empty address
+  double now_us_;                 // Simulated time, us
+  uint32_t overruns_;             // Frames whose traffic ran past the frame boundary
+};
+
+// Particle/Arduino Wire API on top of I2cBus
+class TwoWire
+{
+public:
+  TwoWire(I2cBus *bus);
+  ~TwoWire();
+  // functions
+  int available() { return int(rx_n_ - rx_i_); }
+  void begin() {}
+  void beginTransmission(const uint8_t addr);
+  void beginTransmission(const int addr) { beginTransmission(uint8_t(addr)); }
+  I2cBus *bus() { return bus_; }
+  uint8_t endTransmission(const uint8_t stop=true);
+  bool isEnabled() { return true; }
+  int read() { return ( rx_i_<rx_n_ ) ? rx_[rx_i_++] : -1; }
+  size_t requestFrom(const uint8_t addr, const size_t n, const uint8_t stop=true);
+  void setClock(const uint32_t hz) { bus_->clock(hz); }
+  uint32_t truncations() const { return truncations_; }
+  size_t write(const uint8_t b);
+  size_t write(const uint8_t *buf, const size_t n);
+protected:
+  I2cBus *bus_;
+  uint8_t rx_[I2C_SIM_BUFFER];  // Receive buffer
+  size_t rx_i_;                 // Next byte to read
+  size_t rx_n_;                 // Bytes received
+  uint32_t truncations_;        // Writes or reads that did not fit the Wire buffer
+  uint8_t tx_[I2C_SIM_BUFFER];  // Transmit buffer
+  uint8_t tx_addr_;             // Address of open transmission
+  size_t tx_n_;                 // Bytes queued
+  bool tx_open_;                // beginTransmission seen
+};
+
+
+// Device models
+
+// 47L16 EERAM, SRAM array at 0x50.  First two bytes of a write set the address pointer.   Counts writes to each
+// cell.   A power cut is AutoStore:  the SRAM as it is at that instant goes to the image, now (autostore) or after
+// a given number of further data bytes (cut_after), which may land inside a write
+class Eeram47L16 : public I2cDevice
+{
+public:
+  Eeram47L16(const uint8_t addr=0x50);
+  ~Eeram47L16();
+  void autostore();
+  void cut_after(const long n) { cut_left_ = n; }
+  bool cut_pending() const { return cut_left_>=0; }
+  const uint8_t *image() const { return image_; }
+  void receive(const uint8_t *buf, const size_t n, const double t_us);
+  void request(uint8_t *buf, const size_t n, const double t_us);
+  uint32_t wear[0x0800];  // Writes to each cell
+protected:
+  long cut_left_;         // Data bytes until a pending cut, <0 none
+  uint8_t image_[0x0800]; // SRAM saved at the last cut
+  uint8_t mem_[0x0800];
+  uint16_t ptr_;
+};
+
+// 47L16 EERAM control register at 0x18 (status register for AutoStore)
+class Eeram47L16Ctrl : public I2cDevice
+{
+public:
+  Eeram47L16Ctrl(const uint8_t addr=0x18);
+  ~Eeram47L16Ctrl();
+  void receive(const uint8_t *buf, const size_t n, const double t_us);
+  void request(uint8_t *buf, const size_t n, const double t_us);
+protected:
+  uint8_t status_;
+};
+
+// ADS1015 single-shot conversions.  The OS bit of config reads 0 until 1/rate after a start
+class Ads1015 : public I2cDevice
+{
+public:
+  Ads1015(const char *name, const uint8_t addr, const double rate_sps=1600.);
+  ~Ads1015();
+  void receive(const uint8_t *buf, const size_t n, const double t_us);
+  void request(uint8_t *buf, const size_t n, const double t_us);
+  int16_t counts;       // Conversion result returned, 12 bit counts
+  uint32_t n_conv;      // Conversions started
+protected:
+  uint16_t config_;     // Config register
+  uint8_t ptr_;         // Register pointer
+  double rate_sps_;     // Data rate, samples/s
+  double t_done_;       // Time conversion completes, us
+};
+
+// SSD1306 OLED.  Control byte 0x00 leads commands, 0x40 leads display data
+class Ssd1306 : public I2cDevice
+{
+public:
+  Ssd1306(const uint8_t addr=0x3C);
+  ~Ssd1306();
+  void receive(const uint8_t *buf, const size_t n, const double t_us);
+  void request(uint8_t *buf, const size_t n, const double t_us);
+  uint32_t n_cmd;       // Command bytes received
+  uint32_t n_data;      // Display data bytes received
+};
+
+// DS18B20 on the 1-wire side of a Ds2482.   ROM family 0x28, the serial given, CRC.   Convert T latches the
+// temperature tc (plus offset, 1/16 deg C) into the scratchpad t_conv_us later.   Faults:  absent (off the bus, no
+// presence), por (browns out on each conversion, the scratchpad holds the power-on 85 C), crc_err (that many
+// scratchpad reads come back with a bad CRC) and offset
+class Ds18b20
+{
+public:
+  Ds18b20(const uint64_t serial);
+  ~Ds18b20();
+  // functions
+  void convert(const double t_us);
+  const uint8_t *pad(const double t_us);
+  uint8_t pad_byte(const uint8_t i) const { return pad_[i]; }
+  uint64_t rom_u64() const;
+  // Probe
+  uint8_t rom[8];       // ROM, family code first
+  float tc;             // Temperature at the probe, deg C
+  double t_conv_us;     // Conversion time, us (750000, 12 bit)
+  // Faults
+  bool absent;
+  bool por;
+  uint32_t crc_err;
+  float offset;         // deg C
+  // Counts
+  uint32_t n_conv;      // Conversions
+  uint32_t n_pad;       // Scratchpad reads
+protected:
+  uint8_t pad_[9];      // Scratchpad
+  double t_done_;       // Conversion completes, us, <0 none pending
+};
+
+uint8_t ow_crc8(const uint8_t *buf, const size_t n);
+
+// DS2482-100 I2C to 1-wire bridge.  1-wire commands hold the 1WB status bit for their standard
+// speed duration, so the master's status polls cost bus time the way they do on the hardware.   With no
+// Ds18b20 attached the line reads high and a presence pulse is assumed (i2c_bus).   With probes attached the
+// bridge runs their ROM commands (search triplets, match, skip) and Convert T / Read Scratchpad on the wired-AND
+// of those selected, and a shorted line reports SD on reset
+class Ds2482 : public I2cDevice
+{
+public:
+  Ds2482(const uint8_t addr=0x18);
+  ~Ds2482();
+  void attach(Ds18b20 *probe) { ow_.push_back(probe); }
+  std::vector<Ds18b20 *> &probes() { return ow_; }
+  void receive(const uint8_t *buf, const size_t n, const double t_us);
+  void request(uint8_t *buf, const size_t n, const double t_us);
+  uint32_t n_ow;        // 1-wire commands run
+  bool shorted;         // 1-wire line shorted
+protected:
+  uint8_t config_;      // Configuration register
+  uint8_t data_;        // Read data register
+  uint8_t ptr_;         // Read pointer:  0xF0 status, 0xE1 data, 0xC3 config
+  uint8_t status_;      // Status bits other than 1WB
+  double t_done_;       // Time 1-wire command completes, us
+  // 1-wire side
+  std::vector<Ds18b20 *> ow_;   // Probes
+  std::vector<bool> sel_;       // Selected by the ROM command, or still in the search
+  uint8_t ow_state_;    // Next byte expected, OW_*
+  uint8_t i_byte_;      // Bytes into match ROM or the scratchpad
+  uint8_t i_bit_;       // Search ROM bit
+  uint8_t match_[8];    // Match ROM collected
+  uint8_t ow_read_(const double t_us);
+  void ow_reset_();
+  uint8_t ow_triplet_(const bool dir_in);
+  void ow_write_(const uint8_t b, const double t_us);
+};
+
+#endif
@@ -0,0 +1,414 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "LogStore.h"
+#include <algorithm>
+#include <fcntl.h>
+#include <math.h>
+#include <stdio.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Streams printed by the firmware.  An empty unit_key on the vv1 stream means any line whose first field
+// carries the battery suffix added in assign_identity (_bb, _ch, _chg, _un) unless the caller gives a key.
+const LogStream log_streams[] =
+{
+  {"_mon", "unit,",   "",         2},  // print_serial_header / create_rapid_string
+  {"_sel", "unit_s,", "unit_sel", 1},  // print_signal_sel_header / Sensors::select_all_hdwe_or_model
+  {"_ekf", "unit_e,", "unit_ekf", 1},  // print_serial_ekf_header / BatteryMonitor::solve_ekf
+  {"_sim", "unit_m,", "unit_sim", 1},  // print_serial_sim_header / BatterySim::count_coulombs
+  {"_flt", "fltb,",   "unit_f",   2},  // print_fault_header / Flt_st::print_flt of fault array
+  {"_his", "fltb,",   "unit_h",   2},  // print_fault_header / Flt_st::print_flt of history array
+  {"_sum", "fltb,",   "unit_u",   2},  // print_fault_header / Flt_st::print_flt of summary array
+};
+const int num_log_streams = sizeof(log_streams) / sizeof(LogStream);
+
+// Exact powers of ten.  Products and quotients with these round once for mantissas below 2^53
+static const double pow10_tab[] = {1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9, 1e10, 1e11,
+  1e12, 1e13, 1e14, 1e15, 1e16, 1e17, 1e18, 1e19, 1e20, 1e21, 1e22};
+
+// Helpers
+static uint64_t align_up(const uint64_t x) { return (x + LOG_STORE_ALIGN - 1) / LOG_STORE_ALIGN * LOG_STORE_ALIGN; }
+
+static bool is_space(const char c) { return c==' ' || c=='\t' || c=='\r'; }
+
+static int count_commas(const char *p, const char *end)
+{
+  int n = 0;
+  while ( (p = (const char *)memchr(p, ',', end-p)) != NULL ) { n++; p++; }
+  return n;
+}
+
+
+/* P A R S E _ D O U B L E
+*
+*   Purpose:    Convert the printf %f / %g / %d text the firmware writes.  No locale, no allocation.
+*               Leading blanks skipped.  Accepts nan and inf.  Up to 19 significant digits kept.
+*   Inputs:     p, end          Text range
+*   Outputs:    *val            Result
+*   Returns:    Pointer past the number, or p if no number found
+*/
+const char *parse_double(const char *p, const char *end, double *val)
+{
+  const char *start = p;
+  while ( p<end && is_space(*p) ) p++;
+  bool neg = false;
+  if ( p<end && (*p=='-' || *p=='+') ) { neg = *p=='-'; p++; }
+
+  // nan, inf
+  if ( end-p>=3 && (p[0]|0x20)=='n' && (p[1]|0x20)=='a' && (p[2]|0x20)=='n' )
+  {
+    *val = neg ? -NAN : NAN;
+    return p+3;
+  }
+  if ( end-p>=3 && (p[0]|0x20)=='i' && (p[1]|0x20)=='n' && (p[2]|0x20)=='f' )
+  {
+    *val = neg ? -INFINITY : INFINITY;
+    return p+3;
+  }
+
+  uint64_t mant = 0;
+  int digits = 0;
+  int exp10 = 0;
+  bool any = false;
+  while ( p<end && *p>='0' && *p<='9' )
+  {
+    if ( digits<19 ) { mant = mant*10 + (*p-'0'); if ( mant ) digits++; }
+    else exp10++;
+    any = true;
+    p++;
+  }
+  if ( p<end && *p=='.' )
+  {
+    p++;
+    while ( p<end && *p>='0' && *p<='9' )
+    {
+      if ( digits<19 ) { mant = mant*10 + (*p-'0'); if ( mant ) digits++; exp10--; }
+      any = true;
+      p++;
+    }
+  }
+  if ( !any ) return start;
+  if ( p<end && (*p=='e' || *p=='E') )
+  {
+    const char *q = p + 1;
+    bool eneg = false;
+    if ( q<end && (*q=='-' || *q=='+') ) { eneg = *q=='-'; q++; }
+    if ( q<end && *q>='0' && *q<='9' )
+    {
+      int e = 0;
+      while ( q<end && *q>='0' && *q<='9' ) { if ( e<10000 ) e = e*10 + (*q-'0'); q++; }
+      exp10 += eneg ? -e : e;
+      p = q;
+    }
+  }
+
+  double x = double(mant);
+  if ( exp10==0 || mant==0 ) {}
+  else if ( exp10>0 && exp10<=22 ) x *= pow10_tab[exp10];
+  else if ( exp10<0 && exp10>=-22 ) x /= pow10_tab[-exp10];
+  else x *= pow(10., exp10);
+  *val = neg ? -x : x;
+  return p;
+}
+
+
+// class LogStoreWriter
+LogStoreWriter::LogStoreWriter()
+  : stream_(NULL), has_header_(false), nfields_(0), skips_(0ULL), sorted_(true) {}
+LogStoreWriter::LogStoreWriter(const LogStream *stream)
+  : stream_(stream), has_header_(false), nfields_(0), skips_(0ULL), sorted_(true) {}
+LogStoreWriter::~LogStoreWriter() {}
+
+// First header line found defines the fields, like DataOverModel.write_clean_file
+bool LogStoreWriter::add_header(const char *line, const char *end)
+{
+  if ( has_header_ ) return false;
+  nfields_ = count_commas(line, end);
+  const char *p = line;
+  for ( int i=0; i<nfields_; i++ )
+  {
+    const char *comma = (const char *)memchr(p, ',', end-p);
+    const char *b = p;
+    const char *e = comma;
+    while ( b<e && is_space(*b) ) b++;
+    while ( e>b && is_space(e[-1]) ) e--;
+    names_.push_back(std::string(b, e-b));
+    p = comma + 1;
+  }
+  has_header_ = nfields_ > stream_->time_col;
+  return has_header_;
+}
+
+// Data line.  Rejected unless it has exactly the header's field count and clean characters.
+// The first accepted line decides which fields are numeric; text fields (unit, date) are dropped.
+bool LogStoreWriter::add_line(const char *line, const char *end)
+{
+  if ( !has_header_ ) return false;
+  for ( const char *q=line; q<end; q++ )
+  {
+    unsigned char c = (unsigned char)*q;
+    if ( c==';' || c<0x20 || c>=0x7F ) { if ( c=='\r' && q==end-1 ) break; skips_++; return false; }
+  }
+  if ( count_commas(line, end)!=nfields_ || memmem(line, end-line, "---", 3)!=NULL )
+  {
+    skips_++;
+    return false;
+  }
+
+  // Parse every field; NaN marks a text field
+  fields_.assign(nfields_, NAN);
+  std::vector<bool> ok(nfields_, false);
+  const char *p = line;
+  for ( int i=0; i<nfields_; i++ )
+  {
+    const char *comma = (const char *)memchr(p, ',', end-p);
+    double x;
+    const char *q = parse_double(p, comma, &x);
+    if ( q!=p )
+    {
+      while ( q<comma && is_space(*q) ) q++;
+      if ( q==comma ) { fields_[i] = x; ok[i] = true; }
+    }
+    p = comma + 1;
+  }
+  if ( !ok[stream_->time_col] ) { skips_++; return false; }
+
+  // Column set frozen by first good line
+  if ( time_.empty() && numeric_.empty() )
+  {
+    for ( int i=0; i<nfields_; i++ )
+      if ( ok[i] && i!=stream_->time_col ) numeric_.push_back(i);
+    cols_.resize(numeric_.size());
+  }
+  for ( size_t c=0; c<numeric_.size(); c++ )
+    if ( !ok[numeric_[c]] ) { skips_++; return false; }
+
+  double t = fields_[stream_->time_col];
+  if ( !time_.empty() && t<time_.back() ) sorted_ = false;
+  time_.push_back(t);
+  for ( size_t c=0; c<numeric_.size(); c++ ) cols_[c].push_back(float(fields_[numeric_[c]]));
+  return true;
+}
+
+// Sort by time if needed and write header, names, time and columns each aligned for the reader
+bool LogStoreWriter::write(const std::string &path)
+{
+  if ( time_.empty() ) return false;
+  uint64_t nrows = time_.size();
+  if ( !sorted_ )
+  {
+    std::vector<uint64_t> order(nrows);
+    for ( uint64_t i=0; i<nrows; i++ ) order[i] = i;
+    std::stable_sort(order.begin(), order.end(), [this](uint64_t a, uint64_t b){ return time_[a] < time_[b]; });
+    std::vector<double> t(nrows);
+    for ( uint64_t i=0; i<nrows; i++ ) t[i] = time_[order[i]];
+    time_.swap(t);
+    std::vector<float> v(nrows);
+    for ( size_t c=0; c<cols_.size(); c++ )
+    {
+      for ( uint64_t i=0; i<nrows; i++ ) v[i] = cols_[c][order[i]];
+      cols_[c].swap(v);
+    }
+    sorted_ = true;
+  }
+
+  LogStoreHeader hdr;
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, LOG_STORE_MAGIC, sizeof(LOG_STORE_MAGIC));
+  hdr.version = LOG_STORE_VERSION;
+  hdr.ncols = uint32_t(cols_.size());
+  hdr.nrows = nrows;
+  hdr.names_off = align_up(sizeof(hdr));
+  hdr.time_off = align_up(hdr.names_off + hdr.ncols*LOG_STORE_NAME_LEN);
+  hdr.col_stride = align_up(nrows*sizeof(float));
+  hdr.data_off = align_up(hdr.time_off + nrows*sizeof(double));
+  strncpy(hdr.time_name, names_[stream_->time_col].c_str(), LOG_STORE_NAME_LEN-1);
+
+  FILE *fp = fopen(path.c_str(), "wb");
+  if ( fp==NULL ) return false;
+  std::vector<char> pad(LOG_STORE_ALIGN, 0);
+  uint64_t at = 0;
+  auto put = [&](const void *b, uint64_t n) { fwrite(b, 1, n, fp); at += n; };
+  auto pad_to = [&](uint64_t off) { while ( at<off ) put(pad.data(), std::min<uint64_t>(off-at, LOG_STORE_ALIGN)); };
+  put(&hdr, sizeof(hdr));
+  pad_to(hdr.names_off);
+  for ( size_t c=0; c<numeric_.size(); c++ )
+  {
+    char name[LOG_STORE_NAME_LEN];
+    memset(name, 0, sizeof(name));
+    strncpy(name, names_[numeric_[c]].c_str(), LOG_STORE_NAME_LEN-1);
+    put(name, sizeof(name));
+  }
+  pad_to(hdr.time_off);
+  put(time_.data(), nrows*sizeof(double));
+  for ( size_t c=0; c<cols_.size(); c++ )
+  {
+    pad_to(hdr.data_off + c*hdr.col_stride);
+    put(cols_[c].data(), nrows*sizeof(float));
+  }
+  pad_to(hdr.data_off + cols_.size()*hdr.col_stride);
+  bool good = !ferror(fp);
+  fclose(fp);
+  return good;
+}
+
+
+// class LogStoreBlockWriter
+LogStoreBlockWriter::LogStoreBlockWriter()
+  : fd_(-1), block_rows_(0ULL), block_beg_(0ULL), row_(0ULL), good_(false) { memset(&hdr_, 0, sizeof(hdr_)); }
+LogStoreBlockWriter::~LogStoreBlockWriter() { close(); }
+
+// Same layout LogStoreWriter::write produces.  The file is sized at open so blocks can land anywhere
+bool LogStoreBlockWriter::open(const std::string &path, const char *time_name, const std::vector<std::string> &names,
+  const uint64_t nrows, const uint64_t block_rows)
+{
+  close();
+  memset(&hdr_, 0, sizeof(hdr_));
+  memcpy(hdr_.magic, LOG_STORE_MAGIC, sizeof(LOG_STORE_MAGIC));
+  hdr_.version = LOG_STORE_VERSION;
+  hdr_.ncols = uint32_t(names.size());
+  hdr_.nrows = nrows;
+  hdr_.names_off = align_up(sizeof(hdr_));
+  hdr_.time_off = align_up(hdr_.names_off + hdr_.ncols*LOG_STORE_NAME_LEN);
+  hdr_.col_stride = align_up(nrows*sizeof(float));
+  hdr_.data_off = align_up(hdr_.time_off + nrows*sizeof(double));
+  strncpy(hdr_.time_name, time_name, LOG_STORE_NAME_LEN-1);
+
+  fd_ = ::open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+  if ( fd_<0 ) return false;
+  good_ = ftruncate(fd_, off_t(hdr_.data_off + hdr_.ncols*hdr_.col_stride))==0;
+  good_ = good_ && pwrite(fd_, &hdr_, sizeof(hdr_), 0)==ssize_t(sizeof(hdr_));
+  for ( uint32_t c=0; c<hdr_.ncols; c++ )
+  {
+    char name[LOG_STORE_NAME_LEN];
+    memset(name, 0, sizeof(name));
+    strncpy(name, names[c].c_str(), LOG_STORE_NAME_LEN-1);
+    good_ = good_ && pwrite(fd_, name, sizeof(name), off_t(hdr_.names_off + c*LOG_STORE_NAME_LEN))==ssize_t(sizeof(name));
+  }
+  block_rows_ = std::max<uint64_t>(block_rows, 1ULL);
+  block_beg_ = 0ULL;
+  row_ = 0ULL;
+  time_.reserve(block_rows_);
+  time_.clear();
+  cols_.assign(block_rows_*hdr_.ncols, 0.);
+  return good_;
+}
+
+bool LogStoreBlockWriter::add_row(const double t, const float *vals)
+{
+  if ( fd_<0 || row_>=hdr_.nrows ) return false;
+  uint64_t i = time_.size();
+  time_.push_back(t);
+  for ( uint32_t c=0; c<hdr_.ncols; c++ ) cols_[c*block_rows_ + i] = vals[c];
+  row_++;
+  if ( time_.size()==block_rows_ ) return flush();
+  return true;
+}
+
+// Write the partial block, or complain that rows are missing.   Unwritten rows read as zero
+bool LogStoreBlockWriter::close()
+{
+  if ( fd_<0 ) return false;
+  flush();
+  bool good = good_ && row_==hdr_.nrows;
+  ::close(fd_);
+  fd_ = -1;
+  return good;
+}
+
+bool LogStoreBlockWriter::flush()
+{
+  uint64_t n = time_.size();
+  if ( n==0 ) return good_;
+  good_ = good_ && pwrite(fd_, time_.data(), n*sizeof(double), off_t(hdr_.time_off + block_beg_*sizeof(double)))==ssize_t(n*sizeof(double));
+  for ( uint32_t c=0; c<hdr_.ncols; c++ )
+    good_ = good_ && pwrite(fd_, &cols_[c*block_rows_], n*sizeof(float),
+      off_t(hdr_.data_off + c*hdr_.col_stride + block_beg_*sizeof(float)))==ssize_t(n*sizeof(float));
+  block_beg_ += n;
+  time_.clear();
+  return good_;
+}
+
+
+// class LogStore
+LogStore::LogStore() : base_(NULL), size_(0), hdr_(NULL) {}
+LogStore::~LogStore() { close(); }
+
+void LogStore::close()
+{
+  if ( base_ ) munmap((void *)base_, size_);
+  base_ = NULL;
+  size_ = 0;
+  hdr_ = NULL;
+}
+
+const float *LogStore::column(const char *name)
+{
+  int c = find(name);
+  return c<0 ? NULL : column(c);
+}
+
+int LogStore::find(const char *name)
+{
+  for ( int c=0; c<cols(); c++ )
+    if ( strncmp(this->name(c), name, LOG_STORE_NAME_LEN)==0 ) return c;
+  return -1;
+}
+
+// Map whole file read-only.  Pages come in on demand so a slice touches only its rows
+bool LogStore::open(const char *path)
+{
+  close();
+  int fd = ::open(path, O_RDONLY);
+  if ( fd<0 ) return false;
+  struct stat st;
+  if ( fstat(fd, &st)!=0 || size_t(st.st_size)<sizeof(LogStoreHeader) ) { ::close(fd); return false; }
+  void *m = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  ::close(fd);
+  if ( m==MAP_FAILED ) return false;
+  base_ = (const char *)m;
+  size_ = st.st_size;
+  hdr_ = (const LogStoreHeader *)base_;
+  if ( memcmp(hdr_->magic, LOG_STORE_MAGIC, sizeof(LOG_STORE_MAGIC))!=0 || hdr_->version!=LOG_STORE_VERSION ||
+    hdr_->data_off + hdr_->ncols*hdr_->col_stride > size_ )
+  {
+    fprintf(stderr, "LogStore::open: %s not a valid store\n", path);
+    close();
+    return false;
+  }
+  return true;
+}
+
+// Rows with t_beg <= time < t_end.  Time column is sorted at write so this is two binary searches
+LogSlice LogStore::slice(const double t_beg, const double t_end)
+{
+  LogSlice s = {0ULL, 0ULL};
+  if ( !hdr_ ) return s;
+  const double *t = time();
+  s.begin = std::lower_bound(t, t + rows(), t_beg) - t;
+  s.end = std::max(s.begin, uint64_t(std::lower_bound(t, t + rows(), t_end) - t));
+  return s;
+}
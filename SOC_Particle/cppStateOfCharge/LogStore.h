@@ -0,0 +1,163 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Columnar store of captured serial logs for the analysis host.  Not part of the Particle build.
+// Ingests the text printed by print_serial_header / print_fault_header and the matching data lines
+// (vv, Hd, bd outputs) into one mmap-able file per stream with the time column sorted for range queries.
+
+#ifndef _LOG_STORE_H
+#define _LOG_STORE_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <string>
+#include <vector>
+
+#define LOG_STORE_MAGIC     "SOCCOL1"   // File magic, 8 bytes with terminator
+#define LOG_STORE_VERSION   1           // File layout version
+#define LOG_STORE_NAME_LEN  16          // Fixed width of a column name in the name table, bytes
+#define LOG_STORE_ALIGN     64          // Alignment of each column in the file, bytes
+#define LOG_STORE_BLOCK     65536       // Rows buffered per column by LogStoreBlockWriter
+
+// One stream in a capture, e.g. the vv1 'unit,' lines or the 'fltb' fault lines
+struct LogStream
+{
+  const char *suffix;   // Output file suffix, e.g. "_mon"
+  const char *hdr_key;  // Text that identifies the header line, e.g. "unit,"
+  const char *unit_key; // Text that identifies a data line, e.g. "unit_sel" ("" = caller's unit key)
+  int time_col;         // Field index of the time column in the header
+};
+
+// Streams printed by the firmware.  Keys match pyStateOfCharge/load_data.py
+extern const LogStream log_streams[];
+extern const int num_log_streams;
+
+// On-disk header.  Followed by name table, time column (double) and data columns (float)
+struct LogStoreHeader
+{
+  char magic[8];        // LOG_STORE_MAGIC
+  uint32_t version;     // LOG_STORE_VERSION
+  uint32_t ncols;       // Number of float data columns
+  uint64_t nrows;       // Number of rows
+  uint64_t names_off;   // Offset of name table, ncols*LOG_STORE_NAME_LEN, bytes
+  uint64_t time_off;    // Offset of time column, double[nrows], bytes
+  uint64_t data_off;    // Offset of first data column, bytes
+  uint64_t col_stride;  // Distance between data columns, bytes
+  char time_name[LOG_STORE_NAME_LEN];  // Name of the time column
+};
+
+// Fast text to number.  Returns pointer past the number, or start if none found
+const char *parse_double(const char *p, const char *end, double *val);
+
+// Half-open range of rows [begin, end)
+struct LogSlice
+{
+  uint64_t begin;       // First row
+  uint64_t end;         // One past last row
+  uint64_t size() { return(end - begin); };
+};
+
+
+// Accumulates one stream in memory and writes it out once
+class LogStoreWriter
+{
+public:
+  LogStoreWriter();
+  LogStoreWriter(const LogStream *stream);
+  ~LogStoreWriter();
+  // operators
+  // functions
+  bool add_header(const char *line, const char *end);
+  bool add_line(const char *line, const char *end);
+  bool has_header() { return(has_header_); };
+  uint64_t rows() { return(time_.size()); };
+  uint64_t skips() { return(skips_); };
+  bool write(const std::string &path);
+protected:
+  const LogStream *stream_;       // Stream definition
+  bool has_header_;               // First header line seen; it defines the fields
+  int nfields_;                   // Number of comma delimited fields in header
+  std::vector<std::string> names_;// Names of all header fields
+  std::vector<int> numeric_;      // Field index of each stored data column
+  std::vector<double> time_;      // Time column
+  std::vector<std::vector<float>> cols_;  // Data columns
+  std::vector<double> fields_;    // Scratch for one parsed line
+  uint64_t skips_;                // Lines rejected by the checks
+  bool sorted_;                   // Time column monotonic as read
+};
+
+
+// Writes a store whose row count is known up front, e.g. from a generator, without holding it in memory.
+// Rows collect in a block per column and each full block is written at its place in the column.
+// Rows must come in time order
+class LogStoreBlockWriter
+{
+public:
+  LogStoreBlockWriter();
+  ~LogStoreBlockWriter();
+  // operators
+  // functions
+  bool add_row(const double t, const float *vals);
+  bool close();
+  bool open(const std::string &path, const char *time_name, const std::vector<std::string> &names, const uint64_t nrows,
+    const uint64_t block_rows=LOG_STORE_BLOCK);
+  uint64_t rows() { return(row_); };
+protected:
+  bool flush();
+  int fd_;                        // Output file
+  LogStoreHeader hdr_;            // Layout
+  uint64_t block_rows_;           // Rows per block
+  uint64_t block_beg_;            // Row number of first row in block
+  std::vector<double> time_;      // Time block
+  std::vector<float> cols_;       // Data blocks, column c at c*block_rows_
+  uint64_t row_;                  // Rows added
+  bool good_;                     // No write errors
+};
+
+
+// Read-only memory map of a written store with time range queries
+class LogStore
+{
+public:
+  LogStore();
+  ~LogStore();
+  // operators
+  // functions
+  void close();
+  const float *column(const int c) { return((const float *)(base_ + hdr_->data_off + c*hdr_->col_stride)); };
+  const float *column(const char *name);
+  int cols() { return(hdr_ ? int(hdr_->ncols) : 0); };
+  int find(const char *name);
+  const char *name(const int c) { return(base_ + hdr_->names_off + c*LOG_STORE_NAME_LEN); };
+  bool open(const char *path);
+  uint64_t rows() { return(hdr_ ? hdr_->nrows : 0ULL); };
+  LogSlice slice(const double t_beg, const double t_end);
+  const double *time() { return((const double *)(base_ + hdr_->time_off)); };
+  const char *time_name() { return(hdr_->time_name); };
+protected:
+  const char *base_;              // Start of mapping
+  size_t size_;                   // Length of mapping, bytes
+  const LogStoreHeader *hdr_;     // Header at start of mapping
+};
+
+#endif
@@ -0,0 +1,69 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "SocHost.h"
+
+retained Flt_st saved_hist[NHIS];    // For displaying history
+retained Flt_st saved_faults[NFLT];  // For displaying faults
+retained SavedPars sp = SavedPars(saved_hist, uint16_t(NHIS), saved_faults, uint16_t(NFLT));
+VolatilePars ap = VolatilePars();
+CommandPars cp = CommandPars();
+PrinterPars pr = PrinterPars();
+PrintRouter rt = PrintRouter();
+
+// Copies of the helpers in subs.cpp and Sensors.cpp, whose translation units need the hardware drivers
+void bitMapPrint(char *buf, const int16_t fw, const uint8_t num)
+{
+  for ( int i=0; i<num; i++ )
+  {
+    if ( bitRead(fw, i) ) buf[num-i-1] = '1';
+    else  buf[num-i-1] = '0';
+  }
+  buf[num] = '\0';
+}
+
+void time_long_2_chr(const time_t time, char *tempStr)
+{
+  sprintf(tempStr, "%4u-%02u-%02uT%02u:%02u:%02u", Time.year(time), Time.month(time), Time.day(time),
+    Time.hour(time), Time.minute(time), Time.second(time));
+}
+String time_long_2_str(const time_t time, char *tempStr)
+{
+  time_long_2_chr(time, tempStr);
+  return ( String(tempStr) );
+}
+
+void soc_host_setup(const uint8_t modeling, const time_t time_start)
+{
+  static boolean sinks = false;
+  if ( !sinks )
+  {
+    rt.add(new PortSink<USBSerial>("usb", &Serial));
+    rt.add(new PortSink<USARTSerial>("ble", &Serial1));
+    sinks = true;
+  }
+  sp.large_reset();
+  sp.put_modeling(modeling);
+  Time.setTime(time_start);
+  sp.put_Time_now(Time.now());
+}
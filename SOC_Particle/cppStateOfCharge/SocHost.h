@@ -0,0 +1,46 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Firmware globals for host builds of the battery model sources in src.  Not part of the Particle build.
+// Stands in for the global block and the parts of setup() in SOC_Particle.ino that Battery, Coulombs,
+// Chemistry_BMS, Hysteresis, parameters and Fault use.   Saved parameters live in RAM (no EERAM).
+// Build with -Ihost -I../src, the model sources, host/application.cpp, I2cSim.cpp and SerialRAM.cpp.
+
+#ifndef _SOC_HOST_H
+#define _SOC_HOST_H
+
+#include "application.h"
+#include "parameters.h"
+#include "command.h"
+#include "PrintRouter.h"
+
+extern SavedPars sp;              // Various parameters to be static at system level and saved through power cycle
+extern VolatilePars ap;           // Various adjustment parameters shared at system level
+extern CommandPars cp;            // Various parameters shared at system level
+extern PrinterPars pr;            // Print buffer structure
+extern PrintRouter rt;            // Fan out to Serial and Serial1
+
+// Nominal parameters, modeling bits (sp.modeling(), 'Xm') and clock start like a cold boot
+void soc_host_setup(const uint8_t modeling, const time_t time_start);
+
+#endif
@@ -0,0 +1,2 @@
+// Host stand-in for the Particle Arduino.h.  Not part of the Particle build
+#include "application.h"
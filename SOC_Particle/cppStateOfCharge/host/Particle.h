@@ -0,0 +1,7 @@
+// Host stand-in for the Particle Particle.h.  Not part of the Particle build
+#include "application.h"
+
+// SOC_Particle.ino drops ARDUINO ahead of Adafruit_GFX.h, which lands here.   The host Print is the ARDUINO>=100 one
+#ifndef ARDUINO
+  #define ARDUINO 100
+#endif
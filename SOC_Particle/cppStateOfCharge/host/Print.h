@@ -0,0 +1,2 @@
+// Host stand-in for the Particle Print.h.  Not part of the Particle build
+#include "application.h"
@@ -0,0 +1,11 @@
+// Host stand-in for the Particle Wire.h so drivers in src build against the I2C bus simulator.
+// Not part of the Particle build.   Compile with -Ihost ahead of anything else.
+
+#ifndef _HOST_WIRE_H
+#define _HOST_WIRE_H
+
+#include "../I2cSim.h"
+
+extern TwoWire Wire;
+
+#endif
@@ -0,0 +1,106 @@
+// Host stand-in for the Particle Device OS runtime.  Not part of the Particle build.
+
+#include "application.h"
+
+// Ahead of the firmware globals, whose constructors print and read the clock
+HostSerial Serial __attribute__((init_priority(101))) (stdout);
+HostSerial Serial1 __attribute__((init_priority(101))) (NULL);
+SystemClass System __attribute__((init_priority(101)));
+TimeClass Time __attribute__((init_priority(101)));
+ParticleClass Particle;
+WiFiClass WiFi;
+LoggerClass Log;
+SPIClass SPI;
+static I2cBus host_bus;   // Nothing attached:  SerialRAM links in with parameters.cpp but the host tools run without EERAM
+TwoWire Wire(&host_bus);
+
+// Room to write, refilled at rate_ since last asked
+int HostSerial::availableForWrite()
+{
+  if ( !cap_ ) return 1024;
+  unsigned long long t = clock_();
+  room_ = min(room_ + double(t - t_)*rate_, double(cap_));
+  t_ = t;
+  return room_>0. ? int(room_) : 0;
+}
+
+void HostSerial::limit(const int cap, const double bytes_per_ms, std::function<unsigned long long()> clock,
+  std::function<void(const unsigned long)> wait)
+{
+  cap_ = ( clock && wait && bytes_per_ms>0. ) ? cap : 0;
+  rate_ = bytes_per_ms;
+  clock_ = clock;
+  wait_ = wait;
+  t_ = clock_ ? clock_() : 0ULL;
+  room_ = cap;
+}
+
+size_t HostSerial::write(const uint8_t *buf, const size_t n)
+{
+  if ( cap_ )
+  {
+    availableForWrite();
+    room_ -= double(n);
+    if ( room_<0. )
+    {
+      wait_((unsigned long)ceil(-room_/rate_));
+      availableForWrite();
+    }
+  }
+  if ( out_ ) fwrite(buf, 1, n, out_);
+  return n;
+}
+
+void String::replace(const String &from, const String &to)
+{
+  if ( from.s_.empty() ) return;
+  size_t p = 0;
+  while ( (p = s_.find(from.s_, p)) != std::string::npos )
+  {
+    s_.replace(p, from.s_.size(), to.s_);
+    p += to.s_.size();
+  }
+}
+
+String String::format(const char *format, ...)
+{
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  return String(buf);
+}
+
+void String::trim()
+{
+  size_t a = s_.find_first_not_of(" \t\r\n");
+  size_t b = s_.find_last_not_of(" \t\r\n");
+  s_ = ( a==std::string::npos ) ? std::string() : s_.substr(a, b-a+1);
+}
+
+size_t Print::printf(const char *format, ...)
+{
+  char buf[512];
+  va_list args;
+  va_start(args, format);
+  int n = vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  if ( n<0 ) return 0;
+  return write((const uint8_t *)buf, min(size_t(n), sizeof(buf)-1));
+}
+
+time_t TimeClass::now()
+{
+  return epoch_ + time_t(System.millis()/1000ULL);
+}
+
+void TimeClass::setTime(const time_t t)
+{
+  epoch_ = t - time_t(System.millis()/1000ULL);
+}
+
+unsigned long millis() { return (unsigned long)System.millis(); }
+unsigned long micros() { return (unsigned long)(System.millis()*1000ULL); }
+void delay(const unsigned long ms) { System.advance(ms); }
+void delayMicroseconds(const unsigned int) {}
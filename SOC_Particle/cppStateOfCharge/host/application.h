@@ -0,0 +1,276 @@
+// Host stand-in for the Particle Device OS application.h so the battery model sources in src build
+// on the analysis host.   Not part of the Particle build.   Compile with -Ihost ahead of anything else.
+// Only what the model sources and the headers they pull in use is here.   Serial writes to stdout,
+// Serial1 is discarded, and time is a virtual clock the host tool advances with System.advance().
+
+#ifndef _HOST_APPLICATION_H
+#define _HOST_APPLICATION_H
+
+#include <stdint.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <limits.h>
+#include <string>
+#include <algorithm>
+#include <functional>
+#include <vector>
+#include <Wire.h>     // Ahead of the min/max macros below, which break the standard headers
+
+#ifndef PLATFORM_ID
+  #define PLATFORM_ID 32        // Photon 2, same as local_config.h builds
+#endif
+#define PLATFORM_PHOTON     6
+#define PLATFORM_ARGON      12
+#define PLATFORM_P2         32
+
+typedef bool boolean;
+typedef uint8_t byte;
+typedef int pin_t;
+
+#define retained
+#define SYSTEM_THREAD(x)
+#define FEATURE_RETAINED_MEMORY 1
+#define F(x) x
+#define PROGMEM
+#define pgm_read_byte(a) (*(const uint8_t *)(a))
+#define pgm_read_word(a) (*(const uint16_t *)(a))
+#define pgm_read_dword(a) (*(const uint32_t *)(a))
+#define pgm_read_pointer(a) (*(void * const *)(a))
+
+#ifndef PI
+  #define PI 3.1415926535897932384626433832795
+#endif
+#ifndef max
+  #define max(a, b) (((a)>(b)) ? (a) : (b))
+#endif
+#ifndef min
+  #define min(a, b) (((a)<(b)) ? (a) : (b))
+#endif
+#define constrain(x, a, b) ((x)<(a) ? (a) : ((x)>(b) ? (b) : (x)))
+#define bitRead(v, b) (((v)>>(b)) & 1)
+#define bitSet(v, b) ((v) |= (1UL<<(b)))
+#define bitClear(v, b) ((v) &= ~(1UL<<(b)))
+#define bitWrite(v, b, x) ((x) ? bitSet(v, b) : bitClear(v, b))
+
+// Pins.  Values only need to be distinct
+#define LOW     0
+#define HIGH    1
+#define INPUT   0
+#define OUTPUT  1
+#define INPUT_PULLUP 2
+#define D0 0
+#define D1 1
+#define D2 2
+#define D3 3
+#define D4 4
+#define D5 5
+#define D6 6
+#define D7 7
+#define A0 10
+#define A1 11
+#define A2 12
+#define A3 13
+#define A4 14
+#define A5 15
+#define A6 16
+#define D10 10
+#define D11 11
+#define D12 12
+#define D13 13
+#define D14 14
+#define S4 24
+inline void pinMode(pin_t, int) {}
+inline void digitalWrite(pin_t, uint8_t) {}
+inline int32_t digitalRead(pin_t) { return 0; }
+inline int32_t analogRead(pin_t) { return 0; }
+inline void pinResetFast(pin_t) {}
+inline void pinSetFast(pin_t) {}
+inline int32_t pinReadFast(pin_t) { return 0; }
+inline void HAL_Pin_Mode(pin_t, int) {}
+inline int analogGetReference() { return 0; }
+
+
+// Wiring String, the subset the sources use
+class String
+{
+public:
+  String() {}
+  String(const char *c) : s_(c ? c : "") {}
+  String(const std::string &x) : s_(x) {}
+  String(const char c) : s_(1, c) {}
+  String(const int v) : s_(std::to_string(v)) {}
+  String(const unsigned v) : s_(std::to_string(v)) {}
+  String(const long v) : s_(std::to_string(v)) {}
+  String(const unsigned long v) : s_(std::to_string(v)) {}
+  String(const long long v) : s_(std::to_string(v)) {}
+  String(const unsigned long long v) : s_(std::to_string(v)) {}
+  String(const double v, const int d=2) { char b[40]; snprintf(b, sizeof(b), "%.*f", d, v); s_ = b; }
+  // operators
+  String &operator+=(const String &o) { s_ += o.s_; return *this; }
+  String &operator+=(const char *c) { s_ += c; return *this; }
+  String &operator+=(const char c) { s_ += c; return *this; }
+  bool operator==(const String &o) const { return s_==o.s_; }
+  bool operator!=(const String &o) const { return s_!=o.s_; }
+  // functions
+  const char *c_str() const { return s_.c_str(); }
+  char charAt(const unsigned i) const { return i<s_.size() ? s_[i] : 0; }
+  bool equals(const String &o) const { return s_==o.s_; }
+  static String format(const char *format, ...);
+  int indexOf(const char c, const unsigned from=0) const { size_t p = s_.find(c, from); return p==std::string::npos ? -1 : int(p); }
+  int indexOf(const String &c) const { size_t p = s_.find(c.s_); return p==std::string::npos ? -1 : int(p); }
+  unsigned length() const { return s_.size(); }
+  void remove(const unsigned i) { if ( i<s_.size() ) s_.erase(i); }
+  void remove(const unsigned i, const unsigned n) { if ( i<s_.size() ) s_.erase(i, n); }
+  void replace(const String &from, const String &to);
+  void reserve(const unsigned n) { s_.reserve(n); }
+  String substring(const unsigned a) const { return a<s_.size() ? String(s_.substr(a)) : String(); }
+  String substring(const unsigned a, const unsigned b) const { return a<s_.size() && b>a ? String(s_.substr(a, b-a)) : String(); }
+  void toCharArray(char *buf, const unsigned n) const { if ( n ) { strncpy(buf, s_.c_str(), n-1); buf[n-1] = '\0'; } }
+  float toFloat() const { return atof(s_.c_str()); }
+  long toInt() const { return atol(s_.c_str()); }
+  void trim();
+protected:
+  std::string s_;
+};
+inline String operator+(const String &a, const String &b) { String r(a); r += b; return r; }
+inline String operator+(const String &a, const char *b) { String r(a); r += b; return r; }
+inline String operator+(const char *a, const String &b) { String r(a); r += b; return r; }
+
+
+// Print and Stream
+class __FlashStringHelper;
+class Print
+{
+public:
+  virtual ~Print() {}
+  // functions
+  size_t print(const char *s) { return write((const uint8_t *)s, strlen(s)); }
+  size_t print(const String &s) { return print(s.c_str()); }
+  size_t print(const int v, const int base=10) { return printf(base==16 ? "%x" : "%d", v); }
+  size_t print(const double v, const int d=2) { return printf("%.*f", d, v); }
+  size_t printf(const char *format, ...) __attribute__((format(printf, 2, 3)));
+  size_t println(const char *s="") { return print(s) + print("\n"); }
+  size_t println(const String &s) { return println(s.c_str()); }
+  size_t println(const int v, const int base=10) { return print(v, base) + print("\n"); }
+  virtual size_t write(const uint8_t c) = 0;
+  virtual size_t write(const uint8_t *buf, const size_t n) { for ( size_t i=0; i<n; i++ ) write(buf[i]); return n; }
+};
+
+class Stream : public Print
+{
+public:
+  virtual int available() { return 0; }
+  virtual void flush() {}
+  virtual int peek() { return -1; }
+  virtual int read() { return -1; }
+};
+
+// Serial ports.  out==NULL discards.   Input is whatever the host tool feed()s, as if typed.   Room to write is
+// 1024 unless limit() makes it a port that takes bytes_per_ms on the clock given, up to cap at once.   A write past
+// the room waits for it with the wait given, as the Device OS blocks
+class HostSerial : public Stream
+{
+public:
+  HostSerial(FILE *out) : cap_(0), out_(out), rate_(0.), room_(0.), t_(0ULL) {}
+  // functions
+  int available() { return int(in_.size()); }
+  int availableForWrite();
+  void begin(const long) {}
+  void blockOnOverrun(const bool) {}
+  void feed(const char *s) { in_ += s; }
+  void limit(const int cap, const double bytes_per_ms, std::function<unsigned long long()> clock,
+    std::function<void(const unsigned long)> wait);
+  void out(FILE *out) { out_ = out; }
+  int peek() { return in_.empty() ? -1 : (unsigned char)in_[0]; }
+  int read() { if ( in_.empty() ) return -1; int c = (unsigned char)in_[0]; in_.erase(0, 1); return c; }
+  using Print::write;
+  size_t write(const uint8_t c) { return write(&c, 1); }
+  size_t write(const uint8_t *buf, const size_t n);
+protected:
+  int cap_;           // Most the port takes at once, 0 = unlimited
+  std::function<unsigned long long()> clock_;  // Time, ms
+  std::string in_;    // Not yet read
+  FILE *out_;
+  double rate_;       // Bytes the port takes each ms
+  double room_;       // Bytes it would take now, < 0 while behind
+  unsigned long long t_;  // Time room_ was last refilled, ms
+  std::function<void(const unsigned long)> wait_;  // Pass time, ms
+};
+typedef HostSerial USBSerial;
+typedef HostSerial USARTSerial;
+extern HostSerial Serial;
+extern HostSerial Serial1;
+
+
+// Virtual clock.   Starts at 0 ms since boot and at the Unix time set by Time.setTime().   backupRamSync() calls
+// on_sync, if set, so a host tool can keep what the backup RAM would have saved
+class SystemClass
+{
+public:
+  SystemClass() : n_sync(0UL), now_ms_(0ULL) {}
+  // functions
+  void advance(const uint64_t ms) { now_ms_ += ms; }
+  void backupRamSync() { n_sync++; if ( on_sync ) on_sync(); }
+  void enableFeature(const int) {}
+  uint64_t millis() { return now_ms_; }
+  unsigned long n_sync;           // Backup RAM saves
+  std::function<void()> on_sync;  // Called on each save
+protected:
+  uint64_t now_ms_;   // Virtual time since boot, ms
+};
+extern SystemClass System;
+
+class TimeClass
+{
+public:
+  TimeClass() : epoch_(0) {}
+  // functions
+  int day(const time_t t) { return gmt(t)->tm_mday; }
+  int hour(const time_t t) { return gmt(t)->tm_hour; }
+  int minute(const time_t t) { return gmt(t)->tm_min; }
+  int month(const time_t t) { return gmt(t)->tm_mon + 1; }
+  time_t now();
+  int second(const time_t t) { return gmt(t)->tm_sec; }
+  void setTime(const time_t t);
+  int year(const time_t t) { return gmt(t)->tm_year + 1900; }
+  void zone(const float) {}
+protected:
+  struct tm *gmt(const time_t t) { return gmtime(&t); }
+  time_t epoch_;      // Unix time at System.millis()==0, s
+};
+extern TimeClass Time;
+
+unsigned long millis();
+unsigned long micros();
+void delay(const unsigned long ms);
+void delayMicroseconds(const unsigned int us);
+
+// Cloud and logging, inert
+struct ParticleClass { bool connected() { return false; } void connect() {} void syncTime() {} };
+extern ParticleClass Particle;
+struct WiFiClass { void off() {} };
+extern WiFiClass WiFi;
+struct LoggerClass { void info(const char *, ...) {} void warn(const char *, ...) {} void error(const char *, ...) {} void trace(const char *, ...) {} };
+extern LoggerClass Log;
+
+// SPI, inert
+#define SPI_CLOCK_DIV2 2
+class SPIClass { public: void begin() {} void setClockDivider(const int) {} uint8_t transfer(const uint8_t) { return 0; } };
+extern SPIClass SPI;
+
+#define CLOCK_SPEED_100KHZ  100000
+#define CLOCK_SPEED_400KHZ  400000
+
+#define ARDUINO 100
+#define SPARK               // Adafruit_GFX takes the Particle branch
+
+// print64.h is uint64_t (unsigned long here, unsigned long long on the target)
+String toString(uint64_t value, unsigned char base);
+inline String toString(unsigned long long value, unsigned char base=10) { return toString(uint64_t(value), base); }
+
+#endif
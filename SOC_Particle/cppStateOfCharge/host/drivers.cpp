@@ -0,0 +1,17 @@
+// Host stand-ins for the sensor and display drivers SOC_Particle.ino, Sensors.cpp, serial.cpp and subs.cpp construct.
+// Not part of the Particle build.   Nothing is attached:  the host runs the 2-wire Photon 2 configuration, where the
+// models and injection ('Xm') supply every signal and these objects are never read.
+
+#include "application.h"
+#include "DS18B20.h"
+#include "Adafruit/Adafruit_ADS1X15.h"
+#include "Adafruit/Adafruit_SSD1306.h"
+
+DS18B20::DS18B20(uint16_t, bool, const uint16_t) {}
+DS18B20::~DS18B20() {}
+
+Adafruit_ADS1015::Adafruit_ADS1015() {}
+
+void Adafruit_GFX::setTextSize(uint8_t) {}
+void Adafruit_SSD1306::clearDisplay(void) {}
+void Adafruit_SSD1306::display(void) {}
@@ -0,0 +1,292 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// I2C bus occupancy per 100 ms read frame.  Not part of the Particle build.
+// The EERAM traffic comes from the real src/hardware/SerialRAM.cpp built against I2cSim.
+// ADS1015, SSD1306 and DS2482 traffic replays the transactions the firmware's drivers issue
+// (Adafruit_ADS1X15::readADC_Differential_0_1, Adafruit_SSD1306::display, DS2482-RK search and
+// temperature commands) at the rates set in src/constants.h.
+
+#include "I2cSim.h"
+#include "../src/hardware/SerialRAM.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Rates from src/constants.h
+#define READ_DELAY_MS         100.      // Sensor read frame, ms
+#define READ_TEMP_DELAY_MS    6011.     // Temperature read, ms
+#define DISPLAY_USER_DELAY_MS 1200.     // OLED update and EERAM dynamic save, ms
+#define SUMMARY_DELAY_S       1800.     // History snapshot, s
+#define DS18_CONVERT_MS       750.      // DS18B20 12 bit conversion, ms
+#define ADS_COUNT_MAX         200       // Adafruit_ADS1X15 conversionComplete poll limit
+
+I2cBus bus;
+TwoWire Wire(&bus);
+
+
+// Adafruit_ADS1X15::readADC_Differential_0_1 with the Shunt setup (GAIN_EIGHT, 1600 SPS single shot)
+static int ads_read_diff_0_1(const uint8_t addr)
+{
+  const uint16_t config = 0x8000 | 0x0003 | 0x0100 | 0x0600 | 0x0080;  // OS, CQUE_NONE, SINGLE, PGA 0.512, 1600 SPS, MUX 0_1
+  uint8_t buffer[3] = {0x01, uint8_t(config>>8), uint8_t(config&0xFF)};
+  Wire.beginTransmission(addr);
+  Wire.write(buffer, 3);
+  Wire.endTransmission();
+  uint16_t count = 0;
+  uint16_t reg = 0;
+  do
+  {
+    Wire.beginTransmission(addr);
+    Wire.write(uint8_t(0x01));
+    Wire.endTransmission();
+    Wire.requestFrom(addr, 2);
+    reg = (Wire.read()<<8) | Wire.read();
+  } while ( !(reg & 0x8000) && ++count<ADS_COUNT_MAX );
+  Wire.beginTransmission(addr);
+  Wire.write(uint8_t(0x00));
+  Wire.endTransmission();
+  Wire.requestFrom(addr, 2);
+  Wire.read();
+  Wire.read();
+  return count;
+}
+
+// Adafruit_SSD1306::display over I2C:  command list, then the frame buffer in Wire buffer sized chunks
+static void oled_display(const uint8_t addr, const uint16_t w, const uint16_t h, const uint32_t clk_during, const uint32_t clk_after)
+{
+  const uint8_t dlist1[] = {0x22, 0, 0xFF, 0x21, 0};  // PAGEADDR 0 0xFF, COLUMNADDR 0
+  Wire.setClock(clk_during);
+  Wire.beginTransmission(addr);
+  Wire.write(uint8_t(0x00));
+  Wire.write(dlist1, sizeof(dlist1));
+  Wire.endTransmission();
+  Wire.beginTransmission(addr);
+  Wire.write(uint8_t(0x00));
+  Wire.write(uint8_t(w-1));
+  Wire.endTransmission();
+  uint16_t count = w * ((h + 7) / 8);
+  Wire.beginTransmission(addr);
+  Wire.write(uint8_t(0x40));
+  uint16_t bytes_out = 1;
+  while ( count-- )
+  {
+    if ( bytes_out>=I2C_SIM_BUFFER )
+    {
+      Wire.endTransmission();
+      Wire.beginTransmission(addr);
+      Wire.write(uint8_t(0x40));
+      bytes_out = 1;
+    }
+    Wire.write(uint8_t(0));
+    bytes_out++;
+  }
+  Wire.endTransmission();
+  Wire.setClock(clk_after);
+}
+
+// DS2482 command, then status polls until 1WB clears
+static void ow_cmd(const uint8_t addr, const uint8_t cmd, const int arg=-1)
+{
+  Wire.beginTransmission(addr);
+  Wire.write(cmd);
+  if ( arg>=0 ) Wire.write(uint8_t(arg));
+  Wire.endTransmission();
+  uint8_t status = 0;
+  do
+  {
+    Wire.requestFrom(addr, 1);
+    status = Wire.read();
+  } while ( status & 0x01 );
+}
+
+static void ow_read_byte(const uint8_t addr)
+{
+  ow_cmd(addr, 0x96);
+  Wire.beginTransmission(addr);
+  Wire.write(uint8_t(0xE1));
+  Wire.write(uint8_t(0xE1));
+  Wire.endTransmission();
+  Wire.requestFrom(addr, 1);
+  Wire.read();
+}
+
+// Search ROM, one pass per device plus the pass that finds no more, then skip ROM convert T
+static void ds_search_convert(const uint8_t addr, const int n_dev)
+{
+  for ( int d=0; d<=n_dev; d++ )
+  {
+    ow_cmd(addr, 0xB4);
+    ow_cmd(addr, 0xA5, 0xF0);
+    for ( int b=0; b<64; b++ ) ow_cmd(addr, 0x78, 0x80);
+  }
+  ow_cmd(addr, 0xB4);
+  ow_cmd(addr, 0xA5, 0xCC);
+  ow_cmd(addr, 0xA5, 0x44);
+}
+
+// Match ROM and read the scratchpad of each device
+static void ds_read_temps(const uint8_t addr, const int n_dev)
+{
+  for ( int d=0; d<n_dev; d++ )
+  {
+    ow_cmd(addr, 0xB4);
+    ow_cmd(addr, 0xA5, 0x55);
+    for ( int b=0; b<8; b++ ) ow_cmd(addr, 0xA5, 0x00);
+    ow_cmd(addr, 0xA5, 0xBE);
+    for ( int b=0; b<9; b++ ) ow_read_byte(addr);
+  }
+}
+
+// Round-robin of the old SavedPars::put_all_dynamic, one field a pass:  delta_q, delta_q_model, T_state, T_state_model,
+// Time_now.   PersistSched now writes fewer (soc_persist), so this is the worst case
+static void eeram_put_dynamic(SerialRAM *ram, const uint32_t now_s)
+{
+  static uint8_t blink = 0;
+  switch ( blink++ )
+  {
+    case ( 0 ): ram->put(0x0010, double(-1.5)); break;
+    case ( 1 ): ram->put(0x0018, double(-1.5)); break;
+    case ( 2 ): ram->put(0x0020, float(20.)); break;
+    case ( 3 ): ram->put(0x0024, float(20.)); break;
+    default:    ram->put(0x0028, now_s); blink = 0; break;
+  }
+}
+
+// Flt_ram::put writes a history record field by field
+static void eeram_put_history(SerialRAM *ram, const uint16_t base, const uint32_t now_s)
+{
+  uint16_t a = base;
+  ram->put(a, now_s); a += 4;
+  for ( int i=0; i<15; i++ ) { ram->put(a, int16_t(i)); a += 2; }
+  ram->put(a, uint32_t(0)); a += 4;
+  ram->put(a, uint32_t(0));
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage:  i2c_bus [--frames n] [--clock hz] [--ads n] [--eeram] [--oled] [--oled_clk hz]\n"
+                  "                [--ds2482 n_sensors] [--summary_s s] [--csv file]\n");
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t frames = 600;
+  uint32_t clock_hz = I2C_SIM_CLOCK_HZ;
+  int n_ads = 0;
+  bool eeram = false;
+  bool oled = false;
+  uint32_t oled_clk = 400000;
+  int n_ds = 0;
+  double summary_s = SUMMARY_DELAY_S;
+  const char *csv_name = NULL;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--frames")==0 && more ) frames = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--clock")==0 && more ) clock_hz = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--ads")==0 && more ) n_ads = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--eeram")==0 ) eeram = true;
+    else if ( strcmp(argv[i], "--oled")==0 ) oled = true;
+    else if ( strcmp(argv[i], "--oled_clk")==0 && more ) oled_clk = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--ds2482")==0 && more ) n_ds = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--summary_s")==0 && more ) summary_s = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--csv")==0 && more ) csv_name = argv[++i];
+    else { usage(); return 2; }
+  }
+  bus.clock(clock_hz);
+
+  // Same addresses as the firmware:  ShuntAmp 0x49, ShuntNoAmp 0x48, EERAM 0x50/0x18, OLED 0x3C, DS2482 0x18
+  Ads1015 amp("ads_amp", 0x49), noa("ads_noa", 0x48);
+  Eeram47L16 ee;
+  Eeram47L16Ctrl ee_ctl;
+  Ssd1306 disp;
+  Ds2482 ds;
+  int err = 0;
+  if ( n_ads>0 ) err |= bus.attach(&amp);
+  if ( n_ads>1 ) err |= bus.attach(&noa);
+  if ( eeram ) { err |= bus.attach(&ee); err |= bus.attach(&ee_ctl); }
+  if ( oled ) err |= bus.attach(&disp);
+  if ( n_ds>0 ) err |= bus.attach(&ds);
+  if ( err ) return 1;
+  if ( bus.devices().empty() ) { usage(); return 2; }
+
+  FILE *csv = NULL;
+  if ( csv_name )
+  {
+    csv = fopen(csv_name, "w");
+    if ( !csv ) { fprintf(stderr, "cannot open %s\n", csv_name); return 1; }
+    bus.print_csv_header(csv);
+  }
+
+  SerialRAM ram;
+  if ( eeram )
+  {
+    ram.begin(0, 0);
+    ram.setAutoStore(true);
+  }
+
+  const double frame_us = READ_DELAY_MS * 1000.;
+  double t_temp = 0., t_disp = 0., t_sum = summary_s*1e6;
+  double t_read_temps = -1.;
+  uint16_t ihis = 0;
+  uint32_t ads_polls = 0, ads_reads = 0;
+  for ( uint32_t k=0; k<frames; k++ )
+  {
+    double t = bus.now_us();
+    if ( n_ads>0 ) { ads_polls += ads_read_diff_0_1(amp.addr()); ads_reads++; }
+    if ( n_ads>1 ) { ads_polls += ads_read_diff_0_1(noa.addr()); ads_reads++; }
+    if ( n_ds>0 && t>=t_temp )
+    {
+      ds_search_convert(ds.addr(), n_ds);
+      t_read_temps = t + DS18_CONVERT_MS*1000.;
+      t_temp += READ_TEMP_DELAY_MS*1000.;
+    }
+    if ( n_ds>0 && t_read_temps>=0. && t>=t_read_temps )
+    {
+      ds_read_temps(ds.addr(), n_ds);
+      t_read_temps = -1.;
+    }
+    if ( t>=t_disp )
+    {
+      if ( oled ) oled_display(disp.addr(), 128, 32, oled_clk, clock_hz);
+      if ( eeram ) eeram_put_dynamic(&ram, uint32_t(t/1e6));
+      t_disp += DISPLAY_USER_DELAY_MS*1000.;
+    }
+    if ( eeram && t>=t_sum )
+    {
+      eeram_put_history(&ram, 0x0100 + 42*ihis, uint32_t(t/1e6));
+      if ( ++ihis>=20 ) ihis = 0;
+      t_sum += summary_s*1e6;
+    }
+    bus.frame_end(csv, frame_us);
+  }
+
+  bus.print_summary(stdout, frame_us);
+  if ( ads_reads ) printf("  ADS conversionComplete polls per read %.2f\n", double(ads_polls)/ads_reads + 1.);
+  if ( n_ds>0 ) printf("  DS2482 1-wire commands %u\n", ds.n_ow);
+  if ( oled ) printf("  OLED command bytes %u, data bytes %u\n", disp.n_cmd, disp.n_data);
+  if ( Wire.truncations() ) printf("  Wire buffer truncations %u\n", Wire.truncations());
+  if ( csv ) fclose(csv);
+  return 0;
+}
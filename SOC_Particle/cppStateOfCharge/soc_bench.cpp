@@ -0,0 +1,320 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Cost of the filter sets the firmware runs each frame, new'd myFilters objects called through pointers against the
+// myFiltersT value types that Fault, Looparound, Shunt, TempSensor, Sensors and the Battery classes hold now.   Not
+// part of the Particle build.   Each frame is the set one object updates:  'fault' the 16 persistence timers and the
+// lag, rate and 2-pole filters of Fault; 'sensors' the calibration lags, the Tb and shunt 2-poles and the Tb
+// deadband; 'monitor' the ChargeTransfer lag, y filter, voc deadband and convergence timer of BatteryMonitor.
+// Both run the same inputs, with the update time jittering like Sen->T, and must give the same outputs to the bit.
+// Last, the hum monitor's per-sample work as HumMonitor::step does it, the HUM_NBIN Goertzel bins with and without
+// the notch, on a 60 Hz tone:  the 60 Hz bin must read the tone and the notch must take it out.   analogRead is not
+// in it; 'XB2' on the target times Shunt::hum_sample with the reads.
+// Times are the least over '--passes' so that a busy host does not matter.
+
+#include <chrono>
+#include <string.h>
+#include "application.h"
+#include "myLibrary/myFilters.h"
+#include "myLibrary/myFiltersT.h"
+#include "myLibrary/Goertzel.h"
+#include "constants.h"
+
+#define BENCH_T         0.1       // Nominal update time, s (0.1)
+#define BENCH_NP        16        // Persistence timers in the Fault frame, NUM_FLT_PER (16)
+#define BENCH_NS        4         // Calibration lags in the Sensors frame (4)
+#define BENCH_NG        3         // 2-poles in the Sensors frame, Tb and two shunts (3)
+#define BENCH_NHUM      3         // Hum monitors sampled each grid slot, two shunts and Vb (3)
+#define BENCH_HUM_A     0.01      // Test tone amplitude, V (0.01)
+#define BENCH_HUM_TOL   0.02      // Allowed error of the 60 Hz bin, fraction (0.02)
+#define BENCH_NOTCH_MAX 0.05      // Allowed notch output, fraction of the tone (0.05)
+
+// Outputs of one run, to compare the two
+struct Out
+{
+  double sum;
+  uint32_t mask;
+  double ns;          // Least ns per frame over the passes
+};
+
+static double ns_since(const std::chrono::steady_clock::time_point &t0)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Input and update time of frame k
+static double in_k(const uint32_t k) { return sin(double(k)*0.05); }
+static double T_k(const uint32_t k) { return BENCH_T + 0.001*(k & 3); }
+static double Tt_i(const int i) { return 0.5 + 0.1*i; }
+static double Tf_i(const int i) { return 0.3 + 0.1*i; }
+
+// Fault:  persistence timers, IbErrFilt, QuietRate, QuietFilt
+static Out fault_p(const uint32_t n, const int passes)
+{
+  Out o = {0., 0UL, 1e32};
+  for ( int p=0; p<passes; p++ )
+  {
+    TFDelay *Per[BENCH_NP];
+    for ( int i=0; i<BENCH_NP; i++ ) Per[i] = new TFDelay(false, Tt_i(i), Tf_i(i), BENCH_T);
+    LagTustin *Lag = new LagTustin(BENCH_T, 1., -10., 10.);
+    RateLagExp *Rate = new RateLagExp(BENCH_T, 0.5, -10., 10.);
+    General2_Pole *Pole = new General2_Pole(BENCH_T, 2., 0.7, -10., 10.);  // no destructor for its integrators
+    o.sum = 0.;  o.mask = 0UL;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<n; k++ )
+    {
+      double in = in_k(k), T = T_k(k);
+      for ( int i=0; i<BENCH_NP; i++ )
+        if ( Per[i]->calculate(in > 0.1*(i-8), Tt_i(i), Tf_i(i), T, k==0) ) o.mask ^= (1UL << i);
+      o.sum += Lag->calculate(in, k==0, T) + Rate->calculate(in, k==0, T) + Pole->calculate(in, k==0, T);
+    }
+    o.ns = min(o.ns, ns_since(t0)/double(n));
+    for ( int i=0; i<BENCH_NP; i++ ) delete Per[i];
+    delete Lag;
+    delete Rate;
+  }
+  return ( o );
+}
+static Out fault_v(const uint32_t n, const int passes)
+{
+  Out o = {0., 0UL, 1e32};
+  for ( int p=0; p<passes; p++ )
+  {
+    TFDelayBank<BENCH_NP> Per;
+    for ( int i=0; i<BENCH_NP; i++ ) Per.init(i, false, Tt_i(i), Tf_i(i), BENCH_T);
+    LagTustinT<double> Lag(BENCH_T, 1., -10., 10.);
+    RateLagExpT<double> Rate(BENCH_T, 0.5, -10., 10.);
+    General2_PoleT<double> Pole(BENCH_T, 2., 0.7, -10., 10.);
+    o.sum = 0.;  o.mask = 0UL;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<n; k++ )
+    {
+      double in = in_k(k), T = T_k(k);
+      for ( int i=0; i<BENCH_NP; i++ )
+        if ( Per.calculate(i, in > 0.1*(i-8), Tt_i(i), Tf_i(i), T, k==0) ) o.mask ^= (1UL << i);
+      o.sum += Lag.calculate(in, k==0, T) + Rate.calculate(in, k==0, T) + Pole.calculate(in, k==0, T);
+    }
+    o.ns = min(o.ns, ns_since(t0)/double(n));
+  }
+  return ( o );
+}
+
+// Sensors:  AmpFilt, NoaFilt, SelFilt, VbFilt, TbSenseFilt, two Shunt Filt_, TempSensor SdTb
+static Out sensors_p(const uint32_t n, const int passes)
+{
+  Out o = {0., 0UL, 1e32};
+  for ( int p=0; p<passes; p++ )
+  {
+    LagExp *Lag[BENCH_NS];
+    for ( int i=0; i<BENCH_NS; i++ ) Lag[i] = new LagExp(BENCH_T, 0.5 + 0.1*i, -10., 10.);
+    General2_Pole *Pole[BENCH_NG];
+    for ( int i=0; i<BENCH_NG; i++ ) Pole[i] = new General2_Pole(BENCH_T, 0.5 + 0.2*i, 0.9, -10., 10.);
+    SlidingDeadband *Sd = new SlidingDeadband(0.05);
+    o.sum = 0.;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<n; k++ )
+    {
+      double in = in_k(k), T = T_k(k);
+      for ( int i=0; i<BENCH_NS; i++ ) o.sum += Lag[i]->calculate(in, k==0, 0.5 + 0.1*i, T);
+      for ( int i=0; i<BENCH_NG; i++ ) o.sum += Pole[i]->calculate(in, k==0, T);
+      o.sum += Sd->update(in);
+    }
+    o.ns = min(o.ns, ns_since(t0)/double(n));
+    for ( int i=0; i<BENCH_NS; i++ ) delete Lag[i];
+    delete Sd;
+  }
+  return ( o );
+}
+static Out sensors_v(const uint32_t n, const int passes)
+{
+  Out o = {0., 0UL, 1e32};
+  for ( int p=0; p<passes; p++ )
+  {
+    LagExpT<double> Lag[BENCH_NS];
+    for ( int i=0; i<BENCH_NS; i++ ) Lag[i] = LagExpT<double>(BENCH_T, 0.5 + 0.1*i, -10., 10.);
+    General2_PoleT<double> Pole[BENCH_NG];
+    for ( int i=0; i<BENCH_NG; i++ ) Pole[i] = General2_PoleT<double>(BENCH_T, 0.5 + 0.2*i, 0.9, -10., 10.);
+    SlidingDeadbandT<double> Sd(0.05);
+    o.sum = 0.;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<n; k++ )
+    {
+      double in = in_k(k), T = T_k(k);
+      for ( int i=0; i<BENCH_NS; i++ ) o.sum += Lag[i].calculate(in, k==0, 0.5 + 0.1*i, T);
+      for ( int i=0; i<BENCH_NG; i++ ) o.sum += Pole[i].calculate(in, k==0, T);
+      o.sum += Sd.update(in);
+    }
+    o.ns = min(o.ns, ns_since(t0)/double(n));
+  }
+  return ( o );
+}
+
+// BatteryMonitor:  ChargeTransfer_, y_filt, SdVb_, EKF_converged
+static Out monitor_p(const uint32_t n, const int passes)
+{
+  Out o = {0., 0UL, 1e32};
+  for ( int p=0; p<passes; p++ )
+  {
+    LagExp *Ct = new LagExp(BENCH_T, 2., -10., 10.);
+    LagTustin *Y = new LagTustin(2., 1., -10., 10.);
+    SlidingDeadband *Sd = new SlidingDeadband(0.05);
+    TFDelay *Conv = new TFDelay(false, 1., 1., BENCH_T);
+    o.sum = 0.;  o.mask = 0UL;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<n; k++ )
+    {
+      double in = in_k(k), T = T_k(k);
+      double y = Y->calculate(in, k==0, T);
+      o.sum += Ct->calculate(in, k==0, 2., T) + y + Sd->update(in);
+      if ( Conv->calculate(fabs(y)<0.5, 1., 1., T, k==0) ) o.mask++;
+    }
+    o.ns = min(o.ns, ns_since(t0)/double(n));
+    delete Ct;
+    delete Y;
+    delete Sd;
+    delete Conv;
+  }
+  return ( o );
+}
+static Out monitor_v(const uint32_t n, const int passes)
+{
+  Out o = {0., 0UL, 1e32};
+  for ( int p=0; p<passes; p++ )
+  {
+    LagExpT<double> Ct(BENCH_T, 2., -10., 10.);
+    LagTustinT<double> Y(2., 1., -10., 10.);
+    SlidingDeadbandT<double> Sd(0.05);
+    TFDelayT<double> Conv(false, 1., 1., BENCH_T);
+    o.sum = 0.;  o.mask = 0UL;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<n; k++ )
+    {
+      double in = in_k(k), T = T_k(k);
+      double y = Y.calculate(in, k==0, T);
+      o.sum += Ct.calculate(in, k==0, 2., T) + y + Sd.update(in);
+      if ( Conv.calculate(fabs(y)<0.5, 1., 1., T, k==0) ) o.mask++;
+    }
+    o.ns = min(o.ns, ns_since(t0)/double(n));
+  }
+  return ( o );
+}
+
+// Hum monitor work of one sample, as HumMonitor::step
+struct Hum
+{
+  Goertzel Bin[HUM_NBIN];
+  NotchT<float> Notch;
+  float amp[HUM_NBIN];
+  uint16_t n;
+  float x0;
+  float notched;
+  Hum() : Notch(60., HUM_FS, HUM_NOTCH_Q), n(0), x0(0.), notched(0.)
+  {
+    const float bin_hz[HUM_NBIN] = {50., 60., 100., 120., 150., 180.};
+    for ( uint8_t i=0; i<HUM_NBIN; i++ ) { Bin[i] = Goertzel(bin_hz[i], HUM_FS);  amp[i] = 0.; }
+  }
+  void step(const float in, const boolean notch)
+  {
+    if ( notch ) notched = Notch.calculate(in, false);
+    else notched = in;
+    if ( n==0 ) x0 = in;
+    float x = in - x0;
+    for ( uint8_t i=0; i<HUM_NBIN; i++ ) Bin[i].update(x);
+    if ( ++n>=HUM_N )
+    {
+      for ( uint8_t i=0; i<HUM_NBIN; i++ ) { amp[i] = Bin[i].amplitude(n);  Bin[i].reset(); }
+      n = 0;
+    }
+  }
+};
+
+// Hum samples of a 60 Hz tone on 1.65 V.   Returns the least ns per sample; amp_60 and notch_max for the check
+static double hum(const uint32_t n, const int passes, const boolean notch, float *amp_60, float *notch_max)
+{
+  uint32_t ns = (n/HUM_N)*HUM_N;
+  float w = 2.*PI*60./HUM_FS;
+  float *in = new float[ns];
+  for ( uint32_t k=0; k<ns; k++ ) in[k] = 1.65 + BENCH_HUM_A*sin(w*float(k));
+  double best = 1e32;
+  for ( int p=0; p<passes; p++ )
+  {
+    Hum H;
+    H.Notch.calculate(in[0], true);
+    *notch_max = 0.;
+    auto t0 = std::chrono::steady_clock::now();
+    for ( uint32_t k=0; k<ns; k++ )
+    {
+      H.step(in[k], notch);
+      if ( k>=ns/2 ) *notch_max = max(*notch_max, float(fabs(H.notched - 1.65)));  // settled
+    }
+    best = min(best, ns_since(t0)/double(ns));
+    *amp_60 = H.amp[1];
+  }
+  delete[] in;
+  return ( best );
+}
+
+// One frame both ways.   Returns true when the outputs match
+static boolean report(const char *name, const Out &p, const Out &v)
+{
+  boolean match = p.sum==v.sum && p.mask==v.mask;
+  printf("  %-8s  myFilters %8.1f ns  myFiltersT %8.1f ns  %5.2fx  %s\n", name, p.ns, v.ns, p.ns/max(v.ns, 1e-3),
+    match ? "match" : "DIFFER");
+  if ( !match ) printf("    sum %.17g / %.17g  mask %x / %x\n", p.sum, v.sum, p.mask, v.mask);
+  return ( match );
+}
+
+int main(int argc, char **argv)
+{
+  uint32_t n = 100000;
+  int passes = 10;
+  for ( int i=1; i<argc; i++ )
+  {
+    boolean more = i+1<argc;
+    if ( strcmp(argv[i], "--frames")==0 && more ) n = max(atol(argv[++i]), 1L);
+    else if ( strcmp(argv[i], "--passes")==0 && more ) passes = max(atoi(argv[++i]), 1);
+    else
+    {
+      fprintf(stderr, "usage:  soc_bench [--frames n] [--passes n]\n");
+      return ( 2 );
+    }
+  }
+
+  printf("soc_bench:  %u frames, least of %d passes, ns per frame\n", n, passes);
+  boolean ok = true;
+  ok &= report("fault", fault_p(n, passes), fault_v(n, passes));
+  ok &= report("sensors", sensors_p(n, passes), sensors_v(n, passes));
+  ok &= report("monitor", monitor_p(n, passes), monitor_v(n, passes));
+
+  float amp_60, notch_max;
+  double ns_bins = hum(n, passes, false, &amp_60, &notch_max);
+  double ns_notch = hum(n, passes, true, &amp_60, &notch_max);
+  boolean hum_ok = fabs(amp_60 - BENCH_HUM_A) <= BENCH_HUM_TOL*BENCH_HUM_A && notch_max <= BENCH_NOTCH_MAX*BENCH_HUM_A;
+  printf("  hum       %d bins %6.1f ns  + notch %6.1f ns per sample,  %d monitors %6.4f%% of the %lu us grid\n",
+    HUM_NBIN, ns_bins, ns_notch, BENCH_NHUM, ns_notch*BENCH_NHUM/(HUM_T_US*1e3)*100., HUM_T_US);
+  printf("            60 Hz bin %7.5f of %5.3f V, notched %7.5f V  %s\n", amp_60, BENCH_HUM_A, notch_max,
+    hum_ok ? "ok" : "BAD");
+  ok &= hum_ok;
+  printf("soc_bench:  %s\n", ok ? "pass" : "FAIL");
+  return ( ok ? 0 : 1 );
+}
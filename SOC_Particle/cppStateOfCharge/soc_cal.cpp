@@ -0,0 +1,705 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Least-squares calibration of the Chemistry_BMS tables against recorded runs.   Not part of the Particle build.
+// Fits T_VOC, T_R, T_DV_MAX, T_DV_MIN and T_SOC_MIN of the CHEM in src/local_config.h by replaying
+// LogStore '_mon' files (soc_log ingest, or soc_gen --bin) through the firmware's Chemistry and Hysteresis:
+//
+//   vb = voc_T(soc, Tb) + dvoc + dv_voc_soc + hys_scale*dv_hys + dv_dyn
+//   soc at each bms_off onset = soc_min_T(Tb)
+//
+// vb is linear in T_VOC through the table weights.   dv_hys depends on T_R, T_DV_MAX and T_DV_MIN through the
+// Hysteresis ode, so its Jacobian is carried forward each step beside the real Hysteresis::update (forward
+// sensitivity).   Levenberg-Marquardt on the normal equations.   The runs are cut into chunks that start
+// --warm seconds early to settle the hysteresis state; each chunk's normal equations are independent, so
+// threads share them out and the sums are made in chunk order (same answer on any number of jobs).
+// Threads each own a Chemistry, so the table values never race; the model reads the sp/ap globals only.
+// The Monitor runs with hysteresis disabled (dv_hys_=0 in BatteryMonitor::calculate), so T_R, T_DV_MAX
+// and T_DV_MIN matter to the Sim and to the tables a future Monitor would use.
+
+#include <atomic>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+#include <unistd.h>
+#include "LogStore.h"
+#include "SocHost.h"
+#include "Battery.h"
+#include "Hysteresis.h"
+#include "myLibrary/myFilters.h"
+
+#define CAL_WARM        3600.     // Settling time ahead of each chunk, s
+#define CAL_CHUNK       21600.    // Chunk length, s
+#define CAL_GAP         60.       // Time step treated as a break in the record, s
+#define CAL_ITER        30        // LM iterations limit
+#define CAL_MIN_N       100       // Samples needed on a T_VOC entry to fit it
+#define CAL_TOL         1e-5      // Stop on relative sse improvement below
+#define CAL_RIDGE       1e-6      // Weight pulling each entry to its starting value, fraction of one vb residual
+#define CAL_R_MIN       1e-4      // Floor on fitted T_R, ohms
+#define CAL_DV_MIN      1e-3      // Floor on |T_DV_MAX|, |T_DV_MIN|, V
+
+// One record, copied out of the store
+struct Run
+{
+  std::string name;
+  std::vector<double> t;        // Time, s
+  std::vector<float> tb;        // Temperature, deg C
+  std::vector<float> vb;        // Unit voltage, V
+  std::vector<float> ib;        // Unit current, A
+  std::vector<float> soc;       // Coulomb counted soc, fraction
+  std::vector<float> dv_dyn;    // Recorded dynamic voltage, V (empty = compute with ChargeTransfer)
+  std::vector<uint8_t> sat;     // Saturated, T=saturated
+  std::vector<uint8_t> off;     // BMS off, T=off
+};
+
+// Piece of a run.  Residuals from beg, hysteresis integration from warm
+struct Chunk
+{
+  int run;
+  size_t warm;
+  size_t beg;
+  size_t end;
+};
+
+// Normal equations of a chunk
+struct Normal
+{
+  std::vector<double> A;        // J'J
+  std::vector<double> b;        // J'r
+  std::vector<int> count;       // Samples that touched each parameter
+  double sse;                   // Sum of squared residuals, vb
+  double sse_soc;               // Sum of squared residuals, soc_min
+  double sse_prior;             // Ridge penalty
+  uint64_t n;                   // vb residuals
+  uint64_t n_soc;               // soc_min residuals
+  void clear(const int P) { A.assign(P*P, 0.); b.assign(P, 0.); count.assign(P, 0); sse = sse_soc = sse_prior = 0.; n = n_soc = 0ULL; };
+  void add(const Normal &o);
+};
+
+void Normal::add(const Normal &o)
+{
+  for ( size_t i=0; i<A.size(); i++ ) A[i] += o.A[i];
+  for ( size_t i=0; i<b.size(); i++ ) { b[i] += o.b[i]; count[i] += o.count[i]; }
+  sse += o.sse;  sse_soc += o.sse_soc;
+  n += o.n;  n_soc += o.n_soc;
+}
+
+// Parameter vector over the tables of a Chemistry.   Hysteresis parameters are contiguous from o_r to o_soc
+struct Layout
+{
+  int n_voc, n_r, m_h, n_n;
+  int o_voc, o_r, o_max, o_min, o_soc, P;
+  int nh() { return o_soc - o_r; };
+  void get(Chemistry *chem, std::vector<double> *p);
+  void put(Chemistry *chem, const std::vector<double> &p);
+  Layout() : P(0) {};
+  Layout(Chemistry *chem);
+};
+
+Layout::Layout(Chemistry *chem)
+{
+  n_voc = chem->voc_T_->n1() * chem->voc_T_->n2();
+  n_r = chem->hys_T_->n1() * chem->hys_T_->n2();
+  m_h = chem->hys_Tx_->n1();
+  n_n = chem->soc_min_T_->n1();
+  o_voc = 0;
+  o_r = o_voc + n_voc;
+  o_max = o_r + n_r;
+  o_min = o_max + m_h;
+  o_soc = o_min + m_h;
+  P = o_soc + n_n;
+}
+
+void Layout::get(Chemistry *chem, std::vector<double> *p)
+{
+  p->resize(P);
+  for ( int i=0; i<n_voc; i++ ) (*p)[o_voc+i] = chem->voc_T_->v()[i];
+  for ( int i=0; i<n_r; i++ ) (*p)[o_r+i] = chem->hys_T_->v()[i];
+  for ( int i=0; i<m_h; i++ ) { (*p)[o_max+i] = chem->hys_Tx_->v()[i];  (*p)[o_min+i] = chem->hys_Tn_->v()[i]; }
+  for ( int i=0; i<n_n; i++ ) (*p)[o_soc+i] = chem->soc_min_T_->v()[i];
+}
+
+void Layout::put(Chemistry *chem, const std::vector<double> &p)
+{
+  for ( int i=0; i<n_voc; i++ ) chem->voc_T_->v()[i] = p[o_voc+i];
+  for ( int i=0; i<n_r; i++ ) chem->hys_T_->v()[i] = p[o_r+i];
+  for ( int i=0; i<m_h; i++ ) { chem->hys_Tx_->v()[i] = p[o_max+i];  chem->hys_Tn_->v()[i] = p[o_min+i]; }
+  for ( int i=0; i<n_n; i++ ) chem->soc_min_T_->v()[i] = p[o_soc+i];
+}
+
+// Options
+struct Opts
+{
+  const char *ib_name;          // Current column
+  float ns;                     // Series units in vb
+  float np;                     // Parallel units in ib
+  double warm;                  // Settling time, s
+  double chunk;                 // Chunk length, s
+  int every;                    // Use every n'th sample as a vb residual
+  int min_n;                    // Support needed to fit a T_VOC entry
+  double ridge;                 // Prior weight, see CAL_RIDGE
+  bool fit_voc, fit_hys, fit_soc;
+};
+
+static bool load_run(const char *path, const Opts &o, Run *r)
+{
+  LogStore ls;
+  if ( !ls.open(path) ) return false;
+  const float *tb = ls.column("Tb");
+  const float *vb = ls.column("vb");
+  const float *ib = ls.column(o.ib_name);
+  const float *soc = ls.column("soc");
+  const float *dv_dyn = ls.column("dv_dyn");
+  const float *sat = ls.column("sat");
+  const float *off = ls.column("bms_off");
+  if ( !off ) off = ls.column("bmso");
+  if ( !tb || !vb || !ib || !soc )
+  {
+    fprintf(stderr, "%s:  need Tb, vb, %s and soc columns\n", path, o.ib_name);
+    return false;
+  }
+  size_t n = ls.rows();
+  const double *t = ls.time();
+  r->name = path;
+  r->t.assign(t, t+n);
+  r->tb.assign(tb, tb+n);
+  r->vb.resize(n);
+  r->ib.resize(n);
+  for ( size_t i=0; i<n; i++ ) { r->vb[i] = vb[i] / o.ns;  r->ib[i] = ib[i] / o.np; }
+  r->soc.assign(soc, soc+n);
+  if ( dv_dyn ) r->dv_dyn.assign(dv_dyn, dv_dyn+n);
+  r->sat.assign(n, 0);
+  r->off.assign(n, 0);
+  for ( size_t i=0; i<n; i++ )
+  {
+    if ( sat ) r->sat[i] = sat[i] > 0.5;
+    if ( off ) r->off[i] = off[i] > 0.5;
+  }
+  return n > 1;
+}
+
+// Chunks of --chunk seconds, each starting --warm early, restarting at breaks in the record
+static void make_chunks(const std::vector<Run> &runs, const Opts &o, std::vector<Chunk> *chunks)
+{
+  for ( size_t r=0; r<runs.size(); r++ )
+  {
+    const std::vector<double> &t = runs[r].t;
+    size_t start = 0;                 // First sample after the latest break
+    size_t beg = 0;
+    for ( size_t k=1; k<=t.size(); k++ )
+    {
+      bool brk = k==t.size() || t[k]-t[k-1]>CAL_GAP || t[k]<t[k-1];
+      if ( brk || t[k]-t[beg]>=o.chunk )
+      {
+        size_t warm = beg;
+        while ( warm>start && t[beg]-t[warm-1]<=o.warm ) warm--;
+        Chunk c = {int(r), warm, beg, k};
+        chunks->push_back(c);
+        beg = k;
+        if ( brk ) start = k;
+      }
+    }
+  }
+}
+
+// Add w*row'row and w*row'r.  Repeated indices (clipped table corners) sum correctly
+static void accumulate(Normal *N, const int P, const std::vector<int> &idx, const std::vector<double> &val, const double r)
+{
+  size_t m = idx.size();
+  for ( size_t i=0; i<m; i++ )
+  {
+    double vi = val[i];
+    double *Ai = &N->A[idx[i]*P];
+    for ( size_t j=0; j<m; j++ ) Ai[idx[j]] += vi * val[j];
+    N->b[idx[i]] += vi * r;
+  }
+}
+
+// Residuals and Jacobian of one chunk.  Follows BatterySim::calculate for the hysteresis calls
+static void chunk_pass(const Run &r, const Chunk &c, Chemistry *chem, Layout &L, const Opts &o, Normal *N)
+{
+  const int P = L.P;
+  const int nh = L.nh();
+  Hysteresis hys(chem);
+  LagExp ChargeTransfer(0.1, chem->tau_ct, -NOM_UNIT_CAP, NOM_UNIT_CAP);
+  std::vector<double> s(nh, 0.);      // d(dv_hys)/d(hysteresis parameters)
+  std::vector<int> idx;
+  std::vector<double> val;
+  idx.reserve(4 + nh);
+  val.reserve(4 + nh);
+  const float hys_scale = ap.hys_scale;
+  const double dt_cap = 1. / chem->hys_cap;
+  hys.init(0.);
+  boolean off_past = r.off[c.warm];
+  int k4[4];
+  float w4[4];
+  for ( size_t k=c.warm; k<c.end; k++ )
+  {
+    double dt = k>c.warm ? r.t[k] - r.t[k-1] : 0.;
+    float soc = r.soc[k];
+    float tb = r.tb[k];
+    float ib = r.ib[k];
+    boolean off = r.off[k];
+    boolean use = k>=c.beg;
+
+    // Hysteresis, sensitivity at the state before the step
+    float dv = hys.dv_hys();
+    float dres, dslr;
+    float res = chem->hys_T_->interp(dv, soc);
+    chem->hys_T_->weights(dv, soc, k4, w4, &dres);
+    int ks[4];
+    float ws[4];
+    chem->hys_Ts_->weights(dv, soc, ks, ws, &dslr);
+    float dv_dot = hys.calculate(ib, soc, hys_scale);
+    boolean init_low = off || ( soc<(chem->soc_min_T_->interp(tb)+HYS_SOC_MIN_MARG) && ib>HYS_IB_THR );
+    boolean init_high = r.sat[k];
+    hys.update(dt, init_high, init_low, 0., hys_scale, k==c.warm);
+    float dv_max = chem->hys_Tx_->interp(soc);
+    float dv_min = chem->hys_Tn_->interp(soc);
+    float dv_new;
+    if ( init_high || init_low || k==c.warm )
+    {
+      dv_new = init_high ? -chem->dv_min_abs : ( init_low ? chem->dv_min_abs : 0. );
+      std::fill(s.begin(), s.end(), 0.);
+    }
+    else
+    {
+      dv_new = dv + dv_dot*dt;
+      if ( nh && res>0. )
+      {
+        double a = 1. + dt*dt_cap*(ib*dslr - 1./res + dv*dres/res/res);
+        for ( int j=0; j<nh; j++ ) s[j] *= a;
+        for ( int i=0; i<4; i++ ) s[k4[i]] += dt*dt_cap*dv/res/res*w4[i];
+      }
+    }
+    if ( dv_new>dv_max || dv_new<dv_min )
+    {
+      TableInterp1D *bound = dv_new>dv_max ? chem->hys_Tx_ : chem->hys_Tn_;
+      int o_b = ( dv_new>dv_max ? L.o_max : L.o_min ) - L.o_r;
+      std::fill(s.begin(), s.end(), 0.);
+      int kb[2];
+      float wb[2];
+      bound->weights(soc, kb, wb);
+      for ( int i=0; i<2; i++ ) s[o_b+kb[i]] += wb[i];
+    }
+    dv = hys.dv_hys();
+
+    // Dynamic voltage as BatteryMonitor::calculate
+    float dvdyn;
+    if ( r.dv_dyn.empty() )
+      dvdyn = ChargeTransfer.calculate(ib, k==c.warm, chem->tau_ct, max(dt, 0.001))*chem->r_ct*ap.slr_res + ib*chem->r_0*ap.slr_res;
+    else
+      dvdyn = r.dv_dyn[k];
+
+    // vb residual
+    if ( use && !off && soc>=-0.2 && soc<=1. && (k-c.beg)%o.every==0 )
+    {
+      idx.clear();
+      val.clear();
+      chem->voc_T_->weights(soc, tb, k4, w4);
+      float voc = chem->lookup_voc(soc, tb);
+      if ( o.fit_voc )
+        for ( int i=0; i<4; i++ )
+          if ( w4[i]!=0. ) { idx.push_back(L.o_voc+k4[i]);  val.push_back(w4[i]);  N->count[L.o_voc+k4[i]]++; }
+      if ( o.fit_hys )
+        for ( int j=0; j<nh; j++ )
+          if ( s[j]!=0. ) { idx.push_back(L.o_r+j);  val.push_back(hys_scale*s[j]); }
+      double e = double(r.vb[k]) - (voc + ap.dv_voc_soc + hys_scale*dv + dvdyn);
+      accumulate(N, P, idx, val, e);
+      N->sse += e*e;
+      N->n++;
+    }
+
+    // soc_min residual at each bms_off onset.   Cold shutoffs say nothing about soc
+    if ( use && off && !off_past && tb>chem->low_t )
+    {
+      int k2[2];
+      float w2[2];
+      idx.clear();
+      val.clear();
+      chem->soc_min_T_->weights(tb, k2, w2);
+      if ( o.fit_soc )
+        for ( int i=0; i<2; i++ )
+          if ( w2[i]!=0. ) { idx.push_back(L.o_soc+k2[i]);  val.push_back(w2[i]);  N->count[L.o_soc+k2[i]]++; }
+      double e = double(soc) - chem->soc_min_T_->interp(tb);
+      accumulate(N, P, idx, val, e);
+      N->sse_soc += e*e;
+      N->n_soc++;
+    }
+    off_past = off;
+  }
+}
+
+// Normal equations of all chunks at p, on jobs threads
+class Evaluator
+{
+public:
+  Evaluator(const std::vector<Run> &runs, const std::vector<Chunk> &chunks, const Opts &o, const int jobs_max);
+  // functions
+  void eval(const std::vector<double> &p, const int jobs, Normal *N);
+  Layout &layout() { return L_; };
+protected:
+  const std::vector<Run> &runs_;
+  const std::vector<Chunk> &chunks_;
+  const Opts &o_;
+  std::vector<Chemistry *> chem_;   // One per thread
+  std::vector<Normal> part_;        // One per chunk
+  Layout L_;
+};
+
+Evaluator::Evaluator(const std::vector<Run> &runs, const std::vector<Chunk> &chunks, const Opts &o, const int jobs_max)
+  : runs_(runs), chunks_(chunks), o_(o)
+{
+  for ( int j=0; j<jobs_max; j++ ) chem_.push_back(new Chemistry());
+  L_ = Layout(chem_[0]);
+  part_.resize(chunks.size());
+}
+
+void Evaluator::eval(const std::vector<double> &p, const int jobs, Normal *N)
+{
+  std::atomic<size_t> next(0);
+  std::vector<std::thread> pool;
+  for ( int j=0; j<jobs; j++ )
+  {
+    L_.put(chem_[j], p);
+    pool.push_back(std::thread([this, j, &next]()
+    {
+      for ( size_t c=next++; c<chunks_.size(); c=next++ )
+      {
+        part_[c].clear(L_.P);
+        chunk_pass(runs_[chunks_[c].run], chunks_[c], chem_[j], L_, o_, &part_[c]);
+      }
+    }));
+  }
+  for ( size_t j=0; j<pool.size(); j++ ) pool[j].join();
+  N->clear(L_.P);
+  for ( size_t c=0; c<part_.size(); c++ ) N->add(part_[c]);
+}
+
+// Solve (A + lambda*diag(A)) d = b over the free parameters by Cholesky.   Fixed parameters get d=0.
+// With cov, also the diagonal of the inverse of A
+static bool solve(const Normal &N, const std::vector<bool> &free_p, const double lambda, std::vector<double> *d,
+  std::vector<double> *cov=NULL)
+{
+  const int P = int(free_p.size());
+  std::vector<int> f;
+  for ( int i=0; i<P; i++ ) if ( free_p[i] ) f.push_back(i);
+  const int m = int(f.size());
+  d->assign(P, 0.);
+  if ( cov ) cov->assign(P, 0.);
+  if ( m==0 ) return true;
+  std::vector<double> M(m*m), y(m);
+  for ( int i=0; i<m; i++ )
+  {
+    for ( int j=0; j<m; j++ ) M[i*m+j] = N.A[f[i]*P+f[j]];
+    M[i*m+i] *= 1. + lambda;
+    y[i] = N.b[f[i]];
+  }
+  for ( int j=0; j<m; j++ )
+  {
+    double s = M[j*m+j];
+    for ( int k=0; k<j; k++ ) s -= M[j*m+k]*M[j*m+k];
+    if ( s<=0. ) return false;
+    M[j*m+j] = sqrt(s);
+    for ( int i=j+1; i<m; i++ )
+    {
+      double t = M[i*m+j];
+      for ( int k=0; k<j; k++ ) t -= M[i*m+k]*M[j*m+k];
+      M[i*m+j] = t / M[j*m+j];
+    }
+  }
+  std::vector<double> z(m);
+  auto chol_solve = [&](std::vector<double> &x)
+  {
+    for ( int i=0; i<m; i++ ) { double t = x[i];  for ( int k=0; k<i; k++ ) t -= M[i*m+k]*x[k];  x[i] = t / M[i*m+i]; }
+    for ( int i=m-1; i>=0; i-- ) { double t = x[i];  for ( int k=i+1; k<m; k++ ) t -= M[k*m+i]*x[k];  x[i] = t / M[i*m+i]; }
+  };
+  chol_solve(y);
+  for ( int i=0; i<m; i++ ) (*d)[f[i]] = y[i];
+  if ( cov )
+    for ( int i=0; i<m; i++ )
+    {
+      z.assign(m, 0.);
+      z[i] = 1.;
+      chol_solve(z);
+      (*cov)[f[i]] = z[i];
+    }
+  return true;
+}
+
+// Keep the tables physical
+static void limit(Layout &L, std::vector<double> *p)
+{
+  for ( int i=0; i<L.n_r; i++ ) (*p)[L.o_r+i] = max((*p)[L.o_r+i], CAL_R_MIN);
+  for ( int i=0; i<L.m_h; i++ )
+  {
+    (*p)[L.o_max+i] = max((*p)[L.o_max+i], CAL_DV_MIN);
+    (*p)[L.o_min+i] = min((*p)[L.o_min+i], -CAL_DV_MIN);
+  }
+}
+
+static double wall_now()
+{
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return double(t.tv_sec) + double(t.tv_nsec)*1e-9;
+}
+
+static double total(const Normal &N) { return N.sse + N.sse_soc + N.sse_prior; }
+
+// Ridge toward the starting tables.   Pins the directions the data cannot see, e.g. a run at one temperature
+// sees only a blend of the two T_VOC rows around it
+static void add_prior(Normal *N, const std::vector<double> &p, const std::vector<double> &p_prior,
+  const std::vector<bool> &free_p, const double ridge)
+{
+  const int P = int(p.size());
+  double rho = ridge * max(double(N->n), 1.);
+  for ( int i=0; i<P; i++ )
+  {
+    if ( !free_p[i] ) continue;
+    double e = p_prior[i] - p[i];
+    N->A[i*P+i] += rho;
+    N->b[i] += rho * e;
+    N->sse_prior += rho * e * e;
+  }
+}
+
+// Rows of a table in Chemistry_BMS.cpp layout
+static void print_rows(FILE *fp, const char *decl, const char *comment, const std::vector<double> &p, const int off,
+  const int n1, const int n2, const char *fmt)
+{
+  fprintf(fp, "    %s = // %s\n        {", decl, comment);
+  for ( int j=0; j<n2; j++ )
+  {
+    if ( j ) fprintf(fp, "\n        ");
+    for ( int i=0; i<n1; i++ ) { fprintf(fp, fmt, p[off + i + j*n1]);  fprintf(fp, ", "); }
+  }
+  fprintf(fp, "};\n");
+}
+
+static void print_breaks(FILE *fp, const char *decl, const char *comment, const float *x, const int n, const char *fmt)
+{
+  fprintf(fp, "    %s = // %s\n        {", decl, comment);
+  for ( int i=0; i<n; i++ ) { fprintf(fp, fmt, x[i]);  fprintf(fp, ", "); }
+  fprintf(fp, "};\n");
+}
+
+// Drop-in replacement for the table definitions of this CHEM in Chemistry_BMS.cpp (assign_BB / assign_CH)
+static void print_tables(FILE *fp, Chemistry *chem, Layout &L, const std::vector<double> &p, const Normal &N)
+{
+  char date[16];
+  time_t now = time(NULL);
+  strftime(date, sizeof(date), "%Y-%m-%d", localtime(&now));
+  TableInterp2D *voc = chem->voc_T_;
+  TableInterp2D *hys = chem->hys_T_;
+  int n_s = voc->n1(), m_t = voc->n2(), n_h = hys->n1(), m_h = hys->n2(), n_n = L.n_n;
+  std::vector<double> s(m_h * n_h);
+  for ( int i=0; i<m_h*n_h; i++ ) s[i] = chem->hys_Ts_->v()[i];
+  fprintf(fp, "    // %s:  tune to data (soc_cal, %llu samples, rms %.4f V)\n", date, (unsigned long long)N.n,
+    sqrt(N.sse / max(double(N.n), 1.)));
+  fprintf(fp, "    const uint8_t M_T = %d;    // Number temperature breakpoints for voc table\n", m_t);
+  fprintf(fp, "    const uint8_t N_S = %d;   // Number soc breakpoints for voc table\n", n_s);
+  print_breaks(fp, "float Y_T[M_T]", "Temperature breakpoints for voc table", voc->y(), m_t, "%5.1f");
+  print_breaks(fp, "float X_SOC[N_S]", "soc breakpoints for voc table", voc->x(), n_s, "%6.3f");
+  print_rows(fp, "float T_VOC[M_T * N_S]", "r(soc, dv) table", p, L.o_voc, n_s, m_t, "%6.3f");
+  fprintf(fp, "    const uint8_t N_N = %d;                                          // Number of temperature breakpoints for x_soc_min table\n", n_n);
+  fprintf(fp, "    float X_SOC_MIN[N_N] = {");
+  for ( int i=0; i<n_n; i++ ) fprintf(fp, "%5.1f, ", chem->soc_min_T_->x()[i]);
+  fprintf(fp, "};      // Temperature breakpoints for soc_min table\n");
+  fprintf(fp, "    float T_SOC_MIN[N_N] = {");
+  for ( int i=0; i<n_n; i++ ) fprintf(fp, "%5.3f, ", p[L.o_soc+i]);
+  fprintf(fp, "}; // soc_min(t)\n\n");
+  fprintf(fp, "    const uint8_t M_H = %d;     // Number of soc breakpoints in r(soc, dv) table t_r, t_s\n", m_h);
+  fprintf(fp, "    const uint8_t N_H = %d;     // Number of dv breakpoints in r(dv) table t_r, t_s\n", n_h);
+  print_breaks(fp, "float X_DV[N_H]", "dv breakpoints for r(soc, dv) table t_r, t_s", hys->x(), n_h, "%5.2f");
+  print_breaks(fp, "float Y_SOC[M_H]", "soc breakpoints for r(soc, dv) table t_r, t_s", hys->y(), m_h, "%4.2f");
+  print_rows(fp, "float T_R[M_H * N_H]", "r(soc, dv) table", p, L.o_r, n_h, m_h, "%6.4f");
+  print_rows(fp, "float T_S[M_H * N_H]", "s(soc, dv) table", s, 0, n_h, m_h, "%3.1f");
+  print_rows(fp, "float T_DV_MAX[M_H]", "dv_max(soc) table", p, L.o_max, m_h, 1, "%6.3f");
+  print_rows(fp, "float T_DV_MIN[M_H]", "dv_min(soc) table", p, L.o_min, m_h, 1, "%6.3f");
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_cal [--ib name] [--ns n] [--np n] [--warm s] [--chunk s] [--every n] [--min_n n] [--ridge w]\n"
+                  "                [--fit voc,hys,soc] [--iter n] [--jobs n] [--scaling] [--perturb frac] [--seed n]\n"
+                  "                [--out file] run_mon.soc [...]\n");
+}
+
+int main(int argc, char **argv)
+{
+  Opts o = {"ib", 1., 1., CAL_WARM, CAL_CHUNK, 1, CAL_MIN_N, CAL_RIDGE, true, true, true};
+  int iter = CAL_ITER;
+  int jobs = int(sysconf(_SC_NPROCESSORS_ONLN));
+  bool scaling = false;
+  double perturb = 0.;
+  unsigned seed = 1;
+  const char *out_name = NULL;
+  std::vector<const char *> files;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--ib")==0 && more ) o.ib_name = argv[++i];
+    else if ( strcmp(argv[i], "--ns")==0 && more ) o.ns = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--np")==0 && more ) o.np = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--warm")==0 && more ) o.warm = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--chunk")==0 && more ) o.chunk = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--every")==0 && more ) o.every = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--min_n")==0 && more ) o.min_n = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--ridge")==0 && more ) o.ridge = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--fit")==0 && more )
+    {
+      const char *f = argv[++i];
+      o.fit_voc = strstr(f, "voc")!=NULL;
+      o.fit_hys = strstr(f, "hys")!=NULL;
+      o.fit_soc = strstr(f, "soc")!=NULL;
+    }
+    else if ( strcmp(argv[i], "--iter")==0 && more ) iter = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--jobs")==0 && more ) jobs = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--scaling")==0 ) scaling = true;
+    else if ( strcmp(argv[i], "--perturb")==0 && more ) perturb = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--seed")==0 && more ) seed = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--out")==0 && more ) out_name = argv[++i];
+    else if ( argv[i][0]=='-' ) { usage(); return 2; }
+    else files.push_back(argv[i]);
+  }
+  if ( files.empty() || o.ns<=0. || o.np<=0. || o.chunk<=0. || o.every<1 || jobs<1 ) { usage(); return 2; }
+
+  // Model prints go to stderr so the table block on stdout is clean
+  Serial.out(stderr);
+  soc_host_setup(0, time(NULL));
+
+  std::vector<Run> runs(files.size());
+  for ( size_t f=0; f<files.size(); f++ )
+    if ( !load_run(files[f], o, &runs[f]) ) { fprintf(stderr, "cannot use %s\n", files[f]); return 1; }
+  std::vector<Chunk> chunks;
+  make_chunks(runs, o, &chunks);
+  Evaluator ev(runs, chunks, o, jobs);
+  Layout &L = ev.layout();
+  Chemistry chem_nom;
+  std::vector<double> p0, p;
+  L.get(&chem_nom, &p0);
+  p = p0;
+  uint64_t samples = 0ULL;
+  for ( size_t r=0; r<runs.size(); r++ ) samples += runs[r].t.size();
+  fprintf(stderr, "soc_cal:  CHEM %d, %zu runs, %llu samples, %zu chunks, %d parameters\n", CHEM, runs.size(),
+    (unsigned long long)samples, chunks.size(), L.P);
+
+  // Wall clock of one evaluation against jobs
+  Normal N, Nt;
+  if ( scaling )
+  {
+    double t1 = 0.;
+    fprintf(stderr, "%6s %10s %8s %8s\n", "jobs", "wall_s", "speedup", "effic");
+    for ( int j=1; j<=jobs; j = ( j<jobs && 2*j>jobs ) ? jobs : 2*j )
+    {
+      double t0 = wall_now();
+      ev.eval(p, j, &N);
+      double w = wall_now() - t0;
+      if ( j==1 ) t1 = w;
+      fprintf(stderr, "%6d %10.3f %8.2f %8.2f\n", j, w, t1/w, t1/w/j);
+    }
+  }
+
+  // Fit what the data supports
+  ev.eval(p, jobs, &N);
+  std::vector<bool> free_p(L.P, false);
+  int nfree = 0;
+  for ( int i=0; i<L.P; i++ )
+  {
+    free_p[i] = N.A[i*L.P+i]>0. && ( i>=L.o_r || N.count[i]>=o.min_n );
+    nfree += free_p[i];
+  }
+  if ( perturb>0. )
+  {
+    std::mt19937 gen(seed);
+    std::uniform_real_distribution<double> u(-1., 1.);
+    for ( int i=0; i<L.P; i++ ) if ( free_p[i] ) p[i] *= 1. + perturb*u(gen);
+    limit(L, &p);
+    ev.eval(p, jobs, &N);
+  }
+  std::vector<double> p_start = p;
+  fprintf(stderr, "soc_cal:  %d free, start rms %.5f V (%llu), soc_min rms %.4f (%llu)\n", nfree,
+    sqrt(N.sse / max(double(N.n), 1.)), (unsigned long long)N.n, sqrt(N.sse_soc / max(double(N.n_soc), 1.)),
+    (unsigned long long)N.n_soc);
+
+  add_prior(&N, p, p_start, free_p, o.ridge);
+  double lambda = 1e-3;
+  double t0 = wall_now();
+  std::vector<double> d, pt;
+  for ( int it=0; it<iter; it++ )
+  {
+    if ( !solve(N, free_p, lambda, &d) ) { lambda *= 10.;  continue; }
+    pt = p;
+    for ( int i=0; i<L.P; i++ ) pt[i] += d[i];
+    limit(L, &pt);
+    ev.eval(pt, jobs, &Nt);
+    add_prior(&Nt, pt, p_start, free_p, o.ridge);
+    double f0 = total(N), f1 = total(Nt);
+    fprintf(stderr, "  it %2d  lambda %8.1e  rms %.6f V  soc_min rms %.5f%s\n", it, lambda,
+      sqrt(Nt.sse / max(double(Nt.n), 1.)), sqrt(Nt.sse_soc / max(double(Nt.n_soc), 1.)), f1<f0 ? "" : "  (rejected)");
+    if ( f1<f0 )
+    {
+      p = pt;
+      std::swap(N, Nt);
+      lambda = max(lambda*0.1, 1e-9);
+      if ( (f0-f1) <= CAL_TOL*f0 ) break;
+    }
+    else
+    {
+      lambda *= 10.;
+      if ( lambda>1e8 ) break;
+    }
+  }
+  double wall = wall_now() - t0;
+
+  // One-sigma bounds from the curvature at the answer
+  std::vector<double> cov;
+  double dof = max(double(N.n + N.n_soc) - nfree, 1.);
+  double sigma2 = total(N) / dof;
+  solve(N, free_p, 0., &d, &cov);
+  struct { const char *name; int off, n; } blocks[] = {{"T_VOC", L.o_voc, L.n_voc}, {"T_R", L.o_r, L.n_r},
+    {"T_DV_MAX", L.o_max, L.m_h}, {"T_DV_MIN", L.o_min, L.m_h}, {"T_SOC_MIN", L.o_soc, L.n_n}};
+  fprintf(stderr, "soc_cal:  %.2f s fitting on %d jobs\n%-10s %5s %12s %12s\n", wall, jobs, "table", "free",
+    "rms_vs_nom", "max_1sigma");
+  for ( size_t b=0; b<sizeof(blocks)/sizeof(blocks[0]); b++ )
+  {
+    int nf = 0;
+    double ch = 0., sg = 0.;
+    for ( int i=blocks[b].off; i<blocks[b].off+blocks[b].n; i++ )
+    {
+      if ( !free_p[i] ) continue;
+      nf++;
+      ch += (p[i]-p0[i])*(p[i]-p0[i]);
+      sg = max(sg, sqrt(sigma2*cov[i]));
+    }
+    fprintf(stderr, "%-10s %5d %12.5f %12.5f\n", blocks[b].name, nf, nf ? sqrt(ch/nf) : 0., sg);
+  }
+
+  FILE *fp = out_name ? fopen(out_name, "w") : stdout;
+  if ( !fp ) { fprintf(stderr, "cannot open %s\n", out_name);  return 1; }
+  print_tables(fp, &chem_nom, L, p, N);
+  if ( fp!=stdout ) fclose(fp);
+  return 0;
+}
@@ -0,0 +1,193 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Accuracy of the firmware's time to full / time to empty forecast, ChargeForecast, on simulated runs.   Not part of
+// the Particle build.   Each LogStore '_mon' file (soc_gen --bin) is counted by the Monitor's own Coulombs and fed
+// to ChargeForecast the way monitor() in subs.cpp does, next to the instantaneous calc_charge_time.   The record is
+// then read backwards for the truth at every row:  hours until the next full ('sat') or empty ('bms_off', or
+// counted soc at soc_min) event, + to full and - to empty.   Rows at an event are not scored, and both estimates
+// are clipped to '--t_max', the longest truth scored.   Reports the median and 90th percentile error of both
+// against that truth, how often the sign is right, and how often the truth is inside the bounds.
+
+#include <algorithm>
+#include <string>
+#include <vector>
+#include "LogStore.h"
+#include "SocHost.h"
+#include "Battery.h"
+#include "ChargeForecast.h"
+
+#define FCST_GAP        60.       // Time step treated as a break in the record, s
+#define FCST_SOC_EMPTY  0.002     // Counted soc this close to soc_min is empty, fraction
+
+// One row of the replay
+struct Row
+{
+  double t;             // Time, s
+  float fcst;           // ChargeForecast, hr
+  float near;           // Nearer bound, hr
+  float far;            // Farther bound, hr
+  float inst;           // calc_charge_time, hr
+  signed char event;    // +1 full, -1 empty, 0 neither
+};
+
+// Running tally of one estimate against the truth
+struct Tally
+{
+  std::vector<float> err;   // |estimate - truth|, hr
+  long sign_ok;             // Same direction as the truth
+  long inside;              // Truth within bounds
+  long n;                   // Rows scored
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_fcst [--ib name] [--np n] [--t_max hr] [--every n] [--out file] run_mon.soc [...]\n");
+}
+
+static float quantile(std::vector<float> *v, const double p)
+{
+  if ( v->empty() ) return 0.;
+  size_t k = min(size_t(p*v->size()), v->size()-1);
+  std::nth_element(v->begin(), v->begin()+k, v->end());
+  return (*v)[k];
+}
+
+// One file through Coulombs, calc_charge_time and ChargeForecast.   Returns false on a bad file
+static bool replay(const char *path, const char *ib_name, const double np, BatteryMonitor *Mon, std::vector<Row> *rows)
+{
+  LogStore ls;
+  if ( !ls.open(path) ) { fprintf(stderr, "cannot open %s\n", path); return false; }
+  const float *tb = ls.column("Tb");
+  const float *ib = ls.column(ib_name);
+  const float *sat = ls.column("sat");
+  const float *bms_off = ls.column("bms_off");
+  if ( !tb || !ib || !sat || !bms_off )
+  {
+    fprintf(stderr, "%s:  need Tb, %s, sat and bms_off columns\n", path, ib_name);
+    return false;
+  }
+  const double *t = ls.time();
+  uint64_t n = ls.rows();
+  ChargeForecast *Fcst = Mon->forecast();
+  rows->resize(n);
+  for ( uint64_t i=0; i<n; i++ )
+  {
+    double dt = i ? t[i] - t[i-1] : 0.;
+    boolean reset = i==0 || dt<=0. || dt>FCST_GAP;
+    if ( reset ) Mon->apply_delta_q_t(Mon->delta_q(), tb[i]);
+    float ib_count = ib[i] / np;
+    boolean saturated = sat[i] > 0.5;
+    Mon->count_coulombs(reset ? 0. : dt, reset, tb[i], ib_count, saturated, 0.);
+    Row &r = (*rows)[i];
+    r.t = t[i];
+    r.inst = Mon->calc_charge_time(Mon->q(), Mon->q_capacity(), ib_count, Mon->soc());
+    r.fcst = Fcst->update(reset ? 0. : dt, ib_count, Mon->q(), Mon->q_capacity(), tb[i], Mon->chem()->soc_min_T_,
+      Mon->coul_eff(), reset);
+    r.near = Fcst->hrs_near();
+    r.far = Fcst->hrs_far();
+    boolean full = saturated;
+    boolean empty = bms_off[i]>0.5 || Mon->soc()<=Mon->soc_min()+FCST_SOC_EMPTY;
+    r.event = full ? 1 : ( empty ? -1 : 0 );
+  }
+  return true;
+}
+
+// Truth read backwards and the tallies
+static void score(const std::vector<Row> &rows, const double t_max, const int every, Tally *fcst, Tally *inst,
+  FILE *out)
+{
+  double t_next = -1.;
+  int ev_next = 0;
+  for ( size_t j=rows.size(); j-- > 0; )
+  {
+    const Row &r = rows[j];
+    if ( r.event ) { t_next = r.t; ev_next = r.event; }
+    if ( !ev_next || r.event ) continue;
+    float truth = ev_next * (t_next - r.t) / 3600.;
+    if ( abs(truth) > t_max ) continue;
+    if ( out && (j % every)==0 )
+      fprintf(out, "%13.3f,%7.2f,%7.2f,%7.2f,%7.2f,%7.2f,\n", r.t, truth, r.fcst, r.near, r.far, r.inst);
+    float lo = min(r.near, r.far);
+    float hi = max(r.near, r.far);
+    fcst->err.push_back(abs(constrain(r.fcst, -t_max, t_max) - truth));
+    fcst->sign_ok += (r.fcst>0.)==(truth>0.);
+    fcst->inside += truth>=lo && truth<=hi;
+    fcst->n++;
+    inst->err.push_back(abs(constrain(r.inst, -t_max, t_max) - truth));
+    inst->sign_ok += (r.inst>0.)==(truth>0.);
+    inst->n++;
+  }
+}
+
+int main(int argc, char **argv)
+{
+  const char *ib_name = "ib";
+  const char *out_name = NULL;
+  double np = 1.;
+  double t_max = 24.;
+  int every = 100;
+  std::vector<const char *> files;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--ib")==0 && more ) ib_name = argv[++i];
+    else if ( strcmp(argv[i], "--np")==0 && more ) np = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--t_max")==0 && more ) t_max = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--every")==0 && more ) every = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--out")==0 && more ) out_name = argv[++i];
+    else if ( argv[i][0]=='-' ) { usage(); return 2; }
+    else files.push_back(argv[i]);
+  }
+  if ( files.empty() || np<=0. || t_max<=0. || every<1 ) { usage(); return 2; }
+
+  // Model prints go to stderr so stdout is only the summary
+  Serial.out(stderr);
+  soc_host_setup(0, time(NULL));
+  BatteryMonitor Mon;
+  FILE *out = NULL;
+  if ( out_name )
+  {
+    out = fopen(out_name, "w");
+    if ( !out ) { fprintf(stderr, "cannot open %s\n", out_name); return 1; }
+    fprintf(out, "t,truth,fcst,near,far,inst,\n");
+  }
+
+  Tally fcst = {{}, 0, 0, 0};
+  Tally inst = {{}, 0, 0, 0};
+  for ( size_t f=0; f<files.size(); f++ )
+  {
+    std::vector<Row> rows;
+    if ( !replay(files[f], ib_name, np, &Mon, &rows) ) return 1;
+    score(rows, t_max, every, &fcst, &inst, out);
+  }
+  if ( out ) fclose(out);
+  if ( !fcst.n ) { printf("soc_fcst:  no full or empty event within %.1f hr\n", t_max); return 1; }
+  printf("soc_fcst:  CHEM %d, %zu files, %ld rows within %.1f hr of an event\n", CHEM, files.size(), fcst.n, t_max);
+  printf("            median   p90 err, hr   sign ok   inside bounds\n");
+  printf("forecast   %7.2f %7.2f          %6.1f%%   %6.1f%%\n", quantile(&fcst.err, 0.5), quantile(&fcst.err, 0.9),
+    100.*fcst.sign_ok/fcst.n, 100.*fcst.inside/fcst.n);
+  printf("instant    %7.2f %7.2f          %6.1f%%\n", quantile(&inst.err, 0.5), quantile(&inst.err, 0.9),
+    100.*inst.sign_ok/inst.n);
+  return 0;
+}
@@ -0,0 +1,634 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Property tests of the numeric kernels under the Monitor:  binsearch, tab1, tab1clip, tab2 and TableInterp2D
+// (myLibrary/myTables.cpp), EKF_1x1::predict_ekf and update_ekf (myLibrary/EKF_1x1.cpp) and Iterator::iterate
+// (myLibrary/iterate.cpp) driven the way BatteryMonitor::solve_ekf drives it.   Not part of the Particle build.
+// Each property draws '--cases' random cases from '--seed':  tables with unsorted, repeated and out-of-range
+// breakpoints, NaN and infinite inputs, random EKF step sequences and random voc(soc) curves.   A failing case is
+// shrunk (records dropped, values zeroed, truncated, rounded and halved) while it still fails, then printed.
+// Last, each kernel's throughput is timed so a slowdown shows next to the results (--no_time skips it).
+
+#include <random>           // Ahead of application.h, whose min/max macros break it
+#include <chrono>
+#include <functional>
+#include <string>
+#include <vector>
+#include <float.h>
+#include "application.h"
+#include "myLibrary/myTables.h"
+#include "myLibrary/EKF_1x1.h"
+#include "myLibrary/iterate.h"
+#include "Battery.h"        // SOLV_*
+
+#define FZ_CASES        20000     // Cases per property (20000)
+#define FZ_NMAX         8         // Most breakpoints per table axis (8)
+#define FZ_STEPS        40        // Most EKF steps per case (40)
+#define FZ_SHRINK       20000     // Most checks spent shrinking one failure (20000)
+#define FZ_ULPS         4.        // Rounding allowed on a table result, x FLT_EPSILON x |operands| (4.)
+#define FZ_PASSES       5         // Timing passes, best of (5)
+#define FZ_CALLS        200000    // Calls per timing pass (200000)
+
+// The ap and sp constructors print before main
+static struct SerialToStderr { SerialToStderr() { Serial.out(stderr); } } serial_to_stderr __attribute__((init_priority(102)));
+
+typedef std::vector<double> Case;     // Flat encoding, decoded by each property
+
+// A property:  gen draws a case; check returns false and says why when the property fails.   A case outside the
+// property's domain holds.   Cases are head values then records of rec values; shrinking drops whole records down
+// to min_rec (rec 0 is a fixed layout)
+struct Prop
+{
+  const char *name;
+  const char *what;
+  std::function<void(std::mt19937 &, Case *)> gen;
+  std::function<bool(const Case &, std::string *)> check;
+  size_t head;
+  size_t rec;
+  size_t min_rec;
+};
+
+// Random draws
+static double uni(std::mt19937 &g, const double lo, const double hi)
+{
+  return std::uniform_real_distribution<double>(lo, hi)(g);
+}
+static bool chance(std::mt19937 &g, const double p)
+{
+  return uni(g, 0., 1.) < p;
+}
+static size_t count(std::mt19937 &g, const size_t lo, const size_t hi)
+{
+  return std::uniform_int_distribution<size_t>(lo, hi)(g);
+}
+
+// A breakpoint or table value:  mostly spread over a range, sometimes a repeat of the last of its kind (two back,
+// records being {v, y}) or a round number
+static double value(std::mt19937 &g, const Case &c, const double span)
+{
+  if ( c.size()>=2 && chance(g, 0.15) ) return c[c.size()-2];
+  if ( chance(g, 0.1) ) return double(int(uni(g, -span, span)));
+  return uni(g, -span, span);
+}
+
+// An input:  over the table and past both ends, sometimes exactly on a breakpoint
+static double input(std::mt19937 &g, const float *v, const int n)
+{
+  float lo = *std::min_element(v, v+n);
+  float hi = *std::max_element(v, v+n);
+  double pad = (hi - lo)*0.5 + 1.;
+  if ( chance(g, 0.2) ) return v[count(g, 0, n-1)];
+  return uni(g, lo - pad, hi + pad);
+}
+
+// Rounding allowed on a + d*(b - a), d in [0, 1]
+static float slack(const float a, const float b)
+{
+  return FZ_ULPS*FLT_EPSILON*(fabsf(a) + fabsf(b)) + FLT_MIN;
+}
+
+static bool fail(std::string *why, const char *format, ...)
+{
+  char buf[256];
+  va_list args;
+  va_start(args, format);
+  vsnprintf(buf, sizeof(buf), format, args);
+  va_end(args);
+  *why = buf;
+  return false;
+}
+
+
+// 1-D tables.   Case:  head inputs, then records {v, y}
+struct Tab1
+{
+  int n;
+  float v[64];
+  float y[64];
+  Tab1(const Case &c, const size_t head, const bool sorted)
+  {
+    n = min(int((c.size() - head)/2), 64);
+    for ( int i=0; i<n; i++ )
+    {
+      v[i] = c[head + 2*i];
+      y[i] = c[head + 2*i + 1];
+    }
+    // Sorted:  the values are the first point then increments, which may be zero (repeated breakpoints)
+    if ( sorted ) for ( int i=1; i<n; i++ )
+    {
+      v[i] = v[i-1] + fabsf(v[i]);
+      y[i] = y[i-1] + fabsf(y[i]);
+    }
+  }
+};
+
+static void gen_tab1(std::mt19937 &g, Case *c, const size_t head)
+{
+  size_t n = count(g, 1, FZ_NMAX);
+  c->assign(head, 0.);
+  for ( size_t i=0; i<n; i++ )
+  {
+    c->push_back(value(g, *c, 100.));
+    c->push_back(value(g, *c, 100.));
+  }
+  Tab1 t(*c, head, false);
+  for ( size_t i=0; i<head; i++ ) (*c)[i] = input(g, t.v, t.n);
+}
+
+// Any breakpoints, in any order:  binsearch brackets x with neighbours, dx in [0, 1], and tab1 and tab1clip
+// return the same point between the two table values (tab1clip rounds in double)
+static bool tab1_bounds(const Case &c, std::string *why)
+{
+  Tab1 t(c, 1, false);
+  float x = c[0];
+  if ( t.n<1 || !isfinite(x) ) return true;
+  int high, low;
+  float dx;
+  binsearch(x, t.v, t.n, &high, &low, &dx);
+  if ( low<0 || high>=t.n || low>high || high-low>1 ) return fail(why, "binsearch low %d high %d of %d", low, high, t.n);
+  if ( !(dx>=0. && dx<=1.) ) return fail(why, "binsearch dx %g", dx);
+  float r = tab1(x, t.v, t.y, t.n);
+  float lo = min(t.y[low], t.y[high]);
+  float hi = max(t.y[low], t.y[high]);
+  float s = slack(t.y[low], t.y[high]);
+  if ( !(r>=lo-s && r<=hi+s) ) return fail(why, "tab1 %g outside [%g, %g]", r, lo, hi);
+  float rc = tab1clip(x, t.v, t.y, t.n);
+  if ( fabsf(rc - r) > s ) return fail(why, "tab1clip %g != tab1 %g", rc, r);
+  return true;
+}
+
+// NaN in, NaN out, not a plausible number; +-inf clip to the end values
+static bool tab1_special(const Case &c, std::string *why)
+{
+  Tab1 t(c, 1, false);
+  float x = c[0];
+  if ( t.n<1 || isfinite(x) ) return true;
+  int high, low;
+  float dx;
+  binsearch(x, t.v, t.n, &high, &low, &dx);
+  if ( low<0 || high>=t.n || low>high ) return fail(why, "binsearch low %d high %d of %d", low, high, t.n);
+  float r = tab1(x, t.v, t.y, t.n);
+  if ( isnan(x) && !isnan(r) ) return fail(why, "tab1(nan) = %g", r);
+  if ( x>0. && isinf(x) && r!=t.y[t.n-1] ) return fail(why, "tab1(inf) = %g, not %g", r, t.y[t.n-1]);
+  if ( x<0. && isinf(x) && r!=t.y[0] ) return fail(why, "tab1(-inf) = %g, not %g", r, t.y[0]);
+  return true;
+}
+
+static void gen_tab1_special(std::mt19937 &g, Case *c)
+{
+  gen_tab1(g, c, 1);
+  double pick[3] = {NAN, INFINITY, -INFINITY};
+  (*c)[0] = pick[count(g, 0, 2)];
+}
+
+// Non-decreasing breakpoints and values, repeats allowed:  tab1 does not decrease with x, and at a breakpoint
+// that is not repeated it is the table value (a repeat is a step; either side will do)
+static bool tab1_monotone(const Case &c, std::string *why)
+{
+  Tab1 t(c, 2, true);
+  float xa = min(c[0], c[1]);
+  float xb = max(c[0], c[1]);
+  if ( t.n<1 ) return true;
+  float ra = tab1(xa, t.v, t.y, t.n);
+  float rb = tab1(xb, t.v, t.y, t.n);
+  if ( ra > rb + slack(ra, rb) ) return fail(why, "tab1(%g) = %g > tab1(%g) = %g", xa, ra, xb, rb);
+  for ( int i=0; i<t.n; i++ )
+  {
+    if ( (i<t.n-1 && t.v[i+1]==t.v[i]) || (i && t.v[i-1]==t.v[i]) ) continue;
+    float r = tab1(t.v[i], t.v, t.y, t.n);
+    if ( r!=t.y[i] ) return fail(why, "tab1(v[%d] %g) = %g, not %g", i, t.v[i], r, t.y[i]);
+  }
+  return true;
+}
+
+
+// 2-D tables.   Case:  head inputs, n1, n2, then v1[FZ_NMAX], v2[FZ_NMAX], y[FZ_NMAX*FZ_NMAX]
+#define FZ_T2_LEN (2 + 2*FZ_NMAX + FZ_NMAX*FZ_NMAX)
+struct Tab2
+{
+  int n1, n2;
+  float v1[FZ_NMAX];
+  float v2[FZ_NMAX];
+  float y[FZ_NMAX*FZ_NMAX];
+  Tab2(const Case &c, const size_t head, const bool sorted)
+  {
+    const double *p = &c[head];
+    n1 = constrain(int(fabs(p[0])), 1, FZ_NMAX);
+    n2 = constrain(int(fabs(p[1])), 1, FZ_NMAX);
+    p += 2;
+    for ( int i=0; i<n1; i++ ) v1[i] = ( sorted && i ) ? v1[i-1] + fabsf(p[i]) : p[i];
+    p += FZ_NMAX;
+    for ( int j=0; j<n2; j++ ) v2[j] = ( sorted && j ) ? v2[j-1] + fabsf(p[j]) : p[j];
+    p += FZ_NMAX;
+    // Sorted:  non-negative increments summed along both axes, so y rises with each input
+    for ( int j=0; j<n2; j++ ) for ( int i=0; i<n1; i++ )
+    {
+      float d = p[j*FZ_NMAX + i];
+      if ( !sorted ) y[j*n1 + i] = d;
+      else y[j*n1 + i] = fabsf(d) + ( i ? y[j*n1 + i-1] : 0.f ) + ( j ? y[(j-1)*n1 + i] : 0.f )
+        - ( i && j ? y[(j-1)*n1 + i-1] : 0.f );
+    }
+  }
+};
+
+static void gen_tab2(std::mt19937 &g, Case *c, const size_t head)
+{
+  c->assign(head + FZ_T2_LEN, 0.);
+  (*c)[head] = double(count(g, 1, FZ_NMAX));
+  (*c)[head+1] = double(count(g, 1, FZ_NMAX));
+  Case run;     // Drawn as {value, 0} pairs so a repeat is of the value before
+  for ( size_t k=head+2; k<c->size(); k++ )
+  {
+    run.push_back(value(g, run, 100.));
+    run.push_back(0.);
+    (*c)[k] = run[run.size()-2];
+  }
+  Tab2 t(*c, head, false);
+  for ( size_t i=0; i<head; i++ ) (*c)[i] = ( i%2 ) ? input(g, t.v2, t.n2) : input(g, t.v1, t.n1);
+}
+
+// Any breakpoints:  tab2 lies within the four table values around it, TableInterp2D::interp is tab2 and
+// interp_n is interp
+static bool tab2_bounds(const Case &c, std::string *why)
+{
+  Tab2 t(c, 2, false);
+  float x1 = c[0];
+  float x2 = c[1];
+  if ( !isfinite(x1) || !isfinite(x2) ) return true;
+  int h1, l1, h2, l2;
+  float d1, d2;
+  binsearch(x1, t.v1, t.n1, &h1, &l1, &d1);
+  binsearch(x2, t.v2, t.n2, &h2, &l2, &d2);
+  float corner[4] = {t.y[l2*t.n1 + l1], t.y[l2*t.n1 + h1], t.y[h2*t.n1 + l1], t.y[h2*t.n1 + h1]};
+  float lo = *std::min_element(corner, corner+4);
+  float hi = *std::max_element(corner, corner+4);
+  float s = 2.*slack(lo, hi);
+  float r = tab2(x1, x2, t.v1, t.v2, t.y, t.n1, t.n2);
+  if ( !(r>=lo-s && r<=hi+s) ) return fail(why, "tab2 %g outside [%g, %g]", r, lo, hi);
+  TableInterp2D tab(t.n1, t.n2, t.v1, t.v2, t.y);
+  float ri = tab.interp(x1, x2);
+  if ( ri!=r ) return fail(why, "interp %g != tab2 %g", ri, r);
+  double xn[3] = {x1, t.v1[0], double(x1)*0.5};
+  double vn[3];
+  tab.interp_n(xn, x2, vn, 3);
+  for ( int i=0; i<3; i++ )
+  {
+    float rn = tab.interp(float(xn[i]), x2);
+    if ( float(vn[i])!=rn ) return fail(why, "interp_n[%d] %g != interp %g", i, vn[i], rn);
+  }
+  return true;
+}
+
+// Non-decreasing breakpoints and values:  tab2 does not decrease with either input, and at a grid point off
+// any repeat it is the table value
+static bool tab2_monotone(const Case &c, std::string *why)
+{
+  Tab2 t(c, 3, true);
+  float x1a = min(c[0], c[1]);
+  float x1b = max(c[0], c[1]);
+  float x2 = c[2];
+  float ra = tab2(x1a, x2, t.v1, t.v2, t.y, t.n1, t.n2);
+  float rb = tab2(x1b, x2, t.v1, t.v2, t.y, t.n1, t.n2);
+  if ( ra > rb + 2.*slack(ra, rb) ) return fail(why, "tab2(%g, %g) = %g > tab2(%g, %g) = %g", x1a, x2, ra, x1b, x2, rb);
+  float rc = tab2(x1a, x1b, t.v2, t.v1, t.y, 0, 0);   // n<1 returns y[0]
+  if ( rc!=t.y[0] ) return fail(why, "tab2 empty = %g, not y[0] %g", rc, t.y[0]);
+  float x2b = x2 + fabsf(x1b - x1a);
+  float r2a = tab2(x1a, x2, t.v1, t.v2, t.y, t.n1, t.n2);
+  float r2b = tab2(x1a, x2b, t.v1, t.v2, t.y, t.n1, t.n2);
+  if ( r2a > r2b + 2.*slack(r2a, r2b) ) return fail(why, "tab2(%g, %g) = %g > tab2(%g, %g) = %g", x1a, x2, r2a, x1a, x2b, r2b);
+  for ( int j=0; j<t.n2; j++ ) for ( int i=0; i<t.n1; i++ )
+  {
+    if ( (i<t.n1-1 && t.v1[i+1]==t.v1[i]) || (i && t.v1[i-1]==t.v1[i])
+      || (j<t.n2-1 && t.v2[j+1]==t.v2[j]) || (j && t.v2[j-1]==t.v2[j]) ) continue;
+    float r = tab2(t.v1[i], t.v2[j], t.v1, t.v2, t.y, t.n1, t.n2);
+    if ( r!=t.y[j*t.n1 + i] ) return fail(why, "tab2 at grid (%d, %d) = %g, not %g", i, j, r, t.y[j*t.n1 + i]);
+  }
+  return true;
+}
+
+
+// EKF_1x1 with the transition and observation set per step.   h(x) = H*x
+class FuzzEkf : public EKF_1x1
+{
+public:
+  FuzzEkf() : Fx_set_(1.), Bu_set_(0.), H_set_(0.) {}
+  // functions
+  double K() { return K_; };
+  double P() { return P_; };
+  void set(const double Fx, const double Bu, const double H, const double Q, const double R)
+  {
+    Fx_set_ = Fx; Bu_set_ = Bu; H_set_ = H; Q_ = Q; R_ = R;
+  };
+protected:
+  double Fx_set_, Bu_set_, H_set_;
+  void ekf_predict(double *Fx, double *Bu) { *Fx = Fx_set_; *Bu = Bu_set_; };
+  void ekf_update(double *hx, double *H) { *H = H_set_; *hx = H_set_*x_; };
+};
+
+// Case:  x0, P0, x_min, x_max, then records {Fx, Bu, u, Q, R, H, z}.   Domain, as on the Monitor:  0 <= Fx <= 1,
+// Q >= 0, R >= 1e-10 (magnitudes are taken and floored)
+#define FZ_EKF_HEAD 4
+#define FZ_EKF_REC  7
+static void gen_ekf(std::mt19937 &g, Case *c)
+{
+  size_t n = count(g, 1, FZ_STEPS);
+  c->clear();
+  c->push_back(uni(g, -0.5, 1.5));
+  c->push_back(chance(g, 0.1) ? 0. : pow(10., uni(g, -8., 2.)));
+  c->push_back(uni(g, -0.2, 0.3));
+  c->push_back(uni(g, 0.8, 1.2));
+  for ( size_t k=0; k<n; k++ )
+  {
+    c->push_back(chance(g, 0.5) ? 1. : uni(g, 0., 1.));                   // Fx
+    c->push_back(uni(g, -1., 1.)*pow(10., uni(g, -7., -1.)));           // Bu
+    c->push_back(uni(g, -200., 200.));                                  // u
+    c->push_back(chance(g, 0.1) ? 0. : pow(10., uni(g, -12., 0.)));      // Q
+    c->push_back(pow(10., uni(g, -10., 1.)));                           // R
+    c->push_back(chance(g, 0.1) ? 0. : uni(g, -50., 50.));               // H
+    c->push_back(uni(g, -20., 20.));                                    // z
+  }
+}
+
+// Covariance stays finite and non-negative, the update never raises it, and the state lands within its limits
+static bool ekf_cov(const Case &c, std::string *why)
+{
+  FuzzEkf ekf;
+  double x_min = min(c[2], c[3]);
+  double x_max = max(c[2], c[3]);
+  ekf.init_ekf(c[0], fabs(c[1]));
+  size_t n = (c.size() - FZ_EKF_HEAD)/FZ_EKF_REC;
+  for ( size_t k=0; k<n; k++ )
+  {
+    const double *r = &c[FZ_EKF_HEAD + k*FZ_EKF_REC];
+    ekf.set(min(fabs(r[0]), 1.), r[1], r[5], fabs(r[3]), max(fabs(r[4]), 1e-10));
+    ekf.predict_ekf(r[2]);
+    double P_prior = ekf.P();
+    if ( !isfinite(P_prior) || P_prior<0. ) return fail(why, "step %zu predict P %g", k, P_prior);
+    ekf.update_ekf(r[6], x_min, x_max);
+    double P = ekf.P();
+    if ( !isfinite(P) || P<0. ) return fail(why, "step %zu update P %g, K %g", k, P, ekf.K());
+    if ( P > P_prior*(1. + 1e-12) ) return fail(why, "step %zu update raised P %g to %g", k, P_prior, P);
+    double x = ekf.x_ekf();
+    if ( !(x>=x_min && x<=x_max) ) return fail(why, "step %zu x %g outside [%g, %g]", k, x, x_min, x_max);
+  }
+  return true;
+}
+
+
+// voc(soc) for the solver, shaped like the Chemistry tables:  soc breakpoints over -0.15 to 1.05 at least
+// FZ_DSOC apart, voc rising from 9 V no steeper than FZ_SLOPE, flats allowed.   Case:  target fraction, soc_min,
+// then records {dsoc, dvoc}
+#define FZ_SOLV_HEAD 2
+#define FZ_DSOC         0.005     // Closest soc breakpoints, as at the top of the Battleborn table (0.005)
+#define FZ_SLOPE        200.      // Steepest voc(soc), V/fraction; Battleborn 0.995 - 1.0 is 112 (200.)
+#define FZ_SOC_TOL      1e-4      // Solved soc this close to the root will do when e is still over SOLV_ERR (1e-4)
+struct Curve
+{
+  int n;
+  float x[64];
+  float v[64];
+  Curve(const Case &c)
+  {
+    n = min(int((c.size() - FZ_SOLV_HEAD)/2) + 1, 64);
+    double sum = 1e-12;
+    for ( int i=1; i<n; i++ ) sum += fabs(c[FZ_SOLV_HEAD + 2*(i-1)]);
+    double free = 1.2 - FZ_DSOC*double(n-1);
+    x[0] = -0.15;
+    v[0] = 9.;
+    for ( int i=1; i<n; i++ )
+    {
+      const double *r = &c[FZ_SOLV_HEAD + 2*(i-1)];
+      x[i] = x[i-1] + FZ_DSOC + fabs(r[0])/sum*free;
+      v[i] = v[i-1] + min(fabs(r[1]), FZ_SLOPE*(x[i] - x[i-1]));
+    }
+  }
+  float voc(const float soc) { return tab1(soc, x, v, n); };
+};
+
+static void gen_solv(std::mt19937 &g, Case *c)
+{
+  size_t n = count(g, 1, FZ_NMAX*2);
+  c->clear();
+  c->push_back(chance(g, 0.2) ? uni(g, -0.5, 1.5) : uni(g, 0., 1.));
+  c->push_back(uni(g, 0., 0.3));
+  double span = uni(g, 0.5, 6.);     // Total voc rise, V
+  for ( size_t k=0; k<n; k++ )
+  {
+    c->push_back(uni(g, 0., 1.));
+    c->push_back(chance(g, 0.15) ? 0. : uni(g, 0., 2.*span/double(n)));
+  }
+}
+
+// BatteryMonitor::solve_ekf's loop:  a target voc between voc(soc_min) and voc(1) is met within SOLV_ERR before
+// SOLV_MAX_COUNTS or, where the curve is too steep for a float soc to get within SOLV_ERR, soc ends within
+// FZ_SOC_TOL of the root; any target leaves soc within [soc_min, 1]
+static bool solv_conv(const Case &c, std::string *why)
+{
+  Curve f(c);
+  float soc_min = min(fabs(c[1]), 0.5);
+  float v_lo = f.voc(soc_min);
+  float v_hi = f.voc(1.);
+  float voc_stat = v_lo + float(c[0])*(v_hi - v_lo);
+  Iterator ice("fuzz");
+  float soc_solved = 1.;
+  ice.init(1., soc_min, 2*SOLV_ERR);
+  while ( abs(ice.e())>SOLV_ERR && ice.count()<SOLV_MAX_COUNTS && abs(ice.dx())>0. )
+  {
+    ice.increment();
+    soc_solved = ice.x();
+    ice.e(f.voc(soc_solved) - voc_stat);
+    ice.iterate(false, SOLV_SUCC_COUNTS, false);
+  }
+  if ( !(soc_solved>=soc_min && soc_solved<=1.) ) return fail(why, "soc %g outside [%g, 1]", soc_solved, soc_min);
+  if ( c[0]<0. || c[0]>1. ) return true;
+  float e = f.voc(soc_solved) - voc_stat;
+  if ( ice.count()<SOLV_MAX_COUNTS && abs(e)<=SOLV_ERR ) return true;
+  float e_lo = f.voc(soc_solved - FZ_SOC_TOL) - voc_stat;
+  float e_hi = f.voc(soc_solved + FZ_SOC_TOL) - voc_stat;
+  if ( e_lo<=0. && e_hi>=0. ) return true;
+  return fail(why, "count %d, e %g at soc %g", ice.count(), e, soc_solved);
+}
+
+
+// Shrink a failing case:  drop records, then make values simpler, while it still fails
+static bool fails(const Prop &p, const Case &c, std::string *why, unsigned *checks)
+{
+  (*checks)++;
+  return !p.check(c, why);
+}
+static bool same(const double a, const double b)
+{
+  return a==b || (isnan(a) && isnan(b));
+}
+static Case shrink(const Prop &p, Case c, std::string *why)
+{
+  unsigned checks = 0;
+  bool smaller = true;
+  while ( smaller && checks<FZ_SHRINK )
+  {
+    smaller = false;
+    if ( p.rec ) for ( size_t j=p.head; j+p.rec<=c.size() && c.size()>=p.head + p.rec*(p.min_rec + 1) && checks<FZ_SHRINK; )
+    {
+      Case t(c);
+      t.erase(t.begin()+j, t.begin()+j+p.rec);
+      if ( fails(p, t, why, &checks) ) { c = t; smaller = true; }
+      else j += p.rec;
+    }
+    for ( size_t i=0; i<c.size() && checks<FZ_SHRINK; i++ )
+    {
+      double simpler[5] = {0., 1., trunc(c[i]), round(c[i]*10.)/10., c[i]*0.5};
+      for ( int k=0; k<5; k++ )
+      {
+        if ( same(simpler[k], c[i]) || (k==1 && fabs(c[i])<1.) ) continue;
+        Case t(c);
+        t[i] = simpler[k];
+        if ( fails(p, t, why, &checks) ) { c = t; smaller = true; break; }
+      }
+    }
+  }
+  p.check(c, why);
+  return c;
+}
+
+
+// Throughput of each kernel, best of FZ_PASSES, calls per second
+static volatile double sink;
+static double rate(const std::function<double(int)> &call)
+{
+  double best = 1e30;
+  for ( int pass=0; pass<FZ_PASSES; pass++ )
+  {
+    double acc = 0.;
+    auto w = std::chrono::steady_clock::now();
+    for ( int i=0; i<FZ_CALLS; i++ ) acc += call(i);
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - w).count();
+    sink = acc;
+    best = min(best, s);
+  }
+  return double(FZ_CALLS)/best;
+}
+
+static void timing(std::mt19937 &g)
+{
+  // Shaped like the Monitor's voc(soc, T):  20 soc by 3 temperature breakpoints
+  float x[20], t[3] = {5., 25., 45.}, v[60];
+  for ( int i=0; i<20; i++ ) x[i] = -0.15 + 1.2*float(i)/19.;
+  for ( int j=0; j<3; j++ ) for ( int i=0; i<20; i++ ) v[j*20 + i] = 10. + 4.*x[i] + 0.01*t[j];
+  TableInterp2D tab(20, 3, x, t, v);
+  std::vector<float> xs(1024), ts(1024);
+  for ( int k=0; k<1024; k++ ) { xs[k] = uni(g, -0.2, 1.1); ts[k] = uni(g, 0., 50.); }
+  FuzzEkf ekf;
+  ekf.init_ekf(0.5, 1e-3);
+  Case cv;
+  gen_solv(g, &cv);
+  cv[0] = 0.6;
+
+  printf("%-14s %12s %10s\n", "kernel", "calls/s", "ns/call");
+  struct { const char *name; std::function<double(int)> call; } k[] = {
+    {"binsearch", [&](int i) { int h, l; float d; binsearch(xs[i&1023], x, 20, &h, &l, &d); return double(d + h); }},
+    {"tab1", [&](int i) { return double(tab1(xs[i&1023], x, v, 20)); }},
+    {"tab2", [&](int i) { return double(tab2(xs[i&1023], ts[i&1023], x, t, v, 20, 3)); }},
+    {"interp_n x3", [&](int i) { double s[3] = {xs[i&1023], xs[(i+1)&1023], xs[(i+2)&1023]}, r[3];
+      tab.interp_n(s, ts[i&1023], r, 3); return r[0] + r[1] + r[2]; }},
+    {"ekf step", [&](int i) { ekf.set(1., 1e-5, 4., 1e-6, 1e-4); ekf.predict_ekf(xs[i&1023]*10.);
+      ekf.update_ekf(v[i%60], -0.2, 1.1); return ekf.x_ekf(); }},
+    {"solve", [&](int i) { cv[0] = xs[i&1023]; std::string why; return double(solv_conv(cv, &why)); }},
+  };
+  for ( auto &e : k )
+  {
+    double r = rate(e.call);
+    printf("%-14s %12.4g %10.1f\n", e.name, r, 1e9/r);
+  }
+}
+
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_fuzz [--seed n] [--cases n] [--prop name] [--no_time]\n");
+}
+
+int main(int argc, char **argv)
+{
+  unsigned long seed = 1;
+  long cases = FZ_CASES;
+  const char *only = NULL;
+  bool no_time = false;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--seed")==0 && more ) seed = strtoul(argv[++i], NULL, 10);
+    else if ( strcmp(argv[i], "--cases")==0 && more ) cases = atol(argv[++i]);
+    else if ( strcmp(argv[i], "--prop")==0 && more ) only = argv[++i];
+    else if ( strcmp(argv[i], "--no_time")==0 ) no_time = true;
+    else { usage(); return 2; }
+  }
+
+  Prop props[] = {
+    {"tab1_bounds", "binsearch brackets, tab1 between neighbours, any breakpoints",
+      [](std::mt19937 &g, Case *c) { gen_tab1(g, c, 1); }, tab1_bounds, 1, 2, 1},
+    {"tab1_special", "NaN gives NaN, inf clips",
+      gen_tab1_special, tab1_special, 1, 2, 1},
+    {"tab1_monotone", "sorted tables:  monotone, exact at breakpoints",
+      [](std::mt19937 &g, Case *c) { gen_tab1(g, c, 2); }, tab1_monotone, 2, 2, 1},
+    {"tab2_bounds", "tab2 within its cell, interp and interp_n agree",
+      [](std::mt19937 &g, Case *c) { gen_tab2(g, c, 2); }, tab2_bounds, 0, 0, 0},
+    {"tab2_monotone", "sorted tables:  monotone in both, exact at grid",
+      [](std::mt19937 &g, Case *c) { gen_tab2(g, c, 3); }, tab2_monotone, 0, 0, 0},
+    {"ekf_cov", "P finite, >= 0, not raised by update; x within limits",
+      gen_ekf, ekf_cov, FZ_EKF_HEAD, FZ_EKF_REC, 1},
+    {"solv_conv", "solve_ekf loop converges within SOLV_MAX_COUNTS",
+      gen_solv, solv_conv, FZ_SOLV_HEAD, 2, 1},
+  };
+
+  std::mt19937 g(seed);
+  int failed = 0;
+  int run = 0;
+  for ( auto &p : props )
+  {
+    if ( only && strcmp(only, p.name) ) continue;
+    run++;
+    long n_fail = 0;
+    Case first;
+    std::string why;
+    auto w = std::chrono::steady_clock::now();
+    for ( long k=0; k<cases; k++ )
+    {
+      Case c;
+      p.gen(g, &c);
+      if ( p.check(c, &why) ) continue;
+      if ( !n_fail++ ) first = c;
+    }
+    double s = std::chrono::duration<double>(std::chrono::steady_clock::now() - w).count();
+    printf("%-14s %-58s %7ld cases %6.2f s  %s\n", p.name, p.what, cases, s, n_fail ? "FAIL" : "pass");
+    if ( !n_fail ) continue;
+    failed++;
+    Case m = shrink(p, first, &why);
+    printf("  %ld failed; smallest:  %s\n   ", n_fail, why.c_str());
+    for ( double x : m ) printf(" %.9g", x);
+    printf("\n");
+  }
+  if ( !run ) { fprintf(stderr, "soc_fuzz:  no property %s\n", only); return 2; }
+  if ( !no_time ) timing(g);
+  printf("soc_fuzz:  %d of %d properties failed, seed %lu\n", failed, run, seed);
+  return failed ? 1 : 0;
+}
@@ -0,0 +1,387 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Synthetic long-horizon training data from the firmware's own BatterySim, Hysteresis and Chemistry.
+// Not part of the Particle build.   Replaces the re-implemented simulator in pyStateOfCharge/GenerateDV_Data.py
+// for the TrainTensor_lstm.py data sets.   A profile is a list of segments, repeated for the run:
+//
+//   # dur_s   ib_A   tb_C   type   amp_A   freq_Hz
+//     21600   -5.    25.    0
+//     28800    8.    25.    1      2.      0.05
+//
+// ib is bank current in, tb bank temperature.   type is the 'Xt' injection code added on top of ib through
+// BatterySim::calc_inj (1 sine, 2 square, 3 triangle, 8 cosine, 9 '--inj' trace scaled by amp; 0 none), timed from
+// the segment start.   An '--inj' trace is time_s, amps per line (commas or spaces, '#' and header lines skipped),
+// e.g. a dataReduction capture cut with 'soc_log slice', played linearly between points and looped.
+// Case 0 runs the profile as written; cases 1.. scale ib, bias tb and start soc by seeded draws.
+// Cases are spread over forked worker processes because the model reads the sp/ap globals.
+// Each case is its own file:  CSV with the vv1 'unit,' header, or a LogStore column file soc_log can read.
+
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "LogStore.h"
+#include "SocHost.h"
+#include "Battery.h"
+
+#define GEN_DT          0.1       // Update time, READ_DELAY, s
+#define GEN_DAYS        4.        // Run length, days (GenerateDV_Data.py)
+#define GEN_TIME_START  1691689394  // Unix time of first sample (GenerateDV_Data.py)
+#define GEN_MODELING    7         // sp.modeling():  Sim is the source of tb, vb and ib
+#define GEN_IB_SCALE    0.3       // Half range of case ib scale draw, fraction
+#define GEN_TB_BIAS     10.       // Half range of case tb bias draw, deg C
+#define GEN_SOC_MIN     0.2       // Lowest case start soc, fraction
+
+// One piece of a profile
+struct Segment
+{
+  double dur_s;         // Length, s
+  float ib;             // Bank current, A
+  float tb;             // Bank temperature, deg C
+  uint8_t type;         // Injection type, 'Xt' code
+  float amp;            // Injection amplitude, A
+  float freq_hz;        // Injection frequency, Hz
+};
+
+// GenerateDV_Data.py day:  discharge overnight, charge 08:00-16:00
+static const Segment profile_default[] =
+{
+  {21600., -5., 25., 0, 0., 0.},
+  { 7200.,  0., 25., 0, 0., 0.},
+  {28800.,  8., 25., 0, 0., 0.},
+  {18000.,  0., 25., 0, 0., 0.},
+  {10800., -5., 25., 0, 0., 0.},
+};
+
+// Draws for one case
+struct Case
+{
+  int k;                // Case number
+  float ib_scale;       // Multiplies profile ib
+  float tb_bias;        // Adds to profile tb, deg C
+  float soc0;           // Start soc, fraction
+};
+
+static const char *columns[] = {"Tb", "ib_in", "ib", "ib_charge", "ioc", "vb", "voc", "voc_stat", "dv_dyn", "dv_hys",
+  "soc", "sat", "bms_off", "cutback"};
+static const int num_columns = sizeof(columns) / sizeof(char *);
+
+static bool load_profile(const char *name, std::vector<Segment> *prof)
+{
+  FILE *fp = fopen(name, "r");
+  if ( !fp ) return false;
+  char line[256];
+  while ( fgets(line, sizeof(line), fp) )
+  {
+    char *hash = strchr(line, '#');
+    if ( hash ) *hash = '\0';
+    Segment s = {0., 0., 0., 0, 0., 0.};
+    int type = 0;
+    int n = sscanf(line, "%lf %f %f %d %f %f", &s.dur_s, &s.ib, &s.tb, &type, &s.amp, &s.freq_hz);
+    if ( n<=0 ) continue;
+    if ( n<3 || s.dur_s<=0. )
+    {
+      fprintf(stderr, "%s:  need dur_s>0 ib_A tb_C [type amp_A freq_Hz]:  %s", name, line);
+      fclose(fp);
+      return false;
+    }
+    s.type = uint8_t(type);
+    prof->push_back(s);
+  }
+  fclose(fp);
+  return !prof->empty();
+}
+
+// Recorded (time, amps) trace for type 9
+static bool load_trace(const char *name, std::vector<float> *t, std::vector<float> *a)
+{
+  FILE *fp = fopen(name, "r");
+  if ( !fp ) return false;
+  char line[256];
+  double t0 = 0.;   // Epoch stamps would not survive float
+  while ( fgets(line, sizeof(line), fp) )
+  {
+    char *hash = strchr(line, '#');
+    if ( hash ) *hash = '\0';
+    for ( char *c=line; *c; c++ ) if ( *c==',' ) *c = ' ';
+    double ti;
+    float ai;
+    if ( sscanf(line, "%lf %f", &ti, &ai)!=2 ) continue;
+    if ( t->empty() ) t0 = ti;
+    t->push_back(float(ti - t0));
+    a->push_back(ai);
+  }
+  fclose(fp);
+  return t->size()>=2;
+}
+
+static Case draw_case(const int k, const unsigned seed)
+{
+  Case c = {k, 1., 0., 1.};
+  if ( k==0 ) return c;
+  std::mt19937 gen(seed + k);
+  std::uniform_real_distribution<float> u(-1., 1.);
+  c.ib_scale = 1. + GEN_IB_SCALE*u(gen);
+  c.tb_bias = GEN_TB_BIAS*u(gen);
+  c.soc0 = GEN_SOC_MIN + (1.-GEN_SOC_MIN)*0.5*(1.+u(gen));
+  return c;
+}
+
+// Six decimals, trailing zeros dropped.   Much faster than sprintf("%g") on long runs
+static char *put_fixed(char *p, const float x)
+{
+  if ( !isfinite(x) ) { memcpy(p, "nan", 3); return p + 3; }
+  if ( x<0. ) *p++ = '-';
+  uint64_t u = uint64_t(fabs(double(x))*1e6 + 0.5);
+  uint64_t whole = u / 1000000ULL;
+  uint32_t frac = uint32_t(u % 1000000ULL);
+  char tmp[24];
+  int n = 0;
+  do { tmp[n++] = char('0' + whole % 10ULL); whole /= 10ULL; } while ( whole );
+  while ( n ) *p++ = tmp[--n];
+  if ( frac )
+  {
+    *p++ = '.';
+    int digits = 6;
+    while ( frac % 10 == 0 ) { frac /= 10; digits--; }
+    for ( int i=digits-1; i>=0; i-- ) { p[i] = char('0' + frac % 10); frac /= 10; }
+    p += digits;
+  }
+  return p;
+}
+
+// Output of one case
+class GenOut
+{
+public:
+  GenOut() : csv_(NULL), at_(0) {}
+  ~GenOut() { close(); }
+  // functions
+  bool close();
+  bool open(const std::string &base, const bool bin, const uint64_t nrows);
+  bool row(const double t, const float *v);
+protected:
+  FILE *csv_;                   // CSV file, or NULL for column file
+  LogStoreBlockWriter col_;     // Column file
+  std::vector<char> buf_;       // CSV text waiting to be written
+  size_t at_;                   // Fill of buf_
+  std::string unit_;            // First field of a CSV line
+  time_t hm_t_;                 // Second of hm_
+  char hm_[32];                 // Date field of a CSV line
+};
+
+bool GenOut::open(const std::string &base, const bool bin, const uint64_t nrows)
+{
+  std::vector<std::string> names(columns, columns + num_columns);
+  if ( bin ) return col_.open(base + "_mon.soc", "cTime", names, nrows);
+  csv_ = fopen((base + ".csv").c_str(), "w");
+  if ( !csv_ ) return false;
+  buf_.resize(1<<20);
+  at_ = 0;
+  String batt = CHEM==0 ? "_bb" : ( CHEM==1 ? "_ch" : ( CHEM==2 ? "_chg" : "_un" ) );
+  unit_ = (unit + batt).c_str();
+  hm_t_ = -1;
+  fprintf(csv_, "unit,               hm,                  cTime,");
+  for ( int c=0; c<num_columns; c++ ) fprintf(csv_, "%s,", columns[c]);
+  fprintf(csv_, "\n");
+  return true;
+}
+
+bool GenOut::row(const double t, const float *v)
+{
+  if ( !csv_ ) return col_.add_row(t, v);
+  if ( at_ + 512 > buf_.size() )
+  {
+    fwrite(buf_.data(), 1, at_, csv_);
+    at_ = 0;
+  }
+  if ( time_t(t)!=hm_t_ )
+  {
+    hm_t_ = time_t(t);
+    time_long_2_str(hm_t_, hm_);
+  }
+  char *p = buf_.data() + at_;
+  p += sprintf(p, "%s, %s, %13.3f,", unit_.c_str(), hm_, t);
+  for ( int c=0; c<num_columns; c++ ) { p = put_fixed(p, v[c]); *p++ = ','; }
+  *p++ = '\n';
+  at_ = p - buf_.data();
+  return true;
+}
+
+bool GenOut::close()
+{
+  if ( !csv_ ) return col_.close();
+  fwrite(buf_.data(), 1, at_, csv_);
+  bool good = !ferror(csv_);
+  fclose(csv_);
+  csv_ = NULL;
+  return good;
+}
+
+// One case, start to finish.  Follows the Sim calls of initialize_all and sense_synth_select in subs.cpp
+static uint64_t run_case(const Case &c, const std::vector<Segment> &prof, const double dt, const double days,
+  const int every, const bool bin, const std::string &out, const std::vector<float> &inj_t, const std::vector<float> &inj_a)
+{
+  soc_host_setup(GEN_MODELING, GEN_TIME_START);
+  BatterySim Sim_obj;
+  BatterySim *Sim = &Sim_obj;
+  if ( inj_t.size() ) Sim->prof_inj()->load(inj_t.size(), inj_t.data(), inj_a.data());
+  uint64_t n = uint64_t(days*86400./dt + 0.5);
+  uint64_t nrows = (n + every - 1) / every;
+  char base[32];
+  snprintf(base, sizeof(base), "_%d", c.k);
+  GenOut o;
+  if ( !o.open(out + base, bin, nrows) )
+  {
+    fprintf(stderr, "cannot open %s%s\n", out.c_str(), base);
+    return 0ULL;
+  }
+  unsigned long dt_ms = (unsigned long)(dt*1000. + 0.5);
+
+  // Initialize
+  size_t iseg = 0;
+  double t_seg = 0.;                // Time into segment, s
+  float tb = prof[0].tb + c.tb_bias;
+  float ib_in = prof[0].ib * c.ib_scale;
+  Sim->apply_soc(c.soc0, tb);
+  Sim->init_battery_sim(true, ib_in / sp.nP(), Sim->voc_soc_tab(c.soc0, tb));
+  Sim->calculate(tb, ib_in, dt, false, true);
+  Sim->calculate(tb, ib_in, dt, false, true);  // Again because sat is a UBC
+  Sim->count_coulombs(dt, tb, System.millis(), true, NULL, true);
+
+  float v[num_columns];
+  for ( uint64_t i=0; i<n; i++ )
+  {
+    const Segment &s = prof[iseg];
+    tb = s.tb + c.tb_bias;
+    ib_in = s.ib * c.ib_scale;
+    if ( s.type ) ib_in += Sim->calc_inj((unsigned long long)(t_seg*1000.) + 1ULL, s.type, s.amp, s.freq_hz*2.*PI);
+    Sim->calculate(tb, ib_in, dt, false, false);
+    Sim->count_coulombs(dt, tb, System.millis(), false, NULL, false);
+    if ( i % every == 0 )
+    {
+      v[0] = tb;  v[1] = ib_in;  v[2] = Sim->ib();  v[3] = Sim->ib_charge();  v[4] = Sim->ioc();
+      v[5] = Sim->vb();  v[6] = Sim->voc();  v[7] = Sim->voc_stat();  v[8] = Sim->dv_dyn();  v[9] = Sim->hys_state();
+      v[10] = Sim->soc();  v[11] = Sim->saturated();  v[12] = Sim->bms_off();  v[13] = Sim->cutback();
+      o.row(double(GEN_TIME_START) + double(i)*dt, v);
+    }
+    System.advance(dt_ms);
+    t_seg += dt;
+    if ( t_seg >= s.dur_s - dt*0.5 )
+    {
+      t_seg = 0.;
+      iseg = (iseg + 1) % prof.size();
+    }
+  }
+  if ( !o.close() ) fprintf(stderr, "write failed %s%s\n", out.c_str(), base);
+  return n;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_gen [--profile file] [--days d] [--dt s] [--every n] [--cases n] [--jobs n]\n"
+                  "                [--seed n] [--bin] [--inj trace] [--out prefix]\n");
+}
+
+int main(int argc, char **argv)
+{
+  const char *profile_name = NULL;
+  const char *inj_name = NULL;
+  double days = GEN_DAYS;
+  double dt = GEN_DT;
+  int every = 1;
+  int cases = 1;
+  int jobs = int(sysconf(_SC_NPROCESSORS_ONLN));
+  unsigned seed = 1;
+  bool bin = false;
+  std::string out = "gen";
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--profile")==0 && more ) profile_name = argv[++i];
+    else if ( strcmp(argv[i], "--days")==0 && more ) days = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--dt")==0 && more ) dt = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--every")==0 && more ) every = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--cases")==0 && more ) cases = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--jobs")==0 && more ) jobs = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--seed")==0 && more ) seed = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--bin")==0 ) bin = true;
+    else if ( strcmp(argv[i], "--inj")==0 && more ) inj_name = argv[++i];
+    else if ( strcmp(argv[i], "--out")==0 && more ) out = argv[++i];
+    else { usage(); return 2; }
+  }
+  if ( days<=0. || dt<=0.001 || every<1 || cases<1 ) { usage(); return 2; }
+  jobs = max(min(jobs, cases), 1);
+
+  std::vector<Segment> prof;
+  if ( profile_name )
+  {
+    if ( !load_profile(profile_name, &prof) ) { fprintf(stderr, "bad profile %s\n", profile_name); return 1; }
+  }
+  else
+    prof.assign(profile_default, profile_default + sizeof(profile_default)/sizeof(Segment));
+  std::vector<float> inj_t, inj_a;
+  if ( inj_name )
+  {
+    ProfInj check;
+    if ( !load_trace(inj_name, &inj_t, &inj_a) || !check.load(inj_t.size(), inj_t.data(), inj_a.data()) )
+    {
+      fprintf(stderr, "bad trace %s:  need >=2 points, times ascending, <=%lu points\n", inj_name, PROF_INJ_MAX);
+      return 1;
+    }
+    fprintf(stderr, "soc_gen:  trace %s, %lu points over %.0f s\n", inj_name, (unsigned long)check.n(), check.period());
+  }
+
+  // Model prints (debug, out of range) go to stderr so a CSV on stdout is never mixed in
+  Serial.out(stderr);
+
+  struct timespec t0, t1;
+  clock_gettime(CLOCK_MONOTONIC, &t0);
+  std::vector<pid_t> pids;
+  for ( int w=0; w<jobs; w++ )
+  {
+    pid_t pid = fork();
+    if ( pid<0 ) { perror("fork"); return 1; }
+    if ( pid==0 )
+    {
+      for ( int k=w; k<cases; k+=jobs ) run_case(draw_case(k, seed), prof, dt, days, every, bin, out, inj_t, inj_a);
+      _exit(0);
+    }
+    pids.push_back(pid);
+  }
+  int fails = 0;
+  for ( size_t w=0; w<pids.size(); w++ )
+  {
+    int status = 0;
+    waitpid(pids[w], &status, 0);
+    if ( !WIFEXITED(status) || WEXITSTATUS(status)!=0 ) fails++;
+  }
+  clock_gettime(CLOCK_MONOTONIC, &t1);
+  double wall = double(t1.tv_sec - t0.tv_sec) + double(t1.tv_nsec - t0.tv_nsec)*1e-9;
+  double samples = double(cases) * double(uint64_t(days*86400./dt + 0.5));
+  fprintf(stderr, "soc_gen:  %d cases x %.0f samples in %.2f s on %d jobs:  %.2f M samples/s, %.2f M/s/job\n",
+    cases, samples/cases, wall, jobs, samples/wall*1e-6, samples/wall/jobs*1e-6);
+  return fails ? 1 : 0;
+}
@@ -0,0 +1,184 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Host tool for captured serial logs.  See README.md
+//   soc_log ingest <capture.csv> <out_base> [unit_key]    write <out_base>_mon.soc, _sel, _ekf, _sim, _flt, _his, _sum
+//   soc_log info <store.soc>                              list columns and time span
+//   soc_log slice <store.soc> <t_beg> <t_end> [cols]      print rows t_beg <= time < t_end as csv, cols comma separated
+
+#include "LogStore.h"
+#include <chrono>
+#include <fcntl.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static double seconds_since(const std::chrono::steady_clock::time_point &t0)
+{
+  return std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// vv1 lines carry the unit plus battery suffix from assign_identity
+static bool is_mon_unit(const char *b, const char *e)
+{
+  while ( e>b && e[-1]==' ' ) e--;
+  const char *sfx[] = {"_bb", "_ch", "_chg", "_un"};
+  for ( int i=0; i<4; i++ )
+  {
+    size_t n = strlen(sfx[i]);
+    if ( size_t(e-b)>n && memcmp(e-n, sfx[i], n)==0 ) return true;
+  }
+  return false;
+}
+
+static int ingest(const char *capture, const std::string &out_base, const char *unit_key)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  int fd = open(capture, O_RDONLY);
+  if ( fd<0 ) { fprintf(stderr, "ingest: cannot open %s\n", capture); return 1; }
+  struct stat st;
+  fstat(fd, &st);
+  const char *buf = (const char *)mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if ( buf==MAP_FAILED ) { fprintf(stderr, "ingest: cannot map %s\n", capture); return 1; }
+  madvise((void *)buf, st.st_size, MADV_SEQUENTIAL);
+
+  std::vector<LogStoreWriter> writers;
+  for ( int s=0; s<num_log_streams; s++ ) writers.push_back(LogStoreWriter(&log_streams[s]));
+
+  const char *p = buf;
+  const char *end = buf + st.st_size;
+  uint64_t nlines = 0;
+  while ( p<end )
+  {
+    const char *eol = (const char *)memchr(p, '\n', end-p);
+    if ( eol==NULL ) eol = end;
+    nlines++;
+    if ( memmem(p, eol-p, "FRAG", 4)!=NULL )
+      fprintf(stderr, "ingest: heap fragmentation reported by Particle at line %lu.  Decrease NSUM and re-run\n", (unsigned long)nlines);
+
+    // Key is the first field
+    const char *comma = (const char *)memchr(p, ',', eol-p);
+    if ( comma!=NULL )
+    {
+      const char *b = p;
+      const char *e = comma;
+      while ( b<e && (*b==' ' || *b=='>') ) b++;
+      while ( e>b && e[-1]==' ' ) e--;
+      for ( int s=0; s<num_log_streams; s++ )
+      {
+        const LogStream *ls = &log_streams[s];
+        size_t hn = strlen(ls->hdr_key);
+        if ( size_t(comma+1-b)==hn && memcmp(b, ls->hdr_key, hn)==0 )
+        {
+          writers[s].add_header(b, eol);
+          continue;
+        }
+        const char *key = ls->unit_key[0] ? ls->unit_key : unit_key;
+        bool match = key ? ( size_t(e-b)==strlen(key) && memcmp(b, key, e-b)==0 ) : is_mon_unit(b, e);
+        if ( match ) writers[s].add_line(b, eol);
+      }
+    }
+    p = eol + 1;
+  }
+  double t_parse = seconds_since(t0);
+
+  for ( int s=0; s<num_log_streams; s++ )
+  {
+    if ( !writers[s].rows() ) continue;
+    std::string path = out_base + log_streams[s].suffix + ".soc";
+    if ( !writers[s].write(path) ) { fprintf(stderr, "ingest: write %s failed\n", path.c_str()); continue; }
+    printf("Wrote %s %lu rows %lu skips\n", path.c_str(), (unsigned long)writers[s].rows(), (unsigned long)writers[s].skips());
+  }
+  printf("ingest: %lu lines %.1f MB parse %.3f s total %.3f s\n", (unsigned long)nlines, st.st_size/1e6, t_parse, seconds_since(t0));
+  munmap((void *)buf, st.st_size);
+  return 0;
+}
+
+static int info(const char *path)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  LogStore store;
+  if ( !store.open(path) ) return 1;
+  double t_open = seconds_since(t0);
+  printf("%s: %lu rows, %d cols, open %.6f s\n", path, (unsigned long)store.rows(), store.cols(), t_open);
+  if ( store.rows() ) printf(" %s %.3f to %.3f\n", store.time_name(), store.time()[0], store.time()[store.rows()-1]);
+  for ( int c=0; c<store.cols(); c++ ) printf(" %s", store.name(c));
+  printf("\n");
+  return 0;
+}
+
+static int slice(const char *path, const double t_beg, const double t_end, const char *col_list)
+{
+  auto t0 = std::chrono::steady_clock::now();
+  LogStore store;
+  if ( !store.open(path) ) return 1;
+  std::vector<int> cols;
+  if ( col_list )
+  {
+    std::string list(col_list);
+    size_t b = 0;
+    while ( b<=list.size() )
+    {
+      size_t e = list.find(',', b);
+      if ( e==std::string::npos ) e = list.size();
+      std::string name = list.substr(b, e-b);
+      int c = store.find(name.c_str());
+      if ( c<0 ) fprintf(stderr, "slice: no column %s\n", name.c_str());
+      else cols.push_back(c);
+      b = e + 1;
+    }
+  }
+  else
+    for ( int c=0; c<store.cols(); c++ ) cols.push_back(c);
+
+  LogSlice s = store.slice(t_beg, t_end);
+  double t_query = seconds_since(t0);
+  printf("%s,", store.time_name());
+  for ( size_t j=0; j<cols.size(); j++ ) printf("%s,", store.name(cols[j]));
+  printf("\n");
+  const double *t = store.time();
+  for ( uint64_t i=s.begin; i<s.end; i++ )
+  {
+    printf("%.3f,", t[i]);
+    for ( size_t j=0; j<cols.size(); j++ ) printf("%.7g,", store.column(cols[j])[i]);
+    printf("\n");
+  }
+  fprintf(stderr, "slice: %lu rows, open+query %.6f s\n", (unsigned long)s.size(), t_query);
+  return 0;
+}
+
+int main(int argc, char **argv)
+{
+  if ( argc>=4 && strcmp(argv[1], "ingest")==0 )
+    return ingest(argv[2], argv[3], argc>4 ? argv[4] : NULL);
+  if ( argc>=3 && strcmp(argv[1], "info")==0 )
+    return info(argv[2]);
+  if ( argc>=5 && strcmp(argv[1], "slice")==0 )
+    return slice(argv[2], atof(argv[3]), atof(argv[4]), argc>5 ? argv[5] : NULL);
+  fprintf(stderr, "usage:\n  soc_log ingest <capture.csv> <out_base> [unit_key]\n  soc_log info <store.soc>\n  soc_log slice <store.soc> <t_beg> <t_end> [col,col,...]\n");
+  return 2;
+}
@@ -0,0 +1,464 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Host report of the parameter registry (ParRegistry.h).   Not part of the Particle build.   Checks the flash tables
+// VOL_DEFS and SAV_DEFS (codes unique, nominals in range, text that prints whole, the EERAM layout SAV_MAP the same
+// as assign_addr lays out) and that each Variable built from them prints what the String-carrying classes printed.
+// Then compares RAM and boot cost against those classes:  object and heap bytes on the target, modeled by mirror
+// structs with 32 bit pointers and newlib's malloc blocks, heap allocations per Variable, counted, and the time to
+// construct all of them on this host, the old way by LegV below, a copy of the old constructor body, with WStr
+// standing in for Wiring String (a malloc per copy, counted).
+
+#include <chrono>
+#include <string>
+#include <type_traits>
+#include <vector>
+#include "SocHost.h"
+#include "ParRegistry.h"
+
+#define PAR_TGT_PTR     4         // Pointer on the target, B
+#define PAR_TGT_HDR     4         // newlib malloc chunk header, B
+#define PAR_TGT_MIN     16        // newlib smallest chunk, B
+
+extern PrinterPars pr;
+
+// Bytes a malloc(n) takes from the newlib heap
+static long tgt_block(const long n)
+{
+  return max(long(PAR_TGT_MIN), (n + PAR_TGT_HDR + 7) & ~7L);
+}
+
+// Wiring String, as much as the old constructor used.   Counts its allocations and the target heap they take
+static long ws_n = 0;       // Allocations
+static long ws_b = 0;       // Target heap, B
+class WStr
+{
+public:
+  WStr() : buf_(NULL), len_(0) {}
+  WStr(const char *c) : buf_(NULL), len_(0) { copy(c, strlen(c)); }
+  WStr(const WStr &o) : buf_(NULL), len_(0) { copy(o.buf_, o.len_); }
+  WStr(WStr &&o) : buf_(o.buf_), len_(o.len_) { o.buf_ = NULL; o.len_ = 0; }
+  ~WStr() { free(buf_); }
+  WStr &operator=(const WStr &o) { if ( this!=&o ) { free(buf_); buf_ = NULL; copy(o.buf_, o.len_); } return *this; }
+  WStr &operator=(WStr &&o) { std::swap(buf_, o.buf_); std::swap(len_, o.len_); return *this; }
+  const char *c_str() const { return buf_ ? buf_ : ""; }
+  unsigned length() const { return len_; }
+  WStr substring(const unsigned a, const unsigned b) const
+  {
+    WStr r;
+    if ( a<len_ && b>a ) r.copy(buf_ + a, min(b, len_) - a);
+    return r;
+  }
+protected:
+  void copy(const char *c, const unsigned n)
+  {
+    buf_ = (char *)malloc(n + 1);
+    memcpy(buf_, c, n);
+    buf_[n] = '\0';
+    len_ = n;
+    ws_n++;
+    ws_b += tgt_block(n + 1);
+  }
+  char *buf_;
+  unsigned len_;
+};
+
+// The Variable classes before the registry:  the constructor body and print strings, one template for all types
+struct LegBase
+{
+  virtual ~LegBase() {}
+  virtual void print_str() = 0;
+  virtual void print_help_str() = 0;
+};
+
+template <typename T>
+class LegV : public LegBase
+{
+public:
+  LegV(const WStr &prefix, const WStr &code, SerialRAM *ram, const WStr &description, const WStr &units, const T min,
+    const T max, T *store, const T _default, const boolean check_for_off_on_init, const uint8_t type)
+  {
+    prefix_ = prefix;
+    code_ = code;
+    description_ = description.substring(0, 20);
+    units_ = units.substring(0, 10);
+    check_for_off_on_init_ = check_for_off_on_init;
+    is_eeram_ = !(ram==NULL);
+    rP_ = ram;
+    min_ = min;
+    max_ = max;
+    val_ = store;
+    default_ = max(min(_default, max_), min_);
+    type_ = type;
+    if ( check_for_off_on_init_ && (*val_>max_ || *val_<min_) )
+      printf("%s %s set:: out range\n", code_.c_str(), description_.c_str());
+  }
+  void print_str();
+  void print_help_str();
+protected:
+  typedef typename std::conditional<std::is_floating_point<T>::value, double, int>::type A;  // As printf takes T
+  WStr code_;
+  SerialRAM *rP_;
+  address16b addr_;
+  WStr units_;
+  WStr description_;
+  boolean is_eeram_;
+  boolean check_for_off_on_init_;
+  WStr prefix_;
+  boolean success_;
+  T min_, max_, default_;
+  T *val_;
+  uint8_t type_;
+};
+
+// Formats of the old classes, by ParType
+static const char *LEG_FMT[] = {" %-20s %9d -> %9d, %10s (%s%-2s)", " %-20s %9.1f -> %9.1f, %10s (%s%-2s)",
+  " %-20s %9.3f -> %9.3f, %10s (%s%-2s)", " %-20s %9d -> %9d, %10s (%s%-2s)", " %-20s %9d -> %9d, %10s (%s%-2s)",
+  " %-20s %9d -> %9d, %10s (%s%-2s)", " %-20s %9d -> %9d, %10s (%s%-2s)", " %-18s %10d -> %10d, %10s (%s%-2s)"};
+static const char *LEG_HELP[] = {"%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", "%s%-2s= %6.1f: (%-6.1f-%6.1f) [%6.1f] %s, %s",
+  "%s%-2s= %6.3f: (%-6.3g-%6.3g) [%6.3f] %s, %s", "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s",
+  "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s",
+  "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s"};
+
+#pragma GCC diagnostic ignored "-Wformat-nonliteral"
+#pragma GCC diagnostic ignored "-Wformat-security"
+template <typename T>
+void LegV<T>::print_str()
+{
+  sprintf(pr.buff, LEG_FMT[type_], description_.c_str(), A(default_), A(*val_), units_.c_str(), prefix_.c_str(),
+    code_.c_str());
+}
+
+template <typename T>
+void LegV<T>::print_help_str()
+{
+  sprintf(pr.buff, LEG_HELP[type_], prefix_.c_str(), code_.c_str(), A(*val_), A(min_), A(max_), A(default_),
+    description_.c_str(), units_.c_str());
+}
+
+// Store of one parameter
+union ParStore
+{
+  boolean b;
+  double d;
+  float f;
+  int i;
+  int8_t i8;
+  uint16_t u16;
+  uint8_t u8;
+  unsigned long ul;
+};
+
+// Target layout of the classes, pointers as 32 bit.   Old base, new base, and the members each type adds
+struct TgtString { uint32_t buffer; uint32_t capacity; uint32_t len; uint8_t flags; };
+struct TgtOld { uint32_t vptr; uint32_t app_; TgtString code_; uint32_t rP_; uint16_t addr_; TgtString units_;
+  TgtString description_; boolean is_eeram_; boolean check_; TgtString prefix_; boolean success_; };
+struct TgtNew { uint32_t vptr; uint32_t app_; uint32_t def_; uint32_t rP_; uint16_t addr_; boolean is_eeram_;
+  boolean success_; };
+template <typename B, typename T> struct TgtV : B { T min_, max_, default_; uint32_t val_; };
+struct TgtDef { uint32_t code; uint8_t type; boolean saved; boolean check; uint32_t description; uint32_t units;
+  double min, max, nominal; };
+
+template <typename B>
+static long tgt_size(const uint8_t type)
+{
+  switch ( type )
+  {
+    case PAR_BOOLEAN:   return sizeof(TgtV<B, boolean>);
+    case PAR_DOUBLE:    return sizeof(TgtV<B, double>);
+    case PAR_FLOAT:     return sizeof(TgtV<B, float>);
+    case PAR_INT:       return sizeof(TgtV<B, int32_t>);
+    case PAR_INT8:      return sizeof(TgtV<B, int8_t>);
+    case PAR_UINT16:    return sizeof(TgtV<B, uint16_t>);
+    case PAR_UINT8:     return sizeof(TgtV<B, uint8_t>);
+    default:            return sizeof(TgtV<B, uint32_t>);
+  }
+}
+
+// Store at the nominal, so construction prints nothing
+static void preset(const ParDef &d, ParStore *s)
+{
+  switch ( d.type )
+  {
+    case PAR_BOOLEAN:   s->b = boolean(d.nominal); break;
+    case PAR_DOUBLE:    s->d = d.nominal; break;
+    case PAR_FLOAT:     s->f = float(d.nominal); break;
+    case PAR_INT:       s->i = int(d.nominal); break;
+    case PAR_INT8:      s->i8 = int8_t(d.nominal); break;
+    case PAR_UINT16:    s->u16 = uint16_t(d.nominal); break;
+    case PAR_UINT8:     s->u8 = uint8_t(d.nominal); break;
+    default:            s->ul = (unsigned long)(d.nominal); break;
+  }
+}
+
+// Variable of d on s, as initialize() makes it
+static Variable *make_new(const ParDef *d, ParStore *s)
+{
+  switch ( d->type )
+  {
+    case PAR_BOOLEAN:   return new BooleanV(d, NULL, &s->b);
+    case PAR_DOUBLE:    return new DoubleV(d, NULL, &s->d);
+    case PAR_FLOAT:     return new FloatV(d, NULL, &s->f);
+    case PAR_INT:       return new IntV(d, NULL, &s->i);
+    case PAR_INT8:      return new Int8tV(d, NULL, &s->i8);
+    case PAR_UINT16:    return new Uint16tV(d, NULL, &s->u16);
+    case PAR_UINT8:     return new Uint8tV(d, NULL, &s->u8);
+    default:            return new ULongV(d, NULL, &s->ul);
+  }
+}
+
+// Each deleted as the type it was made, which the warning cannot see
+#pragma GCC diagnostic ignored "-Wdelete-non-virtual-dtor"
+static void free_new(const ParDef *d, Variable *v)
+{
+  switch ( d->type )
+  {
+    case PAR_BOOLEAN:   delete (BooleanV *)v; break;
+    case PAR_DOUBLE:    delete (DoubleV *)v; break;
+    case PAR_FLOAT:     delete (FloatV *)v; break;
+    case PAR_INT:       delete (IntV *)v; break;
+    case PAR_INT8:      delete (Int8tV *)v; break;
+    case PAR_UINT16:    delete (Uint16tV *)v; break;
+    case PAR_UINT8:     delete (Uint8tV *)v; break;
+    default:            delete (ULongV *)v; break;
+  }
+}
+
+// The print strings of v, which print_str and print_help_str leave in pr.buff
+static void print_new(const ParDef *d, Variable *v, std::string *s, std::string *h)
+{
+  switch ( d->type )
+  {
+    case PAR_BOOLEAN:   ((BooleanV *)v)->print_str(); *s = pr.buff; ((BooleanV *)v)->print_help_str(); break;
+    case PAR_DOUBLE:    ((DoubleV *)v)->print_str(); *s = pr.buff; ((DoubleV *)v)->print_help_str(); break;
+    case PAR_FLOAT:     ((FloatV *)v)->print_str(); *s = pr.buff; ((FloatV *)v)->print_help_str(); break;
+    case PAR_INT:       ((IntV *)v)->print_str(); *s = pr.buff; ((IntV *)v)->print_help_str(); break;
+    case PAR_INT8:      ((Int8tV *)v)->print_str(); *s = pr.buff; ((Int8tV *)v)->print_help_str(); break;
+    case PAR_UINT16:    ((Uint16tV *)v)->print_str(); *s = pr.buff; ((Uint16tV *)v)->print_help_str(); break;
+    case PAR_UINT8:     ((Uint8tV *)v)->print_str(); *s = pr.buff; ((Uint8tV *)v)->print_help_str(); break;
+    default:            ((ULongV *)v)->print_str(); *s = pr.buff; ((ULongV *)v)->print_help_str(); break;
+  }
+  *h = pr.buff;
+}
+
+// Old Variable of d on s, from string literals as initialize() passed them
+static LegBase *make_old(const ParDef *d, ParStore *s)
+{
+  const char *prefix = d->saved ? "* " : "  ";
+  switch ( d->type )
+  {
+    case PAR_BOOLEAN:   return new LegV<boolean>(prefix, d->code, NULL, d->description, d->units, boolean(d->min),
+                          boolean(d->max), &s->b, boolean(d->nominal), d->check, d->type);
+    case PAR_DOUBLE:    return new LegV<double>(prefix, d->code, NULL, d->description, d->units, d->min, d->max, &s->d,
+                          d->nominal, d->check, d->type);
+    case PAR_FLOAT:     return new LegV<float>(prefix, d->code, NULL, d->description, d->units, float(d->min),
+                          float(d->max), &s->f, float(d->nominal), d->check, d->type);
+    case PAR_INT:       return new LegV<int>(prefix, d->code, NULL, d->description, d->units, int(d->min), int(d->max),
+                          &s->i, int(d->nominal), d->check, d->type);
+    case PAR_INT8:      return new LegV<int8_t>(prefix, d->code, NULL, d->description, d->units, int8_t(d->min),
+                          int8_t(d->max), &s->i8, int8_t(d->nominal), d->check, d->type);
+    case PAR_UINT16:    return new LegV<uint16_t>(prefix, d->code, NULL, d->description, d->units, uint16_t(d->min),
+                          uint16_t(d->max), &s->u16, uint16_t(d->nominal), d->check, d->type);
+    case PAR_UINT8:     return new LegV<uint8_t>(prefix, d->code, NULL, d->description, d->units, uint8_t(d->min),
+                          uint8_t(d->max), &s->u8, uint8_t(d->nominal), d->check, d->type);
+    default:            return new LegV<unsigned long>(prefix, d->code, NULL, d->description, d->units,
+                          (unsigned long)(d->min), (unsigned long)(d->max), &s->ul, (unsigned long)(d->nominal),
+                          d->check, d->type);
+  }
+}
+
+// Both tables, in the order sp and ap build them
+struct Tab { const char *name; const ParDef *defs; uint8_t n; };
+static const Tab TABS[] = {{"SAV_DEFS", SAV_DEFS, NSAV}, {"VOL_DEFS", VOL_DEFS, NVOL}};
+#define N_TABS  2
+
+// Table checks, printing each failure.   Number of failures
+static int check_tables()
+{
+  int bad = 0;
+  for ( int t=0; t<N_TABS; t++ )
+  {
+    const Tab &tb = TABS[t];
+    for ( uint8_t i=0; i<tb.n; i++ )
+    {
+      const ParDef &d = tb.defs[i];
+      if ( strlen(d.code)!=2 ) { printf("soc_params:  %s '%s' code not 2 characters\n", tb.name, d.code); bad++; }
+      for ( int u=0; u<=t; u++ )
+        for ( uint8_t j=0; j<(u==t ? i : TABS[u].n); j++ )
+          if ( !strcmp(TABS[u].defs[j].code, d.code) )
+          {
+            printf("soc_params:  %s '%s' also in %s\n", tb.name, d.code, TABS[u].name);
+            bad++;
+          }
+      if ( d.nominal<d.min || d.nominal>d.max )
+      {
+        printf("soc_params:  %s '%s' nominal %g outside (%g, %g)\n", tb.name, d.code, d.nominal, d.min, d.max);
+        bad++;
+      }
+      if ( d.saved!=(tb.defs==SAV_DEFS) ) { printf("soc_params:  %s '%s' saved flag\n", tb.name, d.code); bad++; }
+      if ( strlen(d.description)>20 ) printf("soc_params:  %s '%s' description prints cut to 20\n", tb.name, d.code);
+      if ( strlen(d.units)>10 ) printf("soc_params:  %s '%s' units print cut to 10\n", tb.name, d.code);
+    }
+  }
+
+  // Layout:  assign_addr in table order, as the EERAM SavedPars constructor did before SAV_MAP
+  ParStore s[NSAV];
+  uint16_t next = 0;
+  for ( uint8_t i=0; i<NSAV; i++ )
+  {
+    preset(SAV_DEFS[i], &s[i]);
+    Variable *v = make_new(&SAV_DEFS[i], &s[i]);
+    if ( next!=SAV_MAP.addr[i] ) { printf("soc_params:  SAV_MAP '%s' %d, assign_addr %d\n", SAV_DEFS[i].code,
+      SAV_MAP.addr[i], next); bad++; }
+    next = v->assign_addr(next);
+    free_new(&SAV_DEFS[i], v);
+  }
+  if ( next!=SAV_MAP.addr[NSAV] ) { printf("soc_params:  SAV_MAP size %d, assign_addr %d\n", SAV_MAP.addr[NSAV], next);
+    bad++; }
+  return bad;
+}
+
+// Print strings, registry against the old classes, at nominal and past it.   Number differing
+static int check_prints()
+{
+  int bad = 0;
+  for ( int t=0; t<N_TABS; t++ )
+    for ( uint8_t i=0; i<TABS[t].n; i++ )
+    {
+      const ParDef *d = &TABS[t].defs[i];
+      for ( int k=0; k<2; k++ )
+      {
+        ParStore s;
+        preset(*d, &s);
+        Variable *v = make_new(d, &s);
+        LegBase *o = make_old(d, &s);
+        if ( k ) { ParDef up = *d;  up.nominal = d->max;  preset(up, &s); }   // Value off nominal
+        std::string ns, nh;
+        print_new(d, v, &ns, &nh);
+        o->print_str();
+        std::string os = pr.buff;
+        o->print_help_str();
+        if ( ns!=os || nh!=pr.buff )
+        {
+          printf("soc_params:  '%s' prints differ\n  was '%s'\n      '%s'\n  now '%s'\n      '%s'\n", d->code, os.c_str(),
+            pr.buff, ns.c_str(), nh.c_str());
+          bad++;
+        }
+        delete o;
+        free_new(d, v);
+      }
+    }
+  return bad;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_params [--reps n]\n");
+}
+
+int main(int argc, char *argv[])
+{
+  long reps = 2000;
+  for ( int i=1; i<argc; i++ )
+  {
+    std::string a = argv[i];
+    if ( a=="--reps" && i+1<argc ) reps = atol(argv[++i]);
+    else { usage(); return 1; }
+  }
+  soc_host_setup(0, 0);
+
+  int bad = check_tables();
+  int bad_pr = check_prints();
+  printf("soc_params:  %d table faults, %d print strings differ from the String classes\n", bad, bad_pr);
+
+  // RAM on the target, per table
+  printf("\nsoc_params:  target RAM       entries   old obj  old heap   new obj  new heap   allocs old/new  flash table\n");
+  long tot_old = 0, tot_new = 0, tot_flash = 0;
+  for ( int t=0; t<N_TABS; t++ )
+  {
+    long obj_old = 0, obj_new = 0, heap_old = 0, heap_new = 0, n_old = 0;
+    for ( uint8_t i=0; i<TABS[t].n; i++ )
+    {
+      const ParDef *d = &TABS[t].defs[i];
+      long so = tgt_size<TgtOld>(d->type), sn = tgt_size<TgtNew>(d->type);
+      obj_old += so;
+      obj_new += sn;
+      heap_new += tgt_block(sn);
+      ParStore s;
+      preset(*d, &s);
+      long n0 = ws_n;
+      LegBase *o = make_old(d, &s);
+      n_old += ws_n - n0 + 1;
+      heap_old += tgt_block(so);
+      // Blocks the four members keep; the temporaries are freed when the constructor returns
+      heap_old += tgt_block(3) + tgt_block(3) + tgt_block(min(strlen(d->description), size_t(20)) + 1)
+        + tgt_block(min(strlen(d->units), size_t(10)) + 1);
+      delete o;
+    }
+    long flash = long(sizeof(TgtDef))*TABS[t].n;
+    printf("soc_params:  %-16s %6d %9ld %9ld %9ld %9ld %8.1f / %-4.1f %10ld\n", TABS[t].name, TABS[t].n, obj_old,
+      heap_old, obj_new, heap_new, double(n_old)/TABS[t].n, 1., flash);
+    tot_old += heap_old;
+    tot_new += heap_new;
+    tot_flash += flash;
+  }
+  printf("soc_params:  heap %ld B before, %ld B now (%ld B less); tables add %ld B of flash, text unchanged\n",
+    tot_old, tot_new, tot_old - tot_new, tot_flash);
+  printf("soc_params:  sizeof(ParDef) %d B here, %d B on the target; EERAM block %d B\n", int(sizeof(ParDef)),
+    int(sizeof(TgtDef)), SAV_MAP.addr[NSAV]);
+
+  // Construction time on this host, all of both tables each rep
+  const int n_all = NSAV + NVOL;
+  ParStore s[n_all];
+  const ParDef *d[n_all];
+  for ( int t=0, k=0; t<N_TABS; t++ )
+    for ( uint8_t i=0; i<TABS[t].n; i++, k++ ) { d[k] = &TABS[t].defs[i]; preset(*d[k], &s[k]); }
+  Variable *vn[n_all];
+  LegBase *vo[n_all];
+  long n0 = ws_n;
+  auto t0 = std::chrono::steady_clock::now();
+  for ( long r=0; r<reps; r++ )
+  {
+    for ( int k=0; k<n_all; k++ ) vo[k] = make_old(d[k], &s[k]);
+    for ( int k=0; k<n_all; k++ ) delete vo[k];
+  }
+  auto t1 = std::chrono::steady_clock::now();
+  for ( long r=0; r<reps; r++ )
+  {
+    for ( int k=0; k<n_all; k++ ) vn[k] = make_new(d[k], &s[k]);
+    for ( int k=0; k<n_all; k++ ) free_new(d[k], vn[k]);
+  }
+  auto t2 = std::chrono::steady_clock::now();
+  double us_old = std::chrono::duration<double, std::micro>(t1 - t0).count()/reps;
+  double us_new = std::chrono::duration<double, std::micro>(t2 - t1).count()/reps;
+  printf("\nsoc_params:  construct %d Variables, %ld reps:  %.2f us before (%ld string mallocs), %.2f us now, %.1fx\n",
+    n_all, reps, us_old, (ws_n - n0)/reps, us_new, us_old/max(us_new, 1e-9));
+
+  if ( bad || bad_pr )
+  {
+    printf("soc_params:  fail\n");
+    return 1;
+  }
+  printf("soc_params:  pass\n");
+  return 0;
+}
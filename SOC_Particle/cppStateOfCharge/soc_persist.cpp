@@ -0,0 +1,341 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Power-loss and wear check of the persistence scheduler, PersistSched, on a simulated backing store.   Not part of
+// the Particle build.   The dynamic saved parameters (qm, qs, tm, ts, UT) follow a random load every read frame and
+// a history record is queued every '--his' s, as in SOC_Particle.ino; the scheduler runs each display pass.   The
+// store is a 47L16 on the simulated I2C bus, which counts writes to each cell, or with '--sync' the Photon 2
+// backup RAM, whose saved copy is taken at each System.backupRamSync(), made every PS_T_OS_SYNC as the Device OS
+// paces them.   Power is cut at '--cuts' random times, '--in_write' of them inside the writes of a display pass
+// (EERAM), and what the store would keep is compared with the RAM:  how long ago the RAM last held the stored value
+// (staleness) against the scheduler's bound of t_stale plus two passes, and history records not stored in time; either fails the run.   Values matching nothing the
+// RAM held are counted as torn but do not fail it:  a cut inside a write tears that value whatever the schedule.
+// '--rr' runs the old put_all_dynamic round-robin through the same checks for comparison.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "SocHost.h"
+#include "PersistSched.h"
+#include "FltPack.h"
+#include "I2cSim.h"
+#include "hardware/SerialRAM.h"
+
+#define PER_FRAME       (READ_DELAY/1000.)        // Read frame, s
+#define PER_PASS        (DISPLAY_USER_DELAY/1000.)  // Display and remember pass, s
+#define PER_NF          5         // Variables scheduled
+#define PER_NH          8         // History records kept
+#define PER_RING        20000     // Frames of RAM values kept for the staleness search, 2000 s
+#define PER_CAP         (NOM_UNIT_CAP*3600.)      // Charge capacity, C
+
+// One scheduled Variable and its RAM history
+struct Fld
+{
+  Variable *v;
+  uint16_t addr;        // EERAM address
+  uint16_t size;        // Bytes
+  float t_stale;        // Scheduler bound less two passes, s
+  double ring[PER_RING];  // RAM value each frame
+  // Results
+  long n;               // Cuts checked
+  long torn;            // Stored value the RAM never held in the window
+  long late;            // Staleness past the bound
+  std::vector<float> age;  // Staleness at each cut, s
+  double err_max;       // Largest |stored - RAM| at a cut
+};
+
+// Saved copy of the Photon 2 backup RAM
+struct Image
+{
+  double v[PER_NF];
+  Flt_st his[PER_NH];
+};
+
+// RAM
+static double dq_z, dqm_z;
+static float ts_z, tsm_z;
+static unsigned long ut_z;
+static Flt_st his_ram[PER_NH];
+static SerialRAM *ram_p = NULL;
+static uint16_t his_addr = 0;
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_persist [--sync] [--rr] [--days d] [--cuts n] [--in_write frac] [--ib A] [--his s] [--seed n]\n");
+}
+
+static float quantile(std::vector<float> *v, const double p)
+{
+  if ( v->empty() ) return 0.;
+  size_t k = min(size_t(p*v->size()), v->size()-1);
+  std::nth_element(v->begin(), v->begin()+k, v->end());
+  return (*v)[k];
+}
+
+// History record i to the EERAM, packed, in one bulk write as Flt_ram::put does
+static uint16_t put_his(const uint16_t i)
+{
+  if ( ram_p )
+  {
+    uint8_t buf[FLT_PK_BYTES];
+    flt_pack(his_ram[i], buf);
+    ram_p->write_bulk(his_addr + i*FLT_PK_BYTES, buf, FLT_PK_BYTES);
+    return FLT_PK_BYTES;
+  }
+  return sizeof(Flt_st);
+}
+
+// Stored value of field k
+static double stored(Fld *f, const int k, Eeram47L16 *dev, Image *img)
+{
+  if ( !dev ) return img->v[k];
+  const uint8_t *m = dev->image() + f->addr;
+  switch ( k )
+  {
+    case ( 0 ): case ( 1 ): { double x; memcpy(&x, m, sizeof(x)); return x; }
+    case ( 2 ): case ( 3 ): { float x; memcpy(&x, m, sizeof(x)); return x; }
+    default: { unsigned long x; memcpy(&x, m, sizeof(x)); return double(x); }
+  }
+}
+
+int main(int argc, char **argv)
+{
+  bool sync = false;
+  bool rr = false;
+  double days = 2.;
+  long n_cuts = 5000;
+  double in_write = 0.;
+  double ib_max = 40.;
+  double t_his = 1800.;
+  unsigned seed = 1;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--sync")==0 ) sync = true;
+    else if ( strcmp(argv[i], "--rr")==0 ) rr = true;
+    else if ( strcmp(argv[i], "--days")==0 && more ) days = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--cuts")==0 && more ) n_cuts = atol(argv[++i]);
+    else if ( strcmp(argv[i], "--in_write")==0 && more ) in_write = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--ib")==0 && more ) ib_max = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--his")==0 && more ) t_his = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--seed")==0 && more ) seed = atoi(argv[++i]);
+    else { usage(); return 2; }
+  }
+  if ( days<=0. || n_cuts<0 || t_his<=0. ) { usage(); return 2; }
+  soc_host_setup(0, 1700000000);
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uni(0., 1.);
+  std::normal_distribution<double> gauss(0., 1.);
+
+  // Store
+  Eeram47L16 *dev = NULL;
+  SerialRAM ram;
+  Image img;
+  if ( !sync )
+  {
+    dev = new Eeram47L16();
+    Wire.bus()->attach(dev);
+    Wire.bus()->attach(new Eeram47L16Ctrl());
+    ram.begin(0, 0);
+    ram_p = &ram;
+  }
+
+  // Fields as SavedPars lays them out
+  dq_z = dqm_z = 0.;
+  ts_z = tsm_z = 25.;
+  ut_z = 1700000000UL;
+  SerialRAM *rp = sync ? NULL : &ram;
+  static Fld fld[PER_NF];
+  fld[0].v = new DoubleV(par_find(SAV_DEFS, NSAV, "qm"), rp, &dq_z);
+  fld[1].v = new DoubleV(par_find(SAV_DEFS, NSAV, "qs"), rp, &dqm_z);
+  fld[2].v = new FloatV(par_find(SAV_DEFS, NSAV, "tm"), rp, &ts_z);
+  fld[3].v = new FloatV(par_find(SAV_DEFS, NSAV, "ts"), rp, &tsm_z);
+  fld[4].v = new ULongV(par_find(SAV_DEFS, NSAV, "UT"), rp, &ut_z);
+  uint16_t next = 0;
+  for ( int k=0; k<PER_NF; k++ )
+  {
+    fld[k].addr = next;
+    next = fld[k].v->assign_addr(next);
+    fld[k].size = next - fld[k].addr;
+    fld[k].t_stale = ( k<2 ) ? PS_T_STALE_DQ : ( ( k<4 ) ? PS_T_STALE_T : PS_T_STALE_UT );
+    fld[k].n = fld[k].torn = fld[k].late = 0;
+    fld[k].err_max = 0.;
+    fld[k].v->put();
+  }
+  his_addr = next;
+  for ( int i=0; i<PER_NH; i++ ) { his_ram[i].nominal(); put_his(i); }
+  if ( dev ) dev->autostore();
+  for ( int k=0; k<PER_NF; k++ ) img.v[k] = fld[k].v->value();
+  memcpy(img.his, his_ram, sizeof(his_ram));
+  System.on_sync = [&]() { for ( int k=0; k<PER_NF; k++ ) img.v[k] = fld[k].v->value(); memcpy(img.his, his_ram, sizeof(his_ram)); };
+  if ( dev ) memset(dev->wear, 0, sizeof(dev->wear));
+  System.n_sync = 0;
+
+  PersistSched ps;
+  ps.whole_block(sync);
+  ps.add("qm", fld[0].v, PS_TOL_DQ, PS_T_STALE_DQ);
+  ps.add("qs", fld[1].v, PS_TOL_DQ, PS_T_STALE_DQ);
+  ps.add("tm", fld[2].v, PS_TOL_T, PS_T_STALE_T);
+  ps.add("ts", fld[3].v, PS_TOL_T, PS_T_STALE_T);
+  ps.add("UT", fld[4].v, PS_TOL_UT, PS_T_STALE_UT);
+  int8_t k_his = ps.add_rec("his", put_his, PS_T_STALE_REC);
+
+  // Cuts, in frames
+  long n_frames = long(days*86400./PER_FRAME);
+  long per_pass = long(PER_PASS/PER_FRAME + 0.5);
+  std::vector<long> cuts;
+  for ( long c=0; c<n_cuts; c++ ) cuts.push_back(per_pass + long(uni(rng)*(n_frames-per_pass)));
+  std::sort(cuts.begin(), cuts.end());
+  size_t ic = 0;
+
+  // Run
+  double ib = 0., t_seg = 0., t_his_next = t_his, t_sync = 0.;
+  double his_t[PER_NH];
+  for ( int i=0; i<PER_NH; i++ ) his_t[i] = -1.;
+  int i_his = 0;
+  uint8_t blink = 0;
+  long his_late = 0, his_n = 0;
+  uint32_t pass_bytes_max = 0;
+  uint64_t bytes_last = 0;
+  for ( long fr=0; fr<n_frames; fr++ )
+  {
+    double t = fr*PER_FRAME;
+    if ( t>=t_seg )
+    {
+      ib = ib_max*(2.*uni(rng) - 1.);
+      t_seg = t - 300.*log(max(uni(rng), 1e-9));
+    }
+    double i_now = ib + 0.5*gauss(rng);
+    dq_z = max(min(dq_z + i_now*PER_FRAME, 0.), -PER_CAP);
+    dqm_z = max(min(dqm_z + 1.01*i_now*PER_FRAME, 0.), -PER_CAP);
+    ts_z = 25. + 8.*sin(2.*PI*t/86400.) + 0.05*gauss(rng);
+    tsm_z = 25. + 8.*sin(2.*PI*t/86400.);
+    for ( int k=0; k<PER_NF; k++ ) fld[k].ring[fr%PER_RING] = fld[k].v->value();
+
+    // Cut inside this pass's writes
+    bool pass = ( fr%per_pass==0 );
+    bool cut_here = ( ic<cuts.size() && cuts[ic]==fr );
+    bool cut_in = cut_here && pass && dev && uni(rng)<in_write;
+    if ( cut_in ) dev->cut_after(long(uni(rng)*64.));
+
+    if ( pass )
+    {
+      ut_z = 1700000000UL + (unsigned long)t;
+      for ( int k=0; k<PER_NF; k++ ) fld[k].ring[fr%PER_RING] = fld[k].v->value();
+      if ( t>=t_his_next )
+      {
+        t_his_next += t_his;
+        i_his = (i_his + 1) % PER_NH;
+        his_ram[i_his].t_flt = ut_z;
+        his_ram[i_his].soc = int16_t(10000.*(1. + dq_z/PER_CAP));
+        his_ram[i_his].Tb = int16_t(ts_z*600.);
+        his_t[i_his] = t;
+        if ( rr ) { if ( !sync ) put_his(i_his); }
+        else ps.mark_rec(k_his, i_his, t);
+      }
+      if ( !rr ) ps.update(t);
+      else if ( !sync )
+      {
+        fld[blink].v->put();
+        blink = (blink + 1) % PER_NF;
+      }
+      if ( sync && t - t_sync >= PS_T_OS_SYNC ) { System.backupRamSync(); t_sync = t; }
+      if ( dev )
+      {
+        uint64_t b = 0;
+        for ( int a=0; a<0x0800; a++ ) b += dev->wear[a];
+        pass_bytes_max = max(pass_bytes_max, uint32_t(b - bytes_last));
+        bytes_last = b;
+      }
+    }
+
+    // What the store keeps
+    while ( ic<cuts.size() && cuts[ic]==fr )
+    {
+      ic++;
+      if ( dev && !cut_in ) dev->autostore();
+      if ( dev && dev->cut_pending() ) dev->autostore();
+      cut_in = false;
+      for ( int k=0; k<PER_NF; k++ )
+      {
+        Fld *f = &fld[k];
+        double s = stored(f, k, dev, &img);
+        f->n++;
+        f->err_max = max(f->err_max, fabs(s - f->v->value()));
+        long j = fr;
+        while ( j>=0 && j>fr-PER_RING && f->ring[j%PER_RING]!=s ) j--;
+        if ( j<0 || j<=fr-PER_RING ) { f->torn++; continue; }
+        float age = ( j==fr ) ? 0. : float(t - (j+1)*PER_FRAME);
+        f->age.push_back(age);
+        if ( age>f->t_stale + 2.*PER_PASS ) f->late++;
+      }
+      for ( int i=0; i<PER_NH; i++ )
+      {
+        if ( his_t[i]<0. || t - his_t[i] <= PS_T_STALE_REC + 2.*PER_PASS ) continue;
+        uint8_t pk[FLT_PK_BYTES], st[FLT_PK_BYTES];
+        flt_pack(his_ram[i], pk);
+        if ( !dev ) flt_pack(img.his[i], st);
+        const uint8_t *m = dev ? dev->image() + his_addr + i*FLT_PK_BYTES : st;
+        his_n++;
+        if ( memcmp(m, pk, FLT_PK_BYTES) ) his_late++;
+      }
+    }
+  }
+
+  // Report
+  printf("soc_persist:  %s, %s, %.1f days, %ld cuts (%.0f%% inside writes), ib +/-%.0f A, seed %u\n",
+    sync ? "Photon 2 backup RAM" : "47L16 EERAM", rr ? "old round-robin" : "PersistSched", days, n_cuts,
+    ( sync ? 0. : in_write*100. ), ib_max, seed);
+  printf(" field  bound s  stale p50    p99    max  late  torn   max |err|\n");
+  int fail = 0;
+  for ( int k=0; k<PER_NF; k++ )
+  {
+    Fld *f = &fld[k];
+    float mx = 0.;
+    for ( size_t i=0; i<f->age.size(); i++ ) mx = max(mx, f->age[i]);
+    printf(" %-4s  %7.1f  %9.1f %6.1f %6.1f %5ld %5ld %11.3g\n", f->v->code(), f->t_stale + 2.*PER_PASS,
+      quantile(&f->age, 0.5), quantile(&f->age, 0.99), mx, f->late, f->torn, f->err_max);
+    fail += f->late;
+  }
+  printf(" his   %7.1f  %ld of %ld stored records checked missing\n", PS_T_STALE_REC + 2.*PER_PASS, his_late, his_n);
+  fail += his_late;
+  if ( dev )
+  {
+    uint64_t b = 0;
+    uint32_t cell_max = 0;
+    for ( int a=0; a<0x0800; a++ ) { b += dev->wear[a]; cell_max = max(cell_max, dev->wear[a]); }
+    printf(" wear:  %.0f bytes/day, busiest cell %.0f writes/day, most in one pass %u bytes\n", double(b)/days,
+      double(cell_max)/days, pass_bytes_max);
+    for ( int k=0; k<PER_NF; k++ )
+    {
+      uint64_t w = 0;
+      for ( int a=fld[k].addr; a<fld[k].addr+fld[k].size; a++ ) w += dev->wear[a];
+      printf("   %-4s %8.0f writes/day\n", fld[k].v->code(), double(w)/fld[k].size/days);
+    }
+  }
+  else
+    printf(" wear:  %.0f block saves/day\n", double(System.n_sync)/days);
+  if ( !rr ) { printf("\n"); ps.pretty_print(); }
+  printf("soc_persist:  %s\n", fail ? "FAIL" : "pass");
+  return fail ? 1 : 0;
+}
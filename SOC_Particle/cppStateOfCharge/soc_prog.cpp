@@ -0,0 +1,224 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Host harness for the test programs of src/talk/program.h.   Not part of the Particle build.   Runs the whole
+// firmware, setup() and loop() of SOC_Particle.ino over every src translation unit, on the SOFT_VIRTUAL_TIME
+// Clock a millisecond per pass.   Each program is typed at Serial ('Xp<name>;') once the one before has finished,
+// and what Serial prints meanwhile is its capture.   With --golden each capture is compared with
+// <dir>/Xp<name>.txt, and --update writes them.   Same firmware and script give the same capture to the byte, so
+// any difference is a change in behavior.   Nothing is attached:  the programs run on the models ('Xm').   '--port'
+// makes Serial and Serial1 take only so many bytes a ms, as a slow terminal or the HC-06 would, so the print router
+// queues and drops (its counts are printed at the end).
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "application.h"
+#include "Clock.h"
+#include "command.h"
+#include "PrintRouter.h"
+#include "talk/program.h"
+
+#define PROG_TIME_START 1691689394  // Unix time at boot, s (1691689394, same as soc_gen)
+#define PROG_PORT_CAP   64          // Most a port takes at once under --port, bytes (64)
+#define PROG_DRAIN_MS   2000ULL     // Longest a capture waits for the print queues to empty once idle, ms (2000)
+
+extern CommandPars cp;              // Talk queues, SOC_Particle.ino
+extern ProgramRunner myProg;        // Test programs, SOC_Particle.ino
+extern PrintRouter rt;              // Serial and Serial1 print router, SOC_Particle.ino
+void loop();
+void serialEvent();
+void setup();
+
+// The ap and sp constructors print before main.   Keep stdout for captures and --dump
+static struct SerialToStderr { SerialToStderr() { Serial.out(stderr); } } serial_to_stderr __attribute__((init_priority(102)));
+
+// Firmware passes, one per virtual ms, with the serial port read between as Device OS does
+static void run_ms(const unsigned long long ms)
+{
+  for ( unsigned long long i=0; i<ms; i++ )
+  {
+    loop();
+    serialEvent();
+    Clock::step(1ULL);
+  }
+}
+
+// Talk queues empty and no program running
+static bool idle()
+{
+  return !myProg.active() && !cp.inp_str.length() && !cp.cmd_str.length() && !cp.ctl_str.length()
+    && !cp.asap_str.length() && !cp.soon_str.length() && !cp.queue_str.length() && !cp.last_str.length() && !cp.freeze;
+}
+
+static bool read_file(const char *name, std::string *s)
+{
+  FILE *fp = fopen(name, "rb");
+  if ( !fp ) return false;
+  char buf[4096];
+  size_t n;
+  s->clear();
+  while ( (n = fread(buf, 1, sizeof(buf), fp)) > 0 ) s->append(buf, n);
+  fclose(fp);
+  return true;
+}
+
+// First line that differs, 0 if none
+static int first_diff(const std::string &a, const std::string &b, std::string *la, std::string *lb)
+{
+  size_t i = 0, j = 0;
+  int line = 1;
+  while ( i<a.size() || j<b.size() )
+  {
+    size_t ie = a.find('\n', i), je = b.find('\n', j);
+    if ( ie==std::string::npos ) ie = a.size();
+    if ( je==std::string::npos ) je = b.size();
+    *la = a.substr(i, ie-i);
+    *lb = b.substr(j, je-j);
+    if ( *la!=*lb ) return line;
+    i = ie + 1; j = je + 1;
+    line++;
+  }
+  return 0;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_prog [--script file] [--golden dir [--update]] [--max_s s] [--boot_s s] [--log]\n"
+                  "                [--port bytes_per_ms] [name ...]\n"
+                  "        soc_prog --dump          # the built-in script, to start a new one\n");
+}
+
+int main(int argc, char **argv)
+{
+  const char *script_name = NULL;
+  const char *golden = NULL;
+  bool update = false;
+  bool log = false;
+  double max_s = 3600.;
+  double boot_s = 30.;
+  double port = 0.;
+  std::vector<std::string> names;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--script")==0 && more ) script_name = argv[++i];
+    else if ( strcmp(argv[i], "--golden")==0 && more ) golden = argv[++i];
+    else if ( strcmp(argv[i], "--update")==0 ) update = true;
+    else if ( strcmp(argv[i], "--max_s")==0 && more ) max_s = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--boot_s")==0 && more ) boot_s = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--log")==0 ) log = true;
+    else if ( strcmp(argv[i], "--port")==0 && more ) port = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--dump")==0 ) { fputs(PROGRAMS_DEFAULT, stdout); return 0; }
+    else if ( argv[i][0]=='-' ) { usage(); return 2; }
+    else names.push_back(argv[i]);
+  }
+  if ( update && !golden ) { usage(); return 2; }
+
+  // Boot.   Only the script check and the captures are of interest
+  Clock::start(0ULL, PROG_TIME_START);
+  if ( port>0. )
+  {
+    Serial.limit(PROG_PORT_CAP, port, []() { return Clock::millis(); }, [](const unsigned long ms) { Clock::delay(ms); });
+    Serial1.limit(PROG_PORT_CAP, port, []() { return Clock::millis(); }, [](const unsigned long ms) { Clock::delay(ms); });
+  }
+  Serial.out(log ? stderr : NULL);
+  setup();
+  if ( script_name )
+  {
+    std::string script;
+    if ( !read_file(script_name, &script) ) { fprintf(stderr, "cannot read %s\n", script_name); return 1; }
+    Serial.out(stderr);
+    if ( !myProg.load(script.c_str()) ) { fprintf(stderr, "bad script %s\n", script_name); return 1; }
+    Serial.out(log ? stderr : NULL);
+  }
+  if ( names.empty() ) for ( uint8_t i=0; i<myProg.n(); i++ ) names.push_back(myProg.name(i).c_str());
+  run_ms((unsigned long long)(boot_s*1000.));
+
+  // Back to back
+  int differ = 0, fail = 0;
+  for ( size_t k=0; k<names.size(); k++ )
+  {
+    char *buf = NULL;
+    size_t len = 0;
+    FILE *cap = open_memstream(&buf, &len);
+    Serial.out(cap);
+    unsigned long long t0 = Clock::millis();
+    auto w0 = std::chrono::steady_clock::now();
+    std::string cmd = "Xp" + names[k] + ";";
+    Serial.feed(cmd.c_str());
+    run_ms(1ULL);
+    while ( !idle() && Clock::millis()-t0 < (unsigned long long)(max_s*1000.) ) run_ms(100ULL);
+    bool timed_out = !idle();
+    for ( unsigned long long td=Clock::millis(); rt.room(ROUTE_ALL)<PRINT_QUEUE-PRINT_RESERVE && Clock::millis()-td<PROG_DRAIN_MS; )
+      run_ms(1ULL);   // what is still queued belongs to this capture
+    double virt = double(Clock::millis() - t0)/1000.;
+    double wall = std::chrono::duration<double>(std::chrono::steady_clock::now() - w0).count();
+    Serial.out(log ? stderr : NULL);
+    fclose(cap);
+    std::string got(buf, len);
+    free(buf);
+
+    const char *verdict = "";
+    if ( timed_out ) { verdict = "  TIMEOUT"; fail++; }
+    if ( golden )
+    {
+      std::string gname = std::string(golden) + "/Xp" + names[k] + ".txt";
+      std::string want;
+      if ( update )
+      {
+        FILE *fp = fopen(gname.c_str(), "wb");
+        if ( !fp || fwrite(got.data(), 1, got.size(), fp)!=got.size() ) { fprintf(stderr, "cannot write %s\n", gname.c_str()); return 1; }
+        fclose(fp);
+        verdict = timed_out ? "  TIMEOUT, written" : "  written";
+      }
+      else if ( !read_file(gname.c_str(), &want) ) { verdict = "  NO GOLDEN"; differ++; }
+      else
+      {
+        std::string la, lb;
+        int line = first_diff(got, want, &la, &lb);
+        if ( line )
+        {
+          fprintf(stderr, "Xp%s differs from %s at line %d:\n  got  %s\n  want %s\n", names[k].c_str(), gname.c_str(), line,
+            la.c_str(), lb.c_str());
+          verdict = "  DIFFERS";
+          differ++;
+        }
+        else if ( !timed_out ) verdict = "  matches";
+      }
+    }
+    else if ( !golden )
+    {
+      fwrite(got.data(), 1, got.size(), stdout);
+    }
+    fprintf(stderr, "soc_prog:  Xp%-8s %9.1f s in %6.2f s wall, %6.0fx%s\n", names[k].c_str(), virt, wall, virt/max(wall, 1e-6),
+      verdict);
+  }
+  if ( port>0. )
+  {
+    Serial.out(stderr);
+    rt.pretty_print();
+  }
+  fprintf(stderr, "soc_prog:  %d programs, %d differ, %d timed out\n", int(names.size()), differ, fail);
+  return ( differ || fail ) ? 1 : 0;
+}
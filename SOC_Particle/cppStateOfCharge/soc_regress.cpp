@@ -0,0 +1,365 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Golden-capture regression and timing baseline for the analysis host.  Not part of the Particle build.
+// Replays the sensed inputs of a captured run (the '_sel' stream of 'soc_log ingest', debug 'v4' or 'v2') through
+// today's Sensors selection, Fault::select_all_logic, BatteryMonitor::calculate and count_coulombs, initializing with
+// initialize_all / BatteryMonitor::solve_ekf as a cold boot does.   soc, soc_ekf and voc_stat are compared with the
+// '_mon' stream and fltw, falw with '_sel' and every call is timed.   A baseline file holds the accuracy bands and
+// the timing budgets;  the run fails if accuracy drifts past its band, or with '--time' if a call is past its
+// budget.   Times are kept relative to a reference kernel timed in the same frames, so a budget holds on another
+// host or a busy one.   Built like soc_prog, on the whole firmware.
+// Captures hold converted values, so the ADC and 1-wire reads are not replayed;  the bare-bus bits of fltw, 'Xm',
+// the current sensor choice and fake faults are taken from the capture as it goes.
+
+#include <algorithm>
+#include <chrono>
+#include <string>
+#include <vector>
+#include "application.h"
+#include "Clock.h"
+#include "LogStore.h"
+#include "Sync.h"
+#include "subs.h"
+
+#define REGRESS_SOLVE_N   200   // Extra solve_ekf calls timed after the replay (200)
+#define REGRESS_PASSES    20    // Replays of the capture;  timing is the best of them (20)
+#define REGRESS_SLACK     1.5   // Default allowance on the timing budgets, x (1.5)
+#define REGRESS_MARGIN    2.0   // --update writes accuracy bands this much past what was measured, x (2.0)
+#define REGRESS_FLOOR     1e-4  // --update floor on an accuracy band, so a perfect replay is not a zero band (1e-4)
+#define REGRESS_REF_N     16    // Steps of the reference kernel, about the cost of a frame (16)
+
+extern Pins *myPins;              // Pin map, built by setup() in SOC_Particle.ino
+void setup();
+
+// The ap and sp constructors print before main
+static struct SerialToStderr { SerialToStderr() { Serial.out(stderr); } } serial_to_stderr __attribute__((init_priority(102)));
+
+// Per call timing
+struct Timing
+{
+  const char *name;             // Baseline key
+  std::vector<double> ns;       // Every call of this pass, ns
+  double best;                  // Least median of the passes so far, ns
+  double best_p99;              // 99th percentile of that pass, ns
+  void keep_best() { double m = median(); if ( best==0. || m<best ) { best = m; best_p99 = pct(0.99); } };
+  double median() { return pct(0.5); };
+  double pct(const double p)
+  {
+    if ( ns.empty() ) return 0.;
+    std::vector<double> s(ns);
+    size_t k = min(size_t(p*double(s.size())), s.size()-1);
+    std::nth_element(s.begin(), s.begin()+k, s.end());
+    return s[k];
+  }
+};
+
+static double ns_since(const std::chrono::steady_clock::time_point &t0)
+{
+  return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - t0).count();
+}
+
+// Reference kernel:  fixed double arithmetic and libm, the mix of the Monitor, that no firmware change moves.
+// Timed each frame next to the firmware calls so the budgets are in its units, not a host's ns
+static volatile double ref_sink;
+static void ref_kernel(const double x0)
+{
+  double x = x0, y = 0.;
+  for ( int k=0; k<REGRESS_REF_N; k++ )
+  {
+    x = x*0.999 + 0.01*exp(-fabs(x));
+    y += x / (1. + y*y);
+  }
+  ref_sink = y;
+}
+
+// Column or NULL.   Older captures lack some of the newer '_sel' fields
+static const float *col(LogStore &st, const char *name, const bool required, bool *ok)
+{
+  const float *c = st.find(name)>=0 ? st.column(name) : NULL;
+  if ( !c && required ) { fprintf(stderr, "soc_regress:  no column '%s'\n", name); *ok = false; }
+  return c;
+}
+
+// Baseline:  'name value' per line, '#' comments.   Accuracy bands are max abs error (count of rows for the bitwords),
+// timing budgets are the least median time per call over the passes in reference kernels ('rel_*')
+static bool read_base(const char *path, std::vector<std::string> *names, std::vector<double> *vals)
+{
+  FILE *fp = fopen(path, "r");
+  if ( !fp ) return false;
+  char line[256], name[64];
+  double v;
+  while ( fgets(line, sizeof(line), fp) )
+  {
+    if ( line[0]=='#' ) continue;
+    if ( sscanf(line, "%63s %lf", name, &v)==2 ) { names->push_back(name); vals->push_back(v); }
+  }
+  fclose(fp);
+  return true;
+}
+
+static bool base_value(const std::vector<std::string> &names, const std::vector<double> &vals, const char *name, double *v)
+{
+  for ( size_t i=0; i<names.size(); i++ ) if ( names[i]==name ) { *v = vals[i]; return true; }
+  return false;
+}
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_regress <store_base> --base file [--update] [--time] [--slack x] [--passes n]\n"
+                  "        <store_base>_mon.soc and _sel.soc from 'soc_log ingest <capture.csv> <store_base>'\n");
+}
+
+int main(int argc, char **argv)
+{
+  const char *store_base = NULL;
+  const char *base = NULL;
+  bool update = false;
+  bool check_time = false;
+  double slack = REGRESS_SLACK;
+  int passes = REGRESS_PASSES;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--base")==0 && more ) base = argv[++i];
+    else if ( strcmp(argv[i], "--update")==0 ) update = true;
+    else if ( strcmp(argv[i], "--slack")==0 && more ) slack = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--passes")==0 && more ) { passes = atoi(argv[++i]); passes = max(passes, 1); }
+    else if ( strcmp(argv[i], "--time")==0 ) check_time = true;
+    else if ( argv[i][0]=='-' || store_base ) { usage(); return 2; }
+    else store_base = argv[i];
+  }
+  if ( !store_base || !base ) { usage(); return 2; }
+
+  LogStore mon, sel;
+  std::string mon_name = std::string(store_base) + "_mon.soc";
+  std::string sel_name = std::string(store_base) + "_sel.soc";
+  if ( !mon.open(mon_name.c_str()) ) { fprintf(stderr, "soc_regress:  cannot open %s\n", mon_name.c_str()); return 1; }
+  if ( !sel.open(sel_name.c_str()) ) { fprintf(stderr, "soc_regress:  cannot open %s\n", sel_name.c_str()); return 1; }
+  bool ok = true;
+  const float *m_dt = col(mon, "dt", true, &ok);
+  const float *m_mod = col(mon, "mod", true, &ok);
+  const float *m_soc = col(mon, "soc", true, &ok);
+  const float *m_soc_ekf = col(mon, "soc_ekf", true, &ok);
+  const float *m_voc_stat = col(mon, "voc_stat", true, &ok);
+  const float *s_ibmh = col(sel, "ibmh", true, &ok);
+  const float *s_ibnh = col(sel, "ibnh", true, &ok);
+  const float *s_ibmm = col(sel, "ibmm", true, &ok);
+  const float *s_ibnm = col(sel, "ibnm", true, &ok);
+  const float *s_ibm = col(sel, "ibm", true, &ok);
+  const float *s_vb_h = col(sel, "vb_h", true, &ok);
+  const float *s_vb_s = col(sel, "vb_s", true, &ok);
+  const float *s_Tb_h = col(sel, "Tb_h", true, &ok);
+  const float *s_Tb_s = col(sel, "Tb_s", true, &ok);
+  const float *s_ib_sel = col(sel, "ib_sel_stat", true, &ok);
+  const float *s_fltw = col(sel, "fltw", true, &ok);
+  const float *s_falw = col(sel, "falw", true, &ok);
+  const float *s_user_sel = col(sel, "user_sel", true, &ok);
+  const float *s_vc_h = col(sel, "vc_h", false, &ok);
+  const float *s_ff = col(sel, "ff", false, &ok);
+  if ( !ok ) return 1;
+
+  // Boot the firmware for its globals and pin map, quietly
+  Clock::start(0ULL, (unsigned long)mon.time()[0]);
+  Serial.out(NULL);
+  setup();
+  unsigned long long start = Clock::millis();
+  Sync *Talk = new Sync(TALK_DELAY);
+  Sync *ReadSensors = new Sync(READ_DELAY);
+  Sync *Summarize = new Sync(SUMMARY_DELAY);
+
+  // Replay, one '_sel' row per ReadSensors frame, lined up with the '_mon' row of the same time.   Accuracy is
+  // from the first pass.   The timing of each call is the least median of all passes, which shrugs off a busy host
+  Timing t_select = {"ns_select", {}, 0., 0.}, t_calculate = {"ns_calculate", {}, 0., 0.},
+    t_coulombs = {"ns_coulombs", {}, 0., 0.}, t_solve_ekf = {"ns_solve_ekf", {}, 0., 0.}, t_frame = {"ns_frame", {}, 0., 0.},
+    t_ref = {"ns_ref", {}, 0., 0.};
+  Timing *tim[] = {&t_select, &t_calculate, &t_coulombs, &t_solve_ekf, &t_frame};
+  const char *rel[] = {"rel_select", "rel_calculate", "rel_coulombs", "rel_solve_ekf", "rel_frame"};
+  const int n_tim = sizeof(tim)/sizeof(tim[0]);
+  double e_soc = 0., e_soc_ekf = 0., e_voc_stat = 0.;
+  double t_e_soc = 0., t_e_soc_ekf = 0., t_e_voc_stat = 0.;
+  uint64_t n_fltw = 0, n_falw = 0, n = 0;
+  const double *mt = mon.time();
+  const double *st = sel.time();
+  double t0 = st[0];
+  for ( int pass=0; pass<passes; pass++ )
+  {
+    // The objects loop() builds, new for each pass and never freed, as in loop()
+    sp.put_modeling(uint8_t(m_mod[0]));
+    BatteryMonitor *Mon = new BatteryMonitor();
+    Sensors *Sen = new Sensors(EKF_NOM_DT, 0, myPins, ReadSensors, Talk, Summarize, 0UL, start, Mon);
+    TFDelayT<double> Is_sat_delay(false, T_SAT, T_DESAT, EKF_NOM_DT);
+    for ( int k=0; k<n_tim; k++ ) tim[k]->ns.clear();
+    t_ref.ns.clear();
+    uint64_t j = 0;
+    bool reset = true;
+    for ( uint64_t i=0; i<sel.rows(); i++ )
+    {
+      while ( j<mon.rows() && mt[j] < st[i] - 0.0005 ) j++;
+      if ( j>=mon.rows() ) break;
+      if ( fabs(mt[j] - st[i]) > 0.0005 ) continue;   // No matching '_mon' row
+
+      // Settings and inputs as sensed, hardware and model.   Captures print unit values
+      if ( uint8_t(m_mod[j])!=sp.modeling() ) sp.put_modeling(uint8_t(m_mod[j]));
+      if ( int8_t(s_user_sel[i])!=sp.ib_force() ) sp.put_ib_force(int8_t(s_user_sel[i]));
+      if ( s_ff ) ap.fake_faults = s_ff[i]!=0.;
+      Sen->now = (unsigned long long)((st[i] - t0)*1000. + 0.5);
+      Sen->T = Sen->T_filt = max(double(m_dt[j]), 0.);
+      Sen->Ib_amp_hdwe = s_ibmh[i] * sp.nP();
+      Sen->Ib_noa_hdwe = s_ibnh[i] * sp.nP();
+      Sen->Ib_amp_model = s_ibmm[i] * sp.nP();
+      Sen->Ib_noa_model = s_ibnm[i] * sp.nP();
+      Sen->Ib_model = Sen->Ib_model_in = s_ibm[i] * sp.nP();
+      Sen->Vb_hdwe = Sen->Vb_hdwe_f = s_vb_h[i] * sp.nS();
+      Sen->Vb_model = s_vb_s[i] * sp.nS();
+      Sen->Tb_hdwe = Sen->Tb_hdwe_filt = s_Tb_h[i];
+      Sen->Tb_model = Sen->Tb_model_filt = s_Tb_s[i];
+      if ( s_vc_h ) Sen->Vc_hdwe = s_vc_h[i];
+      Sen->ShuntAmp->bare_shunt(bitRead(uint32_t(s_fltw[i]), IB_AMP_BARE));
+      Sen->ShuntNoAmp->bare_shunt(bitRead(uint32_t(s_fltw[i]), IB_NOA_BARE));
+
+      // Cold boot:  initialize_all runs solve_ekf
+      auto w_frame = std::chrono::steady_clock::now();
+      if ( reset )
+      {
+        auto w = std::chrono::steady_clock::now();
+        initialize_all(Mon, Sen, 0., false);
+        t_solve_ekf.ns.push_back(ns_since(w));
+
+        // A capture that starts after boot starts with the current selection latched
+        if ( int8_t(s_ib_sel[i])!=IB_SEL_STAT_DEF )
+        {
+          Sen->Flt->ib_sel_stat(int8_t(s_ib_sel[i]));
+          Sen->Flt->latched_fail(true);
+        }
+      }
+
+      // ReadSensors:  fault checks and selection as in sense_synth_select
+      auto w = std::chrono::steady_clock::now();
+      if ( s_vc_h ) Sen->Flt->vc_check(Sen, Mon, VC_MIN, VC_MAX, reset);
+      if ( !sp.mod_vb_dscn() ) Sen->Flt->vb_check(Sen, Mon, VB_MIN, VB_MAX, reset);
+      else                     Sen->Flt->vb_check(Sen, Mon, -1.0, 1.0, reset);
+      Sen->Flt->ib_range(reset, Sen, Mon);
+      Sen->Flt->ib_logic(reset, Sen, Mon);
+      Sen->Flt->ib_wrap(reset, Sen, Mon);
+      Sen->Flt->ib_quiet(reset, Sen);
+      Sen->Flt->cc_diff(reset, Sen, Mon);
+      Sen->Flt->ib_diff(reset, Sen, Mon);
+      Sen->Flt->select_all_logic(Sen, Mon, reset);
+      Sen->select_all_hdwe_or_model(Mon);
+      t_select.ns.push_back(ns_since(w));
+
+      // monitor():  EKF and Coulomb counter
+      w = std::chrono::steady_clock::now();
+      Mon->calculate(Sen, reset);
+      t_calculate.ns.push_back(ns_since(w));
+      w = std::chrono::steady_clock::now();
+      Sen->saturated = Is_sat_delay.calculate(Mon->is_sat(reset), T_SAT*ap.s_t_sat, T_DESAT*ap.s_t_sat,
+        min(Sen->T, T_SAT/2.), reset);
+      Mon->count_coulombs(Sen->T, reset, Sen->Tb_filt, Mon->ib_charge(), Sen->saturated, Mon->delta_q_ekf());
+      t_coulombs.ns.push_back(ns_since(w));
+      t_frame.ns.push_back(ns_since(w_frame));
+      reset = false;
+      w = std::chrono::steady_clock::now();
+      ref_kernel(Mon->soc());
+      t_ref.ns.push_back(ns_since(w));
+
+      // Compare
+      if ( pass ) continue;
+      double d;
+      if ( (d = fabs(Mon->soc() - m_soc[j])) > e_soc ) { e_soc = d; t_e_soc = st[i] - t0; }
+      if ( (d = fabs(Mon->soc_ekf() - m_soc_ekf[j])) > e_soc_ekf ) { e_soc_ekf = d; t_e_soc_ekf = st[i] - t0; }
+      if ( (d = fabs(Mon->voc_stat() - m_voc_stat[j])) > e_voc_stat ) { e_voc_stat = d; t_e_voc_stat = st[i] - t0; }
+      if ( Sen->Flt->fltw()!=uint32_t(s_fltw[i]) ) n_fltw++;
+      if ( Sen->Flt->falw()!=uint32_t(s_falw[i]) ) n_falw++;
+      n++;
+    }
+    if ( !n ) { fprintf(stderr, "soc_regress:  no '_sel' rows line up with '_mon' rows\n"); return 1; }
+
+    // Steady-state solver, alone
+    for ( int k=0; k<REGRESS_SOLVE_N; k++ )
+    {
+      auto w = std::chrono::steady_clock::now();
+      Mon->solve_ekf(true, true, Sen);
+      t_solve_ekf.ns.push_back(ns_since(w));
+    }
+    for ( int k=0; k<n_tim; k++ ) tim[k]->keep_best();
+    t_ref.keep_best();
+  }
+  double ref = max(t_ref.best, 1.);
+
+  // Against the baseline
+  struct { const char *name; double got; double at; } acc[] = {
+    {"soc", e_soc, t_e_soc}, {"soc_ekf", e_soc_ekf, t_e_soc_ekf}, {"voc_stat", e_voc_stat, t_e_voc_stat},
+    {"fltw", double(n_fltw), -1.}, {"falw", double(n_falw), -1.} };
+  const int n_acc = sizeof(acc)/sizeof(acc[0]);
+  Serial.out(stdout);
+  printf("soc_regress:  %s, %llu frames, %.1f s, reference kernel %.0f ns\n", store_base, (unsigned long long)n,
+    st[sel.rows()-1] - t0, ref);
+
+  if ( update )
+  {
+    FILE *fp = fopen(base, "w");
+    if ( !fp ) { fprintf(stderr, "soc_regress:  cannot write %s\n", base); return 1; }
+    const char *slash = strrchr(store_base, '/');
+    fprintf(fp, "# soc_regress baseline for %s, written by --update\n", slash ? slash+1 : store_base);
+    fprintf(fp, "# accuracy:  max abs error vs capture (soc, soc_ekf fraction; voc_stat V; fltw, falw rows differing)\n");
+    for ( int k=0; k<n_acc; k++ )
+    {
+      double band = k<3 ? max(acc[k].got*REGRESS_MARGIN, REGRESS_FLOOR) : acc[k].got;
+      fprintf(fp, "%-14s %.6g\n", acc[k].name, band);
+    }
+    fprintf(fp, "# timing:  least median time per call of the passes, in reference kernels.   Checked with --time\n");
+    for ( int k=0; k<n_tim; k++ ) fprintf(fp, "%-14s %.3g\n", rel[k], tim[k]->best/ref);
+    fclose(fp);
+  }
+
+  std::vector<std::string> names;
+  std::vector<double> vals;
+  if ( !read_base(base, &names, &vals) ) { fprintf(stderr, "soc_regress:  cannot read %s\n", base); return 1; }
+  int drift = 0;
+  for ( int k=0; k<n_acc; k++ )
+  {
+    double band = 0.;
+    bool have = base_value(names, vals, acc[k].name, &band);
+    bool bad = !have || acc[k].got > band;
+    if ( acc[k].at>=0. )
+      printf("  %-14s %10.6f  band %10.6f  worst at %8.1f s%s\n", acc[k].name, acc[k].got, band, acc[k].at,
+        !have ? "  NO BAND" : ( bad ? "  DRIFT" : "" ));
+    else
+      printf("  %-14s %10.0f  band %10.0f  rows%s\n", acc[k].name, acc[k].got, band, !have ? "  NO BAND" : ( bad ? "  DRIFT" : "" ));
+    if ( bad ) drift++;
+  }
+  for ( int k=0; k<n_tim; k++ )
+  {
+    double budget = 0.;
+    bool have = base_value(names, vals, rel[k], &budget);
+    bool bad = check_time && ( !have || tim[k]->best/ref > budget*slack );
+    printf("  %-14s %6.0f ns %6.2f ref  budget %6.2f x%.2f   p99 %6.0f ns  n %6zu%s\n", tim[k]->name, tim[k]->best,
+      tim[k]->best/ref, budget, slack, tim[k]->best_p99, tim[k]->ns.size(),
+      !have ? "  NO BUDGET" : ( bad ? "  SLOW" : "" ));
+    if ( bad ) drift++;
+  }
+  printf("soc_regress:  %s\n", drift ? "FAIL" : "pass");
+  return drift ? 1 : 0;
+}
@@ -0,0 +1,143 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Replay of recorded runs through the firmware's capacity (state of health) estimator.   Not part of the
+// Particle build.   Each LogStore '_mon' file (soc_log ingest, or soc_gen --bin) is counted by the Monitor's own
+// Coulombs and fed to CapacityEst the way monitor() in subs.cpp does:  saturation edges from 'sat' and quiet
+// EKF converged windows from 'soc_ekf', converged when |y_ekf| has stayed under EKF_CONV for EKF_T_CONV.
+// soc_gen files carry no EKF; '--ref soc' uses the Sim soc as an always converged reference.   '--ib_scale'
+// multiplies the counted current, which looks like a bank of that capacity ratio, so the estimate should
+// settle there.   Files run in the order given with the estimate carried across; a gap drops the anchor.
+
+#include <string>
+#include <vector>
+#include "LogStore.h"
+#include "SocHost.h"
+#include "Battery.h"
+#include "CapacityEst.h"
+#include "myLibrary/myFilters.h"
+
+#define SOH_GAP         60.       // Time step treated as a break in the record, s
+
+struct Opts
+{
+  const char *ib_name;          // Current column counted
+  const char *ref_name;         // Reference soc column, "soc_ekf" or "soc"
+  double np;                    // Parallel units, divides ib
+  double ib_scale;              // Multiplies counted ib
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_soh [--ib name] [--ref soc_ekf|soc] [--np n] [--ib_scale s] [--out file] run_mon.soc [...]\n");
+}
+
+// One file through Coulombs and CapacityEst.   Returns observations taken
+static int replay(const char *path, const Opts &o, BatteryMonitor *Mon, FILE *out)
+{
+  LogStore ls;
+  if ( !ls.open(path) ) { fprintf(stderr, "cannot open %s\n", path); return -1; }
+  const float *tb = ls.column("Tb");
+  const float *ib = ls.column(o.ib_name);
+  const float *sat = ls.column("sat");
+  const float *ref = ls.column(o.ref_name);
+  const float *y_ekf = ls.column("y_ekf");
+  bool always_conv = strcmp(o.ref_name, "soc_ekf")!=0;
+  if ( !tb || !ib || !sat || !ref || (!always_conv && !y_ekf) )
+  {
+    fprintf(stderr, "%s:  need Tb, %s, sat, %s%s columns\n", path, o.ib_name, o.ref_name, always_conv ? "" : " and y_ekf");
+    return -1;
+  }
+  const double *t = ls.time();
+  uint64_t n = ls.rows();
+  TFDelay Conv(false, EKF_T_CONV, EKF_T_RESET, EKF_NOM_DT);
+  CapacityEst *Cap = Mon->cap_est();
+  int obs = 0;
+  for ( uint64_t i=0; i<n; i++ )
+  {
+    double dt = i ? t[i] - t[i-1] : 0.;
+    boolean reset = i==0 || dt<=0. || dt>SOH_GAP;
+    if ( reset ) Mon->apply_delta_q_t(Mon->delta_q(), tb[i]);
+    float ib_count = ib[i] / o.np * o.ib_scale;
+    boolean saturated = sat[i] > 0.5;
+    Mon->count_coulombs(reset ? 0. : dt, reset, tb[i], ib_count, saturated, 0.);
+    boolean conv = always_conv || Conv.calculate(abs(y_ekf[i])<EKF_CONV, EKF_T_CONV, EKF_T_RESET,
+      reset ? EKF_NOM_DT : min(dt, EKF_T_RESET), reset);
+    float q_rated = Mon->q_capacity()*Mon->q_cap_rated()/Mon->q_cap_rated_scaled();
+    if ( Cap->update(t[i], Mon->delta_q_inf(), q_rated, saturated, conv, ref[i], ib[i]/o.np, reset) )
+    {
+      obs++;
+      if ( out ) fprintf(out, "%13.3f,%7.4f,%7.4f,%7.4f,%7.4f,%7.4f,%d,\n", t[i], Cap->theta(), Cap->sd(), Cap->lo(),
+        Cap->hi(), ref[i], Cap->n());
+      fprintf(stderr, "%s  %13.3f  n %4d  theta %6.4f  2sig %6.4f - %6.4f\n", path, t[i], Cap->n(), Cap->theta(),
+        Cap->lo(), Cap->hi());
+    }
+  }
+  return obs;
+}
+
+int main(int argc, char **argv)
+{
+  Opts o = {"ib", "soc_ekf", 1., 1.};
+  const char *out_name = NULL;
+  std::vector<const char *> files;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--ib")==0 && more ) o.ib_name = argv[++i];
+    else if ( strcmp(argv[i], "--ref")==0 && more ) o.ref_name = argv[++i];
+    else if ( strcmp(argv[i], "--np")==0 && more ) o.np = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--ib_scale")==0 && more ) o.ib_scale = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--out")==0 && more ) out_name = argv[++i];
+    else if ( argv[i][0]=='-' ) { usage(); return 2; }
+    else files.push_back(argv[i]);
+  }
+  if ( files.empty() || o.np<=0. || o.ib_scale<=0. ) { usage(); return 2; }
+
+  // Model prints go to stderr so stdout is only the summary
+  Serial.out(stderr);
+  soc_host_setup(0, time(NULL));
+  BatteryMonitor Mon;
+  Mon.cap_est()->reset();
+  FILE *out = NULL;
+  if ( out_name )
+  {
+    out = fopen(out_name, "w");
+    if ( !out ) { fprintf(stderr, "cannot open %s\n", out_name); return 1; }
+    fprintf(out, "t,theta,sd,lo,hi,soc_ref,n,\n");
+  }
+
+  int obs = 0;
+  for ( size_t f=0; f<files.size(); f++ )
+  {
+    int k = replay(files[f], o, &Mon, out);
+    if ( k<0 ) return 1;
+    obs += k;
+  }
+  if ( out ) fclose(out);
+  CapacityEst *Cap = Mon.cap_est();
+  printf("soc_soh:  CHEM %d, %zu files, %d observations\n", CHEM, files.size(), obs);
+  printf("capacity ratio %6.4f  sd %6.4f  2sig %6.4f - %6.4f  (%.1f of %.1f A-h rated)\n", Cap->theta(), Cap->sd(),
+    Cap->lo(), Cap->hi(), Cap->theta()*Mon.q_cap_rated()/3600., Mon.q_cap_rated()/3600.);
+  return 0;
+}
@@ -0,0 +1,386 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Mismatched parallel strings, each a BatterySim of its own chemistry, capacity and start soc, through the
+// firmware's StringBank.   Not part of the Particle build.   Each ReadSensors frame the bank current '--profile'
+// asks for is split between the strings that conduct by KCL on their voc and r_ss of the frame before (one
+// terminal voltage), and each model counts what it took.   Two banks watch:  one with a shunt channel per string
+// and one with none, where each string gets its capacity share of the bank current, as on the unit.   Once a
+// string's monitor has seen saturation its soc is held to the model's, and once all have, the bank soc,
+// imbalance and weakest string are too.   Then the cost of one StringMon::calculate is timed against today's
+// Monitor, BatteryMonitor::calculate, is_sat, Is_sat_delay and count_coulombs, on the same frames.
+// Built like soc_regress, on the whole firmware.
+
+#include <chrono>
+#include <string>
+#include <vector>
+#include "application.h"
+#include "Clock.h"
+#include "subs.h"
+#include "StringBank.h"
+
+#define STR_MODELING    7         // sp.modeling():  Sim is the source of tb, vb and ib (7)
+#define STR_TOL         0.03      // Default allowance on soc, imbalance twice it, fraction (0.03)
+#define STR_SHARE_X     3.        // Allowance on bank soc without shunts, x STR_TOL (3.)
+#define STR_AH_TIE      2.        // Weakest not scored while the two lowest are this close, A-h (2.)
+#define STR_WEAK_MIN    0.95      // Fraction of scored frames the weakest must agree (0.95)
+#define STR_PASSES      20        // Timing passes, best of (20)
+#define STR_SLACK       1.0       // Per-string cost allowed, x the Monitor's (1.0)
+
+extern Pins *myPins;              // Pin map, built by setup() in SOC_Particle.ino
+void setup();
+
+// The ap and sp constructors print before main
+static struct SerialToStderr { SerialToStderr() { Serial.out(stderr); } } serial_to_stderr __attribute__((init_priority(102)));
+
+// Bank current, a step of the profile
+struct Segment
+{
+  double dur_s;         // Length, s
+  float ib;             // Bank current, A
+};
+
+// Charge to saturation, discharge deep, charge again
+static const Segment profile_default[] =
+{
+  {21600.,  40.},
+  { 1800.,   0.},
+  {21600., -30.},
+  { 1800.,   0.},
+  {10800.,  40.},
+};
+
+// A string and its model
+struct Str
+{
+  uint8_t mod;          // Chemistry
+  float s_cap;          // Capacity scale
+  float soc0;           // Start soc
+  double delta_q;       // Model charge memory, C
+  float t_last;         // Model Tb memory, deg C
+  BatterySim *sim;
+};
+
+// A bank watching and its scores
+struct Watch
+{
+  const char *name;
+  StringBank *bank;
+  bool seen[SB_NS];     // Monitor has been saturated
+  double t_seen[SB_NS]; // First saturation, s
+  double e_soc[SB_NS];  // Max abs soc error once seen
+  double e_bank;        // Max abs bank soc error once all seen
+  double e_imb;         // Max abs imbalance error once all seen
+  uint64_t n_weak;      // Frames the weakest was scored
+  uint64_t n_agree;     // Of them, agreeing
+};
+
+// One frame of string 0, for timing
+struct Frame
+{
+  float ib;
+  float vb;
+  float tb;
+  bool reset;
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_strings [--string mod,s_cap,soc0]... [--profile file] [--tb C] [--tol frac] [--hys slr] [--no_time]\n");
+  fprintf(stderr, "   profile lines:  dur_s ib_A\n");
+}
+
+static bool load_profile(const char *name, std::vector<Segment> *prof)
+{
+  FILE *fp = fopen(name, "r");
+  if ( !fp ) return false;
+  char line[256];
+  while ( fgets(line, sizeof(line), fp) )
+  {
+    char *hash = strchr(line, '#');
+    if ( hash ) *hash = '\0';
+    Segment s = {0., 0.};
+    int n = sscanf(line, "%lf %f", &s.dur_s, &s.ib);
+    if ( n<=0 ) continue;
+    if ( n<2 || s.dur_s<=0. )
+    {
+      fprintf(stderr, "%s:  need dur_s>0 ib_A:  %s", name, line);
+      fclose(fp);
+      return false;
+    }
+    prof->push_back(s);
+  }
+  fclose(fp);
+  return !prof->empty();
+}
+
+// A-h above soc_min
+static double ah_left(Coulombs *c)
+{
+  return ( (c->soc() - c->soc_min()) * c->q_capacity() / 3600. );
+}
+
+// Score one bank against the models
+static void score(Watch *w, const std::vector<Str> &str, const double t)
+{
+  StringBank *b = w->bank;
+  uint8_t n = b->n();
+  bool all = true;
+  for ( uint8_t k=0; k<n; k++ )
+  {
+    if ( !w->seen[k] && b->mon(k)->saturated() ) { w->seen[k] = true;  w->t_seen[k] = t; }
+    if ( w->seen[k] ) w->e_soc[k] = max(w->e_soc[k], fabs(b->mon(k)->soc() - str[k].sim->soc()));
+    else all = false;
+  }
+  if ( !all ) return;
+
+  // Truth of the bank
+  double q = 0., q_cap = 0.;
+  float soc_hi = -1e6, soc_lo = 1e6;
+  int weak = 0;
+  double ah_weak = 1e9, ah_next = 1e9;
+  for ( uint8_t k=0; k<n; k++ )
+  {
+    BatterySim *s = str[k].sim;
+    q += s->soc() * s->q_capacity();
+    q_cap += s->q_capacity();
+    soc_hi = max(soc_hi, s->soc());
+    soc_lo = min(soc_lo, s->soc());
+    double ah = ah_left(s);
+    if ( ah<ah_weak ) { ah_next = ah_weak;  ah_weak = ah;  weak = k; }
+    else if ( ah<ah_next ) ah_next = ah;
+  }
+  w->e_bank = max(w->e_bank, fabs(b->soc() - q/q_cap));
+  w->e_imb = max(w->e_imb, fabs(b->imbalance() - (soc_hi - soc_lo)));
+  if ( n>1 && ah_next - ah_weak > STR_AH_TIE )
+  {
+    w->n_weak++;
+    if ( b->weakest()==weak ) w->n_agree++;
+  }
+}
+
+// Least time per frame of the passes, ns
+template <class F> static double time_per_frame(const std::vector<Frame> &fr, F run)
+{
+  double best = 1e30;
+  for ( int pass=0; pass<STR_PASSES; pass++ )
+  {
+    auto w = std::chrono::steady_clock::now();
+    run();
+    double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - w).count();
+    best = min(best, ns / double(fr.size()));
+  }
+  return ( best );
+}
+
+int main(int argc, char **argv)
+{
+  std::vector<Str> str;
+  std::vector<Segment> prof;
+  float tb = 25.;
+  float hys = 0.;
+  double tol = STR_TOL;
+  bool no_time = false;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--string")==0 && more )
+    {
+      Str s = {0, 1., 1., 0., 0., NULL};
+      int mod;
+      if ( sscanf(argv[++i], "%d,%f,%f", &mod, &s.s_cap, &s.soc0)!=3 || mod<0 || s.s_cap<=0. ) { usage(); return 2; }
+      s.mod = uint8_t(mod);
+      str.push_back(s);
+    }
+    else if ( strcmp(argv[i], "--profile")==0 && more )
+    {
+      if ( !load_profile(argv[++i], &prof) ) { fprintf(stderr, "soc_strings:  cannot read %s\n", argv[i]); return 2; }
+    }
+    else if ( strcmp(argv[i], "--tb")==0 && more ) tb = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--tol")==0 && more ) tol = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--hys")==0 && more ) hys = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--no_time")==0 ) no_time = true;
+    else { usage(); return 2; }
+  }
+  if ( str.empty() )
+  {
+    str.push_back({0, 1.00, 0.60, 0., 0., NULL});
+    str.push_back({0, 0.75, 0.80, 0., 0., NULL});
+    str.push_back({1, 0.90, 0.70, 0., 0., NULL});
+  }
+  if ( str.size()>SB_NS ) { fprintf(stderr, "soc_strings:  at most %d strings (SB_NS)\n", SB_NS); return 2; }
+  if ( prof.empty() ) prof.assign(profile_default, profile_default + sizeof(profile_default)/sizeof(Segment));
+
+  // Boot the firmware for its globals and pin map, quietly
+  Clock::start(0ULL, 1700000000UL);
+  Serial.out(NULL);
+  setup();
+  sp.put_modeling(STR_MODELING);
+  ap.hys_scale = hys;
+  double dt = READ_DELAY / 1000.;
+  uint8_t n = uint8_t(str.size());
+
+  // Models and the two banks
+  SbString cfg_ch[SB_NS], cfg_sh[SB_NS];
+  for ( uint8_t k=0; k<n; k++ )
+  {
+    Str &s = str[k];
+    s.t_last = tb;
+    s.sim = new BatterySim(&s.delta_q, &s.t_last);
+    if ( s.mod!=s.sim->mod_code() )
+    {
+      s.sim->chem()->assign_mod(s.mod);
+      s.sim->coul_eff(s.sim->chem()->coul_eff * COULOMBIC_EFF_SCALE);
+    }
+    s.sim->apply_cap_scale(s.s_cap);
+    s.sim->apply_soc(s.soc0, tb);
+    s.sim->init_battery_sim(true, 0., s.sim->voc_soc_tab(s.soc0, tb));
+    cfg_ch[k] = {s.mod, s.s_cap, k};
+    cfg_sh[k] = {s.mod, s.s_cap, SB_CH_SHARE};
+  }
+  Watch w_ch = {"shunts", new StringBank(cfg_ch, n), {}, {}, {}, 0., 0., 0, 0};
+  Watch w_sh = {"shares", new StringBank(cfg_sh, n), {}, {}, {}, 0., 0., 0, 0};
+  Watch *watch[2] = {&w_ch, &w_sh};
+
+  // Run
+  std::vector<Frame> frames;
+  float ib_k[SB_NS];
+  double t = 0.;
+  bool reset = true;
+  for ( size_t p=0; p<prof.size(); p++ )
+  {
+    uint64_t steps = uint64_t(prof[p].dur_s / dt + 0.5);
+    for ( uint64_t i=0; i<steps; i++ )
+    {
+      // KCL:  one terminal voltage, strings the BMS has off take no discharge
+      float ib = prof[p].ib;
+      double g_sum = 0., gv_sum = 0., v_sum = 0.;
+      for ( uint8_t k=0; k<n; k++ )
+      {
+        BatterySim *s = str[k].sim;
+        v_sum += s->voc();
+        if ( s->bms_off() && ib<=0. ) continue;
+        double g = 1. / (s->chem()->r_ss * ap.slr_res);
+        g_sum += g;
+        gv_sum += g * s->voc();
+      }
+      float vb = ( g_sum>0. ) ? (ib + gv_sum) / g_sum : v_sum / n;
+      float ib_bank = 0.;
+      for ( uint8_t k=0; k<n; k++ )
+      {
+        BatterySim *s = str[k].sim;
+        float ib_in = ( s->bms_off() && ib<=0. ) ? 0. : (vb - s->voc()) / (s->chem()->r_ss * ap.slr_res);
+        s->calculate(tb, ib_in, dt, false, reset);
+        if ( reset ) s->calculate(tb, ib_in, dt, false, reset);  // Again because sat is a UBC
+        s->count_coulombs(dt, tb, Clock::millis(), reset, NULL, reset);
+        ib_k[k] = s->ib_charge();
+        ib_bank += ib_k[k];
+      }
+
+      // Monitors, started at the bank soc as monitor() starts them at the Monitor's
+      if ( reset )
+      {
+        double q = 0., q_cap = 0.;
+        for ( uint8_t k=0; k<n; k++ ) { q += str[k].sim->soc()*str[k].sim->q_capacity();  q_cap += str[k].sim->q_capacity(); }
+        w_ch.bank->init_soc(q/q_cap, tb);
+        w_sh.bank->init_soc(q/q_cap, tb);
+      }
+      w_ch.bank->update(ib_k, ib_bank, vb, tb, dt, reset);
+      w_sh.bank->update(NULL, ib_bank, vb, tb, dt, reset);
+      frames.push_back({ib_k[0], vb, tb, reset});
+      if ( !reset ) for ( int b=0; b<2; b++ ) score(watch[b], str, t);
+      reset = false;
+      t += dt;
+    }
+  }
+
+  // Report
+  int bad = 0;
+  printf("soc_strings:  %d strings, %.1f h, Tb %.1f C\n", n, t/3600., tb);
+  printf("   k mod s_cap soc0   soc_end\n");
+  for ( uint8_t k=0; k<n; k++ )
+    printf("  %2d %3d %5.2f %5.2f %8.4f\n", k, str[k].mod, str[k].s_cap, str[k].soc0, str[k].sim->soc());
+  for ( int b=0; b<2; b++ )
+  {
+    Watch *w = watch[b];
+    bool strict = w==&w_ch;   // With a shunt each, every string is held to its model
+    printf(" %s:  bank soc err %.4f, imbalance err %.4f, weakest %.1f%% of %lu frames\n", w->name, w->e_bank, w->e_imb,
+      w->n_weak ? 100.*w->n_agree/w->n_weak : 0., (unsigned long)w->n_weak);
+    for ( uint8_t k=0; k<n; k++ )
+    {
+      if ( !w->seen[k] ) { printf("   string %d never saturated\n", k);  bad++;  continue; }
+      printf("   string %d saturated at %6.0f s, soc err %.4f%s\n", k, w->t_seen[k], w->e_soc[k],
+        strict && w->e_soc[k]>tol ? " (!)" : "");
+      if ( strict && w->e_soc[k]>tol ) bad++;
+    }
+    if ( w->e_bank>(strict ? tol : STR_SHARE_X*tol) ) { printf("   bank soc off by %.4f\n", w->e_bank);  bad++; }
+    if ( strict && w->e_imb>2.*tol ) { printf("   imbalance off by %.4f\n", w->e_imb);  bad++; }
+    if ( strict && n>1 && (w->n_weak==0 || w->n_agree < STR_WEAK_MIN*w->n_weak) )
+    {
+      printf("   weakest right %lu of %lu frames\n", (unsigned long)w->n_agree, (unsigned long)w->n_weak);
+      bad++;
+    }
+  }
+  if ( !no_time )
+  {
+    // Same frames, string 0's, through one StringMon and through the Monitor
+    double dq = 0.;
+    float tl = tb;
+    StringMon *mon = new StringMon(cfg_ch[0], &dq, &tl);
+    double ns_str = time_per_frame(frames, [&]()
+    {
+      for ( size_t i=0; i<frames.size(); i++ )
+      {
+        const Frame &f = frames[i];
+        if ( f.reset ) mon->init_soc(str[0].soc0, f.tb);
+        mon->calculate(f.ib, f.vb, f.tb, dt, f.reset);
+      }
+    });
+    Sync *Talk = new Sync(TALK_DELAY);
+    Sync *ReadSensors = new Sync(READ_DELAY);
+    Sync *Summarize = new Sync(SUMMARY_DELAY);
+    BatteryMonitor *Mon = new BatteryMonitor();
+    Sensors *Sen = new Sensors(EKF_NOM_DT, 0, myPins, ReadSensors, Talk, Summarize, 0UL, Clock::millis(), Mon);
+    TFDelayT<double> Is_sat_delay(false, T_SAT, T_DESAT, EKF_NOM_DT);
+    double ns_mon = time_per_frame(frames, [&]()
+    {
+      for ( size_t i=0; i<frames.size(); i++ )
+      {
+        const Frame &f = frames[i];
+        Sen->Tb_filt = f.tb;
+        Sen->T = dt;
+        Sen->Vb = f.vb * sp.nS();
+        Sen->Ib = f.ib * sp.nP();
+        if ( f.reset ) Mon->apply_soc(str[0].soc0, f.tb);
+        Mon->calculate(Sen, f.reset);
+        boolean sat = Mon->is_sat(f.reset);
+        Sen->saturated = Is_sat_delay.calculate(sat, T_SAT*ap.s_t_sat, T_DESAT*ap.s_t_sat, min(Sen->T, T_SAT/2.), f.reset);
+        Mon->count_coulombs(Sen->T, f.reset, Sen->Tb_filt, Mon->ib_charge(), Sen->saturated, Mon->delta_q_ekf());
+      }
+    });
+    printf(" cost:  StringMon %.0f ns, Monitor %.0f ns per frame, %.2fx\n", ns_str, ns_mon, ns_str/ns_mon);
+    if ( ns_str > STR_SLACK*ns_mon ) { printf("   a string costs more than the Monitor\n");  bad++; }
+  }
+  printf("soc_strings:  %s\n", bad ? "FAIL" : "pass");
+  return ( bad ? 1 : 0 );
+}
@@ -0,0 +1,320 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Scan time and fault isolation of the DS18B20 array, TempArray, on simulated DS2482-100 bridges.   Not part of the
+// Particle build.   '--bridges' bridges (0x18 up) carry '--probes' DS18B20s each, spread '--spread' about a bank
+// temperature that swings slowly; loop() runs every '--pass' ms on the I2C bus simulator's clock.   Four phases of
+// '--phase' s:  healthy; one probe off the bus, one browning out (85 C), one reading '--dev' high and one with two
+// bad CRCs every scan (the library's retries should hide it); then the last bridge's line shorted as well; then
+// every fault cleared.   Each phase must end with exactly the injected probes failed, for the right reason, the
+// other bridges still scanning, and tb within '--tol' of the mean of the healthy probes.   The old way,
+// MyDs2482_Class::check (search then DS2482GetTemperatureForListCommand), runs first on the same probes for the
+// scan time and bus time it costs.
+
+#include <random>
+#include <vector>
+#include "application.h"
+#include "I2cSim.h"
+#include "constants.h"
+#include "TempArray.h"
+
+#define TMP_SWING       2.        // Bank swing, deg C
+#define TMP_PERIOD      3600.     // Bank swing period, s
+
+// A probe and what the array should make of it
+struct Prb
+{
+  Ds18b20 *d;
+  uint8_t bridge;
+  float spread;         // Offset from the bank, deg C
+  uint8_t expect;       // TaFault expected, TA_OK healthy
+  bool crc;             // Two bad CRCs each conversion
+  uint32_t n_conv;      // Conversions at the last CRC arming
+};
+
+static std::vector<Ds2482 *> brg;
+static std::vector<Prb> prb;
+static double pass_ms = 1.;
+static double blk_us_max = 0.;    // Most bus time in one loop(), us
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_temp [--bridges n] [--probes n] [--pass ms] [--phase s] [--spread C] [--dev C] [--tol C] [--seed n]\n");
+}
+
+// Bank temperature, deg C
+static double bank(const double t_s)
+{
+  return 25. + TMP_SWING*sin(2.*PI*t_s/TMP_PERIOD);
+}
+
+// Probe temperatures now, and CRC faults re-armed each conversion
+static void probes_update()
+{
+  double t_s = double(System.millis())/1000.;
+  for ( size_t i=0; i<prb.size(); i++ )
+  {
+    Prb *p = &prb[i];
+    p->d->tc = float(bank(t_s) + p->spread);
+    if ( p->crc && p->d->n_conv!=p->n_conv ) { p->d->crc_err = 2;  p->n_conv = p->d->n_conv; }
+  }
+}
+
+// Run f every pass to t_end_ms, System time kept up with the bus
+static void run_to(const unsigned long long t_end_ms, std::function<void()> f)
+{
+  I2cBus *bus = Wire.bus();
+  while ( System.millis()<t_end_ms )
+  {
+    System.advance((uint64_t)pass_ms);
+    bus->idle_until(double(System.millis())*1000.);
+    probes_update();
+    double t0 = bus->now_us();
+    f();
+    blk_us_max = max(blk_us_max, bus->now_us() - t0);
+    double ahead = bus->now_us()/1000. - double(System.millis());
+    if ( ahead>0. ) System.advance((uint64_t)ceil(ahead));
+  }
+}
+
+// Bus time of the bridges so far, us
+static double bus_us()
+{
+  double us = 0.;
+  for ( size_t b=0; b<brg.size(); b++ ) us += brg[b]->busy_us_tot;
+  return us;
+}
+
+// Mean of the healthy probes now, deg C
+static double truth()
+{
+  double t_s = double(System.millis())/1000.;
+  double sum = 0.;
+  int n = 0;
+  for ( size_t i=0; i<prb.size(); i++ ) if ( prb[i].expect==TA_OK ) { sum += bank(t_s) + prb[i].spread;  n++; }
+  return n ? sum/n : 0.;
+}
+
+// Array against the expectation at the end of a phase.   Returns faults found
+static int check(TempArray *ta, const char *name, const std::vector<uint32_t> &scans, const double tol)
+{
+  static const char *why[] = {"ok", "read", "85C", "range", "dev", "lost"};
+  int bad = 0;
+  int n_fail = 0;
+  for ( size_t i=0; i<prb.size(); i++ )
+  {
+    TaProbe *p = NULL;
+    for ( uint8_t k=0; k<ta->n_probe(); k++ )
+    {
+      bool same = ta->probe(k)->bridge==prb[i].bridge;
+      for ( int j=0; j<8; j++ ) if ( ta->probe(k)->addr[j]!=prb[i].d->rom[j] ) same = false;
+      if ( same ) p = ta->probe(k);
+    }
+    if ( !p ) { printf("   probe %zu never enumerated\n", i);  bad++;  continue; }
+    uint8_t got = p->fail ? p->why : TA_OK;
+    if ( p->fail ) n_fail++;
+    if ( got!=prb[i].expect )
+    {
+      printf("   probe %zu bridge %d:  %s, expected %s\n", i, prb[i].bridge, why[got], why[prb[i].expect]);
+      bad++;
+    }
+  }
+  for ( uint8_t b=0; b<ta->n_bridge(); b++ )
+  {
+    bool dead = true;
+    for ( size_t i=0; i<prb.size(); i++ ) if ( prb[i].bridge==b && prb[i].expect==TA_OK ) dead = false;
+    if ( !dead && scans[b]<2 ) { printf("   bridge %d:  %u scans in the phase\n", b, scans[b]);  bad++; }
+  }
+  double err = ta->tb() - truth();
+  if ( fabs(err)>tol ) { printf("   tb %.3f off the healthy mean by %.3f\n", ta->tb(), err);  bad++; }
+  printf(" %-8s %2d of %2d failed, tb %7.3f err %+6.3f, %s\n", name, n_fail, int(prb.size()), ta->tb(), err,
+    bad ? "FAIL" : "ok");
+  return bad;
+}
+
+int main(int argc, char **argv)
+{
+  int nb = 2;
+  int npb = 8;
+  double t_phase = 60.;
+  double spread = 1.;
+  double dev = 20.;
+  double tol = 0.1;
+  unsigned seed = 1;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--bridges")==0 && more ) nb = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--probes")==0 && more ) npb = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--pass")==0 && more ) pass_ms = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--phase")==0 && more ) t_phase = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--spread")==0 && more ) spread = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--dev")==0 && more ) dev = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--tol")==0 && more ) tol = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--seed")==0 && more ) seed = atoi(argv[++i]);
+    else { usage(); return 2; }
+  }
+  if ( nb<1 || nb>TA_NB || npb<1 || npb>TA_NP_BRIDGE || nb*npb>TA_NP || pass_ms<1. || t_phase<=0. )
+  {
+    usage();
+    return 2;
+  }
+  int n_all = nb*npb;
+  if ( n_all<8 ) fprintf(stderr, "soc_temp:  %d probes, the deviation check needs 4 or more healthy ones\n", n_all);
+
+  // Bridges and probes
+  std::mt19937 rng(seed);
+  std::uniform_real_distribution<double> uni(-1., 1.);
+  I2cBus *bus = Wire.bus();
+  for ( int b=0; b<nb; b++ )
+  {
+    Ds2482 *d = new Ds2482(0x18 + b);
+    if ( bus->attach(d) ) { fprintf(stderr, "soc_temp:  bridge 0x%02x refused\n", 0x18 + b);  return 2; }
+    brg.push_back(d);
+  }
+  for ( int b=0; b<nb; b++ ) for ( int i=0; i<npb; i++ )
+  {
+    Prb p;
+    p.d = new Ds18b20(((uint64_t)rng() << 16) ^ rng());
+    p.bridge = b;
+    p.spread = float(spread*uni(rng));
+    p.expect = TA_OK;
+    p.crc = false;
+    p.n_conv = 0;
+    brg[b]->attach(p.d);
+    prb.push_back(p);
+  }
+
+  // The old way on the same probes:  search, convert and read each READ_TEMP_DELAY, each bridge on its own
+  double t_old = t_phase;
+  std::vector<DS2482 *> old;
+  std::vector<DS2482DeviceListStatic<TA_NP_BRIDGE> > old_list(nb);
+  std::vector<unsigned long long> old_t(nb, 0ULL);
+  std::vector<bool> old_busy(nb, false);
+  std::vector<uint32_t> old_n(nb, 0);
+  double old_ms_max = 0.;
+  for ( int b=0; b<nb; b++ )
+  {
+    old.push_back(new DS2482(Wire, b));
+    old[b]->setup();
+    DS2482DeviceReset::run(*old[b], [](DS2482DeviceReset&, int) {});
+  }
+  double bus0 = bus_us();
+  unsigned long long t0 = System.millis();
+  run_to(t0 + (unsigned long long)(t_old*1000.), [&]()
+  {
+    for ( int b=0; b<nb; b++ )
+    {
+      old[b]->loop();
+      if ( old_busy[b] || ( old_n[b] && System.millis() - old_t[b] < READ_TEMP_DELAY ) ) continue;
+      old_busy[b] = true;
+      old_t[b] = System.millis();
+      DS2482SearchBusCommand::run(*old[b], old_list[b], [&, b](DS2482SearchBusCommand &obj, int status)
+      {
+        if ( status!=DS2482Command::RESULT_DONE ) { old_busy[b] = false;  return; }
+        DS2482GetTemperatureForListCommand::run(*old[b], obj.getDeviceList(), [&, b](DS2482GetTemperatureForListCommand&,
+          int, DS2482DeviceList&)
+        {
+          old_ms_max = max(old_ms_max, double(System.millis() - old_t[b]));
+          old_n[b]++;
+          old_busy[b] = false;
+        });
+      });
+    }
+  });
+  double old_bus_pct = (bus_us() - bus0)/(t_old*1e6)*100.;
+  double old_blk_us = blk_us_max;
+  uint32_t old_scans = 0;
+  for ( int b=0; b<nb; b++ ) old_scans += old_n[b];
+  while ( old_busy[0] ) run_to(System.millis() + 1, [&]() { for ( int b=0; b<nb; b++ ) old[b]->loop(); });
+
+  // TempArray through the phases
+  uint8_t addr[TA_NB];
+  for ( int b=0; b<nb; b++ ) addr[b] = b;
+  TempArray ta(addr, nb);
+  ta.setup();
+  blk_us_max = 0.;
+  bus0 = bus_us();
+  t0 = System.millis();
+  int fail = 0;
+  std::vector<uint32_t> scans(nb);
+  auto phase = [&](const char *name)
+  {
+    for ( int b=0; b<nb; b++ ) scans[b] = ta.bridge(b)->n_scan;
+    run_to(System.millis() + (unsigned long long)(t_phase*1000.), [&]() { ta.loop(); });
+    for ( int b=0; b<nb; b++ ) scans[b] = ta.bridge(b)->n_scan - scans[b];
+    fail += check(&ta, name, scans, tol);
+  };
+  printf("soc_temp:  %d bridges x %d probes, pass %.0f ms, phases %.0f s, seed %u\n", nb, npb, pass_ms, t_phase, seed);
+  phase("healthy");
+  double ta_bus_pct = (bus_us() - bus0)/(double(System.millis() - t0)*1000.)*100.;
+  uint32_t ta_scans = 0;
+  unsigned long ta_ms_max = 0UL;
+  for ( int b=0; b<nb; b++ ) { ta_scans += ta.bridge(b)->n_scan;  ta_ms_max = max(ta_ms_max, ta.bridge(b)->scan_ms_max); }
+  double ta_blk_us = blk_us_max;
+
+  // Probe faults, spread over the bridges
+  static const uint8_t inj[] = {TA_F_READ, TA_F_POR, TA_F_DEV, TA_OK};
+  for ( int j=0; j<4 && j+1<n_all; j++ )
+  {
+    Prb *p = &prb[((j + 1) % nb)*npb + (j + 1)/nb % npb];
+    p->expect = inj[j];
+    switch ( inj[j] )
+    {
+      case ( TA_F_READ ): p->d->absent = true;  break;
+      case ( TA_F_POR ):  p->d->por = true;  break;
+      case ( TA_F_DEV ):  p->d->offset = float(dev);  break;
+      default:            p->crc = true;  break;
+    }
+  }
+  phase("probes");
+
+  // Then the last bridge's line.   Its probes fail, the others keep scanning
+  if ( nb>1 )
+  {
+    brg[nb-1]->shorted = true;
+    for ( size_t i=0; i<prb.size(); i++ ) if ( prb[i].bridge==nb-1 ) prb[i].expect = TA_F_READ;
+    phase("short");
+  }
+
+  // All clear
+  brg[nb-1]->shorted = false;
+  for ( size_t i=0; i<prb.size(); i++ )
+  {
+    prb[i].d->absent = prb[i].d->por = false;
+    prb[i].d->offset = 0.;
+    prb[i].crc = false;
+    prb[i].expect = TA_OK;
+  }
+  phase("cleared");
+
+  // Scan time and bus cost against the old way
+  printf(" scan:   old %7.0f ms, %4u scans in %.0f s, bus %5.2f%%, most in one loop() %6.0f us\n", old_ms_max,
+    old_scans, t_old, old_bus_pct, old_blk_us);
+  printf("         new %7lu ms, %4u scans in %.0f s, bus %5.2f%%, most in one loop() %6.0f us\n", ta_ms_max,
+    ta_scans, t_phase, ta_bus_pct, ta_blk_us);
+  printf("\n");
+  ta.pretty_print();
+  printf("soc_temp:  %s\n", fail ? "FAIL" : "pass");
+  return fail ? 1 : 0;
+}
@@ -0,0 +1,80 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Check of the 2-wire thermistor table in Therm2Wire.h against the HDWE_*_2WIRE formula TempSensor::sample used to
+// evaluate at run time.   Not part of the Particle build.   Every oversampled count sum is converted both ways;
+// the error is reported over the hard fault range TB_MIN - TB_MAX and over the table clip range.   Both are timed.
+
+#include <chrono>
+#include "application.h"
+#include "Therm2Wire.h"
+
+// The run time formula as it was, single precision like the firmware
+static float formula_float(const float counts)
+{
+  float volt = counts*VTB_CONV_GAIN;
+  return float(HDWE_M_2WIRE) * log10f( volt * float(HDWE_RS_2WIRE) / (V3V3 - volt) ) + float(HDWE_B_2WIRE);
+}
+
+int main()
+{
+  const uint32_t nover = 1 << TB2W_OVER_BITS;
+  const uint32_t nsum = (PHOTON_ADC_COUNT - 1)*nover + 1;
+  double err_fault = 0., err_clip = 0., err_float = 0.;
+  uint32_t at_fault = 0, at_clip = 0;
+  float t_lo = 1e9, t_hi = -1e9;
+  for ( uint32_t s=0; s<nsum; s++ )
+  {
+    double counts = double(s) / double(nover);
+    if ( counts<=0. ) continue;
+    double t = tb2w_formula(counts);
+    double e = fabs(double(tb2w_lookup(s)) - t);
+    if ( t>=TB2W_T_MIN && t<=TB2W_T_MAX )
+    {
+      if ( e>err_clip ) { err_clip = e; at_clip = s; }
+      err_float = max(err_float, fabs(double(formula_float(float(counts))) - t));
+      t_lo = min(t_lo, float(t)); t_hi = max(t_hi, float(t));
+    }
+    if ( t>=TB_MIN && t<=TB_MAX && e>err_fault ) { err_fault = e; at_fault = s; }
+  }
+
+  // Cost per conversion
+  const int reps = 200;
+  volatile float sink = 0.;
+  auto t0 = std::chrono::steady_clock::now();
+  for ( int r=0; r<reps; r++ ) for ( uint32_t s=nover; s<nsum; s+=nover ) sink = sink + formula_float(float(s/nover));
+  auto t1 = std::chrono::steady_clock::now();
+  for ( int r=0; r<reps; r++ ) for ( uint32_t s=nover; s<nsum; s+=nover ) sink = sink + tb2w_lookup(s);
+  auto t2 = std::chrono::steady_clock::now();
+  double n = double(reps)*double(PHOTON_ADC_COUNT - 1);
+  double ns_formula = std::chrono::duration<double, std::nano>(t1 - t0).count() / n;
+  double ns_table = std::chrono::duration<double, std::nano>(t2 - t1).count() / n;
+
+  printf("soc_therm:  %d segments of %d counts, %u reads per sample, %zu bytes\n", TB2W_NSEG, 1 << TB2W_SEG_BITS, nover,
+    sizeof(tb2w_table));
+  printf("max error %6.4f dg C in %.0f - %.0f (sum %u),  %6.4f in %.1f - %.1f (sum %u)\n", err_fault, double(TB_MIN),
+    double(TB_MAX), at_fault, err_clip, t_lo, t_hi, at_clip);
+  printf("float formula itself %6.4f dg C\n", err_float);
+  printf("host ns per conversion:  formula %5.1f  table %5.1f\n", ns_formula, ns_table);
+  return 0;
+}
@@ -0,0 +1,245 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Benchmark of the Monitor's two soc estimators, EKF_1x1 and UKF_1x1, on recorded runs.   Not part of the Particle
+// build.   Each LogStore '_mon' file is decimated to the EKF frame (EKF_EFRAME_MULT reads) and both filters get
+// the same u = ib_charge (coul_eff on charge) and z = voc_stat, started '--soc0_err' off the reference 'soc'
+// column (soc_gen truth; vv1 captures carry the counted soc).   '--vnoise' adds Gaussian noise to z.   Accuracy is
+// split into the flat part of the curve ('--flat lo hi', default 0.3 - 0.9) and the knees.   Cost is timed in
+// separate passes over the frames, one filter at a time, in ns and, on x86, cycles per update.   The temperature
+// rate term of ddq_dt is left out; it is the same for both filters.
+
+#include <random>           // Ahead of application.h, whose min/max macros break it
+#include <chrono>
+#if defined(__x86_64__) || defined(__i386__)
+  #include <x86intrin.h>
+  #define UKF_TSC 1
+#endif
+#include <string>
+#include <vector>
+#include "LogStore.h"
+#include "SocHost.h"
+#include "Battery.h"
+
+#define UKF_GAP         60.       // Time step treated as a break in the record, s
+#define UKF_CONV_ERR    0.02      // Error counted as converged after a start or break, fraction (0.02)
+
+struct Frame
+{
+  float dt;     // Frame time, s
+  float tb;     // Battery temperature, deg C
+  float u;      // d(dq)/dt, A
+  float z;      // voc_stat, V
+  float soc;    // Reference soc, fraction
+  bool reset;   // Start or break, filters start over
+};
+
+struct Opts
+{
+  const char *ib_name;          // Charge current column
+  double np;                    // Parallel units, divides ib
+  double soc0_err;              // Start error, fraction
+  double vnoise;                // z noise sd, V
+  double flat_lo;               // Flat region low soc
+  double flat_hi;               // Flat region high soc
+  int reps;                     // Timing passes
+};
+
+// Access to the Monitor's filter hooks without its Sensors plumbing
+class Bench : public BatteryMonitor
+{
+public:
+  void ekf(const Frame &f) { dt_eframe_ = f.dt; temp_c_ = f.tb; predict_ekf(f.u); update_ekf(f.z, 0., 1.); };
+  double H_ekf() { return H_; };
+  void init(const float soc) { init_ekf(soc, 0.); init_ukf(soc, 0.); };
+  double P_ekf() { return P_; };
+  void ukf(const Frame &f) { dt_eframe_ = f.dt; temp_c_ = f.tb; predict_ukf(f.u); update_ukf(f.z, 0., 1.); };
+};
+
+// Error statistics for one filter in one region
+struct Stat
+{
+  double sum2;
+  double max_abs;
+  double n;
+  void add(const double e) { sum2 += e*e; max_abs = max(max_abs, fabs(e)); n += 1.; };
+  double rms() const { return n>0. ? sqrt(sum2/n) : 0.; };
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_ukf [--ib name] [--np n] [--soc0_err e] [--vnoise sd] [--flat lo hi] [--reps n]\n"
+                  "                [--seed n] [--out file] run_mon.soc [...]\n");
+}
+
+// Decimate one file to EKF frames
+static bool load(const char *path, const Opts &o, const double coul_eff, std::mt19937 *gen, std::vector<Frame> *frames)
+{
+  LogStore ls;
+  if ( !ls.open(path) ) { fprintf(stderr, "cannot open %s\n", path); return false; }
+  const float *tb = ls.column("Tb");
+  const float *ib = ls.column(o.ib_name);
+  const float *voc_stat = ls.column("voc_stat");
+  const float *soc = ls.column("soc");
+  if ( !tb || !ib || !voc_stat || !soc ) { fprintf(stderr, "%s:  need Tb, %s, voc_stat, soc columns\n", path, o.ib_name); return false; }
+  std::normal_distribution<float> noise(0., o.vnoise);
+  const double *t = ls.time();
+  uint64_t n = ls.rows();
+  double eframe = EKF_NOM_DT*EKF_EFRAME_MULT;
+  double t_last = 0.;
+  bool reset = true;
+  for ( uint64_t i=0; i<n; i++ )
+  {
+    if ( i && t[i] - t[i-1] > UKF_GAP ) reset = true;
+    if ( !reset && t[i] - t_last < eframe - 1e-6 ) continue;
+    Frame f;
+    f.dt = reset ? eframe : t[i] - t_last;
+    f.tb = tb[i];
+    f.u = ib[i] / o.np;
+    if ( f.u>0. ) f.u *= coul_eff;
+    f.z = voc_stat[i] + ( o.vnoise>0. ? noise(*gen) : 0. );
+    f.soc = soc[i];
+    f.reset = reset;
+    frames->push_back(f);
+    t_last = t[i];
+    reset = false;
+  }
+  return true;
+}
+
+// Time one filter over all frames, ns and cycles per update
+static void time_pass(Bench *B, const std::vector<Frame> &frames, const Opts &o, const bool ukf, double *ns, double *cyc)
+{
+  double ns_best = 1e30;
+  double cyc_best = 0.;
+  for ( int r=0; r<o.reps; r++ )
+  {
+    B->init(frames[0].soc);
+    auto t0 = std::chrono::steady_clock::now();
+#ifdef UKF_TSC
+    uint64_t c0 = __rdtsc();
+#endif
+    if ( ukf ) for ( size_t i=0; i<frames.size(); i++ ) B->ukf(frames[i]);
+    else for ( size_t i=0; i<frames.size(); i++ ) B->ekf(frames[i]);
+#ifdef UKF_TSC
+    uint64_t c1 = __rdtsc();
+#endif
+    auto t1 = std::chrono::steady_clock::now();
+    double ns_r = std::chrono::duration<double, std::nano>(t1 - t0).count() / double(frames.size());
+    if ( ns_r<ns_best )
+    {
+      ns_best = ns_r;
+#ifdef UKF_TSC
+      cyc_best = double(c1 - c0) / double(frames.size());
+#endif
+    }
+  }
+  *ns = ns_best;
+  *cyc = cyc_best;
+}
+
+int main(int argc, char **argv)
+{
+  Opts o = {"ib_charge", 1., -0.1, 0., 0.3, 0.9, 5};
+  unsigned seed = 1;
+  const char *out_name = NULL;
+  std::vector<const char *> files;
+  for ( int i=1; i<argc; i++ )
+  {
+    bool more = i+1<argc;
+    if ( strcmp(argv[i], "--ib")==0 && more ) o.ib_name = argv[++i];
+    else if ( strcmp(argv[i], "--np")==0 && more ) o.np = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--soc0_err")==0 && more ) o.soc0_err = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--vnoise")==0 && more ) o.vnoise = atof(argv[++i]);
+    else if ( strcmp(argv[i], "--flat")==0 && i+2<argc ) { o.flat_lo = atof(argv[++i]); o.flat_hi = atof(argv[++i]); }
+    else if ( strcmp(argv[i], "--reps")==0 && more ) o.reps = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--seed")==0 && more ) seed = atoi(argv[++i]);
+    else if ( strcmp(argv[i], "--out")==0 && more ) out_name = argv[++i];
+    else if ( argv[i][0]=='-' ) { usage(); return 2; }
+    else files.push_back(argv[i]);
+  }
+  if ( files.empty() || o.np<=0. || o.reps<1 ) { usage(); return 2; }
+
+  // Model prints go to stderr so stdout is only the summary
+  Serial.out(stderr);
+  soc_host_setup(0, time(NULL));
+  Bench B;
+  std::mt19937 gen(seed);
+  std::vector<Frame> frames;
+  for ( size_t f=0; f<files.size(); f++ )
+    if ( !load(files[f], o, B.coul_eff(), &gen, &frames) ) return 1;
+  if ( frames.empty() ) { fprintf(stderr, "no frames\n"); return 1; }
+
+  FILE *out = NULL;
+  if ( out_name )
+  {
+    out = fopen(out_name, "w");
+    if ( !out ) { fprintf(stderr, "cannot open %s\n", out_name); return 1; }
+    fprintf(out, "i,soc,z,x_ekf,x_ukf,P_ekf,P_ukf,H_ekf,H_ukf,\n");
+  }
+
+  // Accuracy, both filters on the same frames
+  Stat ekf_flat = {0., 0., 0.}, ukf_flat = {0., 0., 0.}, ekf_knee = {0., 0., 0.}, ukf_knee = {0., 0., 0.};
+  double ekf_conv = 0., ukf_conv = 0., t_since = 0.;
+  int ekf_nconv = 0, ukf_nconv = 0;
+  bool ekf_in = false, ukf_in = false;
+  int starts = 0;
+  for ( size_t i=0; i<frames.size(); i++ )
+  {
+    const Frame &f = frames[i];
+    if ( f.reset )
+    {
+      B.init(max(min(f.soc + o.soc0_err, 1.), 0.));
+      t_since = 0.;
+      ekf_in = ukf_in = false;
+      starts++;
+    }
+    B.ekf(f);
+    B.ukf(f);
+    t_since += f.dt;
+    double e_ekf = B.x_ekf() - f.soc;
+    double e_ukf = B.x_ukf() - f.soc;
+    if ( !ekf_in && fabs(e_ekf)<UKF_CONV_ERR ) { ekf_in = true; ekf_conv += t_since; ekf_nconv++; }
+    if ( !ukf_in && fabs(e_ukf)<UKF_CONV_ERR ) { ukf_in = true; ukf_conv += t_since; ukf_nconv++; }
+    if ( f.soc>=o.flat_lo && f.soc<=o.flat_hi ) { ekf_flat.add(e_ekf); ukf_flat.add(e_ukf); }
+    else { ekf_knee.add(e_ekf); ukf_knee.add(e_ukf); }
+    if ( out ) fprintf(out, "%zu,%7.4f,%7.4f,%7.4f,%7.4f,%10.3e,%10.3e,%7.3f,%7.3f,\n", i, f.soc, f.z, B.x_ekf(),
+      B.x_ukf(), B.P_ekf(), B.P_ukf(), B.H_ekf(), B.H_ukf());
+  }
+  if ( out ) fclose(out);
+
+  // Cost, one filter at a time
+  double ns_ekf, cyc_ekf, ns_ukf, cyc_ukf;
+  time_pass(&B, frames, o, false, &ns_ekf, &cyc_ekf);
+  time_pass(&B, frames, o, true, &ns_ukf, &cyc_ukf);
+
+  printf("soc_ukf:  CHEM %d, %zu files, %zu frames of %.1f s, %d starts at %+.3f soc, vnoise %.4f V\n", CHEM, files.size(),
+    frames.size(), EKF_NOM_DT*EKF_EFRAME_MULT, starts, o.soc0_err, o.vnoise);
+  printf("         flat %.2f-%.2f rms / max    knees rms / max    to %.2f, s (starts)   ns/update  cycles/update\n",
+    o.flat_lo, o.flat_hi, UKF_CONV_ERR);
+  printf("EKF_1x1  %7.4f / %7.4f       %7.4f / %7.4f    %9.0f (%d/%d)      %8.1f   %8.0f\n", ekf_flat.rms(),
+    ekf_flat.max_abs, ekf_knee.rms(), ekf_knee.max_abs, ekf_conv/max(ekf_nconv, 1), ekf_nconv, starts, ns_ekf, cyc_ekf);
+  printf("UKF_1x1  %7.4f / %7.4f       %7.4f / %7.4f    %9.0f (%d/%d)      %8.1f   %8.0f\n", ukf_flat.rms(),
+    ukf_flat.max_abs, ukf_knee.rms(), ukf_knee.max_abs, ukf_conv/max(ukf_nconv, 1), ukf_nconv, starts, ns_ukf, cyc_ukf);
+  return 0;
+}
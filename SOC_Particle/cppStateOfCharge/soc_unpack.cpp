@@ -0,0 +1,186 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+// Host decoder of the packed record dump, 'Hp'.   Not part of the Particle build.   Each 'pk' line of a capture is
+// unpacked (FltPack.h) and printed by Flt_st::print_flt at the scaling of the 'pk_hdr' line before it, so the CSV
+// is what 'Hd' prints for the same records, to the byte.   '--cmp' looks for each line among the unit_u, unit_h
+// and unit_f lines of the same capture ('Hd' and 'Hp' taken together), '--check n' round-trips n random records, in
+// and past the packed ranges, at both scalings, and prints what packing gains for the buffers of this build.
+
+#include <random>
+#include <string>
+#include <vector>
+#include "SocHost.h"
+#include "FltPack.h"
+#include "PrintRouter.h"
+
+#define UNP_ST_TARGET   48        // sizeof(Flt_st) on the Photon 2, 32 bit longs, B
+
+extern SavedPars sp;
+extern PrintRouter rt;
+
+// Sink keeping what print_flt prints
+class StrSink : public PrintSink
+{
+public:
+  StrSink() : PrintSink("str") {}
+  std::string s;
+protected:
+  size_t port_room() { return PRINT_QUEUE; }
+  size_t port_write(const char *buf, const size_t n) { s.append(buf, n); return n; }
+};
+
+static void usage()
+{
+  fprintf(stderr, "usage:  soc_unpack [--cmp] capture\n        soc_unpack --check n [--seed n]\n");
+}
+
+// Lines of s
+static std::vector<std::string> split(const std::string &s)
+{
+  std::vector<std::string> v;
+  size_t a = 0, b;
+  while ( (b = s.find('\n', a)) != std::string::npos ) { v.push_back(s.substr(a, b-a)); a = b + 1; }
+  return v;
+}
+
+// Random records past the packed ranges as often as inside them, checked field by field and as print_flt lines
+static int check(const long n, const unsigned seed, StrSink *sink)
+{
+  std::mt19937 rng(seed);
+  std::uniform_int_distribution<int> i16(-32768, 32767);
+  std::uniform_int_distribution<int> coin(0, 1);
+  long n_in = 0, n_clip = 0, bad = 0, bad_csv = 0;
+  for ( long k=0; k<n; k++ )
+  {
+    sp.put_amp( (k & 1) ? 0. : 100. );   // Nominal scaling and 'Xa' over 40 A
+    Flt_st r, u;
+    r.t_flt = 1700000000UL + rng() % 100000000UL;
+    r.Tb_hdwe = i16(rng);  r.ib_amp_hdwe = i16(rng);  r.ib_noa_hdwe = i16(rng);  r.Tb = i16(rng);  r.ib = i16(rng);
+    const boolean in = coin(rng);
+    std::uniform_int_distribution<int> vb(in ? FLT_PK_VB_FLOOR : -32768, in ? FLT_PK_VB_FLOOR+(1<<FLT_PK_VB_BITS)-1 : 32767);
+    std::uniform_int_distribution<int> soc(in ? FLT_PK_SOC_FLOOR : -32768, in ? FLT_PK_SOC_FLOOR+(1<<FLT_PK_SOC_BITS)-1 : 32767);
+    std::uniform_int_distribution<int> wr(in ? FLT_PK_WRAP_FLOOR : -32768, in ? FLT_PK_WRAP_FLOOR+(1<<FLT_PK_WRAP_BITS)-1 : 32767);
+    r.vb_hdwe = vb(rng);  r.vb = vb(rng);  r.voc = vb(rng);  r.voc_stat = vb(rng);
+    r.soc = soc(rng);  r.soc_min = soc(rng);  r.soc_ekf = soc(rng);
+    r.e_wrap_filt = wr(rng);  r.e_wrap_m_filt = wr(rng);  r.e_wrap_n_filt = wr(rng);
+    r.fltw = rng() & ( in ? (1UL<<NUM_FLT)-1 : 0xFFFFFFFFUL );
+    r.falw = rng() & ( in ? (1UL<<NUM_FA)-1 : 0xFFFFFFFFUL );
+    uint8_t buf[FLT_PK_BYTES];
+    uint8_t c = flt_pack(r, buf);
+    flt_unpack(buf, u);
+    if ( !in ) { n_clip += ( c>0 ); continue; }
+    n_in++;
+    if ( c || memcmp(&r, &u, offsetof(Flt_st, dummy)) ) bad++;
+    sink->s.clear();
+    r.print_flt("unit_h");
+    std::string a = sink->s;
+    sink->s.clear();
+    u.print_flt("unit_h");
+    if ( a!=sink->s ) bad_csv++;
+  }
+  printf("soc_unpack:  %ld records in range, %ld differ, %ld print_flt lines differ; %ld of %ld past it saturated\n",
+    n_in, bad, bad_csv, n_clip, n - n_in);
+  printf("Record %d bits, %d B packed, %d B as Flt_st on the target (%d here), buffers of this build:\n",
+    FLT_PK_BITS, FLT_PK_BYTES, UNP_ST_TARGET, int(sizeof(Flt_st)));
+  flt_pack_capacity("flt", NFLT*UNP_ST_TARGET, UNP_ST_TARGET);
+  flt_pack_capacity("his", NHIS*UNP_ST_TARGET, UNP_ST_TARGET);
+  flt_pack_capacity("sum", NSUM*UNP_ST_TARGET, UNP_ST_TARGET);
+  return ( bad || bad_csv ) ? 1 : 0;
+}
+
+int main(int argc, char **argv)
+{
+  boolean cmp = false;
+  long n_check = 0;
+  unsigned seed = 1;
+  const char *path = NULL;
+  for ( int i=1; i<argc; i++ )
+  {
+    std::string a = argv[i];
+    if ( a=="--cmp" ) cmp = true;
+    else if ( a=="--check" && i+1<argc ) n_check = atol(argv[++i]);
+    else if ( a=="--seed" && i+1<argc ) seed = atoi(argv[++i]);
+    else if ( a[0]!='-' && !path ) path = argv[i];
+    else { usage(); return 2; }
+  }
+  StrSink *sink = new StrSink();
+  rt.add(sink);
+  if ( n_check ) return check(n_check, seed, sink);
+  if ( !path ) { usage(); return 2; }
+  FILE *f = fopen(path, "r");
+  if ( !f ) { fprintf(stderr, "soc_unpack:  cannot open %s\n", path); return 2; }
+
+  // Decode
+  char line[1024];
+  char code[16] = "";
+  std::vector<std::string> printed;   // unit_ lines of the capture
+  long n_rec = 0;
+  while ( fgets(line, sizeof(line), f) )
+  {
+    std::string s = line;
+    while ( !s.empty() && (s.back()=='\n' || s.back()=='\r') ) s.pop_back();
+    int nbuf, bytes;
+    double amp;
+    if ( sscanf(s.c_str(), "pk_hdr, %15[^,], %d, %d, %lf", code, &nbuf, &bytes, &amp)==4 )
+    {
+      if ( bytes!=FLT_PK_BYTES )
+      {
+        fprintf(stderr, "soc_unpack:  %d B records, this build packs %d B\n", bytes, FLT_PK_BYTES);
+        return 1;
+      }
+      sp.put_amp(float(amp));
+    }
+    else if ( s.compare(0, 4, "pk, ")==0 && code[0] )
+    {
+      uint8_t buf[FLT_PK_BYTES];
+      if ( s.size() < 4 + 2*FLT_PK_BYTES ) continue;
+      for ( int j=0; j<FLT_PK_BYTES; j++ ) buf[j] = uint8_t(strtoul(s.substr(4+2*j, 2).c_str(), NULL, 16));
+      Flt_st r;
+      flt_unpack(buf, r);
+      r.print_flt(code);
+      n_rec++;
+    }
+    else if ( s.compare(0, 5, "unit_")==0 ) printed.push_back(s);
+  }
+  fclose(f);
+  std::vector<std::string> decoded = split(sink->s);
+  if ( !cmp )
+  {
+    fputs(sink->s.c_str(), stdout);
+    return 0;
+  }
+
+  // Each decoded line is to be among those printed
+  long n_same = 0, n_diff = 0;
+  std::string first;
+  for ( size_t i=0; i<decoded.size(); i++ )
+  {
+    if ( std::find(printed.begin(), printed.end(), decoded[i]) != printed.end() ) { n_same++; continue; }
+    n_diff++;
+    if ( first.empty() ) first = "decoded, not printed: " + decoded[i];
+  }
+  printf("soc_unpack:  %ld packed records, %ld lines as printed, %ld not\n", n_rec, n_same, n_diff);
+  if ( n_diff ) printf("%s\n", first.c_str());
+  return n_diff ? 1 : 0;
+}
@@ -29,6 +29,7 @@
 #include "command.h"
 #include "subs.h"
 #include "Variable.h"
+#include "Clock.h"
 extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap; // Various adjustment parameters shared at system level
 extern CommandPars cp;  // Various parameters to be static at system level
@@ -40,10 +41,10 @@ extern PublishPars pp;  // For publishing
 Battery::Battery(double *sp_delta_q, float *sp_t_last, const float d_voc_soc)
     : Coulombs(sp_delta_q, sp_t_last, (NOM_UNIT_CAP*3600), T_RLIM, COULOMBIC_EFF_SCALE), bms_charging_(false),
 	bms_off_(false), dt_(0.1), dv_dsoc_(0.3), dv_dyn_(0.), dv_hys_(0.), ib_(0.), ibs_(0.), ioc_(0.), print_now_(false),
-    temp_c_(NOMINAL_TB), vb_(NOMINAL_VB), voc_(NOMINAL_VB), voc_stat_(NOMINAL_VB), voltage_low_(false), vsat_(NOMINAL_VB)
+    temp_c_(NOMINAL_TB), vb_(NOMINAL_VB), voc_(NOMINAL_VB), voc_stat_(NOMINAL_VB), voltage_low_(false), vsat_(NOMINAL_VB),
+    ChargeTransfer_(EKF_NOM_DT, chem_.tau_ct, -NOM_UNIT_CAP, NOM_UNIT_CAP)  // Update time and time constant changed on the fly
 {
     nom_vsat_   = chem_.v_sat - HDB_VB;   // Center in hysteresis
-    ChargeTransfer_ = new LagExp(EKF_NOM_DT, chem_.tau_ct, -NOM_UNIT_CAP, NOM_UNIT_CAP);  // Update time and time constant changed on the fly
 }
 Battery::~Battery() {}
 // operators
@@ -147,6 +148,9 @@ float Battery::voc_soc_tab(const float soc, const float temp_c)
 // Battery monitor class
 BatteryMonitor::BatteryMonitor():
     Battery(&sp.delta_q_z, &sp.T_state_z, VM),
+    y_filt(2., WRAP_ERR_FILT, -MAX_WRAP_ERR_FILT, MAX_WRAP_ERR_FILT),  // actual update time provided run time
+    SdVb_(HDB_VB),  // Noise filter
+    EKF_converged(false, EKF_T_CONV, EKF_T_RESET, EKF_NOM_DT),  // Convergence test debounce.  Initializes false
 	amp_hrs_remaining_ekf_(0.), amp_hrs_remaining_soc_(0.), dt_eframe_(0.1), eframe_(0), ib_charge_(0.), ib_past_(0.),
     q_ekf_(NOM_UNIT_CAP*3600.), soc_ekf_(1.0), tcharge_(0.), tcharge_ekf_(0.), voc_filt_(NOMINAL_VB), voc_soc_(NOMINAL_VB),
     y_filt_(0.)
@@ -155,9 +159,14 @@ BatteryMonitor::BatteryMonitor():
     // EKF
     this->Q_ = EKF_Q_SD_NORM*EKF_Q_SD_NORM;
     this->R_ = EKF_R_SD_NORM*EKF_R_SD_NORM;
-    SdVb_ = new SlidingDeadband(HDB_VB);  // Noise filter
-    EKF_converged = new TFDelay(false, EKF_T_CONV, EKF_T_RESET, EKF_NOM_DT); // Convergence test debounce.  Initializes false
+    this->Q_u_ = this->Q_;
+    this->R_u_ = this->R_;
     ice_ = new Iterator("EKF solver");
+#ifndef SOFT_DEPLOY_PHOTON
+    chm_bank_ = new ChemBank();
+#else
+    chm_bank_ = NULL;
+#endif
 }
 BatteryMonitor::~BatteryMonitor() {}
 
@@ -222,7 +231,7 @@ float BatteryMonitor::calculate(Sensors *Sen, const boolean reset_temp)
     temp_c_ = Sen->Tb_filt;
     vsat_ = calc_vsat();
     dt_ =  Sen->T;
-    float T_rate = T_RLim->calculate(temp_c_, T_RLIM, T_RLIM, reset_temp, Sen->T);
+    float T_rate = T_RLim.calculate(temp_c_, T_RLIM, T_RLIM, reset_temp, Sen->T);
     vb_ = Sen->vb();
     ib_ = Sen->ib();
     ib_ = max(min(ib_, IMAX_NUM), -IMAX_NUM);  // Overflow protection when ib_ past value used
@@ -249,7 +258,7 @@ float BatteryMonitor::calculate(Sensors *Sen, const boolean reset_temp)
     float ib_dyn;
     if (sp.mod_vb()) ib_dyn = ib_past_;
     else ib_dyn = ib_;
-    float dvdyn = (ChargeTransfer_->calculate(ib_dyn, reset_temp, chem_.tau_ct, dt_)*chem_.r_ct*ap.slr_res + ib_dyn*chem_.r_0*ap.slr_res);
+    float dvdyn = (ChargeTransfer_.calculate(ib_dyn, reset_temp, chem_.tau_ct, dt_)*chem_.r_ct*ap.slr_res + ib_dyn*chem_.r_0*ap.slr_res);
     voc_ = vb_ - dvdyn;
     if ( !ap.fake_faults )
     {
@@ -281,21 +290,28 @@ float BatteryMonitor::calculate(Sensors *Sen, const boolean reset_temp)
         ddq_dt -= chem_.dqdt * q_capacity_ * T_rate;
         predict_ekf(ddq_dt);       // u = d(dq)/dt
         update_ekf(voc_stat_, 0., 1.);  // z = voc_stat, estimated = voc_filtered = hx, predicted = est past
-        soc_ekf_ = x_ekf();             // x = Vsoc (0-1 ideal capacitor voltage) proxy for soc
+        // UKF runs alongside so DK switches without a bump
+        predict_ukf(ddq_dt);
+        update_ukf(voc_stat_, 0., 1.);
+        soc_ekf_ = ap.ukf ? x_ukf() : x_ekf();  // x = Vsoc (0-1 ideal capacitor voltage) proxy for soc
         q_ekf_ = soc_ekf_ * q_capacity_;
         delta_q_ekf_ = q_ekf_ - q_capacity_;
-        y_filt_ = y_filt->calculate(y_, reset_temp, min(dt_eframe_, EKF_T_RESET));
+        y_filt_ = y_filt.calculate(y_ekf(), reset_temp, min(dt_eframe_, EKF_T_RESET));
         // EKF convergence.  Audio industry found that detection of quietness requires no more than
         // second order filter of the signal.   Anything more is 'gilding the lily'
         boolean conv = abs(y_filt_)<EKF_CONV && !cp.soft_reset;  // Initialize false
-        EKF_converged->calculate(conv, EKF_T_CONV, EKF_T_RESET, min(dt_eframe_, EKF_T_RESET), cp.soft_reset);
+        EKF_converged.calculate(conv, EKF_T_CONV, EKF_T_RESET, min(dt_eframe_, EKF_T_RESET), cp.soft_reset);
     }
     eframe_++;
     if ( reset_temp || cp.soft_reset || eframe_ >= ap.eframe_mult ) eframe_ = 0;  // '>=' allows changing ap.eframe_mult on the fly
-    if ( (sp.debug()==3 || sp.debug()==4) && cp.publishS ) EKF_1x1::serial_print(Sen->now, dt_eframe_);  // print EKF in Read frame
+    if ( (sp.debug()==3 || sp.debug()==4) && cp.publishS )  // print EKF in Read frame
+    {
+        if ( ap.ukf ) UKF_1x1::serial_print(Sen->now, dt_eframe_);
+        else EKF_1x1::serial_print(Sen->now, dt_eframe_);
+    }
 
     // Filter
-    voc_filt_ = SdVb_->update(voc_);   // used for saturation test
+    voc_filt_ = SdVb_.update(voc_);   // used for saturation test
 
     // if ( sp.debug()==13 || sp.debug()==2 || sp.debug()==4 )
     //     Serial.printf("bms_off,soc,ib,vb,voc,voc_stat,voc_soc,dv_hys,dv_dyn,%d,%7.3f,%7.3f,%7.3f,%7.3f,%7.3f,%7.3f,%7.3f,%7.3f,\n",
@@ -399,6 +415,44 @@ void BatteryMonitor::ekf_update(double *hx, double *H)
     *H = dv_dsoc_;
 }
 
+// Selected estimator, DK
+float BatteryMonitor::hx() { return ( ap.ukf ? hx_u_ : hx_ ); }
+float BatteryMonitor::K_ekf() { return ( ap.ukf ? K_u_ : K_ ); }
+double BatteryMonitor::y_ekf() { return ( ap.ukf ? y_u_ : y_ ); }
+
+// UKF model for predict, the EKF's
+void BatteryMonitor::ukf_predict(double *Fx, double *Bu)
+{
+    ekf_predict(Fx, Bu);
+}
+
+// UKF model for update.   Measurement function hx(x) of all sigma points in one table pass
+void BatteryMonitor::ukf_update(const double *x, double *hx, const uint8_t n)
+{
+    double x_lim[UKF_NSIG] = {0.};
+    boolean outside = false;
+    for ( uint8_t i=0; i<n; i++ )
+    {
+        x_lim[i] = max(min(x[i], 1.0), 0.0);
+        if ( x_lim[i]!=x[i] ) outside = true;
+    }
+    chem_.lookup_voc_n(x_lim, temp_c_, hx, n);
+    // Points past the ends continue on the end slopes.   A clip would flatten h there, and at saturation that
+    // lets P grow without bound until the next discharge
+    if ( outside )
+    {
+        static const double x_end[4] = {0., UKF_DX_END, 1.-UKF_DX_END, 1.};
+        double h_end[4];
+        chem_.lookup_voc_n(x_end, temp_c_, h_end, 4);
+        for ( uint8_t i=0; i<n; i++ )
+        {
+            if ( x[i]<0. ) hx[i] += (h_end[1] - h_end[0]) / UKF_DX_END * x[i];
+            else if ( x[i]>1. ) hx[i] += (h_end[3] - h_end[2]) / UKF_DX_END * (x[i] - 1.);
+        }
+    }
+    for ( uint8_t i=0; i<n; i++ ) hx[i] += sp.Dw();
+}
+
 // Initialize
 // Works in 12 V batteryunits.   Scales up/down to number of series/parallel batteries on output/input.
 void BatteryMonitor::init_battery_mon(const boolean reset, Sensors *Sen)
@@ -422,6 +476,7 @@ void BatteryMonitor::init_soc_ekf(const float soc)
 {
     soc_ekf_ = soc;
     init_ekf(soc_ekf_, 0.0);
+    init_ukf(soc_ekf_, 0.0);
     q_ekf_ = soc_ekf_ * q_capacity_;
     delta_q_ekf_ = q_ekf_ - q_capacity_;
 }
@@ -550,8 +605,11 @@ boolean BatteryMonitor::solve_ekf(const boolean reset, const boolean reset_temp,
 
 ///////////////////////////////////////////////////////////////////////////////////////////////////////////////////////
 // Battery model class for reference use mainly in regression testing
-BatterySim::BatterySim() :
-    Battery(&sp.delta_q_model_z, &sp.T_state_model_z, VS), duty_(0UL), ib_fut_(0.),
+BatterySim::BatterySim() : BatterySim(&sp.delta_q_model_z, &sp.T_state_model_z) {}
+
+// Own charge and Tb memory instead of sp, for more than one model (cppStateOfCharge/soc_strings)
+BatterySim::BatterySim(double *delta_q, float *t_last) :
+    Battery(delta_q, t_last, VS), duty_(0UL), ib_fut_(0.),
     ib_in_(0.), model_cutback_(true), q_(NOM_UNIT_CAP*3600.), sample_time_(0UL), sample_time_z_(0UL), sat_ib_max_(0.)
 {
     // ChargeTransfer dynamic model for EKF
@@ -560,6 +618,7 @@ BatterySim::BatterySim() :
     Sq_inj_ = new SqInj();
     Tri_inj_ = new TriInj();
     Cos_inj_ = new CosInj();
+    Prof_inj_ = new ProfInj();
     sat_ib_null_ = 0.;          // Current cutback value for soc=1, A
     sat_cutback_gain_ = 1000.;  // Gain to retard ib when soc approaches 1, dimensionless
     model_saturated_ = false;
@@ -617,11 +676,17 @@ BatterySim::~BatterySim() {}
 
 */
 float BatterySim::calculate(Sensors *Sen, const boolean dc_dc_on, const boolean reset)
+{
+    return ( calculate(Sen->Tb_filt, Sen->Ib_model_in, Sen->T, dc_dc_on, reset) );
+}
+
+// Same with the Sensors inputs passed in.  Lets the model run without a Sensors object (cppStateOfCharge)
+float BatterySim::calculate(const float temp_c, const float ib_model_in, const double T, const boolean dc_dc_on, const boolean reset)
 {
     // Inputs
-    temp_c_ = Sen->Tb_filt;
-    dt_ = Sen->T;
-    ib_in_ = Sen->Ib_model_in / sp.nP();
+    temp_c_ = temp_c;
+    dt_ = T;
+    ib_in_ = ib_model_in / sp.nP();
     if ( reset ) ib_fut_ = ib_in_;
     ib_ = max(min(ib_fut_, IMAX_NUM), -IMAX_NUM);  //  Past value ib_.  Overflow protection when ib_ past value used
     vsat_ = calc_vsat();
@@ -657,7 +722,7 @@ float BatterySim::calculate(Sensors *Sen, const boolean dc_dc_on, const boolean
         ib_ = 0.;
 
     // ChargeTransfer dynamic model for model, reverse version to generate sensor inputs
-    float dvdyn = (ChargeTransfer_->calculate(ib_, reset, chem_.tau_ct, dt_)*chem_.r_ct*ap.slr_res + ib_*chem_.r_0*ap.slr_res);
+    float dvdyn = (ChargeTransfer_.calculate(ib_, reset, chem_.tau_ct, dt_)*chem_.r_ct*ap.slr_res + ib_*chem_.r_0*ap.slr_res);
     vb_ = voc_ + dvdyn;
 
     // Special cases override
@@ -725,7 +790,7 @@ float BatterySim::calc_inj(const unsigned long long now, const uint8_t type, con
 
     // Sample at instant of signal injection
     sample_time_z_ = sample_time_;
-    sample_time_ = System.millis();
+    sample_time_ = Clock::millis();
 
     // Return if time 0
     if ( now == 0ULL )
@@ -763,6 +828,9 @@ float BatterySim::calc_inj(const unsigned long long now, const uint8_t type, con
         case ( 8 ):   // Cosine wave
             inj_bias = Cos_inj_->signal(amp, freq, t, 0.0) - amp;
             break;
+        case ( 9 ):   // Recorded trace, amp scales
+            inj_bias = Prof_inj_->signal(amp, t, 0.0);
+            break;
         default:
             inj_bias = 0.;
             break;
@@ -791,17 +859,24 @@ Outputs:
     q_min_          Estimated charge at low voltage shutdown, C\
 */
 float BatterySim::count_coulombs(Sensors *Sen, const boolean reset_temp, BatteryMonitor *Mon, const boolean initializing_all) 
+{
+    return ( count_coulombs(Sen->T, Sen->Tb, Sen->now, reset_temp, Mon, initializing_all) );
+}
+
+// Same with the Sensors inputs passed in.   Mon is used only when not modeling vb
+float BatterySim::count_coulombs(const double T, const float tb, const unsigned long long now, const boolean reset_temp, BatteryMonitor *Mon,
+    const boolean initializing_all) 
 {
     float charge_curr = ib_charge_;
-    double d_delta_q = charge_curr * Sen->T;
+    double d_delta_q = charge_curr * T;
     if ( charge_curr>0. ) d_delta_q *= coul_eff_;
 
     // Rate limit temperature.  When modeling, initialize to no change
     if ( reset_temp && sp.mod_vb() )
     {
-        *sp_t_last_ = Sen->Tb;
+        *sp_t_last_ = tb;
     }
-    float temp_lim = max(min(Sen->Tb, *sp_t_last_ + T_RLIM*Sen->T), *sp_t_last_ - T_RLIM*Sen->T);
+    float temp_lim = max(min(tb, *sp_t_last_ + T_RLIM*T), *sp_t_last_ - T_RLIM*T);
     
     // Saturation and re-init.   Goal is to set q_capacity and hold it so remember last saturation status
     // But if not modeling in real world, set to Monitor when Monitor saturated and reset_temp to EKF otherwise
@@ -839,9 +914,9 @@ float BatterySim::count_coulombs(Sensors *Sen, const boolean reset_temp, Battery
     // print_serial_sim
     if ( (sp.debug()==2 || sp.debug()==3 || sp.debug()==4 )  && cp.publishS && !initializing_all)
     {
-        double cTime = double(Sen->now)/1000.;
+        double cTime = double(now)/1000.;
         sprintf(pr.buff, "unit_sim, %13.3f, %d, %7.0f, %d, %7.5f,%7.5f, %7.5f,%7.5f,%7.5f,%8.5f, %7.3f,%7.3f,%7.3f,%7.3f,  %d,  %9.1f,  %8.5f, %d, %c",
-            cTime, CHEM, q_cap_rated_scaled_, bms_off_, Sen->Tb, temp_lim, vsat_, voc_stat_, dv_dyn_, vb_, ib_, ib_in_, ib_charge_, ioc_, model_saturated_, *sp_delta_q_, soc_, reset_temp,'\0');
+            cTime, CHEM, q_cap_rated_scaled_, bms_off_, tb, temp_lim, vsat_, voc_stat_, dv_dyn_, vb_, ib_, ib_in_, ib_charge_, ioc_, model_saturated_, *sp_delta_q_, soc_, reset_temp,'\0');
         Serial.printf("%s\n", pr.buff);
     }
 
@@ -855,9 +930,16 @@ float BatterySim::count_coulombs(Sensors *Sen, const boolean reset_temp, Battery
 void BatterySim::init_battery_sim(const boolean reset, Sensors *Sen)
 {
     if ( !reset ) return;
-    ib_ = Sen->ib_model_in();
+    init_battery_sim(reset, Sen->ib_model_in(), Sen->vb());
+}
+
+// Same with unit current and voltage passed in
+void BatterySim::init_battery_sim(const boolean reset, const float ib_model_in, const float vb)
+{
+    if ( !reset ) return;
+    ib_ = ib_model_in;
     ib_ = max(min(ib_, IMAX_NUM), -IMAX_NUM);  // Overflow protection when ib_ past value used
-    vb_ = Sen->vb();
+    vb_ = vb;
     voc_ = vb_ - ib_*chem_.r_ss*ap.slr_res;
     if ( isnan(voc_) ) voc_ = 13.;    // reset overflow
     if ( isnan(ib_) ) ib_ = 0.;     // reset overflow
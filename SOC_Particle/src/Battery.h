@@ -27,13 +27,18 @@
 
 #include "myLibrary/myTables.h"
 #include "myLibrary/EKF_1x1.h"
+#include "myLibrary/UKF_1x1.h"
 #include "Coulombs.h"
 #include "myLibrary/injection.h"
 #include "myLibrary/myFilters.h"
+#include "myLibrary/myFiltersT.h"
 #include "constants.h"
 #include "myLibrary/iterate.h"
 #include "Hysteresis.h"
 #include "Variable.h"
+#include "CapacityEst.h"
+#include "ChargeForecast.h"
+#include "ChemBank.h"
 
 class Sensors;
 
@@ -59,6 +64,7 @@ const float EKF_T_RESET = (EKF_T_CONV/2.); // EKF reset retest time, sec ('up 1,
 #define SOLV_MAX_COUNTS 30        // EKF initialization solver max iters (30)
 #define SOLV_SUCC_COUNTS 6        // EKF initialization solver iters to switch from successive approximation to Newton-Rapheson (6)
 #define SOLV_MAX_STEP   0.2       // EKF initialization solver max step size of soc, fraction (0.2)
+#define UKF_DX_END      0.01      // UKF end slope of voc(soc) from this far in, fraction (0.01)
 #define HYS_INIT_COUNTS 30        // Maximum initialization iterations hysteresis (50)
 #define HYS_INIT_TOL    1e-8      // Initialization tolerance hysteresis (1e-8)
 // const float MXEPS = 1-1e-6;       // Level of soc that indicates mathematically saturated (threshold is lower for robustness) (1-1e-6) dag 8/3/2023
@@ -126,7 +132,7 @@ protected:
   boolean voltage_low_; // Battery below BMS, T = BMS will turn off
   float vsat_;     // Saturation threshold at temperature, V
   // EKF declarations
-  LagExp *ChargeTransfer_; // ChargeTransfer model {ib, vb} --> {voc}, ioc=ib for Battery version
+  LagExpT<double> ChargeTransfer_; // ChargeTransfer model {ib, vb} --> {voc}, ioc=ib for Battery version
                         // ChargeTransfer model {ib, voc} --> {vb}, ioc=ib for BatterySim version
   double *rand_A_;  // ChargeTransfer model A
   double *rand_B_;  // ChargeTransfer model B
@@ -136,7 +142,7 @@ protected:
 
 
 // BatteryMonitor: extend Battery to use as monitor object
-class BatteryMonitor: public Battery, public EKF_1x1
+class BatteryMonitor: public Battery, public EKF_1x1, public UKF_1x1
 {
 public:
   BatteryMonitor();
@@ -148,14 +154,17 @@ public:
   float calc_charge_time(const double q, const float q_capacity, const float charge_curr, const float soc);
   virtual float calc_soc_voc(const float soc, const float temp_c, float *dv_dsoc);
   float calculate(Sensors *Sen, const boolean reset);
-  boolean converged_ekf() { return EKF_converged->state(); };
+  CapacityEst *cap_est() { return &cap_est_; };
+  ChemBank *chm_bank() { return chm_bank_; };
+  boolean converged_ekf() { return EKF_converged.state(); };
   double delta_q_ekf() { return delta_q_ekf_; };
-  float hx() { return hx_; };
+  ChargeForecast *forecast() { return &forecast_; };
+  float hx();
   float ib_charge() { return ib_charge_; };
   void init_battery_mon(const boolean reset, Sensors *Sen);
   void init_soc_ekf(const float soc);
   boolean is_sat(const boolean reset);
-  float K_ekf() { return K_; };
+  float K_ekf();
   void pretty_print(Sensors *Sen);
   void regauge(const float temp_c);
   float r_sd ();
@@ -167,19 +176,22 @@ public:
   float vb_model_rev() { return vb_model_rev_; };
   float voc_filt() { return voc_filt_; };
   float voc_soc() { return voc_soc_; };
-  double y_ekf() { return y_; };
+  double y_ekf();
   double y_ekf_filt() { return y_filt_; };
   double delta_q_ekf_;         // Charge deficit represented by charge calculated by ekf, C
 protected:
-  LagTustin *y_filt = new LagTustin(2., WRAP_ERR_FILT, -MAX_WRAP_ERR_FILT, MAX_WRAP_ERR_FILT);  // actual update time provided run time
-  SlidingDeadband *SdVb_;  // Sliding deadband filter for Vb
-  TFDelay *EKF_converged;  // Time persistence
-  RateLimit *T_RLim = new RateLimit();
+  LagTustinT<double> y_filt;  // EKF y residual filter
+  SlidingDeadbandT<double> SdVb_;  // Sliding deadband filter for Vb
+  TFDelayT<double> EKF_converged;  // Time persistence
+  RateLimitT<double> T_RLim;  // Tb rate limit for the EKF
   Iterator *ice_;      // Iteration control for EKF solver
   float amp_hrs_remaining_ekf_;  // Discharge amp*time left if drain to q_ekf=0, A-h
   float amp_hrs_remaining_soc_;  // Discharge amp*time left if drain soc_ to 0, A-h
+  CapacityEst cap_est_;  // Capacity (state of health) estimate
+  ChemBank *chm_bank_;   // Shadow chemistries, NULL when not built
   double dt_eframe_;   // Update time for EKF major frame
   uint8_t eframe_;     // Counter to run EKF slower than Coulomb Counter and ChargeTransfer models
+  ChargeForecast forecast_;  // Time to full and to empty from averaged current
   float ib_charge_;    // Current input avaiable for charging, A
   float ib_past_;      // Past value of current to synchronize e_wrap dynamics with model, A
   double q_ekf_;       // Filtered charge calculated by ekf, C
@@ -192,6 +204,8 @@ protected:
   float y_filt_;       // Filtered EKF y value, V
   void ekf_predict(double *Fx, double *Bu);
   void ekf_update(double *hx, double *H);
+  void ukf_predict(double *Fx, double *Bu);
+  void ukf_update(const double *x, double *hx, const uint8_t n);
 };
 
 
@@ -200,13 +214,17 @@ class BatterySim: public Battery
 {
 public:
   BatterySim();
+  BatterySim(double *delta_q, float *t_last);
   ~BatterySim();
   // operators
   // functions
   float calculate(Sensors *Sen, const boolean dc_dc_on, const boolean reset);
+  float calculate(const float temp_c, const float ib_model_in, const double T, const boolean dc_dc_on, const boolean reset);
   float calc_inj(const unsigned long long now, const uint8_t type, const float amp, const double freq);
   virtual float calc_soc_voc(const float soc, const float temp_c, float *dv_dsoc);
   float count_coulombs(Sensors *Sen, const boolean reset, BatteryMonitor *Mon, const boolean initializing_all);
+  float count_coulombs(const double T, const float tb, const unsigned long long now, const boolean reset_temp, BatteryMonitor *Mon,
+    const boolean initializing_all);
   boolean cutback() { return model_cutback_; };
   double delta_q() { return *sp_delta_q_; };
   unsigned long int dt(void) { return sample_time_ - sample_time_z_; };
@@ -217,7 +235,9 @@ public:
   float ib_charge() { return ib_charge_; };
   float ib_fut() { return ib_fut_; };
   void init_battery_sim(const boolean reset, Sensors *Sen);
+  void init_battery_sim(const boolean reset, const float ib_model_in, const float vb);
   void pretty_print(void);
+  ProfInj *prof_inj() { return Prof_inj_; };
   unsigned long int sample_time(void) { return sample_time_; };
   boolean saturated() { return model_saturated_; };
   float t_last() { return *sp_t_last_; };
@@ -228,6 +248,7 @@ protected:
   SqInj *Sq_inj_;           // Class to create square waves
   TriInj *Tri_inj_;         // Class to create triangle waves
   CosInj *Cos_inj_;         // Class to create cosine waves
+  ProfInj *Prof_inj_;       // Class to play back recorded current
   uint32_t duty_;           // Used in Test Mode to inject Fake shunt current (0 - uint32_t(255))
   float ib_charge_;         // Current input avaiable for charging, A
   float ib_fut_;            // Future value of limited current, A
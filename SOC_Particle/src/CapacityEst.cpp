@@ -0,0 +1,141 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "CapacityEst.h"
+#include "parameters.h"
+
+extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
+
+
+// class CapacityEst
+CapacityEst::CapacityEst()
+  : anchored_(false), dq_a_(0.), e_(0.), sd_a_(0.), sat_past_(false), soc_a_(0.), t_a_(0.), t_ekf_(-CAP_T_EKF), x_(0.){}
+CapacityEst::~CapacityEst() {}
+
+// functions
+uint16_t CapacityEst::n() { return sp.cap_n(); }
+float CapacityEst::sd() { return sqrt(max(sp.cap_var(), 0.)); }
+float CapacityEst::theta() { return sp.cap_est(); }
+
+// Print
+void CapacityEst::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf("CapacityEst:\n");
+  Serial.printf(" anchored %d\n", anchored_);
+  Serial.printf(" soc_a%8.4f sd_a%7.4f\n", soc_a_, sd_a_);
+  Serial.printf(" dq_a%10.1f, C\n", dq_a_);
+  Serial.printf(" x%8.4f e%8.4f latest swing and innovation\n", x_, e_);
+  Serial.printf(" n %d\n", n());
+  Serial.printf(" theta%7.4f sd%7.4f (%6.4f - %6.4f 2sig), slr\n", theta(), sd(), lo(), hi());
+#else
+  Serial.printf("CapacityEst: silent DEPLOY\n");
+#endif
+}
+
+// Back to the prior
+void CapacityEst::reset()
+{
+  sp.put_cap_est(1.);
+  sp.put_cap_var(CAP_SD_INIT*CAP_SD_INIT);
+  sp.put_cap_n(0);
+  anchored_ = false;
+  x_ = e_ = 0.;
+}
+
+/* CapacityEst::update:  Anchor and, when the swing is large enough, one RLS step
+Inputs:
+  t               Time, s
+  delta_q_inf     Counted charge, not reset on saturation, C
+  q_rated         Rated capacity at temperature, unscaled by SQ, C
+  sat             Indication that battery is saturated, T=saturated
+  conv_ekf        EKF converged, T=converged
+  soc_ekf         EKF soc, fraction
+  ib              Current, A
+  reset           Counted charge re-initialized, T=reset
+Outputs:
+  sp.cap_est      Capacity ratio theta
+  sp.cap_var      Variance of theta
+  sp.cap_n        Number of observations
+  return          T=observation taken
+*/
+boolean CapacityEst::update(const double t, const double delta_q_inf, const float q_rated, const boolean sat,
+  const boolean conv_ekf, const float soc_ekf, const float ib, const boolean reset)
+{
+  boolean sat_edge = sat && !sat_past_;
+  sat_past_ = sat;
+  if ( reset )
+  {
+    anchored_ = false;
+    return false;
+  }
+
+  // Anchors
+  float soc_r, sd_r;
+  if ( sat_edge )
+  {
+    soc_r = 1.;
+    sd_r = CAP_SD_SAT;
+  }
+  else if ( conv_ekf && !sat && abs(ib)<CAP_IB_QUIET && (t - t_ekf_)>=CAP_T_EKF )
+  {
+    soc_r = soc_ekf;
+    sd_r = CAP_SD_EKF;
+    t_ekf_ = t;
+  }
+  else
+    return false;
+
+  // Observation.  While the swing is small keep the older anchor for a wider swing next time, unless the new one
+  // is at least as certain (daily saturation)
+  boolean observed = false;
+  boolean fresh = anchored_ && (t - t_a_)<=CAP_T_MAX && q_rated>0.;
+  float x = soc_r - soc_a_;
+  if ( fresh && abs(x)<CAP_DSOC_MIN )
+  {
+    if ( sd_r>sd_a_ ) return false;
+  }
+  else if ( fresh )
+  {
+    float y = (delta_q_inf - dq_a_) / q_rated;
+    float r = sd_r*sd_r + sd_a_*sd_a_ + (CAP_SD_CC*x)*(CAP_SD_CC*x);  // Variance of y - th*x
+    float th = sp.cap_est();
+    float p = sp.cap_var();
+    e_ = y - x*th;
+    float k = p*x / (CAP_FORGET*r + x*p*x);
+    th = max(min(th + k*e_, CAP_MAX), CAP_MIN);
+    p = min((p - k*x*p) / CAP_FORGET, CAP_SD_INIT*CAP_SD_INIT);
+    sp.put_cap_est(th);
+    sp.put_cap_var(p);
+    sp.put_cap_n(min(int(sp.cap_n()) + 1, 65535));
+    x_ = x;
+    observed = true;
+  }
+  anchored_ = true;
+  dq_a_ = delta_q_inf;
+  soc_a_ = soc_r;
+  sd_a_ = sd_r;
+  t_a_ = t;
+  return observed;
+}
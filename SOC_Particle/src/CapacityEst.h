@@ -0,0 +1,78 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _CAPACITY_EST_H
+#define _CAPACITY_EST_H
+
+#include "application.h"
+
+#define CAP_DSOC_MIN    0.2       // Least soc swing between anchors for a capacity observation, fraction (0.2)
+#define CAP_FORGET      0.98      // Forgetting factor per observation, ~50 observations memory (0.98)
+#define CAP_SD_SAT      0.01      // Uncertainty of soc at a saturation anchor, fraction (0.01)
+#define CAP_SD_EKF      0.04      // Uncertainty of soc at an EKF converged anchor, fraction (0.04)
+#define CAP_SD_CC       0.01      // Uncertainty of counted charge, fraction of swing (0.01)
+#define CAP_SD_INIT     0.1       // Prior uncertainty of capacity ratio (0.1)
+#define CAP_IB_QUIET    1.0       // Current below which EKF converged soc may anchor, A (1.0)
+#define CAP_T_EKF       3600.     // Least time between EKF anchors, s (3600.)
+#define CAP_T_MAX       1209600.  // Oldest anchor used, s (14 days)
+#define CAP_MIN         0.2       // Floor on capacity ratio, fraction (0.2)
+#define CAP_MAX         2.0       // Ceiling on capacity ratio, fraction (2.0)
+
+// Capacity (state of health) estimate, recursive least squares.   Capacity ratio theta = true / rated.
+// An anchor is a point of known soc:  a saturation edge (soc=1) or a quiet EKF converged window.   Between
+// two anchors the counted charge (delta_q_inf, not reset at saturation) relates to the soc swing
+//      (delta_q_inf_b - delta_q_inf_a) / q_rated(Tb)  =  theta * (soc_b - soc_a)
+// Weighted by the anchor and counting uncertainties and forgotten slowly so the estimate follows aging.
+// State is a few numbers:  theta, its variance and count live in SavedPars (qc, qv, qn); the anchor is
+// volatile and dropped on reset.
+class CapacityEst
+{
+public:
+  CapacityEst();
+  ~CapacityEst();
+  // operators
+  // functions
+  float hi() { return min(theta() + 2.*sd(), CAP_MAX); };
+  float lo() { return max(theta() - 2.*sd(), CAP_MIN); };
+  uint16_t n();
+  void pretty_print();
+  void reset();
+  void reset_anchor() { anchored_ = false; };
+  float sd();
+  float theta();
+  boolean update(const double t, const double delta_q_inf, const float q_rated, const boolean sat, const boolean conv_ekf,
+    const float soc_ekf, const float ib, const boolean reset);
+protected:
+  boolean anchored_;    // Anchor valid, T=valid
+  double dq_a_;         // Counted charge delta_q_inf at anchor, C
+  float e_;             // Latest innovation, fraction
+  float sd_a_;          // Uncertainty of soc at anchor, fraction
+  boolean sat_past_;    // Past value of sat for edge detection
+  float soc_a_;         // soc at anchor, fraction
+  double t_a_;          // Time of anchor, s
+  double t_ekf_;        // Time of latest EKF anchor, s
+  float x_;             // Latest soc swing, fraction
+};
+
+#endif
@@ -0,0 +1,176 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "ChargeForecast.h"
+
+
+// class ChargeForecast
+ChargeForecast::ChargeForecast()
+  : elapsed_(0.), hrs_(0.), hrs_far_(0.), hrs_near_(0.), ib_avg_(0.), k_(0), sd_(0.), tb_end_(25.), tb_fast_(25.),
+  tb_slow_(25.)
+{
+  float tau = FCST_TAU_0;
+  for ( uint8_t i=0; i<FCST_NH; i++ )
+  {
+    tau_[i] = tau;
+    tau *= FCST_TAU_MULT;
+    mean_[i] = 0.;
+    var_[i] = 0.;
+  }
+}
+ChargeForecast::~ChargeForecast() {}
+
+// Hours to full (+) or to empty (-) at constant current ib.   FCST_T_MAX inside the deadband
+float ChargeForecast::hours(const float ib, const double q, const float q_capacity, const float q_min,
+  const double coul_eff)
+{
+  float hrs;
+  if ( ib > FCST_DEADBAND )
+    hrs = max(q_capacity - q, 0.) / (ib*coul_eff) / 3600.;
+  else if ( ib < -FCST_DEADBAND )
+    hrs = -max(q - q_min, 0.) / -ib / 3600.;
+  else if ( ib >= 0. )
+    hrs = FCST_T_MAX;
+  else
+    hrs = -FCST_T_MAX;
+  return max(min(hrs, FCST_T_MAX), -FCST_T_MAX);
+}
+
+// Print
+void ChargeForecast::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf("ChargeForecast:\n");
+  Serial.printf(" elapsed%10.0f, s\n", elapsed_);
+  Serial.printf(" mean");
+  for ( uint8_t i=0; i<FCST_NH; i++ ) Serial.printf("%8.3f", mean_[i]);
+  Serial.printf(", A\n scat");
+  for ( uint8_t i=0; i<FCST_NH; i++ ) Serial.printf("%8.3f", sqrt(max(var_[i], 0.)));
+  Serial.printf(", A\n k %d (%6.0f s)\n", k_, tau_[k_]);
+  Serial.printf(" ib_avg%8.3f sd%7.3f, A\n", ib_avg_, sd_);
+  Serial.printf(" tb_end%6.1f, deg C\n", tb_end_);
+  Serial.printf(" hrs%6.1f (%6.1f - %6.1f 2sig), hr\n", hrs_, hrs_near_, hrs_far_);
+#else
+  Serial.printf("ChargeForecast: silent DEPLOY\n");
+#endif
+}
+
+// Forget the history
+void ChargeForecast::reset(const float ib, const float tb)
+{
+  elapsed_ = 0.;
+  for ( uint8_t i=0; i<FCST_NH; i++ )
+  {
+    mean_[i] = ib;
+    var_[i] = 0.;
+  }
+  tb_fast_ = tb_slow_ = tb_end_ = tb;
+}
+
+/* ChargeForecast::update:  Running averages and the forecast
+Inputs:
+  T               Update time, s
+  ib_charge       Charge current, A
+  q               Present charge, C
+  q_capacity      Capacity at temperature, C
+  tb              Battery temperature, deg C
+  soc_min_T       Floor on soc vs temperature, table
+  coul_eff        Coulombic efficiency of charging, fraction
+  reset           Forget the history, T=reset
+Outputs:
+  hrs_            Forecast, + to full, - to empty, hr
+  hrs_near_       Nearer bound, hr
+  hrs_far_        Farther bound, hr
+  return          hrs_
+*/
+float ChargeForecast::update(const double T, const float ib_charge, const double q, const float q_capacity,
+  const float tb, TableInterp1D *soc_min_T, const double coul_eff, const boolean reset)
+{
+  if ( reset ) ChargeForecast::reset(ib_charge, tb);
+  else elapsed_ += T;
+
+  // Averages, and the scatter of the next shorter one (the samples for the shortest) about each.   Weight by
+  // elapsed time until the horizon fills.   Once full, a deviation adds at most FCST_VAR_CLIP times the scatter
+  // so a load shift stands out for about a horizon instead of widening the scatter it is tested against
+  double x = ib_charge;
+  for ( uint8_t i=0; i<FCST_NH; i++ )
+  {
+    double a = min(T / max(min(double(tau_[i]), elapsed_), T), 1.);
+    mean_[i] += a*(ib_charge - mean_[i]);
+    double d2 = (x - mean_[i])*(x - mean_[i]);
+    if ( elapsed_ >= tau_[i] ) d2 = min(d2, FCST_VAR_CLIP*var_[i] + FCST_DEADBAND*FCST_DEADBAND);
+    var_[i] += a*(d2 - var_[i]);
+    x = mean_[i];
+  }
+  double a_fast = min(T / max(min(double(tau_[1]), elapsed_), T), 1.);
+  double a_slow = min(T / max(min(double(tau_[FCST_NH-1]), elapsed_), T), 1.);
+  tb_fast_ += a_fast*(tb - tb_fast_);
+  tb_slow_ += a_slow*(tb - tb_slow_);
+
+  // Horizon:  longest not longer than its own forecast, unless the shorter one has moved outside its usual
+  // scatter (load shift)
+  float q_min = soc_min_T->interp(tb)*q_capacity;
+  k_ = 0;
+  hrs_ = hours(mean_[0], q, q_capacity, q_min, coul_eff);
+  for ( uint8_t i=1; i<FCST_NH; i++ )
+  {
+    float hrs = hours(mean_[i], q, q_capacity, q_min, coul_eff);
+    double shift = FCST_SIG_SHIFT*sqrt(max(var_[i], 0.)) + FCST_DEADBAND;
+    if ( tau_[i] > abs(hrs)*3600. || abs(mean_[i] - mean_[i-1]) > shift ) break;
+    k_ = i;
+    hrs_ = hrs;
+  }
+  ib_avg_ = mean_[k_];
+
+  // Floor at the temperature projected to the end.   Ramp lags an average by about its time constant
+  double lag_fast = min(double(tau_[1]), elapsed_/2.);
+  double lag_slow = min(double(tau_[FCST_NH-1]), elapsed_/2.);
+  double tb_rate = lag_slow>lag_fast ? (tb_fast_ - tb_slow_) / (lag_slow - lag_fast) : 0.;
+  tb_end_ = tb + max(min(tb_rate*abs(hrs_)*3600., FCST_DTB_MAX), -FCST_DTB_MAX);
+  if ( hrs_ < 0. )
+  {
+    q_min = soc_min_T->interp(tb_end_)*q_capacity;
+    hrs_ = hours(ib_avg_, q, q_capacity, q_min, coul_eff);
+  }
+
+  // Bounds.   The next shorter average scatters about this one with var_; over the time ahead there are about
+  // t_ahead / tau of those to average
+  double t_ahead = max(abs(hrs_)*3600., FCST_TAU_0);
+  double tau_short = k_>0 ? tau_[k_-1] : FCST_TAU_0;
+  sd_ = sqrt(max(var_[k_]*tau_short/t_ahead, 0.));
+  float h_a = hours(ib_avg_ + FCST_SIG*sd_, q, q_capacity, q_min, coul_eff);
+  float h_b = hours(ib_avg_ - FCST_SIG*sd_, q, q_capacity, q_min, coul_eff);
+  if ( hrs_ >= 0. )
+  {
+    hrs_near_ = h_a;    // More charge current, full sooner
+    hrs_far_ = h_b>=0. ? h_b : FCST_T_MAX;
+  }
+  else
+  {
+    hrs_near_ = h_b;    // More discharge current, empty sooner
+    hrs_far_ = h_a<0. ? h_a : -FCST_T_MAX;
+  }
+
+  return hrs_;
+}
@@ -0,0 +1,83 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _CHARGE_FORECAST_H
+#define _CHARGE_FORECAST_H
+
+#include "application.h"
+#include "myLibrary/myTables.h"
+
+#define FCST_NH         4         // Number of averaging horizons (4)
+#define FCST_TAU_0      60.       // Shortest averaging horizon, s (60.)
+#define FCST_TAU_MULT   4.        // Ratio of successive horizons, 1, 4, 16 and 64 min (4.)
+#define FCST_DEADBAND   0.1       // Inside this +/- deadband of average current, forecast is FCST_T_MAX, A (0.1)
+#define FCST_T_MAX      99.       // Longest forecast, hr (99.)
+#define FCST_DTB_MAX    10.       // Limit on projected temperature change to the forecast end, deg C (10.)
+#define FCST_SIG        2.        // Width of the confidence bounds, sigma (2.)
+#define FCST_SIG_SHIFT  3.        // Shorter average this far outside its scatter is a load shift, sigma (3.)
+#define FCST_VAR_CLIP   2.        // Limit on one deviation's addition to the scatter, times the scatter (2.)
+
+// Time to full and time to empty from running averages of charge current instead of the instantaneous value
+// calc_charge_time uses.   Exponentially weighted averages of ib_charge over FCST_NH horizons, each O(1) per update;
+// weights follow the elapsed time until the horizon fills so a fresh start is a plain average.   Each horizon also
+// keeps the scatter of the next shorter average (the samples for the shortest) about its own.   The forecast looks
+// back about as far as it looks ahead:  the longest horizon not longer than its own forecast is used, unless the
+// next shorter average has left its usual scatter (load shift).   Discharge runs down to q_min at the temperature
+// projected to the end from the trend of Tb, the lag between a fast and a slow average, since the floor soc_min_T
+// rises as the battery cools.   Bounds take the average current +/- FCST_SIG sigma, sigma the scatter over the
+// number of shorter averages in the time ahead.   Signs follow tcharge:  + hours to full, - hours to empty.
+class ChargeForecast
+{
+public:
+  ChargeForecast();
+  ~ChargeForecast();
+  // operators
+  // functions
+  float hrs() { return hrs_; };
+  float hrs_far() { return hrs_far_; };
+  float hrs_near() { return hrs_near_; };
+  float ib_avg() { return ib_avg_; };
+  uint8_t k() { return k_; };
+  void pretty_print();
+  void reset(const float ib, const float tb);
+  float update(const double T, const float ib_charge, const double q, const float q_capacity, const float tb,
+    TableInterp1D *soc_min_T, const double coul_eff, const boolean reset);
+protected:
+  float hours(const float ib, const double q, const float q_capacity, const float q_min, const double coul_eff);
+  double elapsed_;          // Time since reset, s
+  float hrs_;               // Forecast, + to full, - to empty, hr
+  float hrs_far_;           // Farther confidence bound, hr
+  float hrs_near_;          // Nearer confidence bound, hr
+  float ib_avg_;            // Average current of the horizon used, A
+  uint8_t k_;               // Horizon used
+  double mean_[FCST_NH];    // Average charge current per horizon, A
+  float sd_;                // Uncertainty of ib_avg_, A
+  float tb_end_;            // Temperature projected to the end of discharge, deg C
+  double tb_fast_;          // Average temperature over horizon 1, deg C
+  double tb_slow_;          // Average temperature over the longest horizon, deg C
+  float tau_[FCST_NH];      // Horizon time constants, s
+  double var_[FCST_NH];     // Scatter of the next shorter average (samples for 0) per horizon, A^2
+};
+
+#endif
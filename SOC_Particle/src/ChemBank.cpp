@@ -0,0 +1,182 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "ChemBank.h"
+#include "constants.h"
+#include "myLibrary/myTables.h"
+#include "Chemistry_BMS.h"
+
+static const char *chb_name[CHB_NMOD] = {"Battleborn", "CHINS", "CHINS Garage"};  // As Chemistry::assign_mod
+
+// Sorted union of breakpoints into u, n in and out
+static void chb_union(float *u, int *n, const float *x, const int nx)
+{
+  for ( int i=0; i<nx; i++ )
+  {
+    int j = 0;
+    while ( j<*n && u[j]<x[i] ) j++;
+    if ( j<*n && u[j]==x[i] ) continue;
+    for ( int k=*n; k>j; k-- ) u[k] = u[k-1];
+    u[j] = x[i];
+    (*n)++;
+  }
+}
+
+
+// class ChemBank
+ChemBank::ChemBank()
+  : frame_(0), n_s_(0), m_t_(0), n_upd_(0)
+{
+  // Union of breakpoints
+  Chemistry *chm[CHB_NMOD];
+  int n_max = 0, m_max = 0;
+  for ( uint8_t m=0; m<CHB_NMOD; m++ )
+  {
+    chm[m] = new Chemistry(m);
+    n_max += chm[m]->voc_T_->n1();
+    m_max += chm[m]->voc_T_->n2();
+  }
+  float *x = new float[n_max];
+  float *y = new float[m_max];
+  for ( uint8_t m=0; m<CHB_NMOD; m++ )
+  {
+    chb_union(x, &n_s_, chm[m]->voc_T_->x(), chm[m]->voc_T_->n1());
+    chb_union(y, &m_t_, chm[m]->voc_T_->y(), chm[m]->voc_T_->n2());
+  }
+  x_soc_ = new float[n_s_];
+  y_t_ = new float[m_t_];
+  for ( int i=0; i<n_s_; i++ ) x_soc_[i] = x[i];
+  for ( int j=0; j<m_t_; j++ ) y_t_[j] = y[j];
+  delete[] x;
+  delete[] y;
+
+  // Resample
+  v_ = new float[CHB_NMOD*m_t_*n_s_];
+  for ( uint8_t m=0; m<CHB_NMOD; m++ )
+  {
+    for ( int j=0; j<m_t_; j++ )
+      for ( int i=0; i<n_s_; i++ )
+        v_[(m*m_t_ + j)*n_s_ + i] = chm[m]->voc_T_->interp(x_soc_[i], y_t_[j]);
+    dvoc_[m] = chm[m]->dvoc;
+    delete chm[m];
+  }
+  reset();
+}
+ChemBank::~ChemBank()
+{
+  delete[] v_;
+  delete[] x_soc_;
+  delete[] y_t_;
+}
+
+// functions
+
+// Most likely chemistry
+uint8_t ChemBank::best()
+{
+  uint8_t b = 0;
+  for ( uint8_t m=1; m<CHB_NMOD; m++ ) if ( ll_[m]>ll_[b] ) b = m;
+  return b;
+}
+
+// Shared lookup:  offsets into one model's table and their weights, as TableInterp2D::weights
+void ChemBank::bracket(const float soc, const float temp_c, int *k, float *w)
+{
+  int high1, low1, high2, low2;
+  float dx1, dx2;
+  binsearch(soc, x_soc_, n_s_, &high1, &low1, &dx1);
+  binsearch(temp_c, y_t_, m_t_, &high2, &low2, &dx2);
+  k[0] = low2*n_s_ + low1;    w[0] = (1. - dx2) * (1. - dx1);
+  k[1] = low2*n_s_ + high1;   w[1] = (1. - dx2) * dx1;
+  k[2] = high2*n_s_ + low1;   w[2] = dx2 * (1. - dx1);
+  k[3] = high2*n_s_ + high1;  w[3] = dx2 * dx1;
+}
+
+// Print
+void ChemBank::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf("ChemBank:  %d x %d shared grid, %lu updates, * = CHEM, ^ = best\n", n_s_, m_t_, (unsigned long)n_upd_);
+  Serial.printf("  mod %-12s %8s %8s %10s %6s\n", "", "e", "e_filt", "ll", "prob");
+  uint8_t b = best();
+  for ( uint8_t m=0; m<CHB_NMOD; m++ )
+    Serial.printf(" %c%c%d  %-12s %8.4f %8.4f %10.1f %6.3f\n", m==CHEM ? '*' : ' ', m==b ? '^' : ' ', m,
+      chb_name[m], e_[m], e_filt_[m], ll_[m], prob(m));
+#else
+  Serial.printf("ChemBank: silent DEPLOY\n");
+#endif
+}
+
+// Normalized likelihood
+float ChemBank::prob(const uint8_t m)
+{
+  float ll_max = ll_[best()];
+  float sum = 0.;
+  for ( uint8_t i=0; i<CHB_NMOD; i++ ) sum += exp(ll_[i] - ll_max);
+  return exp(ll_[m] - ll_max) / sum;
+}
+
+// Forget all evidence
+void ChemBank::reset()
+{
+  for ( uint8_t m=0; m<CHB_NMOD; m++ ) e_[m] = e_filt_[m] = ll_[m] = 0.;
+  n_upd_ = 0;
+  frame_ = 0;
+}
+
+/* ChemBank::update:  Residual and likelihood of every chemistry, every CHB_DECIM calls
+Inputs:
+  voc_stat        Static voc from measurement, V
+  soc             State of charge, fraction
+  temp_c          Battery temperature, deg C
+  dw              Table bias of the Monitor, Dw, V
+  valid           voc_stat meaningful, e.g. not saturated and BMS on, T=valid
+  reset           Forget all evidence, T=reset
+Outputs:
+  e_, e_filt_     Residuals, V
+  ll_             Log likelihoods
+*/
+void ChemBank::update(const float voc_stat, const float soc, const float temp_c, const float dw, const boolean valid,
+  const boolean reset)
+{
+  if ( reset ) this->reset();
+  if ( ++frame_<CHB_DECIM ) return;
+  frame_ = 0;
+  if ( !valid ) return;
+  int k[4];
+  float w[4];
+  bracket(soc, temp_c, k, w);
+  float a = 1. / CHB_TAU;
+  for ( uint8_t m=0; m<CHB_NMOD; m++ )
+  {
+    float *v = v_ + m*m_t_*n_s_;
+    float voc_soc = v[k[0]]*w[0] + v[k[1]]*w[1] + v[k[2]]*w[2] + v[k[3]]*w[3] + dvoc_[m] + dw;
+    e_[m] = voc_stat - voc_soc;
+    float r = e_[m] / CHB_SD;
+    ll_[m] = CHB_FORGET*ll_[m] - 0.5*r*r;
+    if ( n_upd_==0 ) e_filt_[m] = e_[m];
+    else e_filt_[m] += a*(e_[m] - e_filt_[m]);
+  }
+  n_upd_++;
+}
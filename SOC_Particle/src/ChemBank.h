@@ -0,0 +1,72 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _CHEM_BANK_H
+#define _CHEM_BANK_H
+
+#include "application.h"
+
+#define CHB_NMOD        3         // Chemistries in the bank, mod codes 0 .. CHB_NMOD-1 (3)
+#define CHB_DECIM       10        // Calls per bank update, 10 = 1 s at READ_DELAY 100 ms (10)
+#define CHB_SD          0.05      // Residual standard deviation in the likelihood, V (0.05)
+#define CHB_FORGET      0.999     // Log likelihood forgetting per update, ~1000 updates memory (0.999)
+#define CHB_TAU         600.      // Time constant of the displayed residual filter, updates (600.)
+
+// Shadow bank of chemistries.   Runs the voc(soc) residual of every built-in chemistry beside the one CHEM
+// selects, to show which the data favors, without affecting the Monitor.   At construction every voc_T_ table
+// is resampled onto the union of all their breakpoints.  Bilinear tables that clip are exact on a finer grid,
+// so each update needs one bracket (two binary searches, four weights) shared by all chemistries and then
+// four multiply-adds each.   voc_stat comes from the Monitor, i.e. the resistances of the CHEM chemistry.
+class ChemBank
+{
+public:
+  ChemBank();
+  ~ChemBank();
+  // operators
+  // functions
+  uint8_t best();
+  float e(const uint8_t m) { return e_[m]; };
+  float e_filt(const uint8_t m) { return e_filt_[m]; };
+  float ll(const uint8_t m) { return ll_[m]; };
+  void pretty_print();
+  float prob(const uint8_t m);
+  void reset();
+  void update(const float voc_stat, const float soc, const float temp_c, const float dw, const boolean valid,
+    const boolean reset);
+protected:
+  void bracket(const float soc, const float temp_c, int *k, float *w);
+  float dvoc_[CHB_NMOD];    // Table bias of each chemistry, V
+  float e_[CHB_NMOD];       // Latest residual voc_stat - voc_soc, V
+  float e_filt_[CHB_NMOD];  // Filtered residual, V
+  uint8_t frame_;           // Calls since last update
+  float ll_[CHB_NMOD];      // Running log likelihood
+  int n_s_;                 // Number of soc breakpoints, union
+  int m_t_;                 // Number of temperature breakpoints, union
+  uint32_t n_upd_;          // Updates taken since reset
+  float *v_;                // voc tables, model-major, each m_t_ rows of n_s_, V
+  float *x_soc_;            // soc breakpoints, union
+  float *y_t_;              // Temperature breakpoints, union, deg C
+};
+
+#endif
@@ -36,32 +36,52 @@ extern PublishPars pp; // For publishing
 // Structure Chemistry
 // Assign parameters of model
 
+Chemistry::~Chemistry()
+{
+    delete hys_Tn_;
+    delete hys_Ts_;
+    delete hys_Tx_;
+    delete hys_T_;
+    delete voc_T_;
+    delete soc_min_T_;
+}
+
 // Chemistry Executive
 void Chemistry::assign_all_chm()
 {
-    if (CHEM == 0) // "Battleborn";
+    assign_mod(CHEM);
+}
+
+// Any chemistry by mod code
+void Chemistry::assign_mod(const uint8_t mod)
+{
+    if (mod == 0) // "Battleborn";
     {
         mod_code = 0;
         assign_BB();
     }
-    else if (CHEM == 1) // "CHINS"
+    else if (mod == 1) // "CHINS"
     {
         mod_code = 1;
         assign_CH();
     }
-    else if (CHEM == 2) // "CHINS Garage"
+    else if (mod == 2) // "CHINS Garage"
     {
         mod_code = 2;
         assign_CH();
     }
     else
-        Serial.printf("assign_all_mod:  unknown mod %d.  Type 'h' (Xm)\n", CHEM);
+        Serial.printf("assign_all_mod:  unknown mod %d.  Type 'h' (Xm)\n", mod);
     r_ss = r_0 + r_ct;
 }
 
 
+// Tables of every chemistry are built in, each in its own namespace, so the shadow bank (ChemBank.h) can load
+// the ones CHEM does not select
+
 // BattleBorn Chemistry
-#if CHEM == 0
+namespace chm_bb
+{
     // BattleBorn 100 Ah, 12v LiFePO4
     // See VOC_SOC data.xls.    T=40 values are only a notion.   Need data for it.
     // >13.425 V is reliable approximation for SOC>99.7 observed in my prototype around 15-35 C
@@ -107,11 +127,12 @@ void Chemistry::assign_all_chm()
         {0.7,  0.3,  0.2};
     float T_DV_MIN[M_H] = // dv_max(soc) table.  Pulled values from insp of T_R where flattens
         {-0.7, -0.5, -0.3};
-#endif
+}
 
 
 // CHINS Chemistry
-#if CHEM == 1
+namespace chm_ch
+{
     // CHINS 100 Ah, 12v LiFePO4
     // 2023-02-27:  tune to data.  Add slight slope 0.8-0.98 to make models deterministic
     // 2023-08-29:  tune to data
@@ -131,7 +152,11 @@ void Chemistry::assign_all_chm()
     const uint8_t N_N = 4;                                        // Number of temperature breakpoints for x_soc_min table
     float X_SOC_MIN[N_N] = {0.000,  11.00,  21.5,  40.000, };  // Temperature breakpoints for soc_min table
     float T_SOC_MIN[N_N] = {0.31,   0.31,   0.1,   0.1, };  // soc_min(t)
-#elif CHEM == 2
+}
+
+// CHINS Garage Chemistry
+namespace chm_chg
+{
     // 2024-04-24T14-51-24:  tune to data
     const uint8_t M_T = 3;    // Number temperature breakpoints for voc table
     const uint8_t N_S = 28;   // Number soc breakpoints for voc table
@@ -148,11 +173,12 @@ void Chemistry::assign_all_chm()
     const uint8_t N_N = 3; // Number of temperature breakpoints for x_soc_min table
     float X_SOC_MIN[N_N] = {21.5,  25.0, 35.0, };  // Temperature breakpoints for soc_min table
     float T_SOC_MIN[N_N] = {0.13, -0.04, -0.2, };  // soc_min(t)  ****EXTENDED MIN for model bms_off testing
-#endif
+}
 
 
-// CHINS Hysteresis
-#if( CHEM == 1 || CHEM == 2 )
+// CHINS Hysteresis, both CHINS
+namespace chm_ch_hys
+{
     const uint8_t M_H = 4;     // Number of soc breakpoints in r(soc, dv) table t_r, t_s
     const uint8_t N_H = 10;    // Number of dv breakpoints in r(dv) table t_r, t_s
     float X_DV[N_H] = // dv breakpoints for r(soc, dv) table t_r, t_s
@@ -173,7 +199,7 @@ void Chemistry::assign_all_chm()
         {0.06, 0.1, 0.1, 0.06};
     float T_DV_MIN[M_H] = // dv_max(soc) table.  Pulled values from insp of T_R where flattens
         {-0.06, -0.06, -0.06, -0.06};
-#endif
+}
 
 void Chemistry::assign_BB()
 {
@@ -202,6 +228,7 @@ void Chemistry::assign_BB()
     v_sat = 13.85;        // Saturation threshold at temperature, deg C (13.85)
 
     // VOC_SOC table
+    using namespace chm_bb;
     assign_voc_soc(N_S, M_T, X_SOC, Y_T, T_VOC);
 
     // Min SOC table
@@ -241,13 +268,22 @@ void Chemistry::assign_CH()
     vb_rising_sim = 10.75;// Shutoff point in Sim when off, V (10.75)
     v_sat = 13.85;        // Saturation threshold at temperature, deg C (13.85)
 
-    // VOC_SOC table
-    assign_voc_soc(N_S, M_T, X_SOC, Y_T, T_VOC);
-
-    // Min SOC table
-    assign_soc_min(N_N, X_SOC_MIN, T_SOC_MIN);
+    // VOC_SOC and Min SOC tables
+    if ( mod_code==2 )
+    {
+        using namespace chm_chg;
+        assign_voc_soc(N_S, M_T, X_SOC, Y_T, T_VOC);
+        assign_soc_min(N_N, X_SOC_MIN, T_SOC_MIN);
+    }
+    else
+    {
+        using namespace chm_ch;
+        assign_voc_soc(N_S, M_T, X_SOC, Y_T, T_VOC);
+        assign_soc_min(N_N, X_SOC_MIN, T_SOC_MIN);
+    }
 
     // Hys table
+    using namespace chm_ch_hys;
     assign_hys(N_H, M_H, X_DV, Y_SOC, T_R, T_S, T_DV_MAX, T_DV_MIN);
 }
 
@@ -295,6 +331,13 @@ float Chemistry::lookup_voc(const float soc, const float temp_c)
     return voc_T_->interp(soc, temp_c) + dvoc;
 }
 
+// lookup_voc for several soc at one temperature
+void Chemistry::lookup_voc_n(const double *soc, const float temp_c, double *voc, const uint8_t n)
+{
+    voc_T_->interp_n(soc, temp_c, voc, n);
+    for ( uint8_t i=0; i<n; i++ ) voc[i] += dvoc;
+}
+
 // Pretty print
 void Chemistry::pretty_print(void)
 {
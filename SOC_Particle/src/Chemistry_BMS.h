@@ -64,25 +64,32 @@ public:
   float r_sd;       // Equivalent model for EKF reference.	Parasitic discharge equivalent, ohms
   float c_sd;       // Equivalent model for EKF reference.  Parasitic discharge equivalent, Farads
   float r_ss;       // Equivalent model for state space model initialization, ohms
-  TableInterp1D *hys_Tn_;     // soc 1-D table, V_min
-  TableInterp2D *hys_Ts_;     // dv-soc 2-D table scalar
-  TableInterp1D *hys_Tx_;     // soc 1-D table, V_max
-  TableInterp2D *hys_T_;      // dv-soc 2-D table, V
-  TableInterp2D *voc_T_;      // SOC-VOC 2-D table, V
-  TableInterp1D *soc_min_T_;  // SOC-MIN 1-D table, V
+  TableInterp1D *hys_Tn_ = NULL;     // soc 1-D table, V_min
+  TableInterp2D *hys_Ts_ = NULL;     // dv-soc 2-D table scalar
+  TableInterp1D *hys_Tx_ = NULL;     // soc 1-D table, V_max
+  TableInterp2D *hys_T_ = NULL;      // dv-soc 2-D table, V
+  TableInterp2D *voc_T_ = NULL;      // SOC-VOC 2-D table, V
+  TableInterp1D *soc_min_T_ = NULL;  // SOC-MIN 1-D table, V
   Chemistry()
   {
     assign_all_chm();
   }
+  Chemistry(const uint8_t mod)
+  {
+    assign_mod(mod);
+  }
+  ~Chemistry();
   void assign_BB();   // Battleborn assignment
   void assign_CH();   // CHINS assignment
   void assign_all_chm();  // Assignment executive
+  void assign_mod(const uint8_t mod);  // Assignment by mod code, any chemistry built in
   void assign_hys(const int _n_h, const int _m_h, float *x, float *y, float *t, float *s,
     float *tx, float *tn); // Worker bee Hys
   void assign_soc_min(const int _n_n, float *x, float *t);  // Worker bee SOC_MIN
   void assign_voc_soc(const int _n_s, const int _m_t, float *x, float *y, float *t); // Worker bee VOC_SOC
   String decode(const uint8_t mod);
   float lookup_voc(const float soc, const float temp_c);
+  void lookup_voc_n(const double *soc, const float temp_c, double *voc, const uint8_t n);
   void pretty_print();
 };
 
@@ -0,0 +1,90 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef CLOCK_H_
+#define CLOCK_H_
+
+#include "application.h"
+
+// The one place the firmware reads time.   Normal builds pass straight through to Device OS.   SOFT_VIRTUAL_TIME
+// builds read a virtual clock that moves only when a driver calls Clock::step (or the firmware calls Clock::delay),
+// so two runs of loop() on the same inputs match bit for bit and run as fast as the host allows.   Time.year() etc.
+// are functions of their argument and stay as they are.   Off in the unit configs and not #undef'd in constants.h:
+// the host tools set it with -DSOFT_VIRTUAL_TIME, or add '#define SOFT_VIRTUAL_TIME' to a unit config to try it.
+class Clock
+{
+public:
+  // functions
+  static void delay(const unsigned long ms)
+  {
+    #ifdef SOFT_VIRTUAL_TIME
+      virtual_us() += (unsigned long long)ms * 1000ULL;
+    #else
+      ::delay(ms);
+    #endif
+  }
+  static unsigned long micros()
+  {
+    #ifdef SOFT_VIRTUAL_TIME
+      return (unsigned long)virtual_us();
+    #else
+      return ::micros();
+    #endif
+  }
+  static unsigned long long millis()
+  {
+    #ifdef SOFT_VIRTUAL_TIME
+      return virtual_us() / 1000ULL;
+    #else
+      return System.millis();
+    #endif
+  }
+  static time_t now()
+  {
+    #ifdef SOFT_VIRTUAL_TIME
+      return virtual_epoch() + time_t(virtual_us() / 1000000ULL);
+    #else
+      return Time.now();
+    #endif
+  }
+  static void set_time(const time_t t)
+  {
+    #ifdef SOFT_VIRTUAL_TIME
+      virtual_epoch() = t - time_t(virtual_us() / 1000000ULL);
+    #else
+      Time.setTime(t);
+    #endif
+  }
+  #ifdef SOFT_VIRTUAL_TIME
+    // Driver side
+    static void start(const unsigned long long ms, const time_t t) { virtual_us() = ms * 1000ULL; set_time(t); }
+    static void step(const unsigned long long ms) { virtual_us() += ms * 1000ULL; }
+    static void step_us(const unsigned long long us) { virtual_us() += us; }
+  protected:
+    static unsigned long long &virtual_us() { static unsigned long long us = 0ULL; return us; }  // Since boot, us
+    static time_t &virtual_epoch() { static time_t t = 0; return t; }  // Unix time at boot, s
+  #endif
+};
+
+#endif
@@ -32,11 +32,10 @@
 extern CommandPars cp;            // Various parameters to be common at system level (reset on PLC reset)
 extern PublishPars pp;            // For publishing
 
-// Assignments
-void assign_publist(Publish* pubList, const unsigned long long now, const String unit, const String hm_string,
-  Sensors* Sen, const int num_timeouts, BatteryMonitor* Mon)
+// Identity, once.   Both buffers so a flip never shows a blank unit
+void assign_identity(PublishPars *pp)
 {
-  String batt;
+  const char *batt;
   if ( CHEM == 0 )
     batt = "_bb";
   else if ( CHEM == 1 )
@@ -45,9 +44,23 @@ void assign_publist(Publish* pubList, const unsigned long long now, const String
     batt = "_chg";
   else
     batt = "_un";
+  for ( uint8_t i=0; i<2; i++ )
+    snprintf(pp->pub[i].unit, PUB_UNIT_LEN, "%s%s", unit.c_str(), batt);
+}
+
+// Assignments.   Writes the back buffer; caller flips
+void assign_publist(Publish* pubList, const unsigned long long now, const time_t time_now,
+  Sensors* Sen, const int num_timeouts, BatteryMonitor* Mon)
+{
+  static time_t hm_time = 0;
+  static char hm[PUB_HM_LEN] = "00:00";
+  if ( time_now!=hm_time )
+  {
+    hm_time = time_now;
+    time_long_2_chr(time_now, hm);   // PUB_HM_LEN fits its format
+  }
   pubList->now = now;
-  pubList->unit = unit + batt.c_str();
-  pubList->hm_string =hm_string;
+  memcpy(pubList->hm_string, hm, PUB_HM_LEN);
   pubList->Tb = Sen->Tb;
   pubList->Ib = Sen->Ib;
   pubList->tcharge = Mon->tcharge();
@@ -3,12 +3,15 @@
 
 #include "Battery.h"
 
-// Publishing
+#define PUB_UNIT_LEN    40        // unit with chemistry suffix and terminator, e.g. "g20241006_soc4p2_hi_lo_bb" (40)
+#define PUB_HM_LEN      20        // Date with terminator, "2024-10-06T12:34:56" (20)
+
+// Publishing.   Plain data so a frame copies nothing and touches no heap
 struct Publish
 {
   uint32_t now;
-  String unit;
-  String hm_string;
+  char unit[PUB_UNIT_LEN];      // Identity, formatted once by assign_identity
+  char hm_string[PUB_HM_LEN];   // Date, formatted when the second changes
   float Tb;
   float Ib;
   float Voc;
@@ -18,7 +21,9 @@ struct Publish
   float Amp_hrs_remaining_soc;
 };
 
-void assign_publist(Publish* pubList, const unsigned long long now, const String unit, const String hm_string,
+struct PublishPars;
+void assign_identity(PublishPars *pp);
+void assign_publist(Publish* pubList, const unsigned long long now, const time_t time_now,
   Sensors* Sen, const int num_timeouts, BatteryMonitor* Mon);
 
 #endif
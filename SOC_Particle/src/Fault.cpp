@@ -24,6 +24,7 @@
 #include "application.h"
 #include "Fault.h"
 #include "Sensors.h"
+#include "FltPack.h"
 
 extern SavedPars sp;       // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap; // Various adjustment parameters shared at system level
@@ -32,16 +33,16 @@ extern VolatilePars ap; // Various adjustment parameters shared at system level
 void Flt_st::assign(const unsigned long now, BatteryMonitor *Mon, Sensors *Sen)
 {
   this->t_flt = now;
-  this->Tb_hdwe = int16_t(Sen->Tb_hdwe*600.);
+  this->Tb_hdwe = int16_t(Sen->Tb_hdwe*HIST_SLR_TB);
   this->vb_hdwe = int16_t(Sen->Vb_hdwe_f/sp.nS()*sp.vb_hist_slr());
   this->ib_amp_hdwe = int16_t(Sen->Ib_amp_hdwe_f/sp.nP()*sp.ib_hist_slr());
   this->ib_noa_hdwe = int16_t(Sen->Ib_noa_hdwe_f/sp.nP()*sp.ib_hist_slr());
-  this->Tb = int16_t(Sen->Tb*600.);
+  this->Tb = int16_t(Sen->Tb*HIST_SLR_TB);
   this->vb = int16_t(Sen->Vb/sp.nS()*sp.vb_hist_slr());
   this->ib = int16_t(Sen->Ib/sp.nP()*sp.ib_hist_slr());
-  this->soc = int16_t(Mon->soc()*16000.);
-  this->soc_min = int16_t(Mon->soc_min()*16000.);
-  this->soc_ekf = int16_t(Mon->soc_ekf()*16000.);
+  this->soc = int16_t(Mon->soc()*HIST_SLR_SOC);
+  this->soc_min = int16_t(Mon->soc_min()*HIST_SLR_SOC);
+  this->soc_ekf = int16_t(Mon->soc_ekf()*HIST_SLR_SOC);
   this->voc = int16_t(Mon->voc()*sp.vb_hist_slr());
   this->voc_stat = int16_t(Mon->voc_stat()*sp.vb_hist_slr());
   this->e_wrap_filt = int16_t(Sen->Flt->e_wrap_filt()*sp.vb_hist_slr());
@@ -109,16 +110,16 @@ void Flt_st::pretty_print(const String code)
     time_long_2_str((time_t)this->t_flt, buffer);
     Serial.printf("buffer %s\n", buffer);
     Serial.printf("t %ld\n", this->t_flt);
-    Serial.printf("Tb_hdwe %7.3f\n", float(this->Tb_hdwe)/600.);
+    Serial.printf("Tb_hdwe %7.3f\n", float(this->Tb_hdwe)/HIST_SLR_TB);
     Serial.printf("vb_hdwe %7.3f\n", float(this->vb_hdwe)/sp.vb_hist_slr());
     Serial.printf("ib_amp_hdwe %7.3f\n", float(this->ib_amp_hdwe)/sp.ib_hist_slr());
     Serial.printf("ib_noa_hdwe %7.3f\n", float(this->ib_noa_hdwe)/sp.ib_hist_slr());
-    Serial.printf("Tb %7.3f\n", float(this->Tb)/600.);
+    Serial.printf("Tb %7.3f\n", float(this->Tb)/HIST_SLR_TB);
     Serial.printf("vb %7.3f\n", float(this->vb)/sp.vb_hist_slr());
     Serial.printf("ib %7.3f\n", float(this->ib)/sp.ib_hist_slr());
-    Serial.printf("soc %7.4f\n", float(this->soc)/16000.);
-    Serial.printf("soc_min %7.4f\n", float(this->soc_min)/16000.);
-    Serial.printf("soc_ekf %7.4f\n", float(this->soc_ekf)/16000.);
+    Serial.printf("soc %7.4f\n", float(this->soc)/HIST_SLR_SOC);
+    Serial.printf("soc_min %7.4f\n", float(this->soc_min)/HIST_SLR_SOC);
+    Serial.printf("soc_ekf %7.4f\n", float(this->soc_ekf)/HIST_SLR_SOC);
     Serial.printf("voc %7.3f\n", float(this->voc)/sp.vb_hist_slr());
     Serial.printf("voc_stat %7.3f\n", float(this->voc_stat)/sp.vb_hist_slr());
     Serial.printf("e_wrap_filt %7.3f\n", float(this->e_wrap_filt)/sp.vb_hist_slr());
@@ -136,37 +137,18 @@ void Flt_st::print_flt(const String code)
   if ( this->t_flt > 1UL )
   {
     time_long_2_str(this->t_flt, buffer);
-    Serial.printf("%s, %s, %ld, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.4f, %7.4f, %7.4f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %ld, %ld,\n",
+    rt.printf(ROUTE_ALL, "%s, %s, %ld, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.4f, %7.4f, %7.4f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %ld, %ld,\n",
       code.c_str(), buffer, this->t_flt,
-      float(this->Tb_hdwe)/600.,
+      float(this->Tb_hdwe)/HIST_SLR_TB,
       float(this->vb_hdwe)/sp.vb_hist_slr(),
       float(this->ib_amp_hdwe)/sp.ib_hist_slr(),
       float(this->ib_noa_hdwe)/sp.ib_hist_slr(),
-      float(this->Tb)/600.,
+      float(this->Tb)/HIST_SLR_TB,
       float(this->vb)/sp.vb_hist_slr(),
       float(this->ib)/sp.ib_hist_slr(),
-      float(this->soc)/16000.,
-      float(this->soc_min)/16000.,
-      float(this->soc_ekf)/16000.,
-      float(this->voc)/sp.vb_hist_slr(),
-      float(this->voc_stat)/sp.vb_hist_slr(),
-      float(this->e_wrap_filt)/sp.vb_hist_slr(),
-      float(this->e_wrap_m_filt)/sp.vb_hist_slr(),
-      float(this->e_wrap_n_filt)/sp.vb_hist_slr(),
-      this->fltw,
-      this->falw);
-    Serial1.printf("%s, %s, %ld, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %7.4f, %7.4f, %7.4f, %7.3f, %7.3f, %7.3f, %7.3f, %7.3f, %ld, %ld,\n",
-      code.c_str(), buffer, this->t_flt,
-      float(this->Tb_hdwe)/600.,
-      float(this->vb_hdwe)/sp.vb_hist_slr(),
-      float(this->ib_amp_hdwe)/sp.ib_hist_slr(),
-      float(this->ib_noa_hdwe)/sp.ib_hist_slr(),
-      float(this->Tb)/600.,
-      float(this->vb)/sp.vb_hist_slr(),
-      float(this->ib)/sp.ib_hist_slr(),
-      float(this->soc)/16000.,
-      float(this->soc_min)/16000.,
-      float(this->soc_ekf)/16000.,
+      float(this->soc)/HIST_SLR_SOC,
+      float(this->soc_min)/HIST_SLR_SOC,
+      float(this->soc_ekf)/HIST_SLR_SOC,
       float(this->voc)/sp.vb_hist_slr(),
       float(this->voc_stat)/sp.vb_hist_slr(),
       float(this->e_wrap_filt)/sp.vb_hist_slr(),
@@ -200,76 +182,35 @@ Flt_ram::~Flt_ram(){}
 
 // Load all
 #ifdef HDWE_47L16_EERAM
+  // Bulk read of the packed record
   void Flt_ram::get()
   {
-    get_t_flt();
-    get_Tb_hdwe();
-    get_vb_hdwe();
-    get_ib_amp_hdwe();
-    get_ib_noa_hdwe();
-    get_Tb();
-    get_vb();
-    get_ib();
-    get_soc();
-    get_soc_ekf();
-    get_voc();
-    get_voc_stat();
-    get_e_wrap_filt();
-    get_e_wrap_m_filt();
-    get_e_wrap_n_filt();
-    get_fltw();
-    get_falw();
+    uint8_t buf[FLT_PK_BYTES];
+    rP_->read_bulk(eeram_.a16, buf, FLT_PK_BYTES);
+    flt_unpack(buf, *this);
   }
 
   // Initialize each structure
   void Flt_ram::instantiate(SerialRAM *ram, uint16_t *next)
   {
-    t_flt_eeram_.a16 = *next; *next += sizeof(t_flt);
-    Tb_hdwe_eeram_.a16 = *next; *next += sizeof(Tb_hdwe);
-    vb_hdwe_eeram_.a16 = *next; *next += sizeof(vb_hdwe);
-    ib_amp_hdwe_eeram_.a16 = *next; *next += sizeof(ib_amp_hdwe);
-    ib_noa_hdwe_eeram_.a16 = *next; *next += sizeof(ib_noa_hdwe);
-    Tb_eeram_.a16 = *next; *next += sizeof(Tb);
-    vb_eeram_.a16 = *next; *next += sizeof(vb);
-    ib_eeram_.a16 = *next; *next += sizeof(ib);
-    soc_eeram_.a16 = *next; *next += sizeof(soc);
-    soc_min_eeram_.a16 = *next; *next += sizeof(soc_min);
-    soc_ekf_eeram_.a16 = *next; *next += sizeof(soc_ekf);
-    voc_eeram_.a16 = *next; *next += sizeof(voc);
-    voc_stat_eeram_.a16 = *next; *next += sizeof(voc_stat);
-    e_wrap_filt_eeram_.a16 = *next; *next += sizeof(e_wrap_filt);
-    e_wrap_m_filt_eeram_.a16 = *next; *next += sizeof(e_wrap_m_filt);
-    e_wrap_n_filt_eeram_.a16 = *next; *next += sizeof(e_wrap_n_filt);
-    fltw_eeram_.a16 = *next; *next += sizeof(fltw);
-    falw_eeram_.a16 = *next; *next += sizeof(falw);
+    eeram_.a16 = *next; *next += FLT_PK_BYTES;
     rP_ = ram;
     nominal();
   }
 #endif
 
-// Save all
-void Flt_ram::put(const Flt_st value)
+// Save all.   On the 47L16 one bulk write of the packed record in place of a write per field.   Returns the fields
+// saturated packing
+uint8_t Flt_ram::put(const Flt_st value)
 {
   copy_to_Flt_ram_from(value);
+  uint8_t n_clip = 0;
   #ifdef HDWE_47L16_EERAM
-    put_t_flt();
-    put_Tb_hdwe();
-    put_vb_hdwe();
-    put_ib_amp_hdwe();
-    put_ib_noa_hdwe();
-    put_Tb();
-    put_vb();
-    put_ib();
-    put_soc();
-    put_soc_ekf();
-    put_voc();
-    put_voc_stat();
-    put_e_wrap_filt();
-    put_e_wrap_m_filt();
-    put_e_wrap_n_filt();
-    put_fltw();
-    put_falw();
+    uint8_t buf[FLT_PK_BYTES];
+    n_clip = flt_pack(*this, buf);
+    rP_->write_bulk(eeram_.a16, buf, FLT_PK_BYTES);
   #endif
+  return n_clip;
 }
 
 // nominalize
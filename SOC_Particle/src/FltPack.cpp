@@ -0,0 +1,140 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "FltPack.h"
+#include "PrintRouter.h"
+
+extern PrintRouter rt;      // Serial and Serial1 print router
+
+
+// Bit stream, least significant bit first
+static void put_bits(uint8_t *buf, uint16_t *pos, const uint32_t val, const uint8_t bits)
+{
+  for ( uint8_t j=0; j<bits; j++, (*pos)++ )
+    if ( (val>>j) & 1UL ) buf[*pos>>3] |= uint8_t(1 << (*pos & 7));
+}
+
+static uint32_t get_bits(const uint8_t *buf, uint16_t *pos, const uint8_t bits)
+{
+  uint32_t val = 0UL;
+  for ( uint8_t j=0; j<bits; j++, (*pos)++ )
+    if ( (buf[*pos>>3] >> (*pos & 7)) & 1 ) val |= (1UL<<j);
+  return val;
+}
+
+// Offset from the floor, saturated to the width
+static void put_field(uint8_t *buf, uint16_t *pos, const int32_t val, const int32_t lo, const uint8_t bits, uint8_t *n_clip)
+{
+  const int32_t top = int32_t((1UL<<bits) - 1UL);
+  int32_t off = val - lo;
+  if ( off<0 || off>top )
+  {
+    off = constrain(off, 0, top);
+    (*n_clip)++;
+  }
+  put_bits(buf, pos, uint32_t(off), bits);
+}
+
+// Fault word, bits past the width dropped
+static void put_word(uint8_t *buf, uint16_t *pos, const uint32_t val, const uint8_t bits, uint8_t *n_clip)
+{
+  if ( bits<32 && (val>>bits) ) (*n_clip)++;
+  put_bits(buf, pos, val, bits);
+}
+
+// Records a footprint holds as structs of st_bytes and packed
+void flt_pack_capacity(const char *name, const uint32_t footprint, const uint16_t st_bytes)
+{
+  const long n_st = footprint / st_bytes;
+  const long n_pk = footprint / FLT_PK_BYTES;
+  Serial.printf(" %s %6ld B:  %4ld rec as Flt_st, %4ld packed (+%ld)\n", name, long(footprint), n_st, n_pk, n_pk - n_st);
+}
+
+// Pack one record into FLT_PK_BYTES at buf.   Returns the fields saturated
+uint8_t flt_pack(const Flt_st &rec, uint8_t *buf)
+{
+  uint8_t n_clip = 0;
+  uint16_t pos = 0;
+  memset(buf, 0, FLT_PK_BYTES);
+  put_word(buf, &pos, uint32_t(rec.t_flt), FLT_PK_T_BITS, &n_clip);
+  put_field(buf, &pos, rec.Tb_hdwe, FLT_PK_I16_LO, FLT_PK_I16_BITS, &n_clip);
+  put_field(buf, &pos, rec.vb_hdwe, FLT_PK_VB_FLOOR, FLT_PK_VB_BITS, &n_clip);
+  put_field(buf, &pos, rec.ib_amp_hdwe, FLT_PK_I16_LO, FLT_PK_I16_BITS, &n_clip);
+  put_field(buf, &pos, rec.ib_noa_hdwe, FLT_PK_I16_LO, FLT_PK_I16_BITS, &n_clip);
+  put_field(buf, &pos, rec.Tb, FLT_PK_I16_LO, FLT_PK_I16_BITS, &n_clip);
+  put_field(buf, &pos, rec.vb, FLT_PK_VB_FLOOR, FLT_PK_VB_BITS, &n_clip);
+  put_field(buf, &pos, rec.ib, FLT_PK_I16_LO, FLT_PK_I16_BITS, &n_clip);
+  put_field(buf, &pos, rec.soc, FLT_PK_SOC_FLOOR, FLT_PK_SOC_BITS, &n_clip);
+  put_field(buf, &pos, rec.soc_min, FLT_PK_SOC_FLOOR, FLT_PK_SOC_BITS, &n_clip);
+  put_field(buf, &pos, rec.soc_ekf, FLT_PK_SOC_FLOOR, FLT_PK_SOC_BITS, &n_clip);
+  put_field(buf, &pos, rec.voc, FLT_PK_VB_FLOOR, FLT_PK_VB_BITS, &n_clip);
+  put_field(buf, &pos, rec.voc_stat, FLT_PK_VB_FLOOR, FLT_PK_VB_BITS, &n_clip);
+  put_field(buf, &pos, rec.e_wrap_filt, FLT_PK_WRAP_FLOOR, FLT_PK_WRAP_BITS, &n_clip);
+  put_field(buf, &pos, rec.e_wrap_m_filt, FLT_PK_WRAP_FLOOR, FLT_PK_WRAP_BITS, &n_clip);
+  put_field(buf, &pos, rec.e_wrap_n_filt, FLT_PK_WRAP_FLOOR, FLT_PK_WRAP_BITS, &n_clip);
+  put_word(buf, &pos, rec.fltw, NUM_FLT, &n_clip);
+  put_word(buf, &pos, rec.falw, NUM_FA, &n_clip);
+  return n_clip;
+}
+
+// One record as a line of hex, the 'Hp' dump
+void flt_print_pk(const Flt_st &rec)
+{
+  static const char hex[] = "0123456789abcdef";
+  uint8_t buf[FLT_PK_BYTES];
+  char str[2*FLT_PK_BYTES+1];
+  flt_pack(rec, buf);
+  for ( uint16_t j=0; j<FLT_PK_BYTES; j++ )
+  {
+    str[2*j] = hex[buf[j]>>4];
+    str[2*j+1] = hex[buf[j] & 0xF];
+  }
+  str[2*FLT_PK_BYTES] = '\0';
+  rt.printf(ROUTE_ALL, "pk, %s,\n", str);
+}
+
+// Unpack FLT_PK_BYTES at buf into rec
+void flt_unpack(const uint8_t *buf, Flt_st &rec)
+{
+  uint16_t pos = 0;
+  rec.t_flt = get_bits(buf, &pos, FLT_PK_T_BITS);
+  rec.Tb_hdwe = int16_t(FLT_PK_I16_LO + int32_t(get_bits(buf, &pos, FLT_PK_I16_BITS)));
+  rec.vb_hdwe = int16_t(FLT_PK_VB_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_VB_BITS)));
+  rec.ib_amp_hdwe = int16_t(FLT_PK_I16_LO + int32_t(get_bits(buf, &pos, FLT_PK_I16_BITS)));
+  rec.ib_noa_hdwe = int16_t(FLT_PK_I16_LO + int32_t(get_bits(buf, &pos, FLT_PK_I16_BITS)));
+  rec.Tb = int16_t(FLT_PK_I16_LO + int32_t(get_bits(buf, &pos, FLT_PK_I16_BITS)));
+  rec.vb = int16_t(FLT_PK_VB_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_VB_BITS)));
+  rec.ib = int16_t(FLT_PK_I16_LO + int32_t(get_bits(buf, &pos, FLT_PK_I16_BITS)));
+  rec.soc = int16_t(FLT_PK_SOC_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_SOC_BITS)));
+  rec.soc_min = int16_t(FLT_PK_SOC_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_SOC_BITS)));
+  rec.soc_ekf = int16_t(FLT_PK_SOC_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_SOC_BITS)));
+  rec.voc = int16_t(FLT_PK_VB_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_VB_BITS)));
+  rec.voc_stat = int16_t(FLT_PK_VB_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_VB_BITS)));
+  rec.e_wrap_filt = int16_t(FLT_PK_WRAP_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_WRAP_BITS)));
+  rec.e_wrap_m_filt = int16_t(FLT_PK_WRAP_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_WRAP_BITS)));
+  rec.e_wrap_n_filt = int16_t(FLT_PK_WRAP_FLOOR + int32_t(get_bits(buf, &pos, FLT_PK_WRAP_BITS)));
+  rec.fltw = get_bits(buf, &pos, NUM_FLT);
+  rec.falw = get_bits(buf, &pos, NUM_FA);
+  rec.dummy = 0UL;
+}
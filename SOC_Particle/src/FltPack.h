@@ -0,0 +1,84 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _FLT_PACK_H
+#define _FLT_PACK_H
+
+#include "Fault.h"
+#include "Sensors.h"
+
+// Packed Flt_st, the form of a record in EERAM and in the 'Hp' dump.   Fields go in declaration order, least
+// significant bit first, each as its offset from a floor in the fewest bits that reach its ceiling at the nominal
+// scaling (HIST_SLR_*).   A value past either end saturates and is counted.   Each record starts on a byte so it
+// can be read or written alone.   dummy is not kept.
+#define FLT_PK_VB_LO    -1.       // Voltage floor, vb vb_hdwe voc voc_stat, V (-1.)
+#define FLT_PK_VB_HI    VB_MAX    // Voltage ceiling, V (17.)
+#define FLT_PK_SOC_LO   -0.5      // State of charge floor, soc soc_min soc_ekf, frac (-0.5)
+#define FLT_PK_SOC_HI   1.5       // State of charge ceiling, frac (1.5)
+#define FLT_PK_WRAP     MAX_WRAP_ERR_FILT   // Wrap error range, +/-, V (10.)
+
+// Bits to hold 0 - span
+constexpr uint8_t flt_pk_bits(const uint32_t span, const uint8_t b=1)
+{
+  return ( b>=32 || (1UL<<b) > span ) ? b : flt_pk_bits(span, b+1);
+}
+
+// Field floors, counts, and widths.   Tb and ib keep the whole int16:  TEMP_RANGE_CHECK_MAX and the sensor
+// ranges are already past what the int16 holds at HIST_SLR_TB and HIST_SLR_IB
+constexpr uint8_t FLT_PK_T_BITS = 32;
+constexpr int32_t FLT_PK_I16_LO = -32768;
+constexpr uint8_t FLT_PK_I16_BITS = 16;
+constexpr int32_t FLT_PK_VB_FLOOR = int32_t(FLT_PK_VB_LO*HIST_SLR_VB);
+constexpr uint8_t FLT_PK_VB_BITS = flt_pk_bits(uint32_t((FLT_PK_VB_HI - FLT_PK_VB_LO)*HIST_SLR_VB));
+constexpr int32_t FLT_PK_SOC_FLOOR = int32_t(FLT_PK_SOC_LO*HIST_SLR_SOC);
+constexpr uint8_t FLT_PK_SOC_BITS = flt_pk_bits(uint32_t((FLT_PK_SOC_HI - FLT_PK_SOC_LO)*HIST_SLR_SOC));
+constexpr int32_t FLT_PK_WRAP_FLOOR = int32_t(-FLT_PK_WRAP*HIST_SLR_VB);
+constexpr uint8_t FLT_PK_WRAP_BITS = flt_pk_bits(uint32_t(2.*FLT_PK_WRAP*HIST_SLR_VB));
+constexpr uint16_t FLT_PK_BITS = FLT_PK_T_BITS + 5*FLT_PK_I16_BITS + 4*FLT_PK_VB_BITS + 3*FLT_PK_SOC_BITS
+  + 3*FLT_PK_WRAP_BITS + NUM_FLT + NUM_FA;
+constexpr uint16_t FLT_PK_BYTES = (FLT_PK_BITS + 7) / 8;   // One packed record, bytes (38)
+
+// Function prototypes
+void flt_pack_capacity(const char *name, const uint32_t footprint, const uint16_t st_bytes);
+uint8_t flt_pack(const Flt_st &rec, uint8_t *buf);
+void flt_print_pk(const Flt_st &rec);
+void flt_unpack(const uint8_t *buf, Flt_st &rec);
+
+// A whole array into one contiguous buffer of n*FLT_PK_BYTES, e.g. for a single bulk EERAM transfer.   T is Flt_st
+// or Flt_ram.   Returns the fields saturated
+template <typename T>
+uint16_t flt_pack_array(const T *recs, const uint16_t n, uint8_t *buf)
+{
+  uint16_t n_clip = 0;
+  for ( uint16_t i=0; i<n; i++ ) n_clip += flt_pack(recs[i], &buf[i*FLT_PK_BYTES]);
+  return n_clip;
+}
+
+template <typename T>
+void flt_unpack_array(const uint8_t *buf, const uint16_t n, T *recs)
+{
+  for ( uint16_t i=0; i<n; i++ ) flt_unpack(&buf[i*FLT_PK_BYTES], recs[i]);
+}
+
+#endif
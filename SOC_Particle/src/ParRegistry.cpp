@@ -0,0 +1,138 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "ParRegistry.h"
+#include "constants.h"
+#include "Battery.h"
+#include "CapacityEst.h"
+#include "hardware/SerialRAM.h"
+
+
+/* Talk-adjustable parameters.   Entries go in the order VolatilePars::initialize and SavedPars::initialize make their
+    Variables, which are built from them in that order.   Volatile parameters are never EERAM.   The fault and
+    history indices (if, ih) are sized at NFLT and NHIS here; SavedPars resizes them to its buffers.
+*/
+//    code  type         saved  check  description             units        min           max            nominal
+constexpr ParDef VOL_DEFS[NVOL] = {
+    {"Fc", PAR_FLOAT,   false, true,  "Slr cc_diff thr",      "slr",       0,            1000,          1},
+    {"XC", PAR_FLOAT,   false, true,  "Number prog cycle",    "float",     0,            1000,          0},
+    {"Xd", PAR_BOOLEAN, false, true,  "DC-DC charger on",     "T=on",      0,            1,             false},
+    {"FI", PAR_BOOLEAN, false, true,  "Disab hard range ib",  "T=disab",   0,            1,             false},
+    {"FT", PAR_BOOLEAN, false, true,  "Disab hard range tb",  "T=disab",   0,            1,             false},
+    {"FV", PAR_BOOLEAN, false, true,  "Disab hard range vb",  "T=disab",   0,            1,             false},
+    {"HN", PAR_UINT8,   false, true,  "Dump recs per pass",   "uint",      1,            UINT8_MAX,     DUMP_N},
+    {"Ds", PAR_FLOAT,   false, true,  "VOC(SOC) del soc",     "slr",       -0.5,         0.5,           NOM_DS},
+    {"Dy", PAR_FLOAT,   false, true,  "VOC(SOC) del v",       "v",         -50,          50,            NOM_DY},
+    {"DE", PAR_UINT8,   false, true,  "EKF frame rate x Dr",  "uint",      0,            UINT8_MAX,     EKF_EFRAME_MULT},
+    {"Fi", PAR_FLOAT,   false, true,  "Slr wrap hi thr",      "slr",       0,            1000,          1},
+    {"Fo", PAR_FLOAT,   false, true,  "Slr wrap lo thr",      "slr",       0,            1000,          1},
+    {"Xu", PAR_BOOLEAN, false, true,  "Ignore Tb & fail",     "T=Fail",    false,        true,          false},
+    {"Ff", PAR_BOOLEAN, false, true,  "Faults ignored",       "T=ign",     0,            1,             FAKE_FAULTS},
+    {"DF", PAR_FLOAT,   false, true,  "Ib/Vb hum notch",      "Hz",        0,            HUM_FS/2.,     0},
+    {"Sh", PAR_FLOAT,   false, true,  "Sim hys scale",        "slr",       0,            100,           HYS_SCALE},
+    {"SH", PAR_FLOAT,   false, true,  "Sim hys state",        "v",         -10,          10,            0},
+    {"DM", PAR_FLOAT,   false, true,  "Amp amp noise",        "A",         0,            1000,          IB_AMP_NOISE},
+    {"Dm", PAR_FLOAT,   false, true,  "Amp signal add",       "A",         -1000,        1000,          0},
+    {"Mm", PAR_FLOAT,   false, true,  "Amp hdwe unit max",    "A",         0,            __FLT_MAX__,   (IB_ABS_MAX_AMP/NP/0.95)},
+    {"Mn", PAR_FLOAT,   false, true,  "Amp hdwe unit min",    "A",         -__FLT_MAX__, 0,             (-IB_ABS_MAX_AMP/NP/0.95)},
+    {"Fd", PAR_FLOAT,   false, true,  "Slr ib_diff thr",      "A",         0,            1000,          1},
+    {"DN", PAR_FLOAT,   false, true,  "Amp noa noise",        "A",         0,            1000,          IB_NOA_NOISE},
+    {"Dn", PAR_FLOAT,   false, true,  "No amp signal add",    "A",         -1000,        1000,          0},
+    {"Nm", PAR_FLOAT,   false, true,  "Noa hdwe signal max",  "A",         0,            __FLT_MAX__,   (IB_ABS_MAX_NOA/NP/0.95)},
+    {"Nn", PAR_FLOAT,   false, true,  "Noa hdwe signal min",  "A",         -__FLT_MAX__, 0,             (-IB_ABS_MAX_NOA/NP/0.95)},
+    {"Fq", PAR_FLOAT,   false, true,  "Ib quiet det slr",     "slr",       0,            1000,          1},
+    {"Ca", PAR_FLOAT,   false, true,  "Init all to this",     "soc",       -0.5,         1.1,           1},
+    {"Cm", PAR_FLOAT,   false, true,  "Init sim to this",     "soc",       -0.5,         1.1,           1},
+    {"DP", PAR_UINT8,   false, true,  "Print mult x Dr",      "uint",      0,            UINT8_MAX,     DP_MULT},
+    {"Dr", PAR_ULONG,   false, true,  "Minor frame",          "ms",        0UL,          1000000UL,     READ_DELAY},
+    {"Sr", PAR_FLOAT,   false, true,  "Scalar Randles R0",    "slr",       0,            100,           1},
+    {"Xs", PAR_FLOAT,   false, true,  "Scalar on T_SAT",      "slr",       0,            100,           1},
+    {"Dh", PAR_ULONG,   false, true,  "Summary frame",        "ms",        1000UL,       SUMMARY_DELAY, SUMMARY_DELAY},
+    {"XT", PAR_ULONG,   false, true,  "Tail end inj",         "ms",        0UL,          120000UL,      0UL},
+    {"D>", PAR_ULONG,   false, true,  "Talk frame",           "ms",        0UL,          120000UL,      TALK_DELAY},
+    {"D^", PAR_FLOAT,   false, true,  "Del model",            "dg C",      -120,         50,            TEMP_BIAS},
+    {"DT", PAR_FLOAT,   false, true,  "Tb noise",             "dg C pk-pk",0,            50,            TB_NOISE},
+    {"Xv", PAR_FLOAT,   false, true,  "Scale Tb 1-wire pers", "slr",       0,            100,           1},
+    {"DK", PAR_BOOLEAN, false, true,  "soc_ekf from UKF",     "T=UKF",     0,            1,             false},
+    {"XQ", PAR_ULONG,   false, true,  "Time until vv0",       "ms",        0UL,          1000000UL,     0UL},
+    {"Dv", PAR_FLOAT,   false, true,  "Bias on vb",           "v",         -15,          15,            0},
+    {"DV", PAR_FLOAT,   false, true,  "Vb noise",             "v pk-pk",   0,            10,            VB_NOISE},
+    {"D3", PAR_FLOAT,   false, true,  "Bias on Vc/Vr",        "v",         -1.65,        0.85,          0},
+    {"XW", PAR_ULONG,   false, true,  "Wait start inj",       "ms",        0UL,          120000UL,      0UL},
+};
+
+constexpr ParDef SAV_DEFS[NSAV] = {
+    {"Xa", PAR_FLOAT,   true,  true,  "Inj amp",              "Amps pk",   -1e6,         1e6,           0},
+    {"qc", PAR_FLOAT,   true,  false, "Cap est Mon",          "slr",       CAP_MIN,      CAP_MAX,       1.},
+    {"qn", PAR_UINT16,  true,  false, "Cap est count",        "uint",      0,            65535,         0},
+    {"qv", PAR_FLOAT,   true,  false, "Cap est variance",     "slr^2",     0,            1,             CAP_SD_INIT*CAP_SD_INIT},
+    {"Sk", PAR_FLOAT,   true,  true,  "Cutback gain scalar",  "slr",       -1e6,         1e6,           1},
+    {"vv", PAR_INT,     true,  true,  "Verbosity",            "int",       -128,         128,           0},
+    {"qs", PAR_DOUBLE,  true,  false, "Charge chg Sim",       "C",         -1e8,         1e5,           0},
+    {"qm", PAR_DOUBLE,  true,  false, "Charge chg",           "C",         -1e8,         1e5,           0},
+    {"Dw", PAR_FLOAT,   true,  true,  "Tab mon adj",          "v",         -1e2,         1e2,           VTAB_BIAS},
+    {"Xf", PAR_FLOAT,   true,  true,  "Inj freq",             "Hz",        0,            2,             0},
+    {"DI", PAR_FLOAT,   true,  true,  "Del all",              "A",         -1e5,         1e5,           CURR_BIAS_ALL},
+    {"DA", PAR_FLOAT,   true,  true,  "Add amp",              "A",         -1e5,         1e5,           CURR_BIAS_AMP},
+    {"DB", PAR_FLOAT,   true,  true,  "Add noa",              "A",         -1e5,         1e5,           CURR_BIAS_NOA},
+    {"SA", PAR_FLOAT,   true,  true,  "Slr amp",              "A",         -1e5,         1e5,           CURR_SCALE_AMP},
+    {"SB", PAR_FLOAT,   true,  true,  "Slr noa",              "A",         -1e5,         1e5,           CURR_SCALE_NOA},
+    {"SD", PAR_FLOAT,   true,  true,  "Slr disch",            "slr",       -1e5,         1e5,           CURR_SCALE_DISCH},
+    #ifdef HDWE_IB_HI_LO
+    {"si", PAR_INT8,    true,  true,  "curr sel mode",        "(-1, 0, 1)",-1,           1,             int8_t(0)},
+    #else
+    {"si", PAR_INT8,    true,  true,  "curr sel mode",        "(-1, 0, 1)",-1,           1,             int8_t(FAKE_FAULTS)},
+    #endif
+    {"if", PAR_UINT16,  true,  false, "Fault buffer indx",    "uint",      0,            NFLT+1,        NFLT},
+    {"ih", PAR_UINT16,  true,  false, "Hist buffer indx",     "uint",      0,            NHIS+1,        NHIS},
+    {"Xb", PAR_FLOAT,   true,  true,  "Injection bias",       "A",         -1e5,         1e5,           0.},
+    {"is", PAR_UINT16,  true,  false, "Summ buffer indx",     "uint",      0,            NSUM+1,        NSUM},
+    {"Xm", PAR_UINT8,   true,  true,  "Modeling bitmap",      "[0x]",      0,            255,           MODELING},
+    {"BP", PAR_FLOAT,   true,  true,  "Number parallel",      "units",     1e-6,         100,           NP},
+    {"BS", PAR_FLOAT,   true,  true,  "Number series",        "units",     1e-6,         100,           NS},
+    {"X?", PAR_UINT8,   true,  false, "Preserving fault",     "T=Preserve",0,            1,             0},
+    {"SQ", PAR_FLOAT,   true,  true,  "Scalar cap Mon",       "slr",       0,            1000,          1.},
+    {"Sq", PAR_FLOAT,   true,  true,  "Scalar cap Sim",       "slr",       0,            1000,          1.},
+    {"Dt", PAR_FLOAT,   true,  true,  "Bias Tb sensor",       "dg C",      -500,         500,           TEMP_BIAS},
+    {"UT", PAR_ULONG,   true,  false, "UNIX time epoch",      "sec",       0UL,          2100000000UL,  1669801880UL},
+    {"Xt", PAR_UINT8,   true,  true,  "Inj type",             "1sn 2sq 3tr 4 1C, 5 -1C, 8cs 9pb", 0, 10, 0},
+    {"ts", PAR_FLOAT,   true,  false, "Tb Sim rate lim mem",  "dg C",      -10,          70,            RATED_TEMP},
+    {"tm", PAR_FLOAT,   true,  false, "Tb rate lim mem",      "dg C",      -10,          70,            RATED_TEMP},
+    {"Dc", PAR_FLOAT,   true,  true,  "Bias Vb sensor",       "v",         -10,          70,            VOLT_BIAS},
+    {"SV", PAR_FLOAT,   true,  true,  "Scale Vb sensor",      "v",         -1e5,         1e5,           VB_SCALE},
+};
+
+// SavedPars EERAM block
+constexpr ParMap<NSAV> SAV_MAP(SAV_DEFS);
+#ifdef HDWE_47L16_EERAM
+  static_assert(SAV_MAP.addr[NSAV] < MAX_EERAM, "SAV_DEFS past MAX_EERAM");
+#endif
+
+
+// Entry of code in a table, NULL if none
+const ParDef *par_find(const ParDef *defs, const uint8_t n, const char *code)
+{
+  for ( uint8_t i=0; i<n; i++ ) if ( !strncmp(defs[i].code, code, 2) ) return &defs[i];
+  return NULL;
+}
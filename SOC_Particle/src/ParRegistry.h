@@ -0,0 +1,79 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _PAR_REGISTRY_H
+#define _PAR_REGISTRY_H
+
+#include "application.h"
+
+#define NVOL  45    // Volatile parameters, VolatilePars (45)
+#define NSAV  34    // Saved parameters, SavedPars (34)
+
+// Storage type of a parameter, one per Variable class
+enum ParType : uint8_t {PAR_BOOLEAN, PAR_DOUBLE, PAR_FLOAT, PAR_INT, PAR_INT8, PAR_UINT16, PAR_UINT8, PAR_ULONG};
+
+/* Metadata of one talk-adjustable parameter.   The tables VOL_DEFS and SAV_DEFS are constexpr so codes,
+    descriptions, units, limits and nominals stay in flash; a Variable keeps a pointer to its entry and to the RAM
+    store.   Limits and nominal are held as double and cast to the storage type, as the Variable constructors did
+    with their arguments.   Descriptions print to 20 characters and units to 10.
+*/
+struct ParDef
+{
+  const char *code;         // Talk code, two characters
+  uint8_t type;             // ParType
+  boolean saved;            // Kept through power cycle, prints as "* "
+  boolean check;            // Range check on construction and count when off nominal
+  const char *description;
+  const char *units;
+  double min;
+  double max;
+  double nominal;
+};
+
+// Bytes each type takes in EERAM, as the Variable classes put them
+constexpr uint8_t par_size(const uint8_t type)
+{
+  return type==PAR_BOOLEAN ? sizeof(boolean) : type==PAR_DOUBLE ? sizeof(double) : type==PAR_FLOAT ? sizeof(float)
+    : type==PAR_INT ? sizeof(int) : type==PAR_INT8 ? sizeof(int8_t) : type==PAR_UINT16 ? sizeof(uint16_t)
+    : type==PAR_UINT8 ? sizeof(uint8_t) : sizeof(unsigned long);
+}
+
+// EERAM layout of a table:  each entry follows the one before, from 0.   addr[N] is the size of the block
+template <uint8_t N>
+struct ParMap
+{
+  uint16_t addr[N+1];
+  constexpr ParMap(const ParDef (&defs)[N]) : addr()
+  {
+    for ( uint8_t i=0; i<N; i++ ) addr[i+1] = addr[i] + par_size(defs[i].type);
+  }
+};
+
+extern const ParDef VOL_DEFS[NVOL];
+extern const ParDef SAV_DEFS[NSAV];
+extern const ParMap<NSAV> SAV_MAP;
+
+// Entry of code in a table, NULL if none
+const ParDef *par_find(const ParDef *defs, const uint8_t n, const char *code);
+
+#endif
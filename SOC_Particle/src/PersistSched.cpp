@@ -0,0 +1,233 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "constants.h"
+#include "PersistSched.h"
+
+
+// class PersistSched
+PersistSched::PersistSched()
+  : nf_(0), n_over_(0), t_last_(-1.), tokens_(PS_N_EERAM), whole_block_(false){}
+PersistSched::~PersistSched() {}
+
+// Schedule a Variable.   What its RAM holds now is taken as already stored.   Returns the field index, -1 if full
+int8_t PersistSched::add(const char *code, Variable *var, const double tol, const float t_stale)
+{
+  if ( nf_>=PS_NF || var==NULL ) return -1;
+  PersistField *f = &f_[nf_];
+  memset(f, 0, sizeof(PersistField));
+  f->code = code;
+  f->var = var;
+  f->tol = max(tol, 1e-12);
+  f->t_stale = t_stale;
+  f->stored = var->value();
+  return nf_++;
+}
+
+// Schedule a record array, stored an entry at a time as mark_rec queues them.   Returns the field index, -1 if full
+int8_t PersistSched::add_rec(const char *code, rec_put put_rec, const float t_stale)
+{
+  if ( nf_>=PS_NF || put_rec==NULL ) return -1;
+  PersistField *f = &f_[nf_];
+  memset(f, 0, sizeof(PersistField));
+  f->code = code;
+  f->put_rec = put_rec;
+  f->tol = 1.;
+  f->t_stale = t_stale;
+  return nf_++;
+}
+
+// Queue record i of field k.   One entry waits at a time:  one still waiting is stored now
+void PersistSched::mark_rec(const int8_t k, const uint16_t i, const double t)
+{
+  if ( k<0 || k>=nf_ || f_[k].put_rec==NULL ) return;
+  PersistField *f = &f_[k];
+  if ( f->dirty )
+  {
+    if ( whole_block_ ) save_block_(t);
+    else
+    {
+      put_(f, t, true);
+      spend_();
+    }
+  }
+  f->i_rec = i;
+  f->dirty = true;
+  f->t_dirty = t;
+}
+
+// Print
+void PersistSched::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  double t = t_last_;
+  if ( whole_block_ )
+    Serial.printf("PersistSched:  retained block, Device OS saves every %2.0f s\n", PS_T_OS_SYNC);
+  else
+    Serial.printf("PersistSched:  eeram fields, budget %4.1f per %4.0f s, tokens %5.1f\n", PS_N_EERAM, PS_T_BUDGET, tokens_);
+  Serial.printf(" n_over %ld\n", (long)n_over_);
+  Serial.printf(" code      tol t_stale   n_put  forced   bytes lat_avg lat_max   stale\n");
+  for ( uint8_t k=0; k<nf_; k++ )
+  {
+    PersistField *f = &f_[k];
+    Serial.printf(" %-4s %8.3g %7.0f %7ld %7ld %7ld %7.1f %7.1f %7.1f\n", f->code, f->tol, f->t_stale, (long)f->n_put,
+      (long)f->n_forced, (long)f->n_bytes, f->n_put ? f->lat_sum/double(f->n_put) : 0., f->lat_max, staleness(k, t));
+  }
+#else
+  Serial.printf("PersistSched: silent DEPLOY\n");
+#endif
+}
+
+// Zero the wear and latency counters
+void PersistSched::reset_counts()
+{
+  n_over_ = 0;
+  for ( uint8_t k=0; k<nf_; k++ )
+  {
+    f_[k].n_put = f_[k].n_bytes = f_[k].n_forced = 0;
+    f_[k].lat_max = 0.;
+    f_[k].lat_sum = 0.;
+  }
+}
+
+// Age of the unstored change in field k, 0 if stored, s
+float PersistSched::staleness(const uint8_t k, const double t)
+{
+  if ( k>=nf_ || !f_[k].dirty ) return 0.;
+  return max(t - f_[k].t_dirty, 0.);
+}
+
+/* PersistSched::update:  Refill the budget, note changes, store what is stale then what is most urgent
+Inputs:
+  t               Time, s
+  f_[].var        RAM values of the scheduled Variables
+Outputs:
+  f_[]            Stored values, counters
+  returns         Fields stored this pass
+*/
+uint8_t PersistSched::update(const double t)
+{
+  if ( t_last_>=0. ) tokens_ = min(tokens_ + float((t - t_last_) * PS_N_EERAM / PS_T_BUDGET), PS_N_EERAM);
+  t_last_ = t;
+
+  // Changes since stored
+  for ( uint8_t k=0; k<nf_; k++ )
+  {
+    PersistField *f = &f_[k];
+    if ( f->var && !f->dirty && f->var->value()!=f->stored )
+    {
+      f->dirty = true;
+      f->t_dirty = t;
+    }
+  }
+
+  // One block:  hand every change to it, the Device OS saves it
+  if ( whole_block_ ) return save_block_(t);
+
+  // Fields:  stale ones first regardless of budget, then by urgency while the budget lasts
+  uint8_t n = 0;
+  for ( uint8_t k=0; k<nf_; k++ )
+  {
+    PersistField *f = &f_[k];
+    if ( f->dirty && t - f->t_dirty >= f->t_stale )
+    {
+      put_(f, t, true);
+      spend_();
+      n++;
+    }
+  }
+  while ( tokens_>=1. )
+  {
+    PersistField *best = NULL;
+    float u_best = 1.;
+    for ( uint8_t k=0; k<nf_; k++ )
+    {
+      PersistField *f = &f_[k];
+      if ( !f->dirty ) continue;
+      float u = urgency_(f);
+      if ( u>=u_best )
+      {
+        u_best = u;
+        best = f;
+      }
+    }
+    if ( best==NULL ) break;
+    put_(best, t, false);
+    spend_();
+    n++;
+  }
+  return n;
+}
+
+// Store one field and count it.   On Photon 2 the bytes only reach retained RAM, saved by the Device OS
+uint16_t PersistSched::put_(PersistField *f, const double t, const boolean forced)
+{
+  uint16_t bytes;
+  if ( f->var )
+  {
+    bytes = f->var->put();
+    f->stored = f->var->value();
+  }
+  else
+    bytes = f->put_rec(f->i_rec);
+  float lat = max(t - f->t_dirty, 0.);
+  f->dirty = false;
+  f->n_put++;
+  f->n_bytes += bytes;
+  if ( forced ) f->n_forced++;
+  f->lat_max = max(f->lat_max, lat);
+  f->lat_sum += lat;
+  return bytes;
+}
+
+// Store every waiting field in the retained block.   No budget:  nothing reaches flash until the Device OS saves
+uint8_t PersistSched::save_block_(const double t)
+{
+  uint8_t n = 0;
+  for ( uint8_t k=0; k<nf_; k++ )
+  {
+    PersistField *f = &f_[k];
+    if ( f->dirty )
+    {
+      put_(f, t, t - f->t_dirty >= f->t_stale);
+      n++;
+    }
+  }
+  return n;
+}
+
+// Take a write from the budget.   Stale writes may overdraw it
+void PersistSched::spend_()
+{
+  tokens_ -= 1.;
+  if ( tokens_<0. ) n_over_++;
+}
+
+// Change since stored over the tolerance.   A waiting record counts PS_URG_REC
+float PersistSched::urgency_(PersistField *f)
+{
+  if ( !f->dirty ) return 0.;
+  if ( f->var==NULL ) return PS_URG_REC;
+  return fabs(f->var->value() - f->stored) / f->tol;
+}
@@ -0,0 +1,107 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _PERSIST_SCHED_H
+#define _PERSIST_SCHED_H
+
+#include "application.h"
+#include "Variable.h"
+
+#define PS_NF           8         // Most fields scheduled (8)
+#define PS_T_BUDGET     60.       // Write budget window, s (60.)
+#define PS_N_EERAM      30.       // Field writes allowed per window on the 47L16, about 3/5 of the old round-robin (30.)
+#define PS_T_OS_SYNC    10.       // Device OS pace of backup RAM saves on Photon 2, s (10.)
+#define PS_URG_REC      1.        // Urgency of a pending record, same as a field changed by its tolerance (1.)
+
+// Fields SavedPars::persist schedules
+#define PS_TOL_DQ       36.       // Change of delta_q worth a write, 0.01 Ah, C (36.)
+#define PS_T_STALE_DQ   30.       // Longest delta_q goes unstored, s (30.)
+#define PS_TOL_T        0.5       // Change of T_state worth a write, deg C (0.5)
+#define PS_T_STALE_T    120.      // Longest T_state goes unstored, s (120.)
+#define PS_TOL_UT       3600.     // Change of Time_now worth a write, s (3600.)
+#define PS_T_STALE_UT   600.      // Longest Time_now goes unstored, s (600.)
+#define PS_T_STALE_REC  10.       // Longest a new history record goes unstored, s (10.)
+
+typedef uint16_t (*rec_put)(const uint16_t i);  // Stores record i, returns bytes written
+
+// One scheduled field:  a Variable stored through its put(), or a record array stored one entry at a time by
+// put_rec.   Wear and latency counters accumulate from boot.
+struct PersistField
+{
+  const char *code;     // Variable code or record name
+  Variable *var;        // Field stored by var->put(), NULL for a record
+  rec_put put_rec;      // Record store, NULL for a Variable
+  double tol;           // Change worth a write, units of the field
+  float t_stale;        // Longest an unstored change may wait, s
+  double stored;        // Value as last stored, units of the field
+  boolean dirty;        // Unstored change, T=dirty
+  uint16_t i_rec;       // Record index waiting to be stored
+  double t_dirty;       // Time the unstored change was first seen, s
+  uint32_t n_put;       // Writes
+  uint32_t n_bytes;     // Bytes written
+  uint32_t n_forced;    // Writes forced by t_stale
+  float lat_max;        // Longest wait from change to store, s
+  double lat_sum;       // Sum of waits, s
+};
+
+// Persistence scheduler for the dynamic saved parameters (delta_q, T_state, Time_now...) and the history records.
+// Replaces the fixed round-robin of SavedPars::put_all_dynamic.   Called each display_and_remember pass.   A token
+// bucket allows PS_N_EERAM field writes (47L16) per PS_T_BUDGET, refilled continuously.   Within it fields go in
+// order of urgency, their change since stored over their tolerance; those below one wait.   A change left unstored
+// for t_stale is written regardless of the budget (counted n_forced), so on power loss every field holds a value the
+// RAM had no more than t_stale plus one pass earlier.   Photon 2 retains everything in one block that the Device OS
+// saves to flash on its own pace (PS_T_OS_SYNC).   A System.backupRamSync() from here would only add flash wear, so
+// there changes are handed to the block each pass and only counted.
+class PersistSched
+{
+public:
+  PersistSched();
+  ~PersistSched();
+  // operators
+  // functions
+  int8_t add(const char *code, Variable *var, const double tol, const float t_stale);
+  int8_t add_rec(const char *code, rec_put put_rec, const float t_stale);
+  PersistField *field(const uint8_t k) { return ( k<nf_ ) ? &f_[k] : NULL; };
+  void mark_rec(const int8_t k, const uint16_t i, const double t);
+  uint8_t nf() { return nf_; };
+  uint32_t n_over() { return n_over_; };
+  void pretty_print();
+  void reset_counts();
+  float staleness(const uint8_t k, const double t);
+  uint8_t update(const double t);
+  void whole_block(const boolean whole) { whole_block_ = whole; };
+protected:
+  PersistField f_[PS_NF];   // Fields
+  uint8_t nf_;              // Fields added
+  uint32_t n_over_;         // Writes beyond the budget to meet t_stale
+  double t_last_;           // Time of last update, s
+  float tokens_;            // Writes left in the budget
+  boolean whole_block_;     // Store is one block (Photon 2 backup RAM), T=block
+  uint16_t put_(PersistField *f, const double t, const boolean forced);
+  uint8_t save_block_(const double t);
+  void spend_();
+  float urgency_(PersistField *f);
+};
+
+#endif
@@ -0,0 +1,191 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "PrintRouter.h"
+#include "Clock.h"
+#include <stdarg.h>
+
+
+// class PrintSink
+PrintSink::PrintSink(const char *name)
+  : dropped_(0), dropped_rapid_(0), head_(0), listing_(false), n_(0), n_max_(0), name_(name), sent_(0), stalled_(false)
+{}
+PrintSink::~PrintSink() {}
+
+void PrintSink::pretty_print()
+{
+  Serial.printf(" %-6s sent %ld dropped %ld dropped_rapid %ld queued %d max %d of %d%s\n", name_, sent_, dropped_, dropped_rapid_, n_, n_max_, PRINT_QUEUE,
+    stalled_ ? " stalled" : "");
+}
+
+// Wait for the port to take the whole queue, giving up once it takes nothing for PRINT_WAIT_MS.   Returns true
+// when empty
+boolean PrintSink::flush()
+{
+  unsigned long long start = Clock::millis();
+  pump();
+  while ( n_ && !stalled_ )
+  {
+    uint16_t n_past = n_;
+    Clock::delay(1);
+    pump();
+    if ( n_<n_past ) start = Clock::millis();
+    else if ( Clock::millis() - start >= PRINT_WAIT_MS ) stalled_ = true;
+  }
+  return ( n_==0 );
+}
+
+// Move queued bytes to the port as far as it has room.  Never waits
+void PrintSink::pump()
+{
+  while ( n_ )
+  {
+    size_t len = min((size_t)n_, (size_t)(PRINT_QUEUE - head_));  // contiguous run
+    len = min(len, port_room());
+    if ( len==0 ) return;
+    size_t sent = port_write(&q_[head_], len);
+    if ( sent==0 ) return;
+    head_ = (head_ + sent) % PRINT_QUEUE;
+    n_ -= sent;
+  }
+  stalled_ = false;
+}
+
+// Queue one message.  Normal messages leave PRINT_RESERVE for the rapid stream
+boolean PrintSink::push(const char *msg, const size_t n, const boolean rapid)
+{
+  if ( listing_ ) flush();
+  else pump();
+  if ( n_==0 && port_room()>=n )
+  {
+    port_write(msg, n);
+    sent_++;
+    return true;
+  }
+  if ( n > room(rapid) )
+  {
+    if ( rapid ) dropped_rapid_++;
+    else dropped_++;
+    return false;
+  }
+  for ( size_t i=0; i<n; i++ ) q_[(head_ + n_ + i) % PRINT_QUEUE] = msg[i];
+  n_ += n;
+  n_max_ = max(n_max_, n_);
+  sent_++;
+  if ( listing_ ) flush();
+  return true;
+}
+
+// Queue space open to a message of this priority, bytes
+size_t PrintSink::room(const boolean rapid)
+{
+  size_t free = PRINT_QUEUE - n_;
+  if ( rapid ) return free;
+  return free>PRINT_RESERVE ? free - PRINT_RESERVE : 0;
+}
+
+
+// class PrintRouter
+PrintRouter::PrintRouter()
+  : n_sinks_(0), overruns_(0)
+{
+  msg_[0] = '\0';
+}
+PrintRouter::~PrintRouter() {}
+
+void PrintRouter::add(PrintSink *sink)
+{
+  if ( n_sinks_ < PRINT_MAX_SINK ) sinks_[n_sinks_++] = sink;
+}
+
+// Send the formatted message in msg_ to each selected sink
+size_t PrintRouter::fan_out(const uint8_t mask, const int n, const boolean rapid)
+{
+  if ( n<0 ) return 0;
+  size_t len = n;
+  if ( len >= PRINT_MSG )
+  {
+    overruns_++;
+    len = PRINT_MSG - 1;
+  }
+  for ( uint8_t i=0; i<n_sinks_; i++ )
+    if ( mask & (1<<i) ) sinks_[i]->push(msg_, len, rapid);
+  return len;
+}
+
+// Already formatted text plus newline, e.g. pr.buff
+size_t PrintRouter::line(const uint8_t mask, const char *str)
+{
+  return fan_out(mask, snprintf(msg_, PRINT_MSG, "%s\n", str), false);
+}
+
+// Bracket setup() or a long talk listing.   On, empty the queues and have every sink wait for its port, so lines routed here and
+// those printed straight to Serial or Serial1 come out in order and none is dropped.   Off, back to never waiting
+void PrintRouter::listing(const boolean on)
+{
+  for ( uint8_t i=0; i<n_sinks_; i++ )
+  {
+    sinks_[i]->listing(on);
+    if ( on ) sinks_[i]->flush();
+  }
+}
+
+void PrintRouter::pretty_print()
+{
+  Serial.printf("Print router:  overruns %ld\n", overruns_);
+  for ( uint8_t i=0; i<n_sinks_; i++ ) sinks_[i]->pretty_print();
+}
+
+size_t PrintRouter::printf(const uint8_t mask, const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(msg_, PRINT_MSG, fmt, args);
+  va_end(args);
+  return fan_out(mask, n, false);
+}
+
+// Drain every sink.  Called once per loop pass
+void PrintRouter::pump()
+{
+  for ( uint8_t i=0; i<n_sinks_; i++ ) sinks_[i]->pump();
+}
+
+// The vv stream:  may use the queue space normal messages leave in reserve
+size_t PrintRouter::rapid(const uint8_t mask, const char *fmt, ...)
+{
+  va_list args;
+  va_start(args, fmt);
+  int n = vsnprintf(msg_, PRINT_MSG, fmt, args);
+  va_end(args);
+  return fan_out(mask, n, true);
+}
+
+// Smallest normal-priority queue space among the selected sinks, bytes
+size_t PrintRouter::room(const uint8_t mask)
+{
+  size_t room = PRINT_QUEUE;
+  for ( uint8_t i=0; i<n_sinks_; i++ )
+    if ( mask & (1<<i) ) room = min(room, sinks_[i]->room(false));
+  return room;
+}
@@ -0,0 +1,109 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _PRINT_ROUTER_H
+#define _PRINT_ROUTER_H
+
+#include "application.h"
+
+#define PRINT_MSG       320     // Longest formatted message, bytes (> PrinterPars buff)
+#define PRINT_QUEUE     1024    // Per-sink TX queue, bytes
+#define PRINT_RESERVE   384     // Queue kept free for the rapid vv stream, bytes
+#define PRINT_MAX_SINK  4       // Sinks a router can fan out to
+#define PRINT_WAIT_MS   1000    // Longest a listing waits on a port before dropping again, ms (1000)
+#define ROUTE_USB       0x01    // Serial
+#define ROUTE_BLE       0x02    // Serial1, the HC-06
+#define ROUTE_ALL       0xFF    // Every sink
+
+// Non-blocking TX queue in front of one output.   Messages go straight through when the queue is
+// empty and the port has room, otherwise they wait here for pump().   A message that does not fit
+// is dropped whole and counted rather than blocking the caller.   While listing, for setup() and the long talk
+// listings (h, P*, Q) that also print straight to the port, each message waits for the queue to empty before and
+// after so nothing is dropped or overtaken.   A port that takes nothing for PRINT_WAIT_MS is stalled and dropped again until it drains
+class PrintSink
+{
+public:
+  PrintSink(const char *name);
+  virtual ~PrintSink();
+  // functions
+  uint32_t dropped() { return dropped_; }
+  boolean flush();
+  void listing(const boolean on) { listing_ = on; }
+  const char *name() { return name_; }
+  void pretty_print();
+  void pump();
+  boolean push(const char *msg, const size_t n, const boolean rapid);
+  size_t room(const boolean rapid);
+protected:
+  virtual size_t port_room() = 0;
+  virtual size_t port_write(const char *buf, const size_t n) = 0;
+  uint32_t dropped_;        // Normal messages dropped for lack of queue room
+  uint32_t dropped_rapid_;  // Rapid messages dropped for lack of queue room
+  uint16_t head_;           // Index of oldest queued byte
+  boolean listing_;         // Wait for the port rather than drop, T=wait
+  uint16_t n_;              // Bytes queued
+  uint16_t n_max_;          // High water mark of n_
+  const char *name_;
+  char q_[PRINT_QUEUE];     // Circular TX queue
+  uint32_t sent_;           // Messages accepted
+  boolean stalled_;         // Port took nothing for PRINT_WAIT_MS, cleared when drained
+};
+
+// Sink over a Particle port, USBSerial or USARTSerial
+template <class P>
+class PortSink : public PrintSink
+{
+public:
+  PortSink(const char *name, P *port) : PrintSink(name), port_(port) {}
+  ~PortSink() {}
+protected:
+  size_t port_room() { int room = port_->availableForWrite(); return room>0 ? size_t(room) : 0; }
+  size_t port_write(const char *buf, const size_t n) { return port_->write((const uint8_t *)buf, n); }
+  P *port_;
+};
+
+// Formats a message once and fans it out to the sinks selected by mask (bit i = i'th sink added)
+class PrintRouter
+{
+public:
+  PrintRouter();
+  ~PrintRouter();
+  // functions
+  void add(PrintSink *sink);
+  size_t line(const uint8_t mask, const char *str);
+  void listing(const boolean on);
+  void pretty_print();
+  size_t printf(const uint8_t mask, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+  void pump();
+  size_t rapid(const uint8_t mask, const char *fmt, ...) __attribute__((format(printf, 3, 4)));
+  size_t room(const uint8_t mask);
+protected:
+  size_t fan_out(const uint8_t mask, const int n, const boolean rapid);
+  char msg_[PRINT_MSG];             // The one formatting buffer
+  uint8_t n_sinks_;                 // Sinks added
+  uint32_t overruns_;               // Messages truncated to PRINT_MSG
+  PrintSink *sinks_[PRINT_MAX_SINK];
+};
+
+#endif
@@ -84,10 +84,14 @@
 #include "Sync.h"
 #include "subs.h"
 #include "Summary.h"
+#include "Usage.h"
+#include "PrintRouter.h"
 #include "Cloud.h"
 #include "debug.h"
 #include "parameters.h"
 #include "serial.h"
+#include "Clock.h"
+#include "talk/program.h"
 
 //#define BOOT_CLEAN      // Use this to clear 'lockup' problems introduced during testing using Talk
 SYSTEM_THREAD(ENABLED);   // Make sure code always run regardless of network status
@@ -97,13 +101,21 @@ SYSTEM_THREAD(ENABLED);   // Make sure code always run regardless of network sta
   SerialLogHandler logHandler;
 #endif
 
-#ifdef HDWE_DS2482_1WIRE
+#ifdef HDWE_DS2482_ARRAY
+  #include "TempArray.h"
+  TempArray myTemps;
+#elif defined(HDWE_DS2482_1WIRE)
   #include "myDS2482.h"
   MyDs2482_Class Ds2482(0);
   DS2482 ds(Wire, 0);
   DS2482DeviceListStatic<10> deviceList;
 #endif
 
+#ifdef HDWE_STRINGS
+  #include "StringBank.h"
+  StringBank myStrings;
+#endif
+
 #ifdef HDWE_47L16_EERAM
   #include "hardware/SerialRAM.h"
   SerialRAM ram;
@@ -124,17 +136,21 @@ extern Flt_st mySum[NSUM];        // Summaries for saving charge history
   retained Flt_st saved_faults[NFLT];  // For displaying faults
   retained SavedPars sp = SavedPars(saved_hist, uint16_t(NHIS), saved_faults, uint16_t(NFLT));  // Various parameters to be common at system level
 #endif
+retained UsageLog_st myUse;          // Day and week usage counters and histograms
 
 Flt_st mySum[NSUM];                   // Summaries
+DumpCursor myDump = DumpCursor();     // Resumable history dump
+PersistSched myPersist = PersistSched();  // Dynamic saved parameters and history to EERAM or backup RAM
+ProgramRunner myProg = ProgramRunner();  // Test programs ('Xp')
+PrintRouter rt = PrintRouter();       // Format-once, non-blocking fan out to Serial and Serial1
 PrinterPars pr = PrinterPars();       // Print buffer
 VolatilePars ap = VolatilePars();     // Various adjustment parameters commanding at system level.  Initialized on start up.  Not retained.
 CommandPars cp = CommandPars();       // Various control parameters commanding at system level.  Initialized on start up.  Not retained.
 PublishPars pp = PublishPars();       // Common parameters for publishing.  Future-proof cloud monitoring
-unsigned long long millis_flip = System.millis(); // Timekeeping
-unsigned long long last_sync = System.millis();   // Timekeeping
+unsigned long long millis_flip = Clock::millis(); // Timekeeping
+unsigned long long last_sync = Clock::millis();   // Timekeeping
 
 int num_timeouts = 0;           // Number of Particle.connect() needed to unfreeze
-String hm_string = "00:00";     // time, hh:mm
 Pins *myPins;                   // Photon hardware pin mapping used
 #if defined(HDWE_SSD1306_OLED) && !defined(HDWE_2WIRE)
   Adafruit_SSD1306 *display;      // Main OLED display
@@ -148,7 +164,7 @@ void setup()
   // Serial.blockOnOverrun(false);  doesn't work
   Serial.begin(SOFT_SBAUD);
   Serial.flush();
-  delay(1000);          // Ensures a clean display
+  Clock::delay(1000);          // Ensures a clean display
   Serial.printf("Hi!\n");
 
   // EERAM and Bluetooth Serial1.  Use BT-AT project in this GitHub repository to change.
@@ -159,16 +175,22 @@ void setup()
   Serial1.begin(SOFT_S1BAUD);
   Serial1.flush();
 
+  // Print router sinks.  Order sets the ROUTE_USB, ROUTE_BLE mask bits
+  rt.add(new PortSink<USBSerial>("usb", &Serial));
+  rt.add(new PortSink<USARTSerial>("ble", &Serial1));
+  rt.listing(true);  // Boot prints straight to Serial as well and may wait
+
   // EERAM chip card for I2C
   #if defined(HDWE_47L16_EERAM) && !defined(HDWE_2WIRE)
     Log.info("setup EERAM");
     ram.begin(0, 0);
     ram.setAutoStore(true);
-    delay(1000);
+    Clock::delay(1000);
     sp.load_all();
   #endif
-  sp.put_Time_now(max(sp.Time_now_z, (unsigned long)Time.now()));  // Synch with web when possible
-  Time.setTime(sp.Time_now_z);
+  sp.put_Time_now(max(sp.Time_now_z, (unsigned long)Clock::now()));  // Synch with web when possible
+  Clock::set_time(sp.Time_now_z);
+  sp.persist(&myPersist);
 
   // Peripherals (non-Photon2)
   // D6 - one-wire temp sensor
@@ -218,7 +240,7 @@ void setup()
       Serial.printf("Wire started\n");
     #endif
     Wire.begin();
-    delay(1000);
+    Clock::delay(1000);
   #endif
 
   // Display (after start Wire)
@@ -238,12 +260,16 @@ void setup()
     #endif
     // Minimize power transients
     #ifdef HDWE_PHOTON2
-      delay(1000);
+      Clock::delay(1000);
     #endif
   #endif
 
   // 1-Wire chip card for I2C (after start Wire)
-  #ifdef HDWE_DS2482_1WIRE
+  #ifdef HDWE_DS2482_ARRAY
+    Log.info("setup DS2482 probe array");
+    myTemps.setup();
+    Serial.printf("DS2482 probe array setup complete\n");
+  #elif defined(HDWE_DS2482_1WIRE)
     Log.info("setup DS2482 special 1-wire");
     ds.setup();
     Ds2482.setup();
@@ -261,9 +287,9 @@ void setup()
   // Synchronize clock
   // Device needs to be configured for wifi (hold setup 3 sec run Particle app) and in range of wifi
   // Phone hotspot is very convenientwait_on_user_input
-  delay(2000);
+  Clock::delay(2000);
   WiFi.off();
-  delay(1000);
+  Clock::delay(1000);
   Serial.printf("Done WiFi\n");
   Serial.printf("done CLOUD\n");
 
@@ -282,15 +308,21 @@ void setup()
   }
   else Serial.printf("clean\n");
 
-  // Determine System.millis() at turn of Time.now   Used to improve accuracy of timing.
-  long time_begin = Time.now();
+  // Determine Clock::millis() at turn of Time.now   Used to improve accuracy of timing.
+  long time_begin = Clock::now();
   uint16_t count = 0;
-  while ( Time.now()==time_begin && count++<1000 )
+  while ( Clock::now()==time_begin && count++<1000 )
   {
-    delay(1);
-    millis_flip = System.millis()%1000;
+    Clock::delay(1);
+    millis_flip = Clock::millis()%1000;
   }
 
+  // Identity for publishing and headers
+  assign_identity(&pp);
+
+  // Test programs
+  if ( !myProg.load(PROGRAMS_DEFAULT) ) Serial.printf("PROGRAMS_DEFAULT bad\n");
+
   // Enable and print stored history
   #if defined(HDWE_PHOTON) || defined(HDWE_PHOTON2)  // TODO: test that ARGON still works with the #if in place
     System.enableFeature(FEATURE_RETAINED_MEMORY);
@@ -298,7 +330,7 @@ void setup()
   if ( sp.debug_z==1 || sp.debug_z==2 || sp.debug_z==3 || sp.debug_z==4 )
   {
     sp.print_history_array();
-    sp.print_fault_header(&pp.pubList);
+    sp.print_fault_header(pp.front());
   }
   sp.nsum(NSUM);  // Store
 
@@ -318,6 +350,7 @@ void setup()
 
   Log.info("setup end");
   Serial.printf("End setup()\n\n");
+  rt.listing(false);
 } // setup
 
 
@@ -325,8 +358,8 @@ void setup()
 void loop()
 {
   // Synchronization
-  static unsigned long long now = (unsigned long long) System.millis();
-  now = (unsigned long long) System.millis();
+  static unsigned long long now = (unsigned long long) Clock::millis();
+  now = (unsigned long long) Clock::millis();
   boolean chitchat = false;
   static Sync *Talk = new Sync(TALK_DELAY);
   boolean read = false;
@@ -344,45 +377,47 @@ void loop()
   static boolean reset = true;
   static boolean reset_temp = true;
   static boolean reset_publish = true;
-  static unsigned long long start = System.millis();
+  static unsigned long long start = Clock::millis();
 
    // Monitor to count Coulombs and run EKF
   static BatteryMonitor *Mon = new BatteryMonitor();
 
   // Sensor conversions.  The embedded model 'Sim' is contained in Sensors
-  unsigned long long time_now = (unsigned long long) Time.now();
+  unsigned long long time_now = (unsigned long long) Clock::now();
   static Sensors *Sen = new Sensors(EKF_NOM_DT, 0, myPins, ReadSensors, Talk, Summarize, time_now, start, Mon);
 
   // Battery saturation debounce
-  static TFDelay *Is_sat_delay = new TFDelay(false, T_SAT, T_DESAT, EKF_NOM_DT);
+  static TFDelayT<double> Is_sat_delay(false, T_SAT, T_DESAT, EKF_NOM_DT);
 
   ///////////////////////////////////////////////////////////// Top of loop////////////////////////////////////////
 
   // Synchronize
-  #ifdef HDWE_DS2482_1WIRE
+  #ifdef HDWE_DS2482_ARRAY
+    myTemps.loop();
+  #elif defined(HDWE_DS2482_1WIRE)
     Ds2482.loop();
   #endif
   if ( now - last_sync > ONE_DAY_MILLIS || reset )  sync_time(now, &last_sync, &millis_flip); 
   Sen->control_time = double(Sen->now/1000);
-  char buffer[32];
-  time_long_2_str(time_now, buffer);
-  hm_string = String(buffer);
-  read_temp = ReadTemp->update(System.millis(), reset);
-  read = ReadSensors->update(System.millis(), reset);
-  chitchat = Talk->update(System.millis(), reset);
+  read_temp = ReadTemp->update(Clock::millis(), reset);
+  read = ReadSensors->update(Clock::millis(), reset);
+  chitchat = Talk->update(Clock::millis(), reset);
   elapsed = ReadSensors->now() - start;
-  control = ControlSync->update(System.millis(), reset);
-  display_and_remember = DisplayUserSync->update(System.millis(), reset);
+  control = ControlSync->update(Clock::millis(), reset);
+  display_and_remember = DisplayUserSync->update(Clock::millis(), reset);
   boolean boot_summ = boot_wait && ( elapsed >= SUMMARY_WAIT / (SUMMARY_DELAY / ap.sum_delay) ) && !sp.modeling_z;
   if ( elapsed >= SUMMARY_WAIT / (SUMMARY_DELAY / ap.sum_delay) ) boot_wait = false;
-  summarizing = Summarize->update(System.millis(), false) || boot_summ;
+  summarizing = Summarize->update(Clock::millis(), false) || boot_summ;
 
   // Sample temperature
   // Outputs:   Sen->Tb,  Sen->Tb_filt
   if ( read_temp )
   {
     Log.info("read_temp");
-    #ifdef HDWE_DS2482_1WIRE
+    #ifdef HDWE_DS2482_ARRAY
+        cp.tb_info.t_c = myTemps.tb();
+        cp.tb_info.ready = myTemps.ready();
+    #elif defined(HDWE_DS2482_1WIRE)
         Ds2482.check();
         cp.tb_info.t_c = Ds2482.tempC(0);
         cp.tb_info.ready = Ds2482.ready();
@@ -391,13 +426,16 @@ void loop()
     Sen->temp_load_and_filter(Sen, reset_temp);
   }
 
+  // Oversample Ib and Vb for hum monitor
+  Sen->hum_sample(Clock::micros(), myPins->Vb_pin);
+
   // Sample Ib
   #ifndef HDWE_ADS1013_AMP_NOA
     if ( read )
     {
       Log.info("Read shunt");
-      static unsigned int t_us_last = micros();
-      unsigned int t_us_now = micros();
+      static unsigned int t_us_last = Clock::micros();
+      unsigned int t_us_now = Clock::micros();
       float T = float(t_us_now - t_us_last) / 1e6;
       t_us_last = t_us_now;
       Sen->ShuntAmp->sample(reset, T);
@@ -453,7 +491,8 @@ void loop()
     // Publish for variable print rate
     if ( cp.publishS )
     {
-      assign_publist(&pp.pubList, ReadSensors->now(), unit, hm_string, Sen, num_timeouts, Mon);
+      assign_publist(pp.back(), ReadSensors->now(), time_now, Sen, num_timeouts, Mon);
+      pp.flip();
       static boolean wrote_last_time = false;
       if ( wrote_last_time )
         digitalWrite(myPins->status_led, LOW);
@@ -478,12 +517,9 @@ void loop()
       oled_display(Sen, Mon);
     #endif
 
-    #if defined(HDWE_47L16_EERAM) && !defined(HDWE_2WIRE)
-      // Save EERAM dynamic parameters.  Saves critical few state parameters
-      sp.put_all_dynamic();
-    #else
-      sp.put_Time_now(max( sp.Time_now_z, (unsigned long)Time.now()));  // If happen to connect to wifi (assume updated automatically), save new time
-    #endif
+    // Save dynamic parameters, the critical few state parameters, within the write budget
+    sp.Time_now_z = max( sp.Time_now_z, (unsigned long)Clock::now());  // If happen to connect to wifi (assume updated automatically), save new time
+    myPersist.update(double(Clock::millis())/1000.);
   }
 
   // Discuss things with the user
@@ -500,6 +536,9 @@ void loop()
   chitter(chitchat, Mon, Sen);  // Parse inputs to queues
   chatter();  // Prioritize commands to describe.  ctl_str and asap_str queues always run.  Others only with chitchat
   describe(Mon, Sen);  // Run the commands
+  myProg.service(Clock::millis());  // Queue test program steps as the last ones finish
+  myDump.service(ap.dump_n);  // A few history records per pass so frames keep their deadlines
+  rt.pump();  // Drain print queues as the ports take them
 
   // Summary management.   Every boot after a wait an initial summary is saved in rotating buffer
   // Then every half-hour unless modeling.   Can also request manually via cp.write_summary (Talk)
@@ -508,13 +547,13 @@ void loop()
     sp.put_Ihis(sp.ihis_z + 1);
     if ( sp.ihis_z > (sp.nhis() - 1) ) sp.put_Ihis(0);  // wrap buffer
     Flt_st hist_snap, hist_bounced;
-    hist_snap.assign(Time.now(), Mon, Sen);
+    hist_snap.assign(Clock::now(), Mon, Sen);
     hist_bounced = sp.put_history(hist_snap, sp.ihis_z);
 
     sp.put_Isum(sp.isum_z + 1);
     if ( sp.isum_z > (uint16_t)(sp.nsum()-1) ) sp.put_Isum(0);  // wrap buffer
     mySum[sp.isum_z].copy_to_Flt_ram_from(hist_bounced);
-    Serial.printf("Summ...\n");
+    rt.printf(ROUTE_USB, "Summ...\n");
     cp.write_summary = false;
   }
 
@@ -522,7 +561,7 @@ void loop()
   if ( read ) reset = false;
   if ( read_temp && elapsed>TEMP_INIT_DELAY && reset_temp )
   {
-    Serial.printf("...temp init complete\n");
+    rt.printf(ROUTE_USB, "...temp init complete\n");
     reset_temp = false;
   }
   if ( cp.publishS ) reset_publish = false;
@@ -28,6 +28,10 @@
 #include <math.h>
 #include "debug.h"
 #include "Summary.h"
+#include "Clock.h"
+#ifdef HDWE_2WIRE
+  #include "Therm2Wire.h"
+#endif
 
 extern CommandPars cp;  // Various parameters shared at system level
 extern PrinterPars pr;  // Print buffer
@@ -49,15 +53,13 @@ void bitMapPrint(char *buf, const int16_t fw, const uint8_t num)
 // class TempSensor
 // constructors
 TempSensor::TempSensor(const uint16_t pin, const bool parasitic, const uint16_t conversion_delay)
-: DS18B20(pin, true, conversion_delay), tb_stale_flt_(true)
+: DS18B20(pin, true, conversion_delay), SdTb(HDB_TBATT), tb_stale_flt_(true)
 {
-   SdTb = new SlidingDeadband(HDB_TBATT);
    Serial.printf("DS18 1-wire Tb started\n");
 }
 TempSensor::TempSensor(const uint16_t pin, const bool parasitic, const uint16_t conversion_delay, const uint16_t VTb_pin)
-: DS18B20(pin, true, conversion_delay), tb_stale_flt_(true), VTb_pin_(VTb_pin)
+: DS18B20(pin, true, conversion_delay), SdTb(HDB_TBATT), tb_stale_flt_(true), VTb_pin_(VTb_pin)
 {
-   SdTb = new SlidingDeadband(HDB_TBATT);
    Serial.printf("DS18 1-wire Tb started\n");
 }
 TempSensor::~TempSensor() {}
@@ -76,13 +78,13 @@ float TempSensor::sample(Sensors *Sen)
     while ( ++count<MAX_TEMP_READS && temp==0 && !sp.mod_tb_dscn() )
     {
         if ( crcCheck() ) temp = getTemperature() + (TBATT_TEMPCAL);
-      delay(1);
+      Clock::delay(1);
     }
 
     // Check success
     if ( count<MAX_TEMP_READS && TEMP_RANGE_CHECK<temp && temp<TEMP_RANGE_CHECK_MAX && !ap.fail_tb )
     {
-      Tb_hdwe = SdTb->update(temp);
+      Tb_hdwe = SdTb.update(temp);
       tb_stale_flt_ = false;
       if ( sp.debug()==16 ) Serial.printf("I:  t=%7.3f ct=%d, Tb_hdwe=%7.3f,\n", temp, count, Tb_hdwe);
     }
@@ -97,7 +99,7 @@ float TempSensor::sample(Sensors *Sen)
 
     if ( cp.tb_info.ready && TEMP_RANGE_CHECK<cp.tb_info.t_c && cp.tb_info.t_c<TEMP_RANGE_CHECK_MAX && !ap.fail_tb )
     {
-      Tb_hdwe = SdTb->update(cp.tb_info.t_c);
+      Tb_hdwe = SdTb.update(cp.tb_info.t_c);
       tb_stale_flt_ = false;
       if ( sp.debug()==16 ) Serial.printf("I:  t=%7.3f ready=%d, Tb_hdwe=%7.3f,\n", cp.tb_info.t_c, cp.tb_info.ready, Tb_hdwe);
     }
@@ -109,15 +111,96 @@ float TempSensor::sample(Sensors *Sen)
       // Using last-good-value:  no assignment
     }
   #elif defined(HDWE_2WIRE)
-    float volt = float(analogRead(VTb_pin_))*VTB_CONV_GAIN;
-    Tb_hdwe = float(HDWE_M_2WIRE) * log10( volt * float(HDWE_RS_2WIRE) / (V3V3 - volt) ) + float(HDWE_B_2WIRE);
+    uint32_t sum = 0;
+    for ( uint8_t i=0; i<(1<<TB2W_OVER_BITS); i++ ) sum += analogRead(VTb_pin_);
+    Tb_hdwe = tb2w_lookup(sum);
     tb_stale_flt_ = false;
-    if ( sp.debug()==16 ) Serial.printf("I 2wire:  volt=%7.3f Tb_hdwe=%7.3f,\n", volt, Tb_hdwe);
+    if ( sp.debug()==16 ) Serial.printf("I 2wire:  volt=%7.3f Tb_hdwe=%7.3f,\n", float(sum)*VTB_CONV_GAIN/float(1<<TB2W_OVER_BITS), Tb_hdwe);
   #endif
   return ( Tb_hdwe );
 }
 
 
+// class HumMonitor
+// constructors
+HumMonitor::HumMonitor()
+  : held_(0.), init_(false), ipeak_(0), n_(0), n_fill_(0), n_fill_last_(0), notch_hz_(0.), notched_(0.), x0_(0.)
+{
+  const float bin_hz[HUM_NBIN] = {50., 60., 100., 120., 150., 180.};
+  for ( uint8_t i=0; i<HUM_NBIN; i++ )
+  {
+    Bin_[i] = Goertzel(bin_hz[i], HUM_FS);
+    amp_[i] = 0.;
+  }
+}
+HumMonitor::~HumMonitor() {}
+// operators
+// functions
+
+void HumMonitor::pretty_print(const char *name, const float scale)
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf(" %s hum:", name);
+  for ( uint8_t i=0; i<HUM_NBIN; i++ ) Serial.printf(" %3.0fHz%8.4f", Bin_[i].f(), amp_[i]*scale);
+  Serial.printf("  peak %3.0fHz  fill %d/%d  notch %3.0fHz\n", hum_hz(), n_fill_last_, HUM_N, notch_hz_);
+#endif
+}
+
+// Feed one new sample.  slots = number of HUM_T_US periods since the last call, >1 if the loop was busy
+void HumMonitor::sample(const float in, const unsigned long slots, const float notch_hz)
+{
+  boolean reset = !init_ || slots>HUM_N;
+  if ( notch_hz!=notch_hz_ )
+  {
+    notch_hz_ = notch_hz;
+    if ( notch_hz_>0. ) Notch_.assignCoeff(notch_hz_, HUM_FS, HUM_NOTCH_Q);
+    reset = true;
+  }
+  if ( reset )
+  {
+    for ( uint8_t i=0; i<HUM_NBIN; i++ ) Bin_[i].reset();
+    if ( notch_hz_>0. ) Notch_.calculate(in, true);
+    n_ = 0;
+    n_fill_ = 0;
+    held_ = in;
+    init_ = true;
+  }
+  else
+  {
+    for ( unsigned long j=1; j<slots; j++ )
+    {
+      step(held_);
+      n_fill_++;
+    }
+  }
+  step(in);
+  held_ = in;
+}
+
+// Update the notch and the bins with one sample on the grid
+void HumMonitor::step(const float in)
+{
+  if ( notch_hz_>0. ) notched_ = Notch_.calculate(in, false);
+  else notched_ = in;
+  if ( n_==0 ) x0_ = in;
+  float x = in - x0_;
+  for ( uint8_t i=0; i<HUM_NBIN; i++ ) Bin_[i].update(x);
+  if ( ++n_>=HUM_N )
+  {
+    ipeak_ = 0;
+    for ( uint8_t i=0; i<HUM_NBIN; i++ )
+    {
+      amp_[i] = Bin_[i].amplitude(n_);
+      if ( amp_[i]>amp_[ipeak_] ) ipeak_ = i;
+      Bin_[i].reset();
+    }
+    n_fill_last_ = n_fill_;
+    n_fill_ = 0;
+    n_ = 0;
+  }
+}
+
+
 // class Shunt
 // constructors
 Shunt::Shunt()
@@ -129,7 +212,8 @@ Shunt::Shunt(const String name, const uint8_t port, float *sp_ib_scale,  float *
   vshunt_int_(0), vshunt_int_0_(0), vshunt_int_1_(0), vshunt_(0), Ishunt_cal_(0), Ishunt_cal_filt_(0),
   sp_ib_bias_(sp_Ib_bias), sp_ib_scale_(sp_ib_scale), sample_time_(0UL), sample_time_z_(0UL), dscn_cmd_(false),
   vc_pin_(vc_pin), vo_pin_(vo_pin), vr_pin_(vh3v3_pin), Vc_raw_(HALF_V3V3/VH3V3_CONV_GAIN), Vc_(HALF_V3V3),
-  Vo_Vc_(0.), using_opamp_(using_opAmp)
+  Vo_Vc_(0.), using_opamp_(using_opAmp),
+  Filt_(0.1, F_W_I, F_Z_I, -NOM_UNIT_CAP*sp.nP(), NOM_UNIT_CAP*sp.nP())  // actual update time provided run time
 {
   #ifdef HDWE_ADS1013_AMP_NOA
     if ( name_=="No Amp")
@@ -151,7 +235,6 @@ Shunt::Shunt(const String name, const uint8_t port, float *sp_ib_scale,  float *
     if ( using_opamp_ ) Serial.printf("Ib %s sense ADC pin %d started using OpAmp and 3V3 pin %d\n", name_.c_str(), vo_pin_, vr_pin_);
     else Serial.printf("Ib %s sense ADC pins %d and %d started\n", name_.c_str(), vo_pin_, vc_pin_);
   #endif
-  Filt_ = new General2_Pole(0.1, F_W_I, F_Z_I, -NOM_UNIT_CAP*sp.nP(), NOM_UNIT_CAP*sp.nP());  // actual update time provided run time
 }
 Shunt::~Shunt() {}
 // operators
@@ -173,6 +256,7 @@ void Shunt::pretty_print()
   Serial.printf(" Vo-Vc%10.6f; V\n", Vo_-Vc_);
   Serial.printf(" Vo_raw %d;\n", Vo_raw_);
   Serial.printf(" vshunt_int %d; count\n", vshunt_int_);
+  Hum.pretty_print("Ishunt A", v2a_s_*(*sp_ib_scale_));
   Serial.printf("Shunt(%s)::\n", name_.c_str());
   // Serial.printf("Shunt(%s)::", name_.c_str()); Adafruit_ADS1015::pretty_print(name_);
 #else
@@ -192,7 +276,7 @@ void Shunt::convert(const boolean disconnect, const boolean reset, Sensors *Sen)
         vshunt_int_ = 0;
       #endif
       sample_time_z_ = sample_time_;
-      sample_time_ = System.millis();
+      sample_time_ = Clock::millis();
     }
     else
     {
@@ -207,7 +291,8 @@ void Shunt::convert(const boolean disconnect, const boolean reset, Sensors *Sen)
     #endif
     if ( !bare_shunt_ && !dscn_cmd_ )
     {
-      vshunt_ = Vo_Vc_;
+      if ( ap.hum_notch_hz>0. ) vshunt_ = Hum.notched();
+      else vshunt_ = Vo_Vc_;
       vshunt_int_0_ = 0; vshunt_int_1_ = 0; vshunt_int_ = 0;
     }
     else
@@ -223,11 +308,23 @@ void Shunt::convert(const boolean disconnect, const boolean reset, Sensors *Sen)
     Ishunt_cal_ = vshunt_*v2a_s_*(*sp_ib_scale_) + *sp_ib_bias_;
 
       // 2-pole filter
-  Ishunt_cal_filt_ = Filt_->calculate(Ishunt_cal_, disconnect || reset, min(Sen->T, MAX_T_Q_FILT));
+  Ishunt_cal_filt_ = Filt_.calculate(Ishunt_cal_, disconnect || reset, min(Sen->T, MAX_T_Q_FILT));
   if ( Ishunt_cal_filt_ < 0. ) Ishunt_cal_ *= sp.ib_disch_slr();
 
 }
 
+// Oversample amplifier Vo-Vc for the hum monitor.  Not available on ADS hardware (I2C too slow)
+void Shunt::hum_sample(const unsigned long slots)
+{
+  #ifndef HDWE_ADS1013_AMP_NOA
+    if ( bare_shunt_ || dscn_cmd_ ) return;
+    float vc;
+    if ( using_opamp_ ) vc = float(analogRead(vr_pin_))*VH3V3_CONV_GAIN + ap.vc_add;
+    else vc = float(analogRead(vc_pin_))*VC_CONV_GAIN + ap.vc_add;
+    Hum.sample(float(analogRead(vo_pin_))*VO_CONV_GAIN - vc, slots, ap.hum_notch_hz);
+  #endif
+}
+
 // Sample amplifier Vo-Vc
 void Shunt::sample(const boolean reset_loc, const float T)
 {
@@ -242,7 +339,7 @@ void Shunt::sample(const boolean reset_loc, const float T)
     Vc_raw_ = analogRead(vc_pin_);
     Vc_ =  float(Vc_raw_)*VC_CONV_GAIN + ap.vc_add;
   }
-  sample_time_ = System.millis();
+  sample_time_ = Clock::millis();
   Vo_raw_ = analogRead(vo_pin_);
   Vo_ =  float(Vo_raw_)*VO_CONV_GAIN;
   Vo_Vc_ = Vo_ - Vc_;
@@ -255,16 +352,17 @@ void Shunt::sample(const boolean reset_loc, const float T)
 // Class Looparound
 Looparound::Looparound(BatteryMonitor *Mon, Sensors *Sen, const float wrap_hi_amp, const float wrap_lo_amp, const double wrap_trim_gain,
     const float imax, const float imin, const float err_max):
-  chem_(Mon->chem()), e_wrap_(0.), e_wrap_filt_(0.), e_wrap_trim_(0.), e_wrap_trimmed_(0.), hi_fail_(false), hi_fault_(false), ib_(0.),
-  ib_past_(0), imax_(imax), imin_(imin), lo_fail_(false), lo_fault_(false), Mon_(Mon), reset_(false), Sen_(Sen), voc_(0.), wrap_hi_amp_(wrap_hi_amp), wrap_lo_amp_(wrap_lo_amp),
-  wrap_trim_gain_(wrap_trim_gain)
-{
-  ChargeTransfer_ = new LagExp(EKF_NOM_DT, chem_->tau_ct, -NOM_UNIT_CAP, NOM_UNIT_CAP);     // actual update time provided run time
-  Trim_ = new TustinIntegrator(EKF_NOM_DT, -err_max*10., err_max*10.);          // actual update time provided run time
-  WrapErrFilt_ = new LagTustin(2., WRAP_ERR_FILT, -err_max, err_max);   // actual update time provided run time
-  WrapHi_ = new TFDelay(false, WRAP_HI_S, WRAP_HI_R, EKF_NOM_DT);  // Wrap test persistence.  Initializes false
-  WrapLo_ = new TFDelay(false, WRAP_LO_S, WRAP_LO_R, EKF_NOM_DT);  // Wrap test persistence.  Initializes false
-}
+  chem_(Mon->chem()),
+  ChargeTransfer_(EKF_NOM_DT, chem_->tau_ct, -NOM_UNIT_CAP, NOM_UNIT_CAP),  // actual update time provided run time
+  e_wrap_(0.), e_wrap_filt_(0.), e_wrap_trim_(0.), e_wrap_trimmed_(0.), hi_fail_(false), hi_fault_(false), ib_(0.),
+  ib_past_(0), imax_(imax), imin_(imin), lo_fail_(false), lo_fault_(false), Mon_(Mon), reset_(false), Sen_(Sen),
+  Trim_(EKF_NOM_DT, -err_max*10., err_max*10.),  // actual update time provided run time
+  voc_(0.),
+  WrapErrFilt_(2., WRAP_ERR_FILT, -err_max, err_max),  // actual update time provided run time
+  WrapHi_(false, WRAP_HI_S, WRAP_HI_R, EKF_NOM_DT),  // Wrap test persistence.  Initializes false
+  WrapLo_(false, WRAP_LO_S, WRAP_LO_R, EKF_NOM_DT),  // Wrap test persistence.  Initializes false
+  wrap_hi_amp_(wrap_hi_amp), wrap_lo_amp_(wrap_lo_amp), wrap_trim_gain_(wrap_trim_gain)
+{}
 
 // Update the loop
 void Looparound::calculate(const boolean reset, const float ib, Sensors *Sen)
@@ -276,7 +374,7 @@ void Looparound::calculate(const boolean reset, const float ib, Sensors *Sen)
   float ib_dyn;
   if (sp.mod_vb()) ib_dyn = ib_past_;
   else ib_dyn = ib_;
-  float dv_dyn = ChargeTransfer_->calculate(ib_dyn, reset_, chem_->tau_ct, Sen_->T)*chem_->r_ct*ap.slr_res + ib_dyn*chem_->r_0*ap.slr_res;
+  float dv_dyn = ChargeTransfer_.calculate(ib_dyn, reset_, chem_->tau_ct, Sen_->T)*chem_->r_ct*ap.slr_res + ib_dyn*chem_->r_0*ap.slr_res;
   voc_ = Mon_->vb() - dv_dyn;
   e_wrap_ = Mon_->voc_soc() - voc_;
 
@@ -287,7 +385,7 @@ void Looparound::calculate(const boolean reset, const float ib, Sensors *Sen)
   {
     trim_init = -(Mon_->vb() - Mon_->voc_soc() - dv_dyn);
     trim_rate_lim = max(min(e_wrap_filt_*wrap_trim_gain_, MAX_TRIM_RATE), -MAX_TRIM_RATE);
-    e_wrap_trim_ = -Trim_->calculate(trim_rate_lim, min(Sen_->T, F_MAX_T_WRAP), reset_, trim_init);
+    e_wrap_trim_ = -Trim_.calculate(trim_rate_lim, min(Sen_->T, F_MAX_T_WRAP), reset_, trim_init);
   }
   else
   {
@@ -298,7 +396,7 @@ void Looparound::calculate(const boolean reset, const float ib, Sensors *Sen)
 
   // e_wrap using present values
   e_wrap_trimmed_ = e_wrap_ + e_wrap_trim_;
-  e_wrap_filt_ = WrapErrFilt_->calculate(e_wrap_trimmed_, reset_, min(Sen_->T, F_MAX_T_WRAP));
+  e_wrap_filt_ = WrapErrFilt_.calculate(e_wrap_trimmed_, reset_, min(Sen_->T, F_MAX_T_WRAP));
 
   // Thresholds. Scalars are calculated by Flt->wrap_scalars()
   ewhi_thr_ = Mon_->r_ss() * wrap_hi_amp_ * ap.ewhi_slr * Sen_->Flt->ewsat_slr() * Sen_->Flt->ewmin_slr();
@@ -309,9 +407,9 @@ void Looparound::calculate(const boolean reset, const float ib, Sensors *Sen)
   // wrap_vb latches because vb is single sensor  faultAssign( (e_wrap_filt_ >= ewhi_thr_ && !Mon->sat()), WRAP_HI_FLT);
 
   hi_fault_ = e_wrap_filt_ >= ewhi_thr_;
-  hi_fail_ = WrapHi_->calculate(hi_fault_, WRAP_HI_S, WRAP_HI_R, Sen_->T, reset_) && !Sen_->Flt->vb_fa();  // not latched
+  hi_fail_ = WrapHi_.calculate(hi_fault_, WRAP_HI_S, WRAP_HI_R, Sen_->T, reset_) && !Sen_->Flt->vb_fa();  // not latched
   lo_fault_ = e_wrap_filt_ <= ewlo_thr_;
-  lo_fail_ = WrapLo_->calculate(lo_fault_, WRAP_LO_S, WRAP_LO_R, Sen_->T, reset_) && !Sen_->Flt->vb_fa();  // not latched
+  lo_fail_ = WrapLo_.calculate(lo_fault_, WRAP_LO_S, WRAP_LO_R, Sen_->T, reset_) && !Sen_->Flt->vb_fa();  // not latched
 
   if ( sp.debug()==71 ) Serial.printf("ib%7.3f reset%d ewlo_thr/e_wrap_filt/ewhi_thr  %7.3f/%7.3f/%7.3f trim%7.3f vb_fa %d lo_fault/fail %d/%d hi_fault/fail %d/%d\n",
    ib_, reset_, ewlo_thr_, e_wrap_filt_, ewhi_thr_, e_wrap_trim_, Sen_->Flt->vb_fa(), lo_fault_, lo_fail_, hi_fault_, hi_fail_);
@@ -336,6 +434,11 @@ void Looparound::pretty_print()
 
 // Class Fault
 Fault::Fault(const double T, uint8_t *preserving, BatteryMonitor *Mon, Sensors *Sen):
+  IbErrFilt(T, TAU_ERR_FILT, -IBATT_DISAGREE_THRESH*1.5, IBATT_DISAGREE_THRESH*1.5),  // actual update time provided run time
+  IbNoaRate(T, WRAP_ERR_FILT/4., -MAX_ERR_FILT, MAX_ERR_FILT),
+  QuietFilt(T, WN_Q_FILT, ZETA_Q_FILT, MIN_Q_FILT, MAX_Q_FILT),  // actual update time provided run time
+  QuietRate(T, TAU_Q_FILT, MIN_Q_FILT, MAX_Q_FILT),
+  WrapErrFilt(T, WRAP_ERR_FILT, -MAX_WRAP_ERR_FILT, MAX_WRAP_ERR_FILT),  // actual update time provided run time
   cc_diff_(0.), cc_diff_empty_slr_(1), disable_amp_fault_(false), ewmin_slr_(1), ewsat_slr_(1), e_wrap_(0), e_wrap_filt_(0),
   fltw_(0UL), falw_(0UL),
   ib_amp_hi_(false), ib_amp_invalid_(false), ib_amp_lo_(false), ib_choice_(UsingDef),
@@ -345,27 +448,22 @@ Fault::Fault(const double T, uint8_t *preserving, BatteryMonitor *Mon, Sensors *
   latched_fail_fake_(false), reset_all_faults_(false), sp_preserving_(preserving), tb_sel_stat_(TB_SEL_STAT_DEF),
   tb_sel_stat_last_(TB_SEL_STAT_DEF), vb_sel_stat_(VB_SEL_STAT_DEF), vb_sel_stat_last_(VB_SEL_STAT_DEF)
 {
-  IbNoaRate = new RateLagExp(T, WRAP_ERR_FILT/4., -MAX_ERR_FILT, MAX_ERR_FILT);
-  IbErrFilt = new LagTustin(T, TAU_ERR_FILT, -IBATT_DISAGREE_THRESH*1.5, IBATT_DISAGREE_THRESH*1.5);  // actual update time provided run time
-  IbdPosPer = new TFDelay(false, IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, T);
-  IbdNegPer = new TFDelay(false, IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, T);
-  IbdHiPer = new TFDelay(false, IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, T);
-  IbdLoPer = new TFDelay(false, IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, T);
-  DisabAmpFltPer = new TFDelay(false, DISAB_LO_SET, DISAB_LO_RESET, T);
-  CcdiffPer  = new TFDelay(false, CC_DIFF_SET, CC_DIFF_RESET, T);
-  IbAmpHardFail  = new TFDelay(false, IB_HARD_SET, IB_HARD_RESET, T);
-  IbLoActive  = new TFDelay(true, IB_LO_ACTIVE_SET, IB_LO_ACTIVE_RESET, T);
-  IbNoAmpHardFail  = new TFDelay(false, IB_HARD_SET, IB_HARD_RESET, T);
-  TbHardFail  = new TFDelay(false, TB_HARD_SET, TB_HARD_RESET, T);
-  TbStaleFail  = new TFDelay(false, TB_STALE_SET, TB_STALE_RESET, T);
-  VbHardFail  = new TFDelay(false, VB_HARD_SET, VB_HARD_RESET, T);
-  VcHardFail  = new TFDelay(false, VC_HARD_SET, VC_HARD_RESET, T);
-  QuietPer  = new TFDelay(false, QUIET_S, QUIET_R, T);
-  WrapErrFilt = new LagTustin(T, WRAP_ERR_FILT, -MAX_WRAP_ERR_FILT, MAX_WRAP_ERR_FILT);  // actual update time provided run time
-  WrapHi = new TFDelay(false, WRAP_HI_S, WRAP_HI_R, EKF_NOM_DT);  // Wrap test persistence.  Initializes false
-  WrapLo = new TFDelay(false, WRAP_LO_S, WRAP_LO_R, EKF_NOM_DT);  // Wrap test persistence.  Initializes false
-  QuietFilt = new General2_Pole(T, WN_Q_FILT, ZETA_Q_FILT, MIN_Q_FILT, MAX_Q_FILT);  // actual update time provided run time
-  QuietRate = new RateLagExp(T, TAU_Q_FILT, MIN_Q_FILT, MAX_Q_FILT);
+  Per.init(CC_DIFF_PER, false, CC_DIFF_SET, CC_DIFF_RESET, T);
+  Per.init(DISAB_AMP_FLT_PER, false, DISAB_LO_SET, DISAB_LO_RESET, T);
+  Per.init(IB_AMP_HARD_PER, false, IB_HARD_SET, IB_HARD_RESET, T);
+  Per.init(IB_LO_ACTIVE_PER, true, IB_LO_ACTIVE_SET, IB_LO_ACTIVE_RESET, T);
+  Per.init(IBD_POS_PER, false, IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, T);
+  Per.init(IBD_NEG_PER, false, IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, T);
+  Per.init(IBD_HI_PER, false, IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, T);
+  Per.init(IBD_LO_PER, false, IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, T);
+  Per.init(IB_NOA_HARD_PER, false, IB_HARD_SET, IB_HARD_RESET, T);
+  Per.init(QUIET_PER, false, QUIET_S, QUIET_R, T);
+  Per.init(TB_HARD_PER, false, TB_HARD_SET, TB_HARD_RESET, T);
+  Per.init(TB_STALE_PER, false, TB_STALE_SET, TB_STALE_RESET, T);
+  Per.init(VB_HARD_PER, false, VB_HARD_SET, VB_HARD_RESET, T);
+  Per.init(VC_HARD_PER, false, VC_HARD_SET, VC_HARD_RESET, T);
+  Per.init(WRAP_HI_PER, false, WRAP_HI_S, WRAP_HI_R, EKF_NOM_DT);  // Wrap test persistence.  Initializes false
+  Per.init(WRAP_LO_PER, false, WRAP_LO_S, WRAP_LO_R, EKF_NOM_DT);  // Wrap test persistence.  Initializes false
   LoopIbAmp = new Looparound(Mon, Sen, WRAP_HI_AMP, WRAP_LO_AMP, AMP_WRAP_TRIM_GAIN, IB_ABS_MAX_AMP, -IB_ABS_MAX_AMP,
                               MAX_WRAP_ERR_FILT/(IB_ABS_MAX_NOA/IB_ABS_MAX_AMP));
   LoopIbNoa = new Looparound(Mon, Sen, WRAP_HI_NOA, WRAP_LO_NOA, NOA_WRAP_TRIM_GAIN, IB_ABS_MAX_NOA, -IB_ABS_MAX_NOA,
@@ -387,7 +485,7 @@ void Fault::cc_diff(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
   }
   // ewsat_slr_ used here because voc_soc map inaccurate on cold days
   cc_diff_thr_ = CC_DIFF_SOC_DIS_THRESH*ap.cc_diff_slr*cc_diff_empty_slr_*ewsat_slr_;
-  failAssign( CcdiffPer->calculate(abs(cc_diff_)>=cc_diff_thr_, CC_DIFF_SET, CC_DIFF_RESET, Sen->T, reset), CC_DIFF_FA ); // CC_DIFF_FA not latched
+  failAssign( Per.calculate(CC_DIFF_PER, abs(cc_diff_)>=cc_diff_thr_, CC_DIFF_SET, CC_DIFF_RESET, Sen->T, reset), CC_DIFF_FA ); // CC_DIFF_FA not latched
 }
 
 // Compare current sensors - failure conditions large difference
@@ -395,15 +493,15 @@ void Fault::ib_diff(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
 {
   boolean reset_loc = reset || reset_all_faults_;
   if ( !ib_lo_active_ || disable_amp_fault_ ) ib_diff_ = 0.;
-  ib_diff_f_ = IbErrFilt->calculate(ib_diff_, reset_loc || disable_amp_fault_ || !ib_lo_active_, min(Sen->T, MAX_ERR_T));
+  ib_diff_f_ = IbErrFilt.calculate(ib_diff_, reset_loc || disable_amp_fault_ || !ib_lo_active_, min(Sen->T, MAX_ERR_T));
   ib_diff_thr_ = IBATT_DISAGREE_THRESH*ap.ib_diff_slr;
-  faultAssign( IbdPosPer->calculate((ib_diff_f_>=ib_diff_thr_), IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, Sen->T, reset_loc) && 
+  faultAssign( Per.calculate(IBD_POS_PER, (ib_diff_f_>=ib_diff_thr_), IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, Sen->T, reset_loc) && 
       ib_lo_active_, IB_DIFF_HI_FLT );
-  faultAssign( IbdNegPer->calculate((ib_diff_f_<=-ib_diff_thr_), IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, Sen->T, reset_loc) &&
+  faultAssign( Per.calculate(IBD_NEG_PER, (ib_diff_f_<=-ib_diff_thr_), IBATT_INST_DIFF_SET, IBATT_INST_DIFF_RESET, Sen->T, reset_loc) &&
       ib_lo_active_, IB_DIFF_LO_FLT );
-  failAssign( IbdHiPer->calculate(ib_diff_hi_flt(), IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, Sen->T, reset_loc),
+  failAssign( Per.calculate(IBD_HI_PER, ib_diff_hi_flt(), IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, Sen->T, reset_loc),
       IB_DIFF_HI_FA ); // IB_DIFF_FA not latched
-  failAssign( IbdLoPer->calculate(ib_diff_lo_flt(), IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, Sen->T, reset_loc),
+  failAssign( Per.calculate(IBD_LO_PER, ib_diff_lo_flt(), IBATT_DISAGREE_SET, IBATT_DISAGREE_RESET, Sen->T, reset_loc),
      IB_DIFF_LO_FA ); // IB_DIFF_FA not latched
 
   // if ( sp.debug()==2 || sp.debug()==4 ) Serial.printf("ib_diff_%7.3f reset_loc %d disable_amp_fault_ %d ib_diff_f_ %7.3f ib_diff_thr_ %7.3f ib_lo_active_ %d\n",
@@ -424,7 +522,7 @@ void Fault::ib_logic(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
       ib_amp_lo_ = Sen->ib_amp_model() <= HDWE_IB_HI_LO_AMP_LO / sp.nP();
       ib_noa_hi_ = Sen->ib_noa_model() >= HDWE_IB_HI_LO_AMP_HI / sp.nP();
       ib_noa_lo_ = Sen->ib_noa_model() <= HDWE_IB_HI_LO_AMP_LO / sp.nP();
-      ib_lo_active_ = IbLoActive->calculate(HDWE_IB_HI_LO_AMP_LO / sp.nP() < Sen->Ib_noa_model &&
+      ib_lo_active_ = Per.calculate(IB_LO_ACTIVE_PER, HDWE_IB_HI_LO_AMP_LO / sp.nP() < Sen->Ib_noa_model &&
                                             Sen->Ib_noa_model < HDWE_IB_HI_LO_AMP_HI / sp.nP(),
                                             IB_LO_ACTIVE_SET, IB_LO_ACTIVE_RESET, Sen->T , reset_loc);
     #else
@@ -443,7 +541,7 @@ void Fault::ib_logic(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
       ib_amp_lo_ = Sen->ib_amp_hdwe() <= HDWE_IB_HI_LO_AMP_LO / sp.nP();
       ib_noa_hi_ = Sen->ib_noa_hdwe() >= HDWE_IB_HI_LO_AMP_HI / sp.nP();
       ib_noa_lo_ = Sen->ib_noa_hdwe() <= HDWE_IB_HI_LO_AMP_LO / sp.nP();
-      ib_lo_active_ = IbLoActive->calculate(HDWE_IB_HI_LO_AMP_LO / sp.nP() < Sen->Ib_noa_hdwe &&
+      ib_lo_active_ = Per.calculate(IB_LO_ACTIVE_PER, HDWE_IB_HI_LO_AMP_LO / sp.nP() < Sen->Ib_noa_hdwe &&
                                             Sen->Ib_noa_hdwe < HDWE_IB_HI_LO_AMP_HI / sp.nP(),
                                             IB_LO_ACTIVE_SET, IB_LO_ACTIVE_RESET, Sen->T , reset_loc);
     #else
@@ -454,7 +552,7 @@ void Fault::ib_logic(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
       ib_lo_active_ = false;
     #endif
   }
-  disable_amp_fault_ = DisabAmpFltPer->calculate( (ib_amp_hi_ && ib_noa_hi_) || (ib_amp_lo_ && ib_noa_lo_), DISAB_LO_SET, DISAB_LO_RESET, Sen->T, reset);
+  disable_amp_fault_ = Per.calculate(DISAB_AMP_FLT_PER, (ib_amp_hi_ && ib_noa_hi_) || (ib_amp_lo_ && ib_noa_lo_), DISAB_LO_SET, DISAB_LO_RESET, Sen->T, reset);
 
 }
 
@@ -466,15 +564,15 @@ void Fault::ib_quiet(const boolean reset, Sensors *Sen)
   boolean reset_loc = reset | reset_all_faults_;
 
   // Rate (has some filtering)
-  ib_rate_ = QuietRate->calculate(Sen->Ib_amp_hdwe + Sen->Ib_noa_hdwe, reset, min(Sen->T, MAX_T_Q_FILT));
+  ib_rate_ = QuietRate.calculate(Sen->Ib_amp_hdwe + Sen->Ib_noa_hdwe, reset, min(Sen->T, MAX_T_Q_FILT));
 
   // 2-pole filter
-  ib_quiet_ = QuietFilt->calculate(ib_rate_, reset_loc, min(Sen->T, MAX_T_Q_FILT));
+  ib_quiet_ = QuietFilt.calculate(ib_rate_, reset_loc, min(Sen->T, MAX_T_Q_FILT));
 
   // Fault
   ib_quiet_thr_ = QUIET_A * ap.ib_quiet_slr;
   faultAssign( !sp.mod_ib() && abs(ib_quiet_)<=ib_quiet_thr_ && !reset_loc, IB_DSCN_FLT );   // initializes false
-  failAssign( QuietPer->calculate(dscn_flt(), QUIET_S, QUIET_R, Sen->T, reset_loc), IB_DSCN_FA);
+  failAssign( Per.calculate(QUIET_PER, dscn_flt(), QUIET_S, QUIET_R, Sen->T, reset_loc), IB_DSCN_FA);
   #ifndef HDWE_PHOTON
     if ( sp.debug()==-13 ) debug_m13(Sen);
     if ( sp.debug()==-23 ) debug_m23(Sen);
@@ -520,8 +618,8 @@ void Fault::ib_range(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
   }
   else
   {
-    failAssign( vc_fa() || ib_amp_bare() || ib_amp_fa() || IbAmpHardFail->calculate(ib_amp_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_AMP_FA );
-    failAssign( vc_fa() || ib_noa_bare() || ib_noa_fa() || IbNoAmpHardFail->calculate(ib_noa_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_NOA_FA);
+    failAssign( vc_fa() || ib_amp_bare() || ib_amp_fa() || Per.calculate(IB_AMP_HARD_PER, ib_amp_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_AMP_FA );
+    failAssign( vc_fa() || ib_noa_bare() || ib_noa_fa() || Per.calculate(IB_NOA_HARD_PER, ib_noa_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_NOA_FA);
   }
   #ifdef DEBUG_DETAIL
     if ( sp.mod_ib() )
@@ -575,15 +673,15 @@ void Fault::ib_wrap(const boolean reset, Sensors *Sen, BatteryMonitor *Mon)
     failAssign( ( wrap_lo_m_fa() && wrap_lo_n_fa() ), WRAP_LO_FA);
   #else
     e_wrap_ = Mon->voc_soc() - Mon->voc_stat();
-    e_wrap_filt_ = WrapErrFilt->calculate(e_wrap_, reset_loc, min(Sen->T, F_MAX_T_WRAP));
+    e_wrap_filt_ = WrapErrFilt.calculate(e_wrap_, reset_loc, min(Sen->T, F_MAX_T_WRAP));
     // sat logic screens out voc jumps when ib>0 when saturated
     // wrap_hi and wrap_lo don't latch because need them available to check next ib sensor selection for dual ib sensor
     // wrap_vb latches because vb is single sensor
     // Thresholds calculated by wrap_scalars()
     faultAssign( (e_wrap_filt_ >= ewhi_thr_ && !Mon->sat()), WRAP_HI_FLT);
     faultAssign( (e_wrap_filt_ <= ewlo_thr_), WRAP_LO_FLT);
-    failAssign( (WrapHi->calculate(wrap_hi_flt(), WRAP_HI_S, WRAP_HI_R, Sen->T, reset_loc) && !vb_fa()), WRAP_HI_FA );  // not latched
-    failAssign( (WrapLo->calculate(wrap_lo_flt(), WRAP_LO_S, WRAP_LO_R, Sen->T, reset_loc) && !vb_fa()), WRAP_LO_FA );  // not latched
+    failAssign( (Per.calculate(WRAP_HI_PER, wrap_hi_flt(), WRAP_HI_S, WRAP_HI_R, Sen->T, reset_loc) && !vb_fa()), WRAP_HI_FA );  // not latched
+    failAssign( (Per.calculate(WRAP_LO_PER, wrap_lo_flt(), WRAP_LO_S, WRAP_LO_R, Sen->T, reset_loc) && !vb_fa()), WRAP_LO_FA );  // not latched
   #endif
   failAssign( (wrap_vb_fa() && !reset_loc) || (!ib_diff_fa() && wrap_m_and_n_fa()), WRAP_VB_FA);    // WRAP_VB_FA latches latches because vb is single sensor
 }
@@ -1093,8 +1191,8 @@ void Fault::shunt_check(Sensors *Sen, BatteryMonitor *Mon, const boolean reset)
   }
   else
   {
-    failAssign( vc_fa() || ib_amp_bare() || ib_amp_fa() || IbAmpHardFail->calculate(ib_amp_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_AMP_FA );
-    failAssign( vc_fa() || ib_noa_bare() || ib_noa_fa() || IbNoAmpHardFail->calculate(ib_noa_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_NOA_FA);
+    failAssign( vc_fa() || ib_amp_bare() || ib_amp_fa() || Per.calculate(IB_AMP_HARD_PER, ib_amp_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_AMP_FA );
+    failAssign( vc_fa() || ib_noa_bare() || ib_noa_fa() || Per.calculate(IB_NOA_HARD_PER, ib_noa_flt(), IB_HARD_SET, IB_HARD_RESET, Sen->T, reset_loc), IB_NOA_FA);
   }
 }
 
@@ -1109,7 +1207,7 @@ void Fault::tb_check(Sensors *Sen, const float _tb_min, const float _tb_max, con
   if ( ap.disab_tb_fa || sp.mod_tb() )
   {
     faultAssign( (Sen->Tb_model_filt<=_tb_min) || (Sen->Tb_model_filt>=_tb_max), TB_FLT);
-    failAssign( tb_fa() || TbHardFail->calculate(tb_flt(), TB_HARD_SET, TB_HARD_RESET, Sen->T_temp, reset_loc), TB_FA);
+    failAssign( tb_fa() || Per.calculate(TB_HARD_PER, tb_flt(), TB_HARD_SET, TB_HARD_RESET, Sen->T_temp, reset_loc), TB_FA);
   }
   else if ( ap.disab_ib_fa )
   {
@@ -1118,7 +1216,7 @@ void Fault::tb_check(Sensors *Sen, const float _tb_min, const float _tb_max, con
   else
   {
     faultAssign( (Sen->Tb_hdwe<=_tb_min) || (Sen->Tb_hdwe>=_tb_max), TB_FLT);
-    failAssign( tb_fa() || TbHardFail->calculate(tb_flt(), TB_HARD_SET, TB_HARD_RESET, Sen->T_temp, reset_loc), TB_FA);
+    failAssign( tb_fa() || Per.calculate(TB_HARD_PER, tb_flt(), TB_HARD_SET, TB_HARD_RESET, Sen->T_temp, reset_loc), TB_FA);
   }
 }
 
@@ -1135,7 +1233,7 @@ void Fault::tb_stale(const boolean reset, Sensors *Sen)
   else
   {
     faultAssign( Sen->SensorTb->tb_stale_flt(), TB_FLT );
-    failAssign( TbStaleFail->calculate(tb_flt(), TB_STALE_SET*ap.tb_stale_time_slr, TB_STALE_RESET*ap.tb_stale_time_slr,
+    failAssign( Per.calculate(TB_STALE_PER, tb_flt(), TB_STALE_SET*ap.tb_stale_time_slr, TB_STALE_RESET*ap.tb_stale_time_slr,
       Sen->T_temp, reset_loc), TB_FA );
   }
 }
@@ -1156,7 +1254,7 @@ void Fault::vb_check(Sensors *Sen, BatteryMonitor *Mon, const float _vb_min, con
   else
   {
     faultAssign( (Sen->vb_hdwe()<=_vb_min && Sen->ib_hdwe()*sp.nP()>IB_MIN_UP) || (Sen->vb_hdwe()>=_vb_max), VB_FLT);
-    failAssign( vb_fa() || VbHardFail->calculate(vb_flt(), VB_HARD_SET, VB_HARD_RESET, Sen->T, reset_loc), VB_FA);
+    failAssign( vb_fa() || Per.calculate(VB_HARD_PER, vb_flt(), VB_HARD_SET, VB_HARD_RESET, Sen->T, reset_loc), VB_FA);
   }
 }
 void Fault::vc_check(Sensors *Sen, BatteryMonitor *Mon, const float _vc_min, const float _vc_max, const boolean reset)
@@ -1174,7 +1272,7 @@ void Fault::vc_check(Sensors *Sen, BatteryMonitor *Mon, const float _vc_min, con
   else
   {
     faultAssign( ( ((Sen->Vc<=_vc_min) || (Sen->Vc>=_vc_max)) && !reset_loc ), VC_FLT);
-    failAssign( vc_fa() || VcHardFail->calculate(vc_flt(), VC_HARD_SET, VC_HARD_RESET, Sen->T, reset_loc), VC_FA);
+    failAssign( vc_fa() || Per.calculate(VC_HARD_PER, vc_flt(), VC_HARD_SET, VC_HARD_RESET, Sen->T, reset_loc), VC_FA);
   }
 }
 
@@ -1209,8 +1307,14 @@ void Fault::wrap_scalars(BatteryMonitor *Mon)
 
 // Class Sensors
 Sensors::Sensors(double T, double T_temp, Pins *pins, Sync *ReadSensors, Sync *Talk, Sync *Summarize, unsigned long long time_now,
-  unsigned long long millis, BatteryMonitor *Mon):  inst_millis_(millis), inst_time_(time_now), reset_temp_(false),
-  sample_time_ib_(0UL), sample_time_ib_hdwe_(0UL), sample_time_vb_(0UL), sample_time_vb_hdwe_(0UL)
+  unsigned long long millis, BatteryMonitor *Mon):
+  TbSenseFilt(double(READ_DELAY)/1000., F_W_T, F_Z_T, -20.0, 150.),
+  AmpFilt(T, AMP_FILT_TAU, -NOM_UNIT_CAP, NOM_UNIT_CAP),
+  hum_t_us_(Clock::micros()), inst_millis_(millis), inst_time_(time_now),
+  NoaFilt(T, AMP_FILT_TAU, -NOM_UNIT_CAP*sp.nS()*sp.nP(), NOM_UNIT_CAP*sp.nS()*sp.nP()),
+  reset_temp_(false), sample_time_ib_(0UL), sample_time_ib_hdwe_(0UL), sample_time_vb_(0UL), sample_time_vb_hdwe_(0UL),
+  SelFilt(T, AMP_FILT_TAU, -NOM_UNIT_CAP*sp.nS()*sp.nP(), NOM_UNIT_CAP*sp.nS()*sp.nP()),
+  VbFilt(T, AMP_FILT_TAU, 0., NOMINAL_VB*2.5)
 {
   this->T = T;
   this->T_filt = T;
@@ -1227,7 +1331,6 @@ Sensors::Sensors(double T, double T_temp, Pins *pins, Sync *ReadSensors, Sync *T
   #elif !defined(HDWE_BARE)
     this->SensorTb = new TempSensor(pins->pin_1_wire, TEMP_PARASITIC, TEMP_DELAY, pins->VTb_pin);
   #endif
-  this->TbSenseFilt = new General2_Pole(double(READ_DELAY)/1000., F_W_T, F_Z_T, -20.0, 150.);
   this->Sim = new BatterySim();
   this->elapsed_inj = 0ULL;
   this->start_inj = 0ULL;
@@ -1238,16 +1341,15 @@ Sensors::Sensors(double T, double T_temp, Pins *pins, Sync *ReadSensors, Sync *T
   this->Talk = Talk;
   this->display = true;
   this->Ib_hdwe_model = 0.;
+  this->Ib_amp_hum = 0.;
+  this->Ib_noa_hum = 0.;
+  this->Vb_hum = 0.;
   Prbn_Tb_ = new PRBS_7(TB_NOISE_SEED);
   Prbn_Vb_ = new PRBS_7(VB_NOISE_SEED);
   Prbn_Ib_amp_ = new PRBS_7(IB_AMP_NOISE_SEED);
   Prbn_Ib_noa_ = new PRBS_7(IB_NOA_NOISE_SEED);
   Flt = new Fault(T, &sp.preserving_z, Mon, this);
   Serial.printf("Vb sense ADC pin started\n");
-  AmpFilt = new LagExp(T, AMP_FILT_TAU, -NOM_UNIT_CAP, NOM_UNIT_CAP);
-  NoaFilt = new LagExp(T, AMP_FILT_TAU, -NOM_UNIT_CAP*sp.nS()*sp.nP(), NOM_UNIT_CAP*sp.nS()*sp.nP());
-  SelFilt = new LagExp(T, AMP_FILT_TAU, -NOM_UNIT_CAP*sp.nS()*sp.nP(), NOM_UNIT_CAP*sp.nS()*sp.nP());
-  VbFilt = new LagExp(T, AMP_FILT_TAU, 0., NOMINAL_VB*2.5);
   #ifdef HDWE_IB_HI_LO
     sel_brk_hdwe = new ScaleBrk(HDWE_IB_HI_LO_NOA_LO, HDWE_IB_HI_LO_AMP_LO, HDWE_IB_HI_LO_AMP_HI, HDWE_IB_HI_LO_NOA_HI);
   #else
@@ -1533,6 +1635,29 @@ void Sensors::shunt_print()
         Flt->ib_amp_flt(), Flt->ib_amp_fa(), Flt->ib_noa_flt(), Flt->ib_noa_fa());
 }
 
+// Print hum monitors
+void Sensors::hum_print()
+{
+  Serial.printf("Hum (Goertzel %d x %4.0f Hz, DF notch %3.0f Hz):\n", HUM_N, HUM_FS, ap.hum_notch_hz);
+  ShuntAmp->Hum.pretty_print("Ib_amp A", ShuntAmp->v2a_s()*ShuntAmp->scale());
+  ShuntNoAmp->Hum.pretty_print("Ib_noa A", ShuntNoAmp->v2a_s()*ShuntNoAmp->scale());
+  HumVb.pretty_print("Vb     V", 1.);
+  Serial.printf(" Ib_amp_hum%8.4f Ib_noa_hum%8.4f Vb_hum%8.4f\n", Ib_amp_hum, Ib_noa_hum, Vb_hum);
+}
+
+// Oversample Ib and Vb on the HUM_T_US grid for the hum monitors and notch.  Cheap when not due
+void Sensors::hum_sample(const unsigned long now_us, const uint16_t vb_pin)
+{
+  unsigned long slots = (now_us - hum_t_us_) / HUM_T_US;
+  if ( slots==0 ) return;
+  hum_t_us_ += slots*HUM_T_US;
+  ShuntAmp->hum_sample(slots);
+  ShuntNoAmp->hum_sample(slots);
+  #if !defined(HDWE_BARE)
+    if ( !sp.mod_vb_dscn() ) HumVb.sample(float(analogRead(vb_pin))*VB_CONV_GAIN*sp.Vb_scale(), slots, ap.hum_notch_hz);
+  #endif
+}
+
 // Shunt selection.  Use Coulomb counter and EKF to sort three signals:  amp current, non-amp current, voltage
 // Initial selection to charge the Sim for modeling currents on BMS cutback
 // Inputs: sp.ib_force (user override), Mon (EKF status)
@@ -1561,11 +1686,11 @@ void Sensors::shunt_select_initial(const boolean reset)
     Ib_amp_model = max(min(Ib_model + Ib_amp_add() + mod_add, Ib_amp_max()/SIZE_MARG), Ib_amp_min()/SIZE_MARG); // uses past Ib.  Synthesized signal to use as substitute for sensor, Dm/Mm/Nm
     Ib_noa_model = max(min(Ib_model + Ib_noa_add() + mod_add, Ib_noa_max()/SIZE_MARG), Ib_noa_min()/SIZE_MARG); // uses past Ib.  Synthesized signal to use as substitute for sensor, Dn/Nx/Nm
     Ib_amp_hdwe = ShuntAmp->Ishunt_cal() + hdwe_add;    // Sense fault injection feeds logic, not model
-    Ib_amp_hdwe_f = AmpFilt->calculate(Ib_amp_hdwe, reset, AMP_FILT_TAU, T);
+    Ib_amp_hdwe_f = AmpFilt.calculate(Ib_amp_hdwe, reset, AMP_FILT_TAU, T);
     Vc_hdwe = max(ShuntAmp->Vc(), ShuntNoAmp->Vc());
     Ib_noa_hdwe = ShuntNoAmp->Ishunt_cal() + hdwe_add;  // Sense fault injection feeds logic, not model
-    Ib_noa_hdwe_f = NoaFilt->calculate(Ib_noa_hdwe, reset, AMP_FILT_TAU, T);
-    Ib_hdwe_f = SelFilt->calculate(Ib_hdwe, reset, AMP_FILT_TAU, T);
+    Ib_noa_hdwe_f = NoaFilt.calculate(Ib_noa_hdwe, reset, AMP_FILT_TAU, T);
+    Ib_hdwe_f = SelFilt.calculate(Ib_hdwe, reset, AMP_FILT_TAU, T);
     
     // Initial choice
     // Inputs:  ib_choice/ib_sel_stat_, Ib_amp_hdwe, Ib_noa_hdwe, Ib_amp_model(past), Ib_noa_model(past)
@@ -1604,11 +1729,11 @@ void Sensors::temp_load_and_filter(Sensors *Sen, const boolean reset_temp)
   if ( reset_temp_ && Tb_hdwe>TEMP_RANGE_CHECK_MAX )  // Bootup T=85.5 C
   {
       Tb_hdwe = RATED_TEMP;
-      Tb_hdwe_filt = TbSenseFilt->calculate(RATED_TEMP, reset_temp_, min(T_temp, F_MAX_T_TEMP));
+      Tb_hdwe_filt = TbSenseFilt.calculate(RATED_TEMP, reset_temp_, min(T_temp, F_MAX_T_TEMP));
   }
   else
   {
-      Tb_hdwe_filt = TbSenseFilt->calculate(Tb_hdwe, reset_temp_, min(T_temp, F_MAX_T_TEMP));
+      Tb_hdwe_filt = TbSenseFilt.calculate(Tb_hdwe, reset_temp_, min(T_temp, F_MAX_T_TEMP));
   }
   Tb_hdwe += sp.Tb_bias_hdwe();
   Tb_hdwe_filt += sp.Tb_bias_hdwe();
@@ -1630,16 +1755,17 @@ void Sensors::vb_load(const uint16_t vb_pin, const boolean reset)
   {
     #if !defined(HDWE_BARE)
       Vb_raw = analogRead(vb_pin);
-      Vb_hdwe =  float(Vb_raw)*VB_CONV_GAIN*sp.Vb_scale() + float(VB_A) + sp.Vb_bias_hdwe();
+      if ( ap.hum_notch_hz>0. ) Vb_hdwe = HumVb.notched() + float(VB_A) + sp.Vb_bias_hdwe();
+      else Vb_hdwe =  float(Vb_raw)*VB_CONV_GAIN*sp.Vb_scale() + float(VB_A) + sp.Vb_bias_hdwe();
     #endif
-    Vb_hdwe_f = VbFilt->calculate(Vb_hdwe, reset, AMP_FILT_TAU, T);
+    Vb_hdwe_f = VbFilt.calculate(Vb_hdwe, reset, AMP_FILT_TAU, T);
   }
   else
   {
     Vb_raw = 0;
     Vb_hdwe = 0.;
   }
-  sample_time_vb_hdwe_ = System.millis();
+  sample_time_vb_hdwe_ = Clock::millis();
 }
 
 // Print analog voltage
@@ -25,6 +25,8 @@
 #define _MY_SENSORS_H
 
 #include "myLibrary/myFilters.h"
+#include "myLibrary/myFiltersT.h"
+#include "myLibrary/Goertzel.h"
 #include "Battery.h"
 #include "constants.h"
 #include "Cloud.h"
@@ -77,6 +79,39 @@ struct ScaleBrk
   }
 };
 
+// Mains (inverter) hum monitor on an oversampled signal.  Goertzel bins at 50/60 Hz and harmonics with
+// optional notch.  Slots missed while the loop is busy are filled with the last sample to hold the time grid
+class HumMonitor
+{
+public:
+  HumMonitor();
+  ~HumMonitor();
+  // operators
+  // functions
+  float amp(const uint8_t i) { return amp_[i]; };
+  float hum() { return amp_[ipeak_]; };
+  float hum_hz() { return Bin_[ipeak_].f(); };
+  uint16_t n_fill() { return n_fill_last_; };
+  float notched() { return notched_; };
+  void pretty_print(const char *name, const float scale);
+  void sample(const float in, const unsigned long slots, const float notch_hz);
+protected:
+  void step(const float in);
+  float amp_[HUM_NBIN];       // Latched bin amplitudes, input units peak
+  Goertzel Bin_[HUM_NBIN];    // Streaming bins
+  float held_;                // Last sample, for filling missed slots
+  boolean init_;              // Block started
+  uint8_t ipeak_;             // Largest bin of last block
+  uint16_t n_;                // Samples in present block
+  uint16_t n_fill_;           // Filled slots in present block
+  uint16_t n_fill_last_;      // Filled slots in last block
+  NotchT<float> Notch_;       // Hum notch
+  float notch_hz_;            // Notch frequency in use, 0=off, Hz
+  float notched_;             // Notch output, input units
+  float x0_;                  // First sample of block, removes DC before the bins
+};
+
+
 // DS18-based temp sensor
 class TempSensor: public DS18B20
 {
@@ -91,7 +126,7 @@ public:
   float sample(Sensors *Sen);
   float noise();
 protected:
-  SlidingDeadband *SdTb;
+  SlidingDeadbandT<double> SdTb;
   boolean tb_stale_flt_;   // One-wire did not update last pass
   uint16_t VTb_pin_;      // Using 2wire
 };
@@ -108,12 +143,16 @@ public:
   // operators
   // functions
   boolean bare_shunt() { return ( bare_shunt_ ); };
+  void bare_shunt(const boolean bare) { bare_shunt_ = bare; };  // Replay of a capture, cppStateOfCharge/soc_regress
   void dscn_cmd(const boolean cmd) { dscn_cmd_ = cmd; };
   unsigned long long dt() { return sample_time_ - sample_time_z_; };
   void convert(const boolean disconnect, const boolean reset, Sensors *Sen);
   float Ishunt_cal() { return Ishunt_cal_; };
   float ishunt_cal() { return Ishunt_cal_ / sp.nP(); };
   float Ishunt_cal_filt() { return Ishunt_cal_filt_; };
+  float Ishunt_hum() { return Hum.hum()*v2a_s_*(*sp_ib_scale_); };
+  HumMonitor Hum;       // Hum on Vo-Vc oversampled
+  void hum_sample(const unsigned long slots);
   void pretty_print();
   void sample(const boolean reset_loc, const float T);
   float scale() { return ( *sp_ib_scale_ ); };
@@ -153,7 +192,7 @@ protected:
   float Vo_Vc_;         // Sensed Vo-Vc, difference in output of op amps, V
   float Vo_Vc_f_;       // Sensed, filtered Vo-Vc, difference in output of op amps, V
   boolean using_opamp_; // Using differential hardware amp
-  General2_Pole *Filt_; // Linear filter to test for direction
+  General2_PoleT<double> Filt_; // Linear filter to test for direction
 };
 
 // Fault word bits.   All faults heal
@@ -227,7 +266,7 @@ public:
   void pretty_print();
 protected:
   Chemistry *chem_;         // Chemistry
-  LagExp *ChargeTransfer_;  // ChargeTransfer model {ib, vb} --> {voc}, ioc=ib for Battery version
+  LagExpT<double> ChargeTransfer_;  // ChargeTransfer model {ib, vb} --> {voc}, ioc=ib for Battery version
   float e_wrap_;            // Wrap error, V
   float e_wrap_filt_;       // Wrap error, V
   float e_wrap_trim_;       // Trimmer, V
@@ -245,17 +284,38 @@ protected:
   BatteryMonitor *Mon_;     // Monitor ptr
   boolean reset_;           // If resetting or not
   Sensors *Sen_;            // Sensors ptr
-  TustinIntegrator *Trim_;  // Trim integrator
+  TustinIntegratorT<double> Trim_;  // Trim integrator
   float voc_;               // Open circuit unit voltage, V 
-  LagTustin *WrapErrFilt_;  // Noise filter for voltage wrap
-  TFDelay *WrapHi_;         // Wrap test persistence
-  TFDelay *WrapLo_;         // Wrap test persistence
+  LagTustinT<double> WrapErrFilt_;  // Noise filter for voltage wrap
+  TFDelayT<double> WrapHi_; // Wrap test persistence
+  TFDelayT<double> WrapLo_; // Wrap test persistence
   float wrap_hi_amp_;       // Wrap high amplitude, V
   float wrap_lo_amp_;       // Wrap low amplitude, V
   double wrap_trim_gain_;   // Trim gain, r/s
 };
 
 
+// Fault persistence timer slots in Fault::Per
+enum FltPer {
+  CC_DIFF_PER,        // cc_diff ekf fail amp
+  DISAB_AMP_FLT_PER,  // disable_fault_amp debounce of ib_amp_wrap faults, more noise tolerant and prevents false negatives
+  IB_AMP_HARD_PER,    // ib hard fail amp
+  IB_LO_ACTIVE_PER,   // low amp active status
+  IBD_POS_PER,        // ib diff hi instantaneous
+  IBD_NEG_PER,        // ib diff lo instantaneous
+  IBD_HI_PER,         // ib diff hi
+  IBD_LO_PER,         // ib diff lo
+  IB_NOA_HARD_PER,    // ib hard fail noa
+  QUIET_PER,          // ib quiet disconnect detection
+  TB_HARD_PER,        // Tb hard fail
+  TB_STALE_PER,       // stale tb one-wire data
+  VB_HARD_PER,        // vb hard fail
+  VC_HARD_PER,        // vc hard fail
+  WRAP_HI_PER,        // high wrap fail
+  WRAP_LO_PER,        // low wrap fail
+  NUM_FLT_PER
+};
+
 // Detect faults and manage selection
 class Fault
 {
@@ -285,7 +345,6 @@ public:
   float ewsat_slr() { return ewsat_slr_; };
   uint32_t fltw() { return fltw_; };
   uint32_t falw() { return falw_; };
-  TFDelay *IbLoActive;    // Persistence low amp active status
   boolean ib_noa_invalid() { return ib_noa_invalid_; };
   boolean ib_amp_bare() { return faultRead(IB_AMP_BARE);  };
   boolean ib_amp_fa() { return failRead(IB_AMP_FA); };
@@ -375,28 +434,14 @@ public:
   boolean wrap_n_fa() { return failRead(WRAP_LO_N_FA) || failRead(WRAP_HI_N_FA); };
   void wrap_scalars(BatteryMonitor *Mon);
   boolean wrap_vb_fa() { return failRead(WRAP_VB_FA); };
-  void wrap_err_filt_state(const float in) { WrapErrFilt->state(in); }
+  void wrap_err_filt_state(const float in) { WrapErrFilt.state(in); }
 protected:
-  TFDelay *CcdiffPer;       // Persistence cc_diff ekf fail amp
-  TFDelay *DisabAmpFltPer;  // Persistence on disable_fault_amp to debounce ib_amp_wrap faults to make them more noise tolerant and prevent false negatives
-  TFDelay *IbAmpHardFail;   // Persistence ib hard fail amp
-  RateLagExp *IbNoaRate;    // Linear filter to calculate rate for amp
-  TFDelay *IbdPosPer;       // Persistence ib diff hi instantaneous
-  TFDelay *IbdNegPer;       // Persistence ib diff lo instantaneous
-  TFDelay *IbdHiPer;        // Persistence ib diff hi
-  TFDelay *IbdLoPer;        // Persistence ib diff lo
-  LagTustin *IbErrFilt;     // Noise filter for signal selection
-  TFDelay *IbNoAmpHardFail; // Persistence ib hard fail noa
-  General2_Pole *QuietFilt; // Linear filter to test for quiet
-  TFDelay *QuietPer;        // Persistence ib quiet disconnect detection
-  RateLagExp *QuietRate;    // Linear filter to calculate rate for quiet
-  TFDelay *TbHardFail;      // Persistence Tb hard fail
-  TFDelay *TbStaleFail;     // Persistence stale tb one-wire data
-  TFDelay *VbHardFail;      // Persistence vb hard fail
-  TFDelay *VcHardFail;      // Persistence vc hard fail
-  LagTustin *WrapErrFilt;   // Noise filter for voltage wrap
-  TFDelay *WrapHi;          // Time high wrap fail persistence
-  TFDelay *WrapLo;          // Time low wrap fail persistence
+  LagTustinT<double> IbErrFilt;     // Noise filter for signal selection
+  RateLagExpT<double> IbNoaRate;    // Linear filter to calculate rate for amp
+  TFDelayBank<NUM_FLT_PER> Per;     // Persistence timers, indexed by FltPer
+  General2_PoleT<double> QuietFilt; // Linear filter to test for quiet
+  RateLagExpT<double> QuietRate;    // Linear filter to calculate rate for quiet
+  LagTustinT<double> WrapErrFilt;   // Noise filter for voltage wrap
   float cc_diff_;           // EKF tracking error, C
   boolean cc_diff_fa_;      // EKF tested disagree, T = error
   float cc_diff_empty_slr_; // Scale cc_diff when soc low, scalar
@@ -471,6 +516,10 @@ public:
   float Ib_hdwe_model;        // Selected model hardware signal, A
   float Ib_model;             // Modeled battery bank current, A
   float Ib_model_in;          // Battery bank current input to model (modified by cutback), A
+  float Ib_amp_hum;           // Sensed amp mains hum, largest bin, A pk
+  float Ib_noa_hum;           // Sensed noa mains hum, largest bin, A pk
+  float Vb_hum;               // Sensed battery bank mains hum, largest bin, V pk
+  HumMonitor HumVb;           // Hum on Vb oversampled
   float Wb;                   // Sensed battery bank power, use to compare to other shunts, W
   unsigned long long now;     // Time at sample, ms
   double T;                   // Update time, s
@@ -484,8 +533,7 @@ public:
   TempSensor* SensorTb;       // Tb sense
   Sync *Summarize;            // Handle to debug read time
   Sync *Talk;                 // Handle to debug talk time
-  General2_Pole* TbSenseFilt; // Linear filter for Tb. There are 1 Hz AAFs in hardware for Vb and Ib
-  SlidingDeadband *SdTb;      // Non-linear filter for Tb
+  General2_PoleT<double> TbSenseFilt; // Linear filter for Tb. There are 1 Hz AAFs in hardware for Vb and Ib
   BatterySim *Sim;            // Used to model Vb and Ib.   Use Talk 'Xp?' to toggle model on/off
   unsigned long long elapsed_inj;  // Injection elapsed time, ms
   unsigned long long start_inj;// Start of calculated injection, ms
@@ -517,6 +565,8 @@ public:
   float Ib_amp_noise();
   float Ib_noa_noise();
   float Ib_noise();
+  void hum_print();
+  void hum_sample(const unsigned long now_us, const uint16_t vb_pin);  // Oversample for hum monitors, call every loop
   void reset_temp(const boolean reset) { reset_temp_ = reset; };
   boolean reset_temp() { return ( reset_temp_ ); };
   unsigned long long sample_time_ib(void) { return sample_time_ib_; };
@@ -538,14 +588,15 @@ public:
   Fault *Flt;
   ScaleBrk *sel_brk_hdwe;                  // Active/active scale break
 protected:
-  LagExp *AmpFilt;      // Noise filter for calibration
+  LagExpT<double> AmpFilt;  // Noise filter for calibration
   unsigned long long dt_ib_;                // Delta update of selected Ib sample, ms
   unsigned long long dt_ib_hdwe_;           // Delta update of Ib sample, ms
   void ib_choose_active_standby(void);   // Deliberate choice based on inputs and results
   void ib_choose_hi_lo(void);   // Deliberate choice based on inputs and results
+  unsigned long hum_t_us_;                  // Hum monitor sample grid, us
   unsigned long long inst_millis_;          // millis offset to account for setup() time, ms
   unsigned long long inst_time_;            // UTC Zulu at instantiation, s
-  LagExp *NoaFilt;      // Noise filter for calibration
+  LagExpT<double> NoaFilt;  // Noise filter for calibration
   PRBS_7 *Prbn_Tb_;     // Tb noise generator model only
   PRBS_7 *Prbn_Vb_;     // Vb noise generator model only
   PRBS_7 *Prbn_Ib_amp_; // Ib amplified sensor noise generator model only
@@ -555,8 +606,8 @@ protected:
   unsigned long long sample_time_ib_hdwe_;  // Exact moment of Ib sample, ms
   unsigned long long sample_time_vb_;       // Exact moment of selected Vb sample, ms
   unsigned long long sample_time_vb_hdwe_;  // Exact moment of Vb sample, ms
-  LagExp *SelFilt;      // Noise filter for calibration
-  LagExp *VbFilt;       // Noise filter for calibration
+  LagExpT<double> SelFilt;  // Noise filter for calibration
+  LagExpT<double> VbFilt;   // Noise filter for calibration
 };
 
 // Misc
@@ -0,0 +1,252 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "StringBank.h"
+#include "constants.h"
+#include "parameters.h"
+
+extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
+extern VolatilePars ap; // Various adjustment parameters shared at system level
+
+// Configured strings, the unit's HDWE_STRINGS or one string of CHEM
+#ifdef HDWE_STRINGS
+  static const SbString sb_cfg[] = HDWE_STRINGS;
+#else
+  static const SbString sb_cfg[] = {{CHEM, 1., SB_CH_SHARE}};
+#endif
+
+
+// class StringMon
+StringMon::StringMon(const SbString &cfg, double *delta_q, float *t_last)
+  : Battery(delta_q, t_last, VM), ch_(cfg.ch), dt_eframe_(0.1), eframe_(0), ib_charge_(0.), s_cap_(cfg.s_cap),
+  SatDelay_(true, T_SAT, T_DESAT, EKF_NOM_DT), sat_raw_(true), sat_d_(true), SdVb_(HDB_VB), soc_ekf_(1.0)
+{
+  // Own chemistry.   Construction only:  assign_mod allocates the tables again
+  if ( cfg.mod!=chem_.mod_code )
+  {
+    chem_.assign_mod(cfg.mod);
+    coul_eff_ = chem_.coul_eff*COULOMBIC_EFF_SCALE;
+    nom_vsat_ = chem_.v_sat - HDB_VB;
+  }
+  voc_filt_ = chem_.v_sat - HDB_VB;
+  apply_cap_scale(s_cap_);
+  this->Q_ = EKF_Q_SD_NORM*EKF_Q_SD_NORM;
+  this->R_ = EKF_R_SD_NORM*EKF_R_SD_NORM;
+}
+StringMon::~StringMon() {}
+
+/* StringMon::calculate:  one string, BatteryMonitor::calculate, is_sat and count_coulombs in a frame
+    Inputs:
+      ib          String current, A
+      vb          Battery unit terminal voltage, V
+      temp_c      Tb, deg C
+      dt          Update time, s
+      reset       Initialize filters and debounce, reset_temp
+    Outputs:
+      voc_stat_   Static open circuit voltage, V
+      soc_ekf_    Solved state of charge, fraction
+      sat_d_      Debounced saturation
+      soc_ (return)   Counted state of charge, fraction
+*/
+float StringMon::calculate(const float ib, const float vb, const float temp_c, const double dt, const boolean reset)
+{
+  // Inputs
+  temp_c_ = temp_c;
+  vsat_ = calc_vsat();
+  dt_ = dt;
+  float T_rate = T_RLim_.calculate(temp_c_, T_RLIM, T_RLIM, reset, dt_);
+  vb_ = vb;
+  ib_ = max(min(ib, IMAX_NUM), -IMAX_NUM);
+
+  // Battery management system model
+  if ( !bms_off_ )
+    voltage_low_ = voc_stat_ < chem_.vb_down;
+  else
+    voltage_low_ = voc_stat_ < chem_.vb_rising;
+  bms_charging_ = ib_ > IB_MIN_UP;
+  bms_off_ = (temp_c_ <= chem_.low_t) || voltage_low_;
+  ib_charge_ = ib_;
+  if ( bms_off_ && !bms_charging_ )
+    ib_charge_ = 0.;
+  if ( bms_off_ && voltage_low_ )
+    ib_ = 0.;
+
+  // Dynamic emf
+  dv_dyn_ = ChargeTransfer_.calculate(ib_, reset, chem_.tau_ct, dt_)*chem_.r_ct*ap.slr_res + ib_*chem_.r_0*ap.slr_res;
+  voc_ = vb_ - dv_dyn_;
+  if ( bms_off_ && voltage_low_ ) voc_ = vb_;
+  voc_stat_ = voc_;
+  ioc_ = ib_;
+
+  // EKF 1x1
+  if ( eframe_ == 0 )
+  {
+    float ddq_dt = ib_charge_;
+    dt_eframe_ = dt_ * float(ap.eframe_mult);
+    if ( ddq_dt>0. ) ddq_dt *= coul_eff_;
+    ddq_dt -= chem_.dqdt * q_capacity_ * T_rate;
+    predict_ekf(ddq_dt);
+    update_ekf(voc_stat_, 0., 1.);
+    soc_ekf_ = x_ekf();
+  }
+  eframe_++;
+  if ( reset || eframe_ >= ap.eframe_mult ) eframe_ = 0;
+
+  // Saturation, as BatteryMonitor::is_sat and Is_sat_delay
+  voc_filt_ = SdVb_.update(voc_);
+  if ( reset )
+    sat_raw_ = temp_c_ > chem_.low_t && (voc_filt_ >= vsat_);
+  else
+    sat_raw_ = temp_c_ > chem_.low_t && (voc_filt_ >= vsat_ || (soc_ >= MXEPS && !sat_raw_) );
+  sat_d_ = SatDelay_.calculate(sat_raw_, T_SAT*ap.s_t_sat, T_DESAT*ap.s_t_sat, min(dt_, T_SAT/2.), reset);
+
+  // Memory store
+  return ( count_coulombs(dt_, reset, temp_c_, ib_charge_, sat_d_, 0.) );
+}
+
+// EKF model for predict, as BatteryMonitor
+void StringMon::ekf_predict(double *Fx, double *Bu)
+{
+  *Fx = 1. - dt_eframe_ / chem_.tau_sd;
+  *Bu = dt_eframe_ / chem_.c_sd;
+}
+
+// EKF model for update, as BatteryMonitor
+void StringMon::ekf_update(double *hx, double *H)
+{
+  float x_lim = max(min(x_, 1.0), 0.0);
+  *hx = Battery::calc_soc_voc(x_lim, temp_c_, &dv_dsoc_) + sp.Dw();
+  *H = dv_dsoc_;
+}
+
+// Start the counter and the EKF at soc
+void StringMon::init_soc(const float soc, const float temp_c)
+{
+  *sp_t_last_ = temp_c;
+  apply_soc(soc, temp_c);
+  soc_ekf_ = soc;
+  init_ekf(soc_ekf_, 0.0);
+}
+
+
+// class StringBank
+StringBank::StringBank()
+{
+  begin_(sb_cfg, sizeof(sb_cfg)/sizeof(SbString));
+}
+StringBank::StringBank(const SbString *cfg, const uint8_t n)
+{
+  begin_(cfg, n);
+}
+StringBank::~StringBank() {}
+
+// Build the strings.   Capacity shares of the strings without a shunt
+void StringBank::begin_(const SbString *cfg, const uint8_t n)
+{
+  ah_weak_ = 0.;
+  imb_ = 0.;
+  n_ = min(n, SB_NS);
+  soc_ = soc_ekf_ = 1.;
+  weak_ = 0;
+  float s_cap_share = 0.;
+  for ( uint8_t k=0; k<n_; k++ )
+  {
+    delta_q_[k] = 0.;
+    t_last_[k] = RATED_TEMP;
+    str_[k] = new StringMon(cfg[k], &delta_q_[k], &t_last_[k]);
+    if ( cfg[k].ch==SB_CH_SHARE ) s_cap_share += cfg[k].s_cap;
+  }
+  for ( uint8_t k=0; k<n_; k++ )
+    share_[k] = ( cfg[k].ch==SB_CH_SHARE && s_cap_share>0. ) ? cfg[k].s_cap / s_cap_share : 0.;
+}
+
+// All strings to soc
+void StringBank::init_soc(const float soc, const float temp_c)
+{
+  for ( uint8_t k=0; k<n_; k++ ) str_[k]->init_soc(soc, temp_c);
+}
+
+// Print
+void StringBank::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf("StringBank:  %d strings, soc%8.4f soc_ekf%8.4f imbalance%7.4f%s weakest %d%7.2f A-h\n", n_, soc_,
+    soc_ekf_, imb_, imb_>SB_IMB_WARN ? " (!)" : "", weak_, ah_weak_);
+  Serial.printf("   k  ch mod s_cap %8s %8s %8s %7s %7s sat bms\n", "ib", "soc", "soc_ekf", "voc", "vsat");
+  for ( uint8_t k=0; k<n_; k++ )
+  {
+    StringMon *s = str_[k];
+    Serial.printf(" %c%2d %3d %3d %5.2f %8.3f %8.4f %8.4f %7.3f %7.3f %3d %3d\n", k==weak_ ? '^' : ' ', k, s->ch(),
+      s->mod_code(), s->s_cap(), s->ib(), s->soc(), s->soc_ekf(), s->voc_stat(), s->vsat(), s->saturated(), s->bms_off());
+  }
+#else
+  Serial.printf("StringBank: silent DEPLOY\n");
+#endif
+}
+
+/* StringBank::update:  run every string and the bank results
+    Inputs:
+      ib_ch       Shunt channel currents, A, NULL if none
+      ib_bank     Bank current, A
+      vb          Battery unit terminal voltage, V
+      temp_c      Tb, deg C
+      T           Update time, s
+      reset       reset_temp
+    Outputs:
+      soc_        Bank charge over bank capacity, fraction
+      imb_        soc spread of the strings, fraction
+      weak_       String with the fewest A-h above its soc_min
+*/
+void StringBank::update(const float *ib_ch, const float ib_bank, const float vb, const float temp_c, const double T,
+  const boolean reset)
+{
+  // Current the shunts do not measure goes to the others by capacity
+  float ib_rest = ib_bank;
+  if ( ib_ch )
+    for ( uint8_t k=0; k<n_; k++ )
+      if ( str_[k]->ch()!=SB_CH_SHARE ) ib_rest -= ib_ch[str_[k]->ch()];
+
+  double q = 0., q_cap = 0., q_ekf = 0.;
+  float soc_hi = -1e6, soc_lo = 1e6;
+  for ( uint8_t k=0; k<n_; k++ )
+  {
+    StringMon *s = str_[k];
+    float ib = ( s->ch()!=SB_CH_SHARE && ib_ch ) ? ib_ch[s->ch()] : ib_rest*share_[k];
+    float soc = s->calculate(ib, vb, temp_c, T, reset);
+    q += s->q();
+    q_cap += s->q_capacity();
+    q_ekf += s->soc_ekf() * s->q_capacity();
+    soc_hi = max(soc_hi, soc);
+    soc_lo = min(soc_lo, soc);
+    float ah = (soc - s->soc_min()) * s->q_capacity() / 3600.;
+    if ( k==0 || ah<ah_weak_ )
+    {
+      ah_weak_ = ah;
+      weak_ = k;
+    }
+  }
+  soc_ = q / q_cap;
+  soc_ekf_ = q_ekf / q_cap;
+  imb_ = soc_hi - soc_lo;
+}
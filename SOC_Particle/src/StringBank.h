@@ -0,0 +1,119 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _STRING_BANK_H
+#define _STRING_BANK_H
+
+#include "application.h"
+#include "Battery.h"
+
+#define SB_NS           4         // Most strings in the bank (4)
+#define SB_CH_SHARE     255       // String has no shunt of its own, it takes its capacity share of the bank current (255)
+#define SB_IMB_WARN     0.10      // Spread of string soc the bank reports as imbalanced, fraction (0.10)
+
+// One parallel string of the bank:  chemistry (mod code, as 'Xm' CHEM), capacity scale (as 's_cap_mon') and the
+// shunt channel that measures its current
+struct SbString
+{
+  uint8_t mod;          // Chemistry, Chemistry::assign_mod
+  float s_cap;          // Capacity scale of the string, slr
+  uint8_t ch;           // Shunt channel, SB_CH_SHARE none
+};
+
+// Monitor of one string.   BatteryMonitor::calculate and is_sat with count_coulombs, cut to what a string needs:
+// the ChargeTransfer model, BMS logic, EKF at the eframe rate, saturation debounce and the Coulomb counter, on
+// the string's own chemistry, capacity and current.   No UKF, ChemBank, reversionary model or prints, so a string
+// costs no more than the Monitor.   delta_q is kept in RAM, not sp:  a reset starts the string at the bank soc and
+// its first saturation puts it right.
+class StringMon : public Battery, public EKF_1x1
+{
+public:
+  StringMon(const SbString &cfg, double *delta_q, float *t_last);
+  ~StringMon();
+  // operators
+  // functions
+  float calculate(const float ib, const float vb, const float temp_c, const double dt, const boolean reset);
+  uint8_t ch() { return ch_; };
+  float ib_charge() { return ib_charge_; };
+  void init_soc(const float soc, const float temp_c);
+  float s_cap() { return s_cap_; };
+  boolean saturated() { return sat_d_; };
+  float soc_ekf() { return soc_ekf_; };
+  float voc_filt() { return voc_filt_; };
+protected:
+  uint8_t ch_;          // Shunt channel, SB_CH_SHARE none
+  double dt_eframe_;    // Update time for EKF major frame, s
+  uint8_t eframe_;      // Counter to run EKF slower than the Coulomb Counter
+  float ib_charge_;     // Current input avaiable for charging, A
+  float s_cap_;         // Capacity scale, slr
+  TFDelayT<double> SatDelay_;  // Saturation debounce, as Is_sat_delay
+  boolean sat_raw_;     // Saturation before debounce, as BatteryMonitor::is_sat
+  boolean sat_d_;       // Saturation debounced
+  SlidingDeadbandT<double> SdVb_;  // Sliding deadband filter for voc
+  float soc_ekf_;       // Filtered state of charge from ekf (0-1)
+  RateLimitT<double> T_RLim_;  // Tb rate limit for the EKF
+  float voc_filt_;      // Filtered, static model open circuit voltage, V
+  void ekf_predict(double *Fx, double *Bu);
+  void ekf_update(double *hx, double *H);
+};
+
+// Bank of parallel strings that need not match:  one StringMon for each entry of HDWE_STRINGS, in place of one
+// Monitor scaled by nP.   Each string counts its own current, from its shunt channel or, without one, its capacity
+// share of the bank current.   soc() is the bank's, charge over capacity of all strings, imbalance() the spread of
+// the string socs and weakest() the string with the fewest A-h left above its soc_min, the one the BMS will stop
+// first.   The BatteryMonitor stays the bank's reference; the strings add to it.
+class StringBank
+{
+public:
+  StringBank();
+  StringBank(const SbString *cfg, const uint8_t n);
+  ~StringBank();
+  // operators
+  // functions
+  float ah_weakest() { return ah_weak_; };
+  float imbalance() { return imb_; };
+  void init_soc(const float soc, const float temp_c);
+  uint8_t n() { return n_; };
+  void pretty_print();
+  float soc() { return soc_; };
+  float soc_ekf() { return soc_ekf_; };
+  StringMon *mon(const uint8_t k) { return ( k<n_ ) ? str_[k] : NULL; };
+  void update(const float *ib_ch, const float ib_bank, const float vb, const float temp_c, const double T,
+    const boolean reset);
+  uint8_t weakest() { return weak_; };
+protected:
+  float ah_weak_;             // A-h left in the weakest string above its soc_min
+  double delta_q_[SB_NS];     // Charge since saturated, each string, C
+  float imb_;                 // soc max - min
+  uint8_t n_;                 // Strings
+  float share_[SB_NS];        // Capacity share of the bank current, of the strings without a shunt
+  float soc_;                 // Bank soc, fraction
+  float soc_ekf_;             // Bank soc of the EKFs, fraction
+  StringMon *str_[SB_NS];     // Strings
+  float t_last_[SB_NS];       // Tb rate limit memory, each string, deg C
+  uint8_t weak_;              // Weakest string
+  void begin_(const SbString *cfg, const uint8_t n);
+};
+
+#endif
@@ -23,6 +23,14 @@
 
 #include "Summary.h"
 #include "parameters.h"
+#include "talk/chitchat.h"
+#include "FltPack.h"
+
+extern SavedPars sp;        // Various parameters to be static at system level and saved through power cycle
+extern CommandPars cp;      // Various parameters shared at system level
+extern PublishPars pp;      // For publishing
+extern Flt_st mySum[NSUM];  // Summaries for saving charge history
+extern PrintRouter rt;      // Serial and Serial1 print router
 
 // print helper
 void print_all_fault_buffer(const String code, struct Flt_st *flt, const uint16_t iflt, const uint16_t nflt)
@@ -47,3 +55,161 @@ void reset_all_fault_buffer(const String code, struct Flt_st *flt, const uint16_
     flt[i].put_nominal();
   }
 }
+
+
+// class DumpCursor
+DumpCursor::DumpCursor()
+  : i_(0), n_(0), nbuf_(0), n_steps_(0), started_(false), step_(0)
+{}
+DumpCursor::~DumpCursor() {}
+
+// Queue a step.  Starting a new dump after the last one finished clears the queue.   Returns false and says so
+// when the queue is full
+boolean DumpCursor::add(const DumpStep step)
+{
+  if ( !active() ) cancel();
+  if ( n_steps_ >= DUMP_MAX_STEPS )
+  {
+    Serial.printf("DumpCursor: queue full (%d), step %d dropped\n", DUMP_MAX_STEPS, step);
+    return false;
+  }
+  steps_[n_steps_++] = step;
+  return true;
+}
+
+// Drop whatever is left
+void DumpCursor::cancel()
+{
+  n_steps_ = 0;
+  step_ = 0;
+  started_ = false;
+}
+
+// Position on the oldest record of the buffer for the current step.   A packed step starts with a line of what
+// the decoder needs to print the records as print_flt does
+void DumpCursor::begin_step()
+{
+  switch ( buffer_step() )
+  {
+    case ( DUMP_SUM ):
+      i_ = sp.isum();
+      nbuf_ = sp.nsum();
+      break;
+    case ( DUMP_HIS ):
+      i_ = sp.Ihis();
+      nbuf_ = sp.nhis();
+      break;
+    case ( DUMP_FLT ):
+      i_ = sp.Iflt();
+      nbuf_ = sp.nflt();
+      break;
+    case ( DUMP_CHIT ):
+      chit("Pr;Q;", SOON);
+      nbuf_ = 0;
+      break;
+    default:
+      nbuf_ = 0;
+  }
+  n_ = nbuf_;
+  started_ = true;
+  if ( buffer_step()!=steps_[step_] )
+    rt.printf(ROUTE_ALL, "pk_hdr, %s, %d, %d, %.9g,\n", code(), nbuf_, FLT_PK_BYTES, sp.amp());
+}
+
+// Buffer the current step prints, the packed steps as the plain ones
+DumpStep DumpCursor::buffer_step()
+{
+  switch ( steps_[step_] )
+  {
+    case ( DUMP_PK_SUM ):
+      return DUMP_SUM;
+    case ( DUMP_PK_HIS ):
+      return DUMP_HIS;
+    case ( DUMP_PK_FLT ):
+      return DUMP_FLT;
+    default:
+      return steps_[step_];
+  }
+}
+
+// Record code of the current buffer
+const char *DumpCursor::code()
+{
+  switch ( buffer_step() )
+  {
+    case ( DUMP_SUM ):
+      return "unit_u";
+    case ( DUMP_HIS ):
+      return "unit_h";
+    default:
+      return "unit_f";
+  }
+}
+
+// Record i of the buffer for the current step
+Flt_st *DumpCursor::record(const uint16_t i)
+{
+  switch ( buffer_step() )
+  {
+    case ( DUMP_SUM ):
+      return &mySum[i];
+    case ( DUMP_HIS ):
+      return sp.history(i);
+    default:
+      return sp.fault(i);
+  }
+}
+
+// Back-pressure:  each record goes to both Serial and Serial1 through the print router
+boolean DumpCursor::room()
+{
+  return ( rt.room(ROUTE_ALL) >= PRINT_MSG );
+}
+
+// Print up to n_rec records, resuming where the last pass stopped.  Called once per loop pass
+void DumpCursor::service(const uint8_t n_rec)
+{
+  uint8_t count = 0;
+  while ( active() && count < n_rec && room() )
+  {
+    if ( !started_ ) begin_step();
+    switch ( steps_[step_] )
+    {
+      case ( DUMP_SUM ):
+      case ( DUMP_HIS ):
+      case ( DUMP_FLT ):
+      case ( DUMP_PK_SUM ):
+      case ( DUMP_PK_HIS ):
+      case ( DUMP_PK_FLT ):
+        if ( n_ == 0 )
+        {
+          next_step();
+          break;
+        }
+        if ( ++i_ > (nbuf_-1) ) i_ = 0; // circular buffer
+        n_--;
+        if ( record(i_)->t_flt > 1UL )
+        {
+          if ( buffer_step()==steps_[step_] ) record(i_)->print_flt(code());
+          else flt_print_pk(*record(i_));
+          count++;
+        }
+        break;
+
+      case ( DUMP_HDR ):
+        sp.print_fault_header(pp.front());
+        count++;
+        next_step();
+        break;
+
+      case ( DUMP_CHIT ):  // Hold until the queued prints have run so they are not interleaved
+        if ( cp.soon_str.length() ) return;
+        next_step();
+        break;
+
+      default:
+        Serial.printf("\n");
+        next_step();
+    }
+  }
+}
@@ -29,6 +29,40 @@
 #include "command.h"
 #include "Fault.h"
 
+// Steps of a resumable dump.   DUMP_PK_* print the same records packed (FltPack.h), one line of hex each
+enum DumpStep {DUMP_SUM, DUMP_HIS, DUMP_FLT, DUMP_HDR, DUMP_CHIT, DUMP_NL, DUMP_PK_SUM, DUMP_PK_HIS, DUMP_PK_FLT};
+#define DUMP_MAX_STEPS  12  // Steps queued in one dump, 'Hd' uses 9 (12)
+
+// Resumable dump of the summary, history and fault buffers.  Prints a bounded number of records
+// each loop pass and only while the serial TX buffers have room, so a long 'Hd' does not hold up
+// the read and EKF frames
+class DumpCursor
+{
+public:
+  DumpCursor();
+  ~DumpCursor();
+  // operators
+  // functions
+  boolean active() { return ( step_ < n_steps_ ); }
+  boolean add(const DumpStep step);
+  void cancel();
+  void service(const uint8_t n_rec);
+protected:
+  void begin_step();
+  DumpStep buffer_step();
+  const char *code();
+  void next_step() { step_++; started_ = false; }
+  Flt_st *record(const uint16_t i);
+  boolean room();
+  uint16_t i_;                      // Index of last record printed in buffer
+  uint16_t n_;                      // Records remaining in current step
+  uint16_t nbuf_;                   // Length of current buffer
+  uint8_t n_steps_;                 // Number of steps queued
+  boolean started_;                 // Current step initialized
+  uint8_t step_;                    // Step in progress
+  DumpStep steps_[DUMP_MAX_STEPS];  // Queued steps
+};
+
 // Function prototypes
 void print_all_fault_buffer(const String code, struct Flt_st *sum, const uint16_t iflt, const uint16_t nflt);
 void reset_all_fault_buffer(const String code, struct Flt_st *sum, const uint16_t iflt, const uint16_t nflt);
@@ -0,0 +1,326 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "constants.h"
+#include "Clock.h"
+#include "TempArray.h"
+
+static const uint8_t TA_ADDR[] = TA_BRIDGES;
+static const TaMap TA_MAP[] = TA_MAP_UNIT;
+
+// ROM as one number, family code in the low byte
+static uint64_t ta_rom(const DS24821WireAddress &addr)
+{
+  uint64_t rom = 0ULL;
+  for ( int i=DS24821WireAddress::ADDR_SIZE-1; i>=0; i-- ) rom = (rom << 8) | addr[i];
+  return rom;
+}
+
+
+// class TempArray
+TempArray::TempArray()
+  : nb_(0), np_(0), n_good_(0), scan_ms_(0UL), tb_(0.), tb_max_(0.), tb_min_(0.)
+{
+  begin_(TA_ADDR, sizeof(TA_ADDR));
+}
+TempArray::TempArray(const uint8_t *addr, const uint8_t n)
+  : nb_(0), np_(0), n_good_(0), scan_ms_(0UL), tb_(0.), tb_max_(0.), tb_min_(0.)
+{
+  begin_(addr, n);
+}
+TempArray::~TempArray() {}
+
+// Bridges at addr, n of them
+void TempArray::begin_(const uint8_t *addr, const uint8_t n)
+{
+  nb_ = min(n, TA_NB);
+  for ( uint8_t b=0; b<nb_; b++ )
+  {
+    TaBridge *B = &b_[b];
+    B->addr = addr[b];
+    B->ds = new DS2482(Wire, B->addr);
+    B->state = TA_S_RESET;
+    B->busy = false;
+    B->next = 0;
+    B->t_search = B->t_scan = B->t_hold = 0ULL;
+    B->scan_ms = B->scan_ms_max = 0UL;
+    B->n_scan = 0;
+    B->status = DS2482Command::RESULT_DONE;
+  }
+}
+
+// Start all conversions on bridge b at once.   If that fails every probe on it takes a bad read
+void TempArray::convert_(const uint8_t b)
+{
+  TaBridge *B = &b_[b];
+  B->busy = true;
+  B->t_scan = Clock::millis();
+  DS2482ConvertTCommand::run(*B->ds, DS24821WireAddress(), [this, b](DS2482ConvertTCommand&, int status)
+  {
+    TaBridge *B = &b_[b];
+    B->busy = false;
+    if ( status!=DS2482Command::RESULT_DONE )
+    {
+      B->status = status;
+      for ( uint8_t k=0; k<np_; k++ ) if ( p_[k].bridge==b ) judge_(&p_[k], status, NULL);
+      fuse_();
+      B->t_hold = Clock::millis() + TA_T_RETRY;
+      B->state = TA_S_SEARCH;
+      return;
+    }
+    B->next = 0;
+    B->state = TA_S_READ;
+  }).withConversionSize(TA_CONV);
+}
+
+// Add the probes bridge b found to the array, keeping the record of those seen before
+void TempArray::enroll_(const uint8_t b)
+{
+  TaBridge *B = &b_[b];
+  for ( uint8_t k=0; k<np_; k++ ) if ( p_[k].bridge==b ) p_[k].seen = false;
+  for ( size_t i=0; i<B->list.getDeviceCount(); i++ )
+  {
+    DS24821WireAddress addr = B->list.getAddressByIndex(i);
+    uint8_t k = 0;
+    while ( k<np_ && !(p_[k].bridge==b && p_[k].addr==addr) ) k++;
+    if ( k==np_ )
+    {
+      if ( np_>=TA_NP ) break;
+      TaProbe *p = &p_[np_++];
+      p->addr = addr;
+      p->bridge = b;
+      p->str = 0;
+      p->cell = k;
+      p->weight = 1.;
+      p->t_raw = p->tc = 0.;
+      p->t_good = 0ULL;
+      p->n_bad = p->n_good = 0;
+      p->fail = false;
+      p->why = TA_OK;
+      p->n_read = p->n_fault = 0;
+      uint64_t rom = ta_rom(addr);
+      for ( uint8_t j=0; j<sizeof(TA_MAP)/sizeof(TaMap); j++ )
+        if ( TA_MAP[j].rom==rom ) { p->str = TA_MAP[j].str;  p->cell = TA_MAP[j].cell;  p->weight = TA_MAP[j].weight; }
+    }
+    p_[k].seen = true;
+  }
+}
+
+// Bank temperatures from the good probes.   A probe with no good read in TA_T_STALE fails here
+void TempArray::fuse_()
+{
+  unsigned long long now = Clock::millis();
+  float sum = 0.;
+  float sum_w = 0.;
+  uint8_t n = 0;
+  for ( uint8_t k=0; k<np_; k++ )
+  {
+    TaProbe *p = &p_[k];
+    if ( p->fail || p->n_read==p->n_fault ) continue;
+    if ( now - p->t_good > TA_T_STALE )
+    {
+      p->fail = true;
+      p->why = TA_F_LOST;
+      p->n_good = 0;
+      continue;
+    }
+    if ( n==0 || p->tc<tb_min_ ) tb_min_ = p->tc;
+    if ( n==0 || p->tc>tb_max_ ) tb_max_ = p->tc;
+    sum += p->weight * p->tc;
+    sum_w += p->weight;
+    n++;
+  }
+  n_good_ = n;
+  if ( n>0 && sum_w>0. ) tb_ = sum / sum_w;
+  else if ( n>0 ) tb_ = (tb_min_ + tb_max_) / 2.;
+}
+
+// Result of reading p:  bad if the read failed, returned the power-on value, is out of range or far from the others
+void TempArray::judge_(TaProbe *p, const int status, const uint8_t *scratchpad)
+{
+  uint8_t why = TA_OK;
+  p->n_read++;
+  if ( status!=DS2482Command::RESULT_DONE || scratchpad==NULL ) why = TA_F_READ;
+  else
+  {
+    p->t_raw = DS2482GetTemperatureCommand::convertTemp(scratchpad, TA_CONV);
+    if ( p->t_raw==TA_POR_C ) why = TA_F_POR;
+    else if ( p->t_raw<TEMP_RANGE_CHECK || p->t_raw>TEMP_RANGE_CHECK_MAX ) why = TA_F_RANGE;
+    else
+    {
+      // Median of the other good probes, when there are enough to outvote this one
+      float t[TA_NP];
+      uint8_t n = 0;
+      for ( uint8_t k=0; k<np_; k++ )
+      {
+        TaProbe *q = &p_[k];
+        if ( q==p || q->fail || q->n_read==q->n_fault ) continue;
+        uint8_t i = n++;
+        while ( i>0 && t[i-1]>q->tc ) { t[i] = t[i-1];  i--; }
+        t[i] = q->tc;
+      }
+      if ( n>=3 )
+      {
+        float med = ( n & 1 ) ? t[n/2] : (t[n/2-1] + t[n/2]) / 2.;
+        if ( fabs(p->t_raw - med) > TA_DEV_MAX ) why = TA_F_DEV;
+      }
+    }
+  }
+  if ( why==TA_OK )
+  {
+    p->tc = p->t_raw;
+    p->t_good = Clock::millis();
+    p->n_bad = 0;
+    if ( p->fail && ++p->n_good>=TA_N_GOOD ) p->fail = false;
+  }
+  else
+  {
+    p->n_fault++;
+    p->why = why;
+    p->n_good = 0;
+    if ( p->n_bad<UINT8_MAX ) p->n_bad++;
+    if ( p->n_bad>=TA_N_BAD ) p->fail = true;
+  }
+}
+
+// Call every pass.   Runs the bridges' command queues and starts the next step of each idle bridge
+void TempArray::loop()
+{
+  unsigned long long now = Clock::millis();
+  for ( uint8_t b=0; b<nb_; b++ )
+  {
+    TaBridge *B = &b_[b];
+    B->ds->loop();
+    if ( B->busy || now<B->t_hold ) continue;
+    switch ( B->state )
+    {
+      case ( TA_S_SEARCH ):
+        if ( now - B->t_scan < TA_T_SCAN ) break;
+        if ( now - B->t_search >= TA_T_SEARCH ) search_(b);
+        else convert_(b);
+        break;
+      case ( TA_S_CONVERT ):
+        convert_(b);
+        break;
+      case ( TA_S_READ ):
+        read_(b);
+        break;
+      default:
+        break;
+    }
+  }
+}
+
+void TempArray::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  static const char *why[] = {"", "read", "85C", "range", "dev", "lost"};
+  Serial.printf("TempArray:  tb %7.2f min %7.2f max %7.2f deg C, %d of %d probes good\n", tb_, tb_min_, tb_max_,
+    n_good_, np_);
+  for ( uint8_t b=0; b<nb_; b++ )
+    Serial.printf(" bridge %d:  0x%02x scans %ld, scan %ld ms (max %ld), status %d\n", b, b_[b].addr, (long)b_[b].n_scan,
+      (long)b_[b].scan_ms, (long)b_[b].scan_ms_max, b_[b].status);
+  Serial.printf(" rom              br str cell   wt      tc   t_raw  reads    bad fail\n");
+  for ( uint8_t k=0; k<np_; k++ )
+  {
+    TaProbe *p = &p_[k];
+    Serial.printf(" %016llx %2d %3d %4d %4.2f %7.2f %7.2f %6ld %6ld %4d %s%s\n", (unsigned long long)ta_rom(p->addr),
+      p->bridge, p->str, p->cell, p->weight, p->tc, p->t_raw, (long)p->n_read, (long)p->n_fault, p->fail,
+      p->fail ? why[p->why] : "", p->seen ? "" : " unseen");
+  }
+#else
+  Serial.printf("TempArray: silent DEPLOY\n");
+#endif
+}
+
+// Read the next probe of bridge b.   Past the last one the scan is done:  fuse and start over
+void TempArray::read_(const uint8_t b)
+{
+  TaBridge *B = &b_[b];
+  uint8_t k = B->next;
+  while ( k<np_ && p_[k].bridge!=b ) k++;
+  if ( k>=np_ )
+  {
+    B->scan_ms = (unsigned long)(Clock::millis() - B->t_scan);
+    B->scan_ms_max = max(B->scan_ms_max, B->scan_ms);
+    B->n_scan++;
+    scan_ms_ = 0UL;
+    for ( uint8_t c=0; c<nb_; c++ ) scan_ms_ = max(scan_ms_, b_[c].scan_ms);
+    fuse_();
+    B->state = TA_S_SEARCH;
+    return;
+  }
+  B->busy = true;
+  DS2482ReadScratchpadCommand::run(*B->ds, p_[k].addr, [this, b, k](DS2482ReadScratchpadCommand&, int status,
+    uint8_t *scratchpad)
+  {
+    TaBridge *B = &b_[b];
+    B->busy = false;
+    if ( status!=DS2482Command::RESULT_DONE ) B->status = status;
+    judge_(&p_[k], status, scratchpad);
+    B->next = k + 1;
+  });
+}
+
+// Enumerate bridge b.   On failure the probes found before are still converted and read
+void TempArray::search_(const uint8_t b)
+{
+  TaBridge *B = &b_[b];
+  B->busy = true;
+  B->t_search = Clock::millis();
+  DS2482SearchBusCommand::run(*B->ds, B->list, [this, b](DS2482SearchBusCommand&, int status)
+  {
+    TaBridge *B = &b_[b];
+    B->busy = false;
+    if ( status!=DS2482Command::RESULT_DONE )
+    {
+      B->status = status;
+      B->t_search = Clock::millis() + TA_T_RETRY - TA_T_SEARCH;
+    }
+    else enroll_(b);
+    B->state = TA_S_CONVERT;
+  });
+}
+
+// Reset each bridge, then start its rotation TA_T_STAGGER after the one before
+void TempArray::setup()
+{
+  unsigned long long now = Clock::millis();
+  for ( uint8_t b=0; b<nb_; b++ )
+  {
+    TaBridge *B = &b_[b];
+    B->ds->setup();
+    B->busy = true;
+    B->t_hold = now + (unsigned long long)b * TA_T_STAGGER;
+    B->t_search = now - TA_T_SEARCH;
+    B->t_scan = now - TA_T_SCAN;
+    DS2482DeviceReset::run(*B->ds, [this, b](DS2482DeviceReset&, int status)
+    {
+      TaBridge *B = &b_[b];
+      B->busy = false;
+      if ( status!=DS2482Command::RESULT_DONE ) B->status = status;
+      B->state = TA_S_SEARCH;
+    });
+  }
+}
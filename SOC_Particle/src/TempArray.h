@@ -0,0 +1,153 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _TEMP_ARRAY_H
+#define _TEMP_ARRAY_H
+
+#include "application.h"
+#include "DS2482-RK.h"
+
+#define TA_NB           4         // Most DS2482 bridges (4)
+#define TA_NP_BRIDGE    16        // Most probes one bridge enumerates (16)
+#define TA_NP           32        // Most probes, all bridges (32)
+#define TA_CONV         DS2482Command::CONVERSION_12BIT   // Resolution, 750 ms conversion (CONVERSION_12BIT)
+#define TA_T_SCAN       6000UL    // Start of a scan after the one before, about READ_TEMP_DELAY, ms (6000UL)
+#define TA_T_SEARCH     600000UL  // Re-enumerate each bus, ms (600000UL = 10 min)
+#define TA_T_STAGGER    250UL     // Start of each bridge after the one before, spreads the conversion current, ms (250UL)
+#define TA_T_STALE      30000UL   // No good read this long fails a probe, ms (30000UL)
+#define TA_T_RETRY      1000UL    // Wait after a failed search or conversion, ms (1000UL)
+#define TA_N_BAD        3         // Bad reads in a row that fail a probe (3)
+#define TA_N_GOOD       3         // Good reads in a row that clear it (3)
+#define TA_DEV_MAX      8.        // Largest departure from the median of the good probes, deg C (8.)
+#define TA_POR_C        85.       // DS18B20 power-on scratchpad, read when a conversion did not run, deg C (85.)
+#ifndef TA_BRIDGES
+  #define TA_BRIDGES    {0}       // DS2482 addresses, 0-3 or an I2C address ({0})
+#endif
+#ifndef TA_MAP_UNIT
+  #define TA_MAP_UNIT   {{0ULL, 0, 0, 1.}}  // TaMap of the unit's probes, ROM 0 is never found ({{0ULL, 0, 0, 1.}})
+#endif
+
+// Why a probe's last read was bad
+enum TaFault : uint8_t {TA_OK, TA_F_READ, TA_F_POR, TA_F_RANGE, TA_F_DEV, TA_F_LOST};
+
+// Place of a probe in the bank, by ROM.   Probes not in TA_MAP keep weight 1 and are numbered in search order
+struct TaMap
+{
+  uint64_t rom;         // ROM as printed by 'PT', family code in the low byte
+  uint8_t str;          // String
+  uint8_t cell;         // Cell in the string
+  float weight;         // Share of the weighted bank temperature
+};
+
+// One DS18B20
+struct TaProbe
+{
+  DS24821WireAddress addr;  // ROM
+  uint8_t bridge;       // Bridge it hangs on
+  uint8_t str;          // String, TA_MAP
+  uint8_t cell;         // Cell, TA_MAP
+  float weight;         // TA_MAP
+  float t_raw;          // Last read, deg C
+  float tc;             // Last good read, deg C
+  unsigned long long t_good;  // Time of the last good read, ms
+  uint8_t n_bad;        // Bad reads in a row
+  uint8_t n_good;       // Good reads in a row
+  boolean fail;         // Out of the fusion, T=failed
+  uint8_t why;          // TaFault of the last bad read
+  boolean seen;         // Found by the last search
+  uint32_t n_read;      // Reads
+  uint32_t n_fault;     // Bad reads
+};
+
+// Rotation of one bridge
+enum TaState : uint8_t {TA_S_RESET, TA_S_SEARCH, TA_S_CONVERT, TA_S_READ};
+struct TaBridge
+{
+  DS2482 *ds;
+  uint8_t addr;         // TA_BRIDGES entry
+  DS2482DeviceListStatic<TA_NP_BRIDGE> list;  // Last search
+  uint8_t state;        // TaState
+  boolean busy;         // Command queued on the bridge
+  uint8_t next;         // Probe being read
+  unsigned long long t_search;  // Last search, ms
+  unsigned long long t_scan;    // Start of this scan, ms
+  unsigned long long t_hold;    // Stagger, start no earlier, ms
+  unsigned long scan_ms;        // Last whole scan, ms
+  unsigned long scan_ms_max;    // Longest scan, ms
+  uint32_t n_scan;      // Scans
+  int status;           // Last failed command, DS2482Command::RESULT_*
+};
+
+/* Array of DS18B20 probes on one or more DS2482 1-wire bridges, in place of the one probe MyDs2482_Class reads.
+    Each bridge runs on its own, one command at a time and never waiting in loop():  enumerate the ROMs (search),
+    start every conversion at once (skip ROM, Convert T), read the probes' scratchpads one after another, and
+    start over TA_T_SCAN after the last start.   The search runs once in TA_T_SEARCH rather than ahead of every scan
+    as in MyDs2482_Class::check, and the bridges scan side by side, started TA_T_STAGGER apart.   A read is bad if
+    it fails (no presence, CRC after the library's retries), reads the power-on 85 C, is out of the range check, or
+    departs from the median of the good probes by more than TA_DEV_MAX; TA_N_BAD in a row, or no good read in
+    TA_T_STALE, fail the probe and leave it out of the fusion until TA_N_GOOD good reads in a row.   tb() is the
+    weighted mean of the good probes, tb_min() and tb_max() their extremes.
+*/
+class TempArray
+{
+public:
+  TempArray();
+  TempArray(const uint8_t *addr, const uint8_t n);
+  ~TempArray();
+  // operators
+  // functions
+  TaBridge *bridge(const uint8_t b) { return ( b<nb_ ) ? &b_[b] : NULL; };
+  uint8_t n_bridge() { return nb_; };
+  uint8_t n_good() { return n_good_; };
+  uint8_t n_probe() { return np_; };
+  void loop();
+  void pretty_print();
+  TaProbe *probe(const uint8_t k) { return ( k<np_ ) ? &p_[k] : NULL; };
+  boolean ready() { return n_good_>0; };
+  void search() { for ( uint8_t b=0; b<nb_; b++ ) b_[b].t_search = 0ULL; };
+  void setup();
+  unsigned long scan_ms() { return scan_ms_; };
+  float tb() { return tb_; };
+  float tb_max() { return tb_max_; };
+  float tb_min() { return tb_min_; };
+protected:
+  TaBridge b_[TA_NB];     // Bridges
+  uint8_t nb_;            // Bridges in use
+  TaProbe p_[TA_NP];      // Probes, all bridges
+  uint8_t np_;            // Probes found
+  uint8_t n_good_;        // Probes in the fusion
+  unsigned long scan_ms_; // Longest last scan of the bridges, ms
+  float tb_;              // Weighted mean of the good probes, deg C
+  float tb_max_;          // Hottest good probe, deg C
+  float tb_min_;          // Coldest good probe, deg C
+  void begin_(const uint8_t *addr, const uint8_t n);
+  void convert_(const uint8_t b);
+  void enroll_(const uint8_t b);
+  void fuse_();
+  void judge_(TaProbe *p, const int status, const uint8_t *scratchpad);
+  void read_(const uint8_t b);
+  void search_(const uint8_t b);
+};
+
+#endif
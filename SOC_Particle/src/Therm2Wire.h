@@ -0,0 +1,99 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef THERM_2WIRE_H_
+#define THERM_2WIRE_H_
+
+#include "constants.h"
+
+// 2-wire thermistor counts to deg C without a divide or log10 at run time.   The HDWE_*_2WIRE characteristic is
+// evaluated by the compiler at every 2^TB2W_SEG_BITS counts and interpolated between.   TempSensor::sample sums
+// 2^TB2W_OVER_BITS reads, which adds that many bits of resolution to the index.   cppStateOfCharge/soc_therm
+// checks the table against the formula
+#define TB2W_SEG_BITS   4         // Counts per table segment, 2^n (4)
+#define TB2W_NSEG       (PHOTON_ADC_COUNT >> TB2W_SEG_BITS)  // Table segments (256)
+#define TB2W_OVER_BITS  2         // analogRead per sample, 2^n (2)
+#define TB2W_T_MIN      -60.      // Table clip where the characteristic runs off at the rails, deg C (-60.)
+#define TB2W_T_MAX      120.      // Table clip where the characteristic runs off at the rails, deg C (120.)
+
+// Natural log for the compiler.   Halve to [1, 2) then atanh series
+constexpr double tb2w_ln(double x)
+{
+  if ( x<=0. ) return -1e300;
+  double k = 0.;
+  while ( x>=2. ) { x *= 0.5; k += 1.; }
+  while ( x<1. ) { x *= 2.; k -= 1.; }
+  double y = (x - 1.) / (x + 1.);
+  double y2 = y*y;
+  double term = y;
+  double sum = 0.;
+  for ( int n=1; n<60; n+=2 )
+  {
+    sum += term / double(n);
+    term *= y2;
+  }
+  return k*0.69314718055994530942 + 2.*sum;
+}
+
+// The characteristic, as TempSensor::sample had it, of counts
+constexpr double tb2w_formula(const double counts)
+{
+  double volt = counts * double(PHOTON_ADC_VOLT) / double(PHOTON_ADC_COUNT) * double(VTB_S);
+  double r = volt * double(HDWE_RS_2WIRE) / (double(V3V3) - volt);
+  return double(HDWE_M_2WIRE) * tb2w_ln(r) / 2.30258509299404568402 + double(HDWE_B_2WIRE);
+}
+
+struct Tb2wTable
+{
+  float t[TB2W_NSEG+1];     // deg C at every 2^TB2W_SEG_BITS counts
+};
+
+constexpr Tb2wTable tb2w_make()
+{
+  Tb2wTable tab = {};
+  for ( int i=0; i<=TB2W_NSEG; i++ )
+  {
+    double counts = double(i << TB2W_SEG_BITS);
+    double rail = double(HDWE_M_2WIRE)<0. ? 1e300 : -1e300;  // Formula at 0 counts; the other rail is opposite
+    double t = rail;
+    if ( counts>=double(PHOTON_ADC_COUNT) ) t = -rail;
+    else if ( counts>0. ) t = tb2w_formula(counts);
+    tab.t[i] = float(max(min(t, TB2W_T_MAX), TB2W_T_MIN));
+  }
+  return tab;
+}
+
+static constexpr Tb2wTable tb2w_table = tb2w_make();
+
+// Sum of 2^TB2W_OVER_BITS reads to deg C
+inline float tb2w_lookup(const uint32_t sum)
+{
+  const uint8_t shift = TB2W_SEG_BITS + TB2W_OVER_BITS;
+  uint32_t i = sum >> shift;
+  if ( i>=TB2W_NSEG ) return tb2w_table.t[TB2W_NSEG];
+  float frac = float(sum & ((1UL << shift) - 1)) * (1.f / float(1UL << shift));
+  return tb2w_table.t[i] + frac*(tb2w_table.t[i+1] - tb2w_table.t[i]);
+}
+
+#endif
@@ -0,0 +1,189 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "Usage.h"
+
+String time_long_2_str(const time_t current_time, char *tempStr);
+
+// Upper edges of the histogram bins below the last
+static const float use_ib_edge[USE_NIB-1] = {-20., -5., -1., 1., 5., 20.};  // Bank current, A
+static const float use_tb_edge[USE_NTB-1] = {0., 10., 20., 30., 40.};       // Bank temperature, C
+
+static uint8_t use_bin(const float x, const float *edge, const uint8_t n)
+{
+  uint8_t i = 0;
+  while ( i<n-1 && x>=edge[i] ) i++;
+  return i;
+}
+
+static void use_tick(uint16_t *minutes)
+{
+  if ( *minutes<65535 ) (*minutes)++;
+}
+
+
+// struct Usage_st
+void Usage_st::nominal(const unsigned long t)
+{
+  t_beg = t;
+  ah_chg = ah_dis = wh_chg = wh_dis = 0.;
+  tb_min = 127;
+  tb_max = -128;
+  soc_min = 255;
+  soc_max = 0;
+  for ( uint8_t i=0; i<USE_NSOC; i++ ) min_soc[i] = 0;
+  for ( uint8_t i=0; i<USE_NIB; i++ ) min_ib[i] = 0;
+  for ( uint8_t i=0; i<USE_NTB; i++ ) min_tb[i] = 0;
+}
+
+void Usage_st::pretty_print(const char *code)
+{
+  char buffer[32];
+  time_long_2_str(t_beg, buffer);
+  Serial.printf("%-6s %s %8.2f %8.2f %8.1f %8.1f", code, buffer, ah_chg, ah_dis, wh_chg, wh_dis);
+  if ( soc_min<=soc_max ) Serial.printf(" %4d %4d %4d %4d\n", tb_min, tb_max, soc_min, soc_max);
+  else Serial.printf("    -    -    -    -\n");
+  Serial.printf("  soc  ");
+  for ( uint8_t i=0; i<USE_NSOC; i++ ) Serial.printf("%6d", min_soc[i]);
+  Serial.printf("\n  ib   ");
+  for ( uint8_t i=0; i<USE_NIB; i++ ) Serial.printf("%6d", min_ib[i]);
+  Serial.printf("\n  Tb   ");
+  for ( uint8_t i=0; i<USE_NTB; i++ ) Serial.printf("%6d", min_tb[i]);
+  Serial.printf("\n");
+}
+
+
+// struct UsageLog_st
+void UsageLog_st::nominal()
+{
+  key = USE_KEY;
+  iday = iweek = 0;
+  ah_chg = ah_dis = wh_chg = wh_dis = ib_t = t_acc = 0.;
+  for ( uint8_t i=0; i<USE_NDAY; i++ ) day[i].nominal(0UL);
+  for ( uint8_t i=0; i<USE_NWEEK; i++ ) week[i].nominal(0UL);
+}
+
+void UsageLog_st::pretty_print()
+{
+  Serial.printf("Usage, UTC periods, minutes in bins:\n");
+  Serial.printf("%-6s %-19s %8s %8s %8s %8s %4s %4s %4s %4s\n", "", "start", "Ah_chg", "Ah_dis", "Wh_chg", "Wh_dis",
+    "Tb_n", "Tb_x", "sc_n", "sc_x");
+  today()->pretty_print("today");
+  yesterday()->pretty_print("yest");
+  this_week()->pretty_print("week");
+  last_week()->pretty_print("lastwk");
+  Serial.printf("  bins soc 0.1 wide; ib <%.0f", use_ib_edge[0]);
+  for ( uint8_t i=1; i<USE_NIB-1; i++ ) Serial.printf(",%.0f", use_ib_edge[i]);
+  Serial.printf(",> A; Tb <%.0f", use_tb_edge[0]);
+  for ( uint8_t i=1; i<USE_NTB-1; i++ ) Serial.printf(",%.0f", use_tb_edge[i]);
+  Serial.printf(",> C\n");
+}
+
+// Fold the counters into today and this week, with one histogram sample
+void UsageLog_st::fold(const unsigned long t, const float soc, const float tb)
+{
+  roll(t);
+  float ib_avg = ib_t / t_acc;
+  int8_t tb_c = int8_t(max(min(tb, 127.), -128.));
+  uint8_t soc_pct = uint8_t(max(min(soc*100., 255.), 0.));
+  uint8_t i_soc = uint8_t(max(min(soc*float(USE_NSOC), float(USE_NSOC-1)), 0.));
+  uint8_t i_ib = use_bin(ib_avg, use_ib_edge, USE_NIB);
+  uint8_t i_tb = use_bin(tb, use_tb_edge, USE_NTB);
+  Usage_st *per[2] = {today(), this_week()};
+  for ( uint8_t k=0; k<2; k++ )
+  {
+    Usage_st *p = per[k];
+    p->ah_chg += ah_chg;
+    p->ah_dis += ah_dis;
+    p->wh_chg += wh_chg;
+    p->wh_dis += wh_dis;
+    p->tb_min = min(p->tb_min, tb_c);
+    p->tb_max = max(p->tb_max, tb_c);
+    p->soc_min = min(p->soc_min, soc_pct);
+    p->soc_max = max(p->soc_max, soc_pct);
+    use_tick(&p->min_soc[i_soc]);
+    use_tick(&p->min_ib[i_ib]);
+    use_tick(&p->min_tb[i_tb]);
+  }
+  ah_chg = ah_dis = wh_chg = wh_dis = ib_t = t_acc = 0.;
+}
+
+// Start new periods when t has left today or this week
+void UsageLog_st::roll(const unsigned long t)
+{
+  unsigned long d = t / 86400UL;
+  unsigned long day_beg = d * 86400UL;
+  unsigned long week_beg = ((d + 3UL) / 7UL * 7UL - 3UL) * 86400UL;  // 1970-01-01 was a Thursday
+  if ( today()->t_beg!=day_beg )
+  {
+    unsigned long last_beg = today()->t_beg;
+    if ( last_beg!=0UL ) iday = (iday + 1) % USE_NDAY;
+    today()->nominal(day_beg);
+    // Off for more than a day:  yesterday was not logged, so don't label the old day as yesterday
+    if ( last_beg!=0UL && day_beg > last_beg + 86400UL ) yesterday()->nominal(day_beg - 86400UL);
+  }
+  if ( this_week()->t_beg!=week_beg )
+  {
+    unsigned long last_beg = this_week()->t_beg;
+    if ( last_beg!=0UL ) iweek = (iweek + 1) % USE_NWEEK;
+    this_week()->nominal(week_beg);
+    if ( last_beg!=0UL && week_beg > last_beg + 604800UL ) last_week()->nominal(week_beg - 604800UL);
+  }
+}
+
+/* UsageLog_st::update:  Integrate and, every USE_SAMPLE, fold into the periods
+Inputs:
+  t               Time, Unix s
+  T               Update time, s
+  ib              Bank current, A
+  wb              Bank power, W
+  soc             State of charge, fraction
+  tb              Bank temperature, C
+  reset           Start over the partial sample, T=reset
+Outputs:
+  day, week       Periods
+*/
+void UsageLog_st::update(const unsigned long t, const float T, const float ib, const float wb, const float soc,
+  const float tb, const boolean reset)
+{
+  if ( key!=USE_KEY ) nominal();
+  if ( reset || t<USE_T_VALID )
+  {
+    ah_chg = ah_dis = wh_chg = wh_dis = ib_t = t_acc = 0.;
+    return;
+  }
+  if ( ib>0. )
+  {
+    ah_chg += ib * T / 3600.;
+    wh_chg += wb * T / 3600.;
+  }
+  else
+  {
+    ah_dis -= ib * T / 3600.;
+    wh_dis -= wb * T / 3600.;
+  }
+  ib_t += ib * T;
+  t_acc += T;
+  if ( t_acc>=USE_SAMPLE ) fold(t, soc, tb);
+}
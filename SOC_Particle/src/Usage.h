@@ -0,0 +1,87 @@
+//
+// MIT License
+//
+// Copyright (C) 2023 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef _USAGE_H
+#define _USAGE_H
+
+#include "application.h"
+
+#define USE_NDAY        2         // Days kept, today and yesterday (2)
+#define USE_NWEEK       2         // Weeks kept, this week and last week, Monday 00:00 UTC start (2)
+#define USE_NSOC        10        // soc histogram bins, 0.1 wide (10)
+#define USE_NIB         7         // ib histogram bins, edges in use_ib_edge (7)
+#define USE_NTB         6         // Tb histogram bins, edges in use_tb_edge (6)
+#define USE_SAMPLE      60.       // Histogram sample and counter fold time, s (60.)
+#define USE_KEY         0x55534531UL  // Retained layout marker, 'USE1'.  Change with the layout
+#define USE_T_VALID     1577836800UL  // Clock not yet synced before this, Unix s (2020-01-01)
+
+// Battery use over one period.  Histograms are minutes spent in each bin
+struct Usage_st
+{
+  unsigned long t_beg;        // Start of period, Unix s
+  float ah_chg;               // Charge in, bank, A-h
+  float ah_dis;               // Charge out, bank, A-h
+  float wh_chg;               // Energy in, bank, W-h
+  float wh_dis;               // Energy out, bank, W-h
+  int8_t tb_min;              // Minimum Tb, C
+  int8_t tb_max;              // Maximum Tb, C
+  uint8_t soc_min;            // Minimum soc, percent
+  uint8_t soc_max;            // Maximum soc, percent
+  uint16_t min_soc[USE_NSOC]; // Minutes in each soc bin
+  uint16_t min_ib[USE_NIB];   // Minutes in each ib bin
+  uint16_t min_tb[USE_NTB];   // Minutes in each Tb bin
+  void nominal(const unsigned long t);
+  void pretty_print(const char *code);
+};
+
+// Rolling day and week usage.   Plain data so it can be retained through a warm boot; validity by key.
+// Counters integrate every call and fold into the periods once per USE_SAMPLE with one histogram sample,
+// so a query is a read of one period
+struct UsageLog_st
+{
+  uint32_t key;               // USE_KEY when contents valid
+  uint8_t iday;               // Slot of today in day
+  uint8_t iweek;              // Slot of this week in week
+  float ah_chg;               // Charge in since last fold, A-h
+  float ah_dis;               // Charge out since last fold, A-h
+  float wh_chg;               // Energy in since last fold, W-h
+  float wh_dis;               // Energy out since last fold, W-h
+  float ib_t;                 // Integral of ib since last fold, A-s
+  float t_acc;                // Time since last fold, s
+  Usage_st day[USE_NDAY];     // Days, newest at iday
+  Usage_st week[USE_NWEEK];   // Weeks, newest at iweek
+  Usage_st *last_week() { return &week[(iweek + USE_NWEEK - 1) % USE_NWEEK]; };
+  void nominal();
+  void pretty_print();
+  Usage_st *this_week() { return &week[iweek]; };
+  Usage_st *today() { return &day[iday]; };
+  void update(const unsigned long t, const float T, const float ib, const float wb, const float soc, const float tb,
+    const boolean reset);
+  Usage_st *yesterday() { return &day[(iday + USE_NDAY - 1) % USE_NDAY]; };
+protected:
+  void fold(const unsigned long t, const float soc, const float tb);
+  void roll(const unsigned long t);
+};
+
+#endif
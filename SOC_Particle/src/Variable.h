@@ -25,9 +25,12 @@
 #define VARIABLE_H_
 
 #include "hardware/SerialRAM.h"
+#include "ParRegistry.h"
 #include "PrinterPars.h"
+#include "PrintRouter.h"
 
 extern PrinterPars pr;  // Print buffer
+extern PrintRouter rt;  // Serial and Serial1 print router
 
 #undef max
 #define max(a, b) (((a) > (b)) ? (a) : (b))
@@ -44,14 +47,10 @@ class Variable
 public:
     Variable(){}
 
-    Variable(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units,
-        const boolean check_for_off_on_init=true)
+    Variable(const ParDef *def, SerialRAM *ram, const uint8_t type)
     {
-        prefix_ = prefix;
-        code_ = code;
-        description_ = description.substring(0, 20);
-        units_ = units.substring(0, 10);
-        check_for_off_on_init_ = check_for_off_on_init;
+        def_ = def;
+        if ( def_->type!=type ) Serial.printf("%s registry type %d, class %d\n", def_->code, def_->type, type);
         is_eeram_ = !(ram==NULL);
         rP_ = ram;
         // app_ = app;
@@ -62,31 +61,32 @@ public:
     fptr app_;
     fptr app() { return app_; }
     // void app(fptr ptr) { app_ = ptr; }
-    String code() { return code_; }
-    const char* description() { return description_.c_str(); }
+    const char* code() { return def_->code; }
+    const ParDef *def() { return def_; }
+    const char* description() { return def_->description; }
     boolean success() { return success_; }
-    const char* units() { return units_.c_str(); }
+    const char* prefix() { return def_->saved ? "* " : "  "; }
+    const char* units() { return def_->units; }
 
     // Placeholders
     virtual uint16_t assign_addr(uint16_t next){return next;}
     virtual void get(){};
+    virtual void get_from(const uint8_t *buf){};
     virtual boolean is_corrupt(){return false;};
     virtual boolean is_eeram(){return is_eeram_;};
     virtual boolean is_off(){return false;};
     virtual boolean off_nominal(){return false;};
-    virtual void print(){};
+    virtual void print(const uint8_t route=ROUTE_USB){};
     virtual boolean print_adjust(const String &str){return false;};
+    virtual uint16_t put(){return 0;};
     virtual void set_nominal(){};
+    virtual double value(){return 0.;};
 
 protected:
-    String code_;
+    const ParDef *def_;     // Code, description, units, limits and nominal in flash
     SerialRAM *rP_;
     address16b addr_;
-    String units_;
-    String description_;
     boolean is_eeram_;      // eeram
-    boolean check_for_off_on_init_;  // check for off-nominal on initialization
-    String prefix_;         // either "* " saved or "  " not saved
     boolean success_;       // result of print_adjust
 };
 
@@ -96,20 +96,19 @@ class BooleanV: public Variable
 public:
     BooleanV(){}
 
-    BooleanV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const boolean min, const boolean max,
-    boolean *store, const boolean _default=false, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    BooleanV(const ParDef *def, SerialRAM *ram, boolean *store):
+        Variable(def, ram, PAR_BOOLEAN)
     {
-        min_ = min;
-        max_ = max;
+        min_ = boolean(def_->min);
+        max_ = boolean(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(boolean(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~BooleanV(){}
 
-    uint16_t assign_addr(boolean next)
+    uint16_t assign_addr(uint16_t next)
     {
         addr_.a16 = next;
         return next + sizeof(boolean);
@@ -119,7 +118,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            Serial.printf("%s %s set:: out range %d (%d, %d)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            Serial.printf("%s %.20s set:: out range %d (%d, %d)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -135,16 +134,21 @@ public:
         if ( is_eeram_ ) *val_ = rP_->read(addr_.a16);
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        *val_ = buf[0];
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -154,64 +158,59 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9d -> %9d, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-20.20s %9d -> %9d, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
 
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
+        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
 
-    void print_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-
-    void print1_help()
-    {
-        print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toInt());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const boolean input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
    
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->write(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->write(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     boolean *val_;
     boolean min_;
@@ -225,15 +224,14 @@ class DoubleV: public Variable
 public:
     DoubleV(){}
 
-    DoubleV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const double min, const double max, double *store,
-        const double _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    DoubleV(const ParDef *def, SerialRAM *ram, double *store):
+        Variable(def, ram, PAR_DOUBLE)
     {
-        min_ = min;
-        max_ = max;
+        min_ = double(def_->min);
+        max_ = double(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(double(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~DoubleV(){}
@@ -248,7 +246,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %7.3f (%7.3f, %7.3f)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %7.3f (%7.3f, %7.3f)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -267,16 +265,21 @@ public:
         }
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        memcpy(val_, buf, sizeof(*val_));
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -286,64 +289,59 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9.1f -> %9.1f, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-20.20s %9.1f -> %9.1f, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
     
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-        sprintf(pr.buff, "%s%-2s= %6.1f: (%-6.1f-%6.1f) [%6.1f] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
+        sprintf(pr.buff, "%s%-2s= %6.1f: (%-6.1f-%6.1f) [%6.1f] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
     
-    void print_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-
-    void print1_help()
-    {
-        print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toFloat());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const double input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     double *val_;
     double default_;
@@ -357,15 +355,14 @@ class FloatV: public Variable
 public:
     FloatV(){}
 
-    FloatV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const float min, const float max,
-    float *store, const float _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    FloatV(const ParDef *def, SerialRAM *ram, float *store):
+        Variable(def, ram, PAR_FLOAT)
     {
-        min_ = min;
-        max_ = max;
+        min_ = float(def_->min);
+        max_ = float(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(float(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~FloatV(){}
@@ -380,7 +377,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %7.3f (%7.3f, %7.3f)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %7.3f (%7.3f, %7.3f)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -399,16 +396,21 @@ public:
         }
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        memcpy(val_, buf, sizeof(*val_));
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -418,64 +420,59 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9.3f -> %9.3f, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
-    }
-
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
+        sprintf(pr.buff, " %-20.20s %9.3f -> %9.3f, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
 
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
     
     void print_help_str()
     {
-        sprintf(pr.buff, "%s%-2s= %6.3f: (%-6.3g-%6.3g) [%6.3f] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
-    }
-
-    void print_help()
-    {
-        print_help_str();
-        Serial.printf("%s\n", pr.buff);
+        sprintf(pr.buff, "%s%-2s= %6.3f: (%-6.3g-%6.3g) [%6.3f] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
 
-    void print1_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toFloat());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const float input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     float *val_;
     float default_;
@@ -489,15 +486,14 @@ class IntV: public Variable
 public:
     IntV(){}
 
-    IntV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const int min, const int max, int *store,
-        const int _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    IntV(const ParDef *def, SerialRAM *ram, int *store):
+        Variable(def, ram, PAR_INT)
     {
-        min_ = min;
-        max_ = max;
+        min_ = int(def_->min);
+        max_ = int(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(int(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~IntV(){}
@@ -512,7 +508,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %d (%d, %d)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %d (%d, %d)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -531,16 +527,21 @@ public:
         }
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        memcpy(val_, buf, sizeof(*val_));
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -550,63 +551,58 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9d -> %9d, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-20.20s %9d -> %9d, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-      sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
+      sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
 
-    void print_help()
-    {
-        print_help_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
     
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toInt());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const int input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     int *val_;
     int min_;
@@ -620,15 +616,14 @@ class Int8tV: public Variable
 public:
     Int8tV(){}
 
-    Int8tV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const int8_t min, const int8_t max,
-        int8_t *store, const int8_t _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    Int8tV(const ParDef *def, SerialRAM *ram, int8_t *store):
+        Variable(def, ram, PAR_INT8)
     {
-        min_ = min;
-        max_ = max;
+        min_ = int8_t(def_->min);
+        max_ = int8_t(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(int8_t(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~Int8tV(){}
@@ -643,7 +638,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %d (%d, %d)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %d (%d, %d)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -662,16 +657,21 @@ public:
         }
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        memcpy(val_, buf, sizeof(*val_));
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -681,64 +681,59 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9d -> %9d, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-20.20s %9d -> %9d, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
 
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-      sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
+      sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
 
-    void print_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1_help()
-    {
-        print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
     
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toInt());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const int8_t input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     int8_t *val_;
     int8_t min_;
@@ -752,15 +747,14 @@ class Uint16tV: public Variable
 public:
     Uint16tV(){}
 
-    Uint16tV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const uint16_t min, const uint16_t max,
-    uint16_t *store, const uint16_t _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    Uint16tV(const ParDef *def, SerialRAM *ram, uint16_t *store):
+        Variable(def, ram, PAR_UINT16)
     {
-        min_ = min;
-        max_ = max;
+        min_ = uint16_t(def_->min);
+        max_ = uint16_t(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(uint16_t(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
      }
 
     ~Uint16tV(){}
@@ -775,32 +769,37 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %d (%d, %d)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %d (%d, %d)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
         {
             *val_ = val;
-            if ( is_eeram_ ) rP_->write(addr_.a16, *val_);
+            if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
             return true;
         }
     }
 
     virtual void get()
     {
-        if ( is_eeram_ ) *val_ = rP_->read(addr_.a16);
+        if ( is_eeram_ ) rP_->get(addr_.a16, *val_);
+    }
+
+    virtual void get_from(const uint8_t *buf)
+    {
+        memcpy(val_, buf, sizeof(*val_));
     }
 
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     void new_maximum(const uint16_t new_max) { max_ = new_max; }
@@ -813,62 +812,57 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9d -> %9d, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-20.20s %9d -> %9d, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
 
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
+        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
 
-    void print_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-
-    void print1_help()
-    {
-        print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toInt());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const uint16_t input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
    
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
-        if ( is_eeram_ ) rP_->write(addr_.a16, *val_);
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+    }
+
+    virtual double value()
+    {
+        return double(*val_);
     }
 
 protected:
@@ -883,15 +877,14 @@ class Uint8tV: public Variable
 public:
     Uint8tV(){}
 
-    Uint8tV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const uint8_t min, const uint8_t max,
-    uint8_t *store, const uint8_t _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    Uint8tV(const ParDef *def, SerialRAM *ram, uint8_t *store):
+        Variable(def, ram, PAR_UINT8)
     {
-        min_ = min;
-        max_ = max;
+        min_ = uint8_t(def_->min);
+        max_ = uint8_t(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min(uint8_t(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~Uint8tV(){}
@@ -906,7 +899,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %d (%d, %d)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %d (%d, %d)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -922,16 +915,21 @@ public:
         if ( is_eeram_ ) *val_ = rP_->read(addr_.a16);
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        *val_ = buf[0];
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -941,64 +939,59 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-20s %9d -> %9d, %10s (%s%-2s)", description_.c_str(), default_, *val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-20.20s %9d -> %9d, %10.10s (%s%-2s)", def_->description, default_, *val_, def_->units, prefix(), def_->code);
     }
 
-    void print()
-    {
-        print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", prefix_.c_str(), code_.c_str(), *val_, min_, max_, default_, description_.c_str(), units_.c_str());
+        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %.20s, %.10s", prefix(), def_->code, *val_, min_, max_, default_, def_->description, def_->units);
     }
 
-    void print_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-
-    void print1_help()
-    {
-        print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(str.toInt());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const uint8_t input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
    
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->write(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->write(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     uint8_t *val_;
     uint8_t min_;
@@ -1012,15 +1005,14 @@ class ULongV: public Variable
 public:
     ULongV(){}
 
-    ULongV(const String &prefix, const String &code, SerialRAM *ram, const String &description, const String &units, const unsigned long min, const unsigned long max,
-    unsigned long *store, const unsigned long _default=0, const boolean check_for_off_on_init=true):
-        Variable(prefix, code, ram, description, units, check_for_off_on_init)
+    ULongV(const ParDef *def, SerialRAM *ram, unsigned long *store):
+        Variable(def, ram, PAR_ULONG)
     {
-        min_ = min;
-        max_ = max;
+        min_ = (unsigned long)(def_->min);
+        max_ = (unsigned long)(def_->max);
         val_ = store;
-        default_ = max(min(_default, max_), min_);
-        if ( check_for_off_on_init_ ) check_set_put(*val_);
+        default_ = max(min((unsigned long)(def_->nominal), max_), min_);
+        if ( def_->check ) check_set_put(*val_);
     }
 
     ~ULongV(){}
@@ -1035,7 +1027,7 @@ public:
     {
         if ( val>max_ || val<min_ )
         {
-            if ( val>max_ || val<min_ ) Serial.printf("%s %s set:: out range %ld (%ld, %ld)\n", code_.c_str(), description_.c_str(), val, min_, max_);
+            if ( val>max_ || val<min_ ) Serial.printf("%s %.20s set:: out range %ld (%ld, %ld)\n", def_->code, def_->description, val, min_, max_);
             return false;
         }
         else
@@ -1054,16 +1046,21 @@ public:
         }
     }
 
+    virtual void get_from(const uint8_t *buf)
+    {
+        memcpy(val_, buf, sizeof(*val_));
+    }
+
     virtual boolean is_corrupt()
     {
         boolean corrupt = *val_ > max_ || *val_ < min_;
-        if ( corrupt ) Serial.printf("\n%s %s corrupt", code_.c_str(), description_.c_str());
+        if ( corrupt ) Serial.printf("\n%s %.20s corrupt", def_->code, def_->description);
         return corrupt;
     }
 
     virtual boolean is_off()
     {
-        return off_nominal() && check_for_off_on_init_;
+        return off_nominal() && def_->check;
     }
 
     virtual boolean off_nominal()
@@ -1073,64 +1070,59 @@ public:
 
     void print_str()
     {
-        sprintf(pr.buff, " %-18s %10d -> %10d, %10s (%s%-2s)", description_.c_str(), (int)default_, (int)*val_, units_.c_str(), prefix_.c_str(), code_.c_str());
+        sprintf(pr.buff, " %-18.20s %10d -> %10d, %10.10s (%s%-2s)", def_->description, (int)default_, (int)*val_, def_->units, prefix(), def_->code);
     }
     
-    void print()
+    void print(const uint8_t route=ROUTE_USB)
     {
         print_str();
-        Serial.printf("%s\n", pr.buff);
-    }
-    
-    void print1()
-    {
-        print_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     void print_help_str()
     {
-        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %s, %s", prefix_.c_str(), code_.c_str(), (int)*val_, (int)min_, (int)max_, (int)default_, description_.c_str(), units_.c_str());
-    }
-
-    void print_help()
-    {
-        print_help_str();
-        Serial.printf("%s\n", pr.buff);
+        sprintf(pr.buff, "%s%-2s= %6d: (%-6d-%6d) [%6d] %.20s, %.10s", prefix(), def_->code, (int)*val_, (int)min_, (int)max_, (int)default_, def_->description, def_->units);
     }
 
-    void print1_help()
+    void print_help(const uint8_t route=ROUTE_USB)
     {
         print_help_str();
-        Serial1.printf("%s\n", pr.buff);
+        rt.line(route, pr.buff);
     }
 
     virtual boolean print_adjust(const String &str)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put((unsigned long) str.toInt());
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
 
     boolean print_adj_print(const unsigned long input)
     {
-        print();
-        print1();
+        print(ROUTE_ALL);
         success_ = check_set_put(input);
-        print();
-        print1();
+        print(ROUTE_ALL);
         return success_;
     }
    
+    virtual uint16_t put()
+    {
+        if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
+        return sizeof(*val_);
+    }
+
     virtual void set_nominal()
     {
         *val_ = default_;
         if ( is_eeram_ ) rP_->put(addr_.a16, *val_);
     }
 
+    virtual double value()
+    {
+        return double(*val_);
+    }
+
 protected:
     unsigned long *val_;
     unsigned long min_;
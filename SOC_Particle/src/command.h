@@ -35,21 +35,27 @@ typedef union {
 } Tb_union;
 
 
-// Definition of structure for external control coordination
+// Definition of structure for external control coordination.   Double buffered:  the read frame fills back()
+// and flips; the display, rapid print and history paths read front() in place
 struct PublishPars
 {
-  Publish pubList;          // Publish object
+  Publish pub[2];           // Publish objects
+  uint8_t ifront;           // Index of the one readers see
   PublishPars(void)
   {
-    pubList = Publish();
+    pub[0] = pub[1] = Publish();
+    ifront = 0;
   }
+  Publish *back() { return &pub[ifront ^ 1]; }
+  void flip() { ifront ^= 1; }
+  Publish *front() { return &pub[ifront]; }
 };
 
 
 class CommandPars
 {
 public:
-  ~CommandPars();
+  ~CommandPars() {}
 
   // Small static value area for 'retained'
   String ctl_str;           // Hold control queue
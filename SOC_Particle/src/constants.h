@@ -40,6 +40,8 @@
 #undef HDWE_SSD1306_OLED
 #undef HDWE_DS18B20_SWIRE
 #undef HDWE_DS2482_1WIRE
+#undef HDWE_DS2482_ARRAY
+#undef HDWE_STRINGS
 #undef HDWE_2WIRE
 #undef HDWE_IB_HI_LO_NOA_LO
 #undef HDWE_IB_HI_LO_AMP_LO
@@ -105,11 +107,12 @@ const String unit = version + "_" + HDWE_UNIT;
 
 // If NSUM too large, will get flashing red with auto reboot on 'Hs' or compile error `.data' will not fit in region `APP_FLASH'
 // For all, there are 40 bytes for each unit of NSUM
+// Retained SRAM also holds myUse (Usage.h, ~350 bytes), the room of 8 NHIS slices
 
 #ifdef HDWE_PHOTON  // dec ~134000  units: pro0p, soc0p
     #ifdef SOFT_DEPLOY_PHOTON
         #define NFLT   7  // Number of saved SRAM/EERAM fault data slices 10 s intervals.  (7)
-        #define NHIS  49  // Number of saved SRAM history data slices. Sized to approx match  Photon2, If too large, will get compile error BACKUPSRAM   (49)
+        #define NHIS  41  // Number of saved SRAM history data slices. Sized to approx match  Photon2, If too large, will get compile error BACKUPSRAM   (41)
         #define NSUM  90  // Number of saved summaries. If NFLT + NHIS + NSUM too large, will get compile error APP_FLASH, or GUI FRAG msg  (110)
     #else
         #ifdef DEBUG_DETAIL
@@ -117,11 +120,11 @@ const String unit = version + "_" + HDWE_UNIT;
         #else
             #ifdef SOFT_DEBUG_QUEUE
                 #define NFLT  7  // Number of saved SRAM/EERAM fault data slices 10 s intervals.  If too large, will get compile error BACKUPSRAM (7)
-                #define NHIS 36  // Number of saved SRAM history data slices. Sized to approx match Photon2 (36)
+                #define NHIS 28  // Number of saved SRAM history data slices. Sized to approx match Photon2 (28)
                 #define NSUM 16  // Number of saved summaries. If NFLT + NHIS + NSUM too large, will get compile error BACKUPSRAM  (16)
             #else
                 #define NFLT  7  // Number of saved SRAM/EERAM fault data slices 10 s intervals.  If too large, will get compile error BACKUPSRAM (7)
-                #define NHIS 56  // Number of saved SRAM history data slices. Sized to approx match  Photon2  (56)
+                #define NHIS 48  // Number of saved SRAM history data slices. Sized to approx match  Photon2  (48)
                 #define NSUM  2  // Number of saved summaries. If NFLT + NHIS + NSUM too large, will get compile error BACKUPSRAM  (9)
             #endif
         #endif
@@ -136,7 +139,7 @@ const String unit = version + "_" + HDWE_UNIT;
 
 #ifdef HDWE_PHOTON2  // dec ~ 256268  units: pro2p2, soc3p2
     #define NFLT    7  // Number of saved SRAM fault data slices 10 s intervals (7)
-    #define NHIS   50  // Number of saved SRAM history data slices. If NFLT + NHIS too large will get compile error BACKUPSRAM (55)
+    #define NHIS   42  // Number of saved SRAM history data slices. If NFLT + NHIS too large will get compile error BACKUPSRAM (42)
     #define NSUM 2500  // Number of saved summaries. If NFLT + NHIS + NSUM too large, will get compile error BACKUPSRAM, or GUI FRAG msg (2845) or SOS 4 Bus Fault
 #endif
 
@@ -215,6 +218,12 @@ const float IBATT_DISAGREE_SET = (WRAP_LO_S-1.); // Signal selection current dis
 #define QUIET_A         0.005           // Quiet set threshold, sec (0.005, 0.01 too large in truck)
 #define QUIET_S         60.             // Quiet set persistence, sec (60.)
 const float QUIET_R   (QUIET_S/10.);    // Quiet reset persistence, sec ('up 1 down 10')
+#define HUM_T_US        2000UL          // Hum monitor oversample period, us (2000UL = 500 Hz)
+constexpr float HUM_FS = (1e6/float(HUM_T_US)); // Hum monitor sample rate, Hz
+#define HUM_N           50              // Hum monitor Goertzel block, samples (50 = 0.1 s, 10 Hz bins)
+#define HUM_NBIN        6               // Hum monitor bins 50, 60, 100, 120, 150, 180 Hz (6)
+#define HUM_NOTCH_Q     5.              // Ib/Vb hum notch quality factor (5.)
+#define DUMP_N          2               // History dump records printed per loop pass (2)
 #define TB_STALE_SET    3600.           // Tb read from one-wire stale persistence for failure, s (3600, 1 hr)
 #define TB_STALE_RESET  0.              // Tb read from one-wire stale persistence for reset, s (0)
 #define NOMINAL_TB      15.             // Middle of the road Tb for decent reversionary operation, deg C (15.)
@@ -26,8 +26,11 @@
 #include "debug.h"
 #include "parameters.h"
 #include "talk/chitchat.h"
+#include "PrintRouter.h"
+#include "Clock.h"
 
 extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
+extern PrintRouter rt;  // Serial and Serial1 print router
 
 
 // Check for heap fragmentation during String += operation
@@ -118,31 +121,19 @@ void add_verify(String *src, const String addend)
 void debug_5(BatteryMonitor *Mon, Sensors *Sen)
 {
   Serial.printf("oled_display: Tb, Vb, Ib, Ahrs_rem_ekf, tcharge, Ahrs_rem_wt, %3.0f, %5.2f, %5.1f,  %3.0f,%5.1f,%3.0f,\n",
-    pp.pubList.Tb, pp.pubList.Voc, pp.pubList.Ib, pp.pubList.Amp_hrs_remaining_ekf, pp.pubList.tcharge, pp.pubList.Amp_hrs_remaining_soc);
+    pp.front()->Tb, pp.front()->Voc, pp.front()->Ib, pp.front()->Amp_hrs_remaining_ekf, pp.front()->tcharge, pp.front()->Amp_hrs_remaining_soc);
 }
 
 // Q quick print critical parameters
 void debug_q(BatteryMonitor *Mon, Sensors *Sen)
 {
-  Serial.printf("ib_amp_fail %d\nib_noa_fail %d\nvb_fail %d\nTb%7.3f\nvb%7.3f\nvoc%7.3f\nvoc_filt%7.3f\nvoc_stat%7.3f\nvsat%7.3f\nib%7.3f\nsoc_m%8.4f\n\
+  rt.printf(ROUTE_ALL, "ib_amp_fail %d\nib_noa_fail %d\nvb_fail %d\nTb%7.3f\nvb%7.3f\nvoc%7.3f\nvoc_filt%7.3f\nvoc_stat%7.3f\nvsat%7.3f\nib%7.3f\nsoc_m%8.4f\n\
 soc_ekf%8.4f\nsoc%8.4f\nsoc_min%8.4f\nsoc_inf%8.4f\nmodeling %d\n",
     Sen->Flt->ib_amp_fa(), Sen->Flt->ib_noa_fa(), Sen->Flt->vb_fail(),
     Mon->temp_c(), Mon->vb(), Mon->voc(), Mon->voc_filt(), Mon->voc_stat(), Mon->vsat(), Mon->ib(), Sen->Sim->soc(), Mon->soc_ekf(),
     Mon->soc(), Mon->soc_min(), Mon->soc_inf(), sp.modeling());
 
-  Serial.printf("dq_inf/dq_abs%10.1f/%10.1f %8.4f coul_eff*=%9.6f, DAB+=%9.6f\nDQn%10.1f Tn%10.1f DQp%10.1f Tp%10.1f\n",
-    Mon->delta_q_inf(), Mon->delta_q_abs(), Mon->delta_q_inf()/Mon->delta_q_abs(),
-    -Mon->delta_q_neg()/Mon->delta_q_pos(),
-    -(Mon->delta_q_neg() + Mon->delta_q_pos()) / nice_zero(Mon->time_neg() + Mon->time_pos(), 1e-6),
-    Mon->delta_q_neg(), Mon->time_neg(), Mon->delta_q_pos(), Mon->time_pos());
-
-  Serial1.printf("ib_amp_fail %d\nib_noa_fail %d\nvb_fail %d\nTb%7.3f\nvb%7.3f\nvoc%7.3f\nvoc_filt%7.3f\nvoc_stat%7.3f\nvsat%7.3f\nib%7.3f\nsoc_m%8.4f\n\
-soc_ekf%8.4f\nsoc%8.4f\nsoc_min%8.4f\nsoc_inf%8.4f\nmodeling %d\n",
-    Sen->Flt->ib_amp_fa(), Sen->Flt->ib_noa_fa(), Sen->Flt->vb_fail(),
-    Mon->temp_c(), Mon->vb(), Mon->voc(), Mon->voc_filt(), Mon->voc_stat(), Mon->vsat(), Mon->ib(), Sen->Sim->soc(), Mon->soc_ekf(),
-    Mon->soc(), Mon->soc_min(), Mon->soc_inf(), sp.modeling());
-
-  Serial1.printf("dq_inf/dq_abs%10.1f/%10.1f = %8.4f coul_eff*=%9.6f DAB+=%9.6f\nDQn%10.1f Tn%10.1f DQp%10.1f Tp%10.1f\n",
+  rt.printf(ROUTE_ALL, "dq_inf/dq_abs%10.1f/%10.1f = %8.4f coul_eff*=%9.6f DAB+=%9.6f\nDQn%10.1f Tn%10.1f DQp%10.1f Tp%10.1f\n",
     Mon->delta_q_inf(), Mon->delta_q_abs(), Mon->delta_q_inf()/Mon->delta_q_abs(),
     -Mon->delta_q_neg()/Mon->delta_q_pos(),
     -(Mon->delta_q_neg() + Mon->delta_q_pos()) / nice_zero(Mon->time_neg() + Mon->time_pos(), 1e-6),
@@ -150,29 +141,34 @@ soc_ekf%8.4f\nsoc%8.4f\nsoc_min%8.4f\nsoc_inf%8.4f\nmodeling %d\n",
 
   if ( Sen->Flt->falw() || Sen->Flt->fltw() ) chit("Pf;", SOON);
   time_long_2_str((time_t)sp.Time_now_z, pr.buff);
-  Serial.printf(" time %ld hms:  %s\n", sp.Time_now_z, pr.buff);
-  Serial1.printf(" time %ld hms:  %s\n", sp.Time_now_z, pr.buff);
+  rt.printf(ROUTE_ALL, " time %ld hms:  %s\n", sp.Time_now_z, pr.buff);
 
 }
 
 // Calibration
 void debug_98(BatteryMonitor *Mon, Sensors *Sen)
 {
-  Serial.printf("imh imfh inh infh: %6.2fA %6.2fA, %6.2fA %6.2fA,\n",
-  Sen->Ib_amp_hdwe_f, Sen->ShuntAmp->Ishunt_cal_filt(), Sen->Ib_noa_hdwe_f, Sen->ShuntNoAmp->Ishunt_cal_filt());
-  
-  Serial1.printf("imh imfh inh infh: %6.2fA %6.2fA, %6.2fA %6.2fA,\n",
+  rt.printf(ROUTE_ALL, "imh imfh inh infh: %6.2fA %6.2fA, %6.2fA %6.2fA,\n",
   Sen->Ib_amp_hdwe_f, Sen->ShuntAmp->Ishunt_cal_filt(), Sen->Ib_noa_hdwe_f, Sen->ShuntNoAmp->Ishunt_cal_filt());
 }
 void debug_99(BatteryMonitor *Mon, Sensors *Sen)
 {
-  Serial.printf("Tb Vb Vr imh inh sel voc voc_soc |*SV,*Dc |*SA,*DA|*SB,*DB| *SD| *Dw| *Sr: %6.2fC %7.3fv %6.3fv %6.2fA %6.2fA %6.2fA %6.2fv %6.2fv |%6.3f %6.3fv  |%6.3f %6.3fA | %6.3f %6.3fA |%6.3f|%6.3fv|%6.3f,\n",
-  Sen->Tb_hdwe, Sen->Vb_hdwe_f, Sen->ShuntAmp->Vc(), Sen->Ib_amp_hdwe_f, Sen->Ib_noa_hdwe_f, Sen->Ib_hdwe_f, Mon->voc(), Mon->voc_soc(), sp.Vb_scale(), sp.Vb_bias_hdwe(), sp.ib_scale_amp(), sp.ib_bias_amp(), sp.ib_scale_noa(), sp.ib_bias_noa(), sp.ib_disch_slr(), sp.Dw(), ap.slr_res);
-  
-  Serial1.printf("Tb Vb Vr imh inh sel voc voc_soc |*SV,*Dc |*SA,*DA|*SB,*DB| *SD| *Dw| *Sr: %6.2fC %7.3fv %6.3fv %6.2fA %6.2fA %6.2fA %6.2fv %6.2fv |%6.3f %6.3fv  |%6.3f %6.3fA | %6.3f %6.3fA |%6.3f|%6.3fv|%6.3f,\n",
+  rt.printf(ROUTE_ALL, "Tb Vb Vr imh inh sel voc voc_soc |*SV,*Dc |*SA,*DA|*SB,*DB| *SD| *Dw| *Sr: %6.2fC %7.3fv %6.3fv %6.2fA %6.2fA %6.2fA %6.2fv %6.2fv |%6.3f %6.3fv  |%6.3f %6.3fA | %6.3f %6.3fA |%6.3f|%6.3fv|%6.3f,\n",
   Sen->Tb_hdwe, Sen->Vb_hdwe_f, Sen->ShuntAmp->Vc(), Sen->Ib_amp_hdwe_f, Sen->Ib_noa_hdwe_f, Sen->Ib_hdwe_f, Mon->voc(), Mon->voc_soc(), sp.Vb_scale(), sp.Vb_bias_hdwe(), sp.ib_scale_amp(), sp.ib_bias_amp(), sp.ib_scale_noa(), sp.ib_bias_noa(), sp.ib_disch_slr(), sp.Dw(), ap.slr_res);
  }
 
+// XB2:  per-sample cost of Shunt::hum_sample with its analog reads, the part the host can't time (cppStateOfCharge/soc_bench)
+void bench_hum(Sensors *Sen, const uint32_t n)
+{
+  unsigned long t0 = Clock::micros();
+  for ( uint32_t k=0; k<n; k++ ) Sen->ShuntAmp->hum_sample(1);
+  unsigned long dt_shunt = Clock::micros() - t0;
+
+  Serial.printf("XB2 %ld samples, %d bins + notch %3.0fHz\n", n, HUM_NBIN, ap.hum_notch_hz);
+  Serial.printf(" Shunt::hum_sample  %8.2f us/sample (with analogRead)\n", float(dt_shunt)/float(max(n, 1UL)));
+  Serial.printf(" load %5.2f%% of %ld us grid per shunt\n", float(dt_shunt)/float(max(n, 1UL))/float(HUM_T_US)*100., HUM_T_US);
+}
+
 #ifdef DEBUG_DETAIL
   // Various parameters to debug initialization stuff as needed
   void debug_m1(BatteryMonitor *Mon, Sensors *Sen)
@@ -28,6 +28,7 @@
 #include "subs.h"
 
 void add_verify(String *src, const String addend);
+void bench_hum(Sensors *Sen, const uint32_t n);
 
 #ifdef DEBUG_DETAIL
     void debug_m1(BatteryMonitor *Mon, Sensors *Sen);
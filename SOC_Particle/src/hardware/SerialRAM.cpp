@@ -182,3 +182,30 @@ void SerialRAM::read(const uint16_t address, uint8_t * values, const uint16_t si
 	#endif
 }
 
+///<summary>
+///	Write "size" bytes of any length at "address" as EERAM_CHUNK byte transactions.   The address
+///		increments across them as it does within one.
+///		<returns>0:success, else the first error of write()</returns>
+///</summary>
+uint8_t SerialRAM::write_bulk(const uint16_t address, const uint8_t* values, const uint16_t size)
+{
+	for (uint16_t j = 0; j < size; j += EERAM_CHUNK) {
+		uint16_t len = size - j;
+		if ( len > EERAM_CHUNK ) len = EERAM_CHUNK;
+		uint8_t err = write(address + j, &values[j], len);
+		if ( err ) return err;
+	}
+	return 0;
+}
+
+///<summary>
+///	Read "size" bytes of any length from "address" as EERAM_CHUNK byte transactions.
+///</summary>
+void SerialRAM::read_bulk(const uint16_t address, uint8_t* values, const uint16_t size)
+{
+	for (uint16_t j = 0; j < size; j += EERAM_CHUNK) {
+		uint16_t len = size - j;
+		if ( len > EERAM_CHUNK ) len = EERAM_CHUNK;
+		read(address + j, &values[j], len);
+	}
+}
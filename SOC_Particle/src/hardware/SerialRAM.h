@@ -15,6 +15,7 @@
 #define _SerialRAM_h
 
 const uint16_t MAX_EERAM = 0x07FF;
+const uint16_t EERAM_CHUNK = 30;  // Largest transfer, fits the 32 byte Wire buffer with the address
 
 typedef union {
 	uint16_t a16;
@@ -37,6 +38,8 @@ public:
 	
 	uint8_t write(const uint16_t address, const uint8_t* values, const uint16_t size);
 	void read(const uint16_t address, uint8_t* values, const uint16_t size);
+	uint8_t write_bulk(const uint16_t address, const uint8_t* values, const uint16_t size);
+	void read_bulk(const uint16_t address, uint8_t* values, const uint16_t size);
 
 	//Functionality to 'get' and 'put' objects to and from EERAM
 	// https://github.com/sparkfun/SparkFun_External_EEPROM_Arduino_Library/blob/master/src/SparkFun_External_EEPROM.h
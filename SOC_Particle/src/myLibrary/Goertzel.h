@@ -0,0 +1,47 @@
+/***************************************************
+  A simple single-bin Goertzel library
+
+  Class code for embedded application.  Streaming amplitude of one
+  frequency over a block of n uniformly spaced samples, one multiply and
+  two adds per sample.  Choose n so the bin is a whole number of cycles
+  (f*n/fs integer) to keep DC and the other bins out.
+
+  18-Oct-2026   Dave Gutz   Created
+ ****************************************************/
+
+#ifndef _Goertzel_H
+#define _Goertzel_H
+
+#include "application.h"
+#include <math.h>
+
+
+class Goertzel
+{
+public:
+  Goertzel() : coeff_(0), f_(0), s1_(0), s2_(0) {}
+  Goertzel(const float f, const float fs) : f_(f), s1_(0), s2_(0) { coeff_ = 2.*cos(2.*PI*f/fs); }
+  // operators
+  // functions
+  float amplitude(const uint16_t n)  // Peak amplitude of the bin after n updates
+  {
+    float pow = s1_*s1_ + s2_*s2_ - coeff_*s1_*s2_;
+    return ( 2.*sqrt(max(pow, 0.)) / float(max(n, 1)) );
+  }
+  float f() { return f_; };
+  void reset() { s1_ = 0.;  s2_ = 0.; };
+  void update(const float in)
+  {
+    float s0 = in + coeff_*s1_ - s2_;
+    s2_ = s1_;
+    s1_ = s0;
+  }
+protected:
+  float coeff_;   // 2*cos(2*pi*f/fs)
+  float f_;       // Bin frequency, Hz
+  float s1_;      // Past state
+  float s2_;      // Past past state
+};
+
+
+#endif
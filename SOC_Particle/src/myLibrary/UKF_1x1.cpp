@@ -0,0 +1,139 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#include "application.h"
+#include "UKF_1x1.h"
+#include <math.h>
+
+
+// class UKF_1x1
+// constructors
+UKF_1x1::UKF_1x1():
+  Fx_u_(1.), Bu_u_(0.), Q_u_(0.), R_u_(0.), P_u_(0.), S_u_(0.), Pxz_(0.), K_u_(0.), u_u_(0.), x_u_(0.), y_u_(0.),
+  z_u_(0.), hx_u_(0.), H_u_(0.)
+{
+  W_[0] = UKF_KAPPA / (1. + UKF_KAPPA);
+  W_[1] = W_[2] = 0.5 / (1. + UKF_KAPPA);
+  for ( uint8_t i=0; i<UKF_NSIG; i++ ) sig_[i] = hsig_[i] = 0.;
+}
+UKF_1x1::~UKF_1x1() {}
+
+// operators
+
+// functions
+// Initialize
+void UKF_1x1::init_ukf(double x, double Pinit)
+{
+  x_u_ = x;
+  P_u_ = Pinit;
+}
+
+//1x1 Unscented Kalman Filter predict
+void UKF_1x1::predict_ukf(const double u)
+{
+  /*
+  Linear process so the sigma points would map exactly; same as EKF_1x1::predict_ekf
+  Inputs:
+    u   1x1 input, =ib, A
+    Bu  1x1 control transition, Ohms
+    Fx  1x1 state transition, V/V
+  Outputs:
+    x   1x1 Kalman state variable = Vsoc (0-1 fraction)
+    P   1x1 Kalman probability
+  */
+  u_u_ = u;
+  this->ukf_predict(&Fx_u_, &Bu_u_);
+  x_u_ = Fx_u_*x_u_ + Bu_u_*u_u_;
+  if ( isnan(P_u_) ) P_u_ = 0.;   // reset overflow
+  P_u_ = Fx_u_*P_u_*Fx_u_ + Q_u_;
+}
+
+// Pretty Print
+void UKF_1x1::pretty_print(void)
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf("UKF_1x1:\n");
+  Serial.printf("In:\n");
+  Serial.printf("  z  %8.4f, V\n", z_u_);
+  Serial.printf("  R%10.6f\n", R_u_);
+  Serial.printf("  Q%10.6f\n", Q_u_);
+  Serial.printf("  H   %7.3f, Pxz/P\n", H_u_);
+  Serial.printf("  sig %8.4f %8.4f %8.4f\n", sig_[0], sig_[1], sig_[2]);
+  Serial.printf("  hsig%8.4f %8.4f %8.4f\n", hsig_[0], hsig_[1], hsig_[2]);
+  Serial.printf("Out:\n");
+  Serial.printf("  x  %8.4f, Vsoc (0-1 fraction)\n", x_u_);
+  Serial.printf("  hx %8.4f\n", hx_u_);
+  Serial.printf("  y   %8.4f, V\n", y_u_);
+  Serial.printf("  P%10.6f\n", P_u_);
+  Serial.printf("  K%10.6f\n", K_u_);
+  Serial.printf("  S%10.6f\n", S_u_);
+#else
+  Serial.printf("UKF_1x1: silent DEPLOY\n");
+#endif
+}
+
+// Serial print
+void UKF_1x1::serial_print(const unsigned long long now, const float dt)
+{
+  double cTime = double(now)/1000.;
+
+  Serial.printf("unit_ukf,%13.3f,%7.3f,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,%10.7g,\n",
+    cTime, dt, Fx_u_, Bu_u_, Q_u_, R_u_, P_u_, S_u_, K_u_, u_u_, x_u_, y_u_, z_u_, hx_u_, H_u_);
+}
+
+void UKF_1x1::update_ukf(const double z, double x_min, double x_max)
+{
+  /*1x1 Unscented Kalman Filter update
+  Inputs:
+    z   1x1 input, =voc, dynamic predicted by other model, V
+    R   1x1 Kalman state uncertainty
+  Outputs:
+    x   1x1 Kalman state variable = Vsoc (0-1 fraction)
+    hx  1x1 Weighted mean of h(sigma)
+    y   1x1 Residual z-hx, V
+    P   1x1 Kalman uncertainty covariance
+    K   1x1 Kalman gain
+    S   1x1 system uncertainty
+  */
+  z_u_ = z;
+  double spread = sqrt(max((1. + UKF_KAPPA)*P_u_, 0.));
+  sig_[0] = x_u_;
+  sig_[1] = x_u_ + spread;
+  sig_[2] = x_u_ - spread;
+  this->ukf_update(sig_, hsig_, UKF_NSIG);
+  hx_u_ = 0.;
+  for ( uint8_t i=0; i<UKF_NSIG; i++ ) hx_u_ += W_[i]*hsig_[i];
+  S_u_ = R_u_;
+  Pxz_ = 0.;
+  for ( uint8_t i=0; i<UKF_NSIG; i++ )
+  {
+    double dh = hsig_[i] - hx_u_;
+    S_u_ += W_[i]*dh*dh;
+    Pxz_ += W_[i]*(sig_[i] - x_u_)*dh;
+  }
+  if ( abs(S_u_) > 1e-12 ) K_u_ = Pxz_ / S_u_;  // Using last-good-value if S = 0
+  if ( P_u_ > 1e-12 ) H_u_ = Pxz_ / P_u_;
+  y_u_ = z_u_ - hx_u_;
+  x_u_ = max(min( x_u_ + K_u_*y_u_, x_max), x_min);
+  P_u_ = max(P_u_ - K_u_*Pxz_, 0.);
+}
@@ -0,0 +1,82 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+
+#ifndef UKF_1X1_H_
+#define UKF_1X1_H_
+
+#include <stdint.h>
+
+#define UKF_NSIG        3         // Sigma points for one state, 2n+1 (3)
+#define UKF_KAPPA       2.        // Sigma spread, n+kappa=3 matches Gaussian kurtosis (2.)
+
+// Unscented (sigma point) Kalman filter, one state.   Same use as EKF_1x1:  init, predict each frame with the
+// input, update with the observation.   The process model is linear so the predict is the EKF's; the update
+// passes all sigma points through the observation in one call instead of linearizing it with a Jacobian
+class UKF_1x1
+{
+public:
+  UKF_1x1();
+  ~UKF_1x1();
+  // operators
+  // functions
+  void init_ukf(double x, double Pinit);
+  void predict_ukf(const double u);
+  virtual void pretty_print(void);
+  void serial_print(const unsigned long long now, const float dt);
+  void update_ukf(const double z, double x_min, double x_max);
+  double H_ukf() { return ( H_u_ ); };
+  double K_ukf() { return ( K_u_ ); };
+  double P_ukf() { return ( P_u_ ); };
+  double x_ukf() { return ( x_u_ ); };
+  double y_ukf() { return ( y_u_ ); };
+protected:
+  double Fx_u_;   // State transition
+  double Bu_u_;   // Control transition
+  double Q_u_;    // Process uncertainty
+  double R_u_;    // State uncertainty
+  double P_u_;    // Uncertainty covariance
+  double S_u_;    // System uncertainty, Pzz
+  double Pxz_;    // State-observation cross covariance
+  double K_u_;    // Kalman gain
+  double u_u_;    // Control input
+  double x_u_;    // Kalman state variable
+  double y_u_;    // Residual z - hx
+  double z_u_;    // Observation of state x
+  double hx_u_;   // Weighted mean of h over the sigma points
+  double H_u_;    // Statistical slope Pxz/P, for comparison with the EKF Jacobian
+  double sig_[UKF_NSIG];    // Sigma points
+  double hsig_[UKF_NSIG];   // h(sigma points)
+  double W_[UKF_NSIG];      // Weights, mean and covariance alike (alpha=1, beta=0)
+  /*
+    Implement these for your UKF model.
+    @param Fx gets state transition
+    @param Bu gets control transition
+    @param x holds n sigma points
+    @param hx gets h(x) for each, all at once so a table lookup can share its bracketing
+  */
+  virtual void ukf_predict(double *Fx, double *Bu) = 0;
+  virtual void ukf_update(const double *x, double *hx, const uint8_t n) = 0;
+};
+
+#endif
@@ -28,6 +28,7 @@
 
 #include "math.h"
 #define PI          3.1415926535897932384626433832795
+#define PROF_INJ_MAX    2000000UL // Largest ProfInj trace, points (2000000, a day at 0.05 s)
 
 // Signal construction classes - convenient because they control their own memory
 // Sine wave signal generation
@@ -171,5 +172,60 @@ class TriInj
   protected:
     double t_last_;
 };
+// Recorded current playback
+/*
+
+           *-*                 p = last time of the trace
+          /   \      *--*      linear between points, then repeats
+bias---*-*     *----*    *-*---*-*...
+       0                     p
+
+*/
+class ProfInj
+{
+  public:
+    ProfInj(): a_(NULL), i_(0), n_(0), t_(NULL) {};
+    ~ProfInj() { clear(); };
+    void clear()
+    {
+      delete[] a_;
+      delete[] t_;
+      a_ = t_ = NULL;
+      n_ = i_ = 0;
+    };
+    // Copy of a (time, amps) trace, times ascending.   Shifted to start at 0
+    bool load(const uint32_t n, const float *t, const float *a)
+    {
+      clear();
+      if ( n<2 || n>PROF_INJ_MAX ) return false;
+      for ( uint32_t i=1; i<n; i++ ) if ( !(t[i]>t[i-1]) ) return false;
+      t_ = new float[n];
+      a_ = new float[n];
+      for ( uint32_t i=0; i<n; i++ )
+      {
+        t_[i] = t[i] - t[0];
+        a_[i] = a[i];
+      }
+      n_ = n;
+      return true;
+    };
+    uint32_t n() { return n_; };
+    float period() { return ( n_ ? t_[n_-1] : 0. ); };
+    // amp scales the trace, 1 as recorded.   Steps a cursor forward so a long trace costs little per call
+    float signal(const float amp, const double t, const float inj_bias)
+    {
+      if ( n_<2 ) return ( inj_bias );
+      float tp = float(fmod(t, double(t_[n_-1])));
+      if ( tp<t_[i_] ) i_ = 0;   // Looped or restarted
+      while ( i_+2<n_ && t_[i_+1]<=tp ) i_++;
+      float f = (tp - t_[i_]) / (t_[i_+1] - t_[i_]);
+      return ( amp*(a_[i_] + f*(a_[i_+1] - a_[i_])) + inj_bias );
+    };
+  protected:
+    float *a_;      // Trace current, A
+    uint32_t i_;    // Cursor, segment of the last call
+    uint32_t n_;    // Points
+    float *t_;      // Trace time from its start, s
+};
 
 #endif
\ No newline at end of file
@@ -77,11 +77,14 @@ double Iterator::iterate(const boolean verbose, const uint16_t success_count, co
     {
         if ( count_ > success_count )
         {
-            x_ = max(min(x_ - e_/des_*dx_, xmax_),xmin_);
             if ( e_ > 0 )
                 xmax_ = xp_;
             else
                 xmin_ = xp_;
+            // Secant, unless it leaves the bracket or the two points are on one flat (des_ 0):  then bisect
+            x_ = x_ - e_/des_*dx_;
+            if ( !(x_>xmin_ && x_<xmax_) )
+                x_ = (xmin_ + xmax_)/2;
         }
         else
         {
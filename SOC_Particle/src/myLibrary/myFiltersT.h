@@ -0,0 +1,538 @@
+/***************************************************
+  A simple value-type dynamic filter library
+
+  Class code for embedded application.  Header-only, non-virtual
+  equivalents of the myFilters classes meant to be embedded by value in
+  their owners instead of reached through new'd pointers.  Arithmetic
+  matches myFilters bit for bit for the double instantiation; coefficients
+  are only recomputed when T or tau change.
+
+  18-Oct-2026   Dave Gutz   Created from myFilters
+ ****************************************************/
+
+#ifndef _myFiltersT_H
+#define _myFiltersT_H
+
+#include "application.h"
+#include <math.h>
+
+
+// TFDelay timer step shared by TFDelayT and TFDelayBank.  timer>0 is true, counts down to false
+inline boolean tf_delay_step(int &timer, const int nt, const int nf, const boolean in)
+{
+  if ( timer >= 0 )
+  {
+    if ( in ) timer = nf;
+    else
+    {
+      timer--;
+      if ( timer<0 ) timer = -nt;
+    }
+  }
+  else
+  {
+    if ( !in ) timer = -nt;
+    else
+    {
+      timer++;
+      if ( timer>=0 ) timer = nf;
+    }
+  }
+  return ( timer > 0 );
+}
+
+
+// Rate limit.  The 5-argument calculate returns the limited rate, as RateLimit
+template <typename F=double>
+class RateLimitT
+{
+public:
+  RateLimitT() : jmax_(0), jmin_(0), past_(0), T_(1) {}
+  RateLimitT(const F in, const F T, const F Rmax, const F Rmin)
+    : jmax_(fabs(Rmax*T)), jmin_(-fabs(Rmin*T)), past_(in), T_(T) {}
+  // operators
+  // functions
+  F calculate(const F in)
+  {
+    past_ = fmax(fmin(in, past_+jmax_), past_+jmin_);
+    return ( past_ );
+  }
+  F calculate(const F in, const F Rmax, const F Rmin, const int RESET, const F T)
+  {
+    T_ = T;
+    if ( RESET>0 ) past_ = in;
+    F past = past_;
+    jmax_ = fabs(Rmax*T_);
+    jmin_ = -fabs(Rmin*T_);
+    return ( (calculate(in) - past) / T_ );
+  }
+  F state() { return ( past_ ); };
+protected:
+  F jmax_, jmin_;   // Rate limits, units of in/update
+  F past_;          // Output state
+  F T_;             // Update time, s
+};
+
+
+// Sliding deadband
+template <typename F=double>
+class SlidingDeadbandT
+{
+public:
+  SlidingDeadbandT() : hdb_(0), z_(0) {}
+  SlidingDeadbandT(const F hdb) : hdb_(hdb), z_(0) {}
+  // operators
+  // functions
+  F update(const F in)
+  {
+    z_ = fmax(fmin(z_, in+hdb_), in-hdb_);
+    return ( z_ );
+  }
+  F update(const F in, const int RESET)
+  {
+    if ( RESET>0 ) z_ = in;
+    return ( update(in) );
+  }
+  F state() { return ( z_ ); };
+protected:
+  F hdb_;   // Half deadband width
+  F z_;     // Output state
+};
+
+
+// True/false persistence delay.  Same semantics as TFDelay 5-argument calculate
+template <typename F=double>
+class TFDelayT
+{
+public:
+  TFDelayT() : timer_(0), nt_(0), nf_(0), T_(1), T_init_(1), Tt_(-1), Tf_(-1) {}
+  TFDelayT(const boolean in, const F Tt, const F Tf, const F T)
+    : timer_(0), nt_(int(fmax(round(Tt/T)+1,0))), nf_(int(fmax(round(Tf/T+1),0))), T_(T), T_init_(T), Tt_(-1), Tf_(-1)
+  {
+    if ( Tt==0 ) nt_ = 0;
+    if ( Tf==0 ) nf_ = 0;
+    if ( in ) timer_ = nf_;
+    else timer_ = -nt_;
+  }
+  // operators
+  // functions
+  boolean calculate(const boolean in) { return ( tf_delay_step(timer_, nt_, nf_, in) ); }
+  boolean calculate(const boolean in, const F Tt, const F Tf, const F T, const int RESET)
+  {
+    F T_loc = T;
+    if ( RESET>0 )
+    {
+      if ( in ) timer_ = nf_;
+      else timer_ = -nt_;
+      T_loc = T_init_;
+    }
+    if ( T_loc!=T_ || Tt!=Tt_ || Tf!=Tf_ )
+    {
+      T_ = T_loc;  Tt_ = Tt;  Tf_ = Tf;
+      nt_ = int(fmax(round(Tt/T_)+1, 0));
+      nf_ = int(fmax(round(Tf/T_)+1, 0));
+    }
+    return ( tf_delay_step(timer_, nt_, nf_, in) );
+  }
+  boolean state() { return ( timer_ > 0 ); };
+  int timer() { return timer_; };
+  int nt() { return nt_; };
+  int nf() { return nf_; };
+protected:
+  int timer_;   // Persistence count, >0 true
+  int nt_;      // Updates to go true
+  int nf_;      // Updates to go false
+  F T_;         // Update time of last count computation, s
+  F T_init_;    // Update time used on reset, s
+  F Tt_;        // Set time of last count computation, s
+  F Tf_;        // Reset time of last count computation, s
+};
+
+
+// Many TFDelay persistence timers stored contiguously, updated by slot or all in one pass
+template <int N, typename F=double>
+class TFDelayBank
+{
+public:
+  TFDelayBank()
+  {
+    for ( int i=0; i<N; i++ ) init(i, false, 0, 0, 1);
+  }
+  // operators
+  // functions
+  boolean calculate(const int i, const boolean in, const F Tt, const F Tf, const F T, const int RESET)
+  {
+    F T_loc = T;
+    if ( RESET>0 )
+    {
+      if ( in ) timer_[i] = nf_[i];
+      else timer_[i] = -nt_[i];
+      T_loc = T_init_[i];
+    }
+    if ( T_loc!=T_[i] || Tt!=Tt_[i] || Tf!=Tf_[i] )
+    {
+      T_[i] = T_loc;  Tt_[i] = Tt;  Tf_[i] = Tf;
+      nt_[i] = int(fmax(round(Tt/T_loc)+1, 0));
+      nf_[i] = int(fmax(round(Tf/T_loc)+1, 0));
+    }
+    return ( tf_delay_step(timer_[i], nt_[i], nf_[i], in) );
+  }
+  // Update every slot with its last set/reset times.  Bit i of in_mask is input i; returns output mask
+  uint32_t calculate_all(const uint32_t in_mask, const F T, const int RESET)
+  {
+    uint32_t out = 0;
+    for ( int i=0; i<N; i++ )
+      if ( calculate(i, bitRead(in_mask, i), Tt_[i], Tf_[i], T, RESET) ) out |= (1UL << i);
+    return ( out );
+  }
+  void init(const int i, const boolean in, const F Tt, const F Tf, const F T)
+  {
+    nt_[i] = int(fmax(round(Tt/T)+1,0));
+    nf_[i] = int(fmax(round(Tf/T+1),0));
+    if ( Tt==0 ) nt_[i] = 0;
+    if ( Tf==0 ) nf_[i] = 0;
+    timer_[i] = in ? nf_[i] : -nt_[i];
+    T_[i] = -1;  T_init_[i] = T;  // T_ -1 forces count recompute on first calculate, like TFDelay
+    Tt_[i] = Tt;  Tf_[i] = Tf;
+  }
+  boolean state(const int i) { return ( timer_[i] > 0 ); };
+  int timer(const int i) { return timer_[i]; };
+protected:
+  static_assert(N>0 && N<=32, "TFDelayBank slots must fit a uint32_t mask");
+  int timer_[N];  // Persistence counts, >0 true
+  int nt_[N];     // Updates to go true
+  int nf_[N];     // Updates to go false
+  F T_[N];        // Update times of last count computation, s
+  F T_init_[N];   // Update times used on reset, s
+  F Tt_[N];       // Set times of last count computation, s
+  F Tf_[N];       // Reset times of last count computation, s
+};
+
+
+// Tustin lag calculator, non-pre-warped
+template <typename F=double>
+class LagTustinT
+{
+public:
+  LagTustinT() : a_(0), b_(0), max_(0), min_(0), rate_(0), state_(0), T_(0), tau_(0) {}
+  LagTustinT(const F T, const F tau, const F min, const F max)
+    : max_(max), min_(min), rate_(0), state_(0), T_(T), tau_(tau)
+  {
+    assignCoeff();
+  }
+  // operators
+  // functions
+  F calculate(const F in, const int RESET)
+  {
+    if ( RESET>0 ) state_ = in;
+    calcState(in);
+    return ( state_ );
+  }
+  F calculate(const F in, const int RESET, const F T)
+  {
+    if ( RESET>0 ) state_ = in;
+    if ( T!=T_ )
+    {
+      T_ = T;
+      assignCoeff();
+    }
+    calcState(in);
+    return ( state_ );
+  }
+  F rate() { return ( rate_ ); };
+  F state() { return ( state_ ); };
+  void state(const F in) { state_ = in; }  // For severity testing - sudden offset
+protected:
+  void assignCoeff()
+  {
+    a_ = 2.0 / (2.0 * tau_ + T_);
+    b_ = (2.0 * tau_ - T_) / (2.0 * tau_ + T_);
+  }
+  void calcState(const F in)
+  {
+    rate_ = fmax(fmin(a_ * (in - state_), max_), min_);
+    state_ = fmax(fmin(in * (1.0 - b_) + state_ * b_, max_), min_);
+  }
+  F a_, b_;     // Coefficients
+  F max_, min_; // Limits
+  F rate_;      // Rate
+  F state_;     // Output state
+  F T_;         // Update time, s
+  F tau_;       // Time constant, s
+};
+
+
+// Exp lag calculator variable update rate and limits
+template <typename F=double>
+class LagExpT
+{
+public:
+  LagExpT() : a_(0), b_(0), c_(0), lstate_(0), max_(0), min_(0), rate_(0), rstate_(0), T_(0), tau_(0) {}
+  LagExpT(const F T, const F tau, const F min, const F max)
+    : lstate_(0), max_(max), min_(min), rate_(0), rstate_(0), T_(0), tau_(0)
+  {
+    assignCoeff(tau, T);
+  }
+  // operators
+  // functions
+  F calculate(const F in, const int RESET)
+  {
+    if ( RESET>0 )
+    {
+      lstate_ = in;
+      rstate_ = in;
+      rate_ = 0;
+    }
+    rateState(in);
+    return ( lstate_ );
+  }
+  F calculate(const F in, const int RESET, const F tau, const F T)
+  {
+    if ( RESET>0 )
+    {
+      lstate_ = in;
+      rstate_ = in;
+    }
+    assignCoeff(tau, T);
+    rateState(in);
+    return ( lstate_ );
+  }
+  F rate() { return ( rate_ ); };
+  F state() { return ( lstate_ ); };
+protected:
+  void assignCoeff(const F tau, const F T)
+  {
+    if ( tau==tau_ && T==T_ ) return;
+    tau_ = tau;
+    T_ = T;
+    F eTt = exp(-T_ / tau_);
+    F meTt = 1 - eTt;
+    a_ = tau_ / T_ - eTt / meTt;
+    b_ = 1.0 / meTt - tau_ / T_;
+    c_ = meTt / T_;
+  }
+  void rateState(const F in)
+  {
+    rate_ = c_ * (a_ * rstate_ + b_ * in - lstate_);
+    rstate_ = in;
+    lstate_ = fmax(fmin(lstate_ + T_ * rate_, max_), min_);
+  }
+  F a_, b_, c_; // Coefficients
+  F lstate_;    // Lag state
+  F max_, min_; // Limits
+  F rate_;      // Rate
+  F rstate_;    // Past input
+  F T_;         // Update time, s
+  F tau_;       // Time constant, s
+};
+
+
+// Exponential rate-lag rate calculator, non-pre-warped
+template <typename F=double>
+class RateLagExpT
+{
+public:
+  RateLagExpT() : a_(0), b_(0), c_(0), lstate_(0), max_(0), min_(0), rate_(0), rstate_(0), T_(0), tau_(0) {}
+  RateLagExpT(const F T, const F tau, const F min, const F max)
+    : lstate_(0), max_(max), min_(min), rate_(0), rstate_(0), T_(T), tau_(tau)
+  {
+    assignCoeff();
+  }
+  // operators
+  // functions
+  F calculate(const F in, const int RESET)
+  {
+    if ( RESET>0 )
+    {
+      lstate_ = in;
+      rstate_ = in;
+    }
+    rateState(in);
+    return ( rate_ );
+  }
+  F calculate(const F in, const int RESET, const F T)
+  {
+    if ( RESET>0 )
+    {
+      lstate_ = in;
+      rstate_ = in;
+    }
+    if ( T!=T_ )
+    {
+      T_ = T;
+      assignCoeff();
+    }
+    rateState(in);
+    return ( rate_ );
+  }
+  F rate() { return ( rate_ ); };
+  F state() { return ( lstate_ ); };
+protected:
+  void assignCoeff()
+  {
+    F eTt = exp(-T_ / tau_);
+    a_ = tau_ / T_ - eTt / (1 - eTt);
+    b_ = 1.0 / (1 - eTt) - tau_ / T_;
+    c_ = (1.0 - eTt) / T_;
+  }
+  void rateState(const F in)
+  {
+    rate_ = fmax(fmin(c_ * (a_ * rstate_ + b_ * in - lstate_), max_), min_);
+    rstate_ = in;
+    lstate_ += T_ * rate_;
+  }
+  F a_, b_, c_; // Coefficients
+  F lstate_;    // Lag state
+  F max_, min_; // Limits
+  F rate_;      // Rate output
+  F rstate_;    // Past input
+  F T_;         // Update time, s
+  F tau_;       // Time constant, s
+};
+
+
+// Second order notch, direct form II transposed.  Unity gain away from f0, Q sets the width
+template <typename F=double>
+class NotchT
+{
+public:
+  NotchT() : a1_(0), a2_(0), b0_(1), b1_(0), z1_(0), z2_(0) {}
+  NotchT(const F f0, const F fs, const F Q) : z1_(0), z2_(0) { assignCoeff(f0, fs, Q); }
+  // operators
+  // functions
+  void assignCoeff(const F f0, const F fs, const F Q)
+  {
+    F w0 = 2.*PI*f0/fs;
+    F alpha = sin(w0)/(2.*Q);
+    F a0 = 1. + alpha;
+    b0_ = 1./a0;
+    b1_ = -2.*cos(w0)/a0;
+    a1_ = b1_;
+    a2_ = (1. - alpha)/a0;
+  }
+  F calculate(const F in, const int RESET)
+  {
+    if ( RESET>0 )  // steady state at in
+    {
+      z1_ = in*(1. - b0_);
+      z2_ = z1_;
+    }
+    F out = b0_*in + z1_;
+    z1_ = b1_*in - a1_*out + z2_;
+    z2_ = b0_*in - a2_*out;  // b2 = b0
+    return ( out );
+  }
+protected:
+  F a1_, a2_;   // Denominator coefficients, a0 normalized out
+  F b0_, b1_;   // Numerator coefficients, b2 = b0
+  F z1_, z2_;   // States
+};
+
+
+// Integrator with limits.  a, b, c select the method:  AB2 (3, -1, 2), Tustin (1, 1, 2)
+template <typename F=double>
+class DiscreteIntegratorT
+{
+public:
+  DiscreteIntegratorT() : a_(1), b_(1), c_(2), lim_(false), max_(1e32), min_(-1e32), lstate_(0), rstate_(0), T_(1) {}
+  DiscreteIntegratorT(const F T, const F min, const F max, const F a, const F b, const F c)
+    : a_(a), b_(b), c_(c), lim_(false), max_(max), min_(min), lstate_(0), rstate_(0), T_(T) {}
+  // operators
+  // functions
+  F calculate(const F in, const F T, const boolean RESET, const F init_value)
+  {
+    T_ = T;
+    if ( RESET )
+    {
+      lstate_ = init_value;  rstate_ = 0.0;
+    }
+    else
+    {
+      lstate_ += (a_*in + b_*rstate_)*T_/c_;
+    }
+    if ( lstate_<min_ )
+    {
+      lstate_ = min_;  lim_ = true;  rstate_ = 0.0;
+    }
+    else if ( lstate_>max_ )
+    {
+      lstate_ = max_;  lim_ = true;  rstate_ = 0.0;
+    }
+    else
+    {
+      lim_ = false;  rstate_ = in;
+    }
+    return ( lstate_ );
+  }
+  void newState(const F new_state)
+  {
+    lstate_ = fmax(fmin(new_state, max_), min_);
+    rstate_ = 0.0;
+  }
+  boolean lim() { return ( lim_ ); };
+  F state() { return ( lstate_ ); };
+protected:
+  F a_, b_, c_;   // Method coefficients
+  boolean lim_;   // Output limited, T=limited
+  F max_, min_;   // Limits
+  F lstate_;      // Output state
+  F rstate_;      // Past input
+  F T_;           // Update time, s
+};
+
+template <typename F=double>
+class AB2_IntegratorT : public DiscreteIntegratorT<F>
+{
+public:
+  AB2_IntegratorT() : DiscreteIntegratorT<F>() {}
+  AB2_IntegratorT(const F T, const F min, const F max) : DiscreteIntegratorT<F>(T, min, max, 3.0, -1.0, 2.0) {}
+};
+
+template <typename F=double>
+class TustinIntegratorT : public DiscreteIntegratorT<F>
+{
+public:
+  TustinIntegratorT() : DiscreteIntegratorT<F>() {}
+  TustinIntegratorT(const F T, const F min, const F max) : DiscreteIntegratorT<F>(T, min, max, 1.0, 1.0, 2.0) {}
+};
+
+
+// General 2-Pole filter variable update rate and limits, poor aliasing characteristics
+template <typename F=double>
+class General2_PoleT
+{
+public:
+  General2_PoleT() : a_(0), b_(0), T_(0) {}
+  General2_PoleT(const F T, const F omega_n, const F zeta, const F min, const F max)
+    : AB2_(T, -1e12, 1e12), Tustin_(T, min, max), a_(2 * zeta * omega_n), b_(omega_n * omega_n), T_(T) {}
+  // operators
+  // functions
+  F calculate(const F in, const int RESET)
+  {
+    rateState(in, RESET);
+    return ( Tustin_.state() );
+  }
+  F calculate(const F in, const int RESET, const F T)
+  {
+    T_ = T;
+    rateState(in, RESET);
+    return ( Tustin_.state() );
+  }
+  F state() { return ( Tustin_.state() ); };
+protected:
+  void rateState(const F in, const int RESET)
+  {
+    F accel;
+    if ( RESET>0 ) accel = 0;
+    else accel = b_*(in - Tustin_.state()) - a_*AB2_.state();
+    Tustin_.calculate(AB2_.calculate(accel, T_, RESET, 0), T_, RESET, in);
+    if ( Tustin_.lim() ) AB2_.newState(0);
+  }
+  AB2_IntegratorT<F> AB2_;        // Rate integrator
+  TustinIntegratorT<F> Tustin_;   // Position integrator
+  F a_, b_;                       // Coefficients 2*zeta*wn, wn^2
+  F T_;                           // Update time, s
+};
+
+
+#endif
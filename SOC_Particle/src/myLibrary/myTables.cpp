@@ -233,6 +233,19 @@ float TableInterp1D::interp(float x)
   return (tab1(x, x_, v_, n1_));
 }
 
+// Weights interp applies to the table values:  interp(x) = w[0]*v_[k[0]] + w[1]*v_[k[1]].   These are
+// the analytic derivatives of interp with respect to the values.  slope is d(interp)/dx, zero when clipped
+int TableInterp1D::weights(const float x, int *k, float *w, float *slope)
+{
+  float dx;
+  int high, low;
+  binsearch(x, x_, n1_, &high, &low, &dx);
+  k[0] = low;   w[0] = 1. - dx;
+  k[1] = high;  w[1] = dx;
+  if ( slope ) *slope = ( high>low ) ? (v_[high] - v_[low]) / (x_[high] - x_[low]) : 0.;
+  return 2;
+}
+
 // 1-D Interpolation Table Lookup
 // constructors
 TableInterp1Dclip::TableInterp1Dclip() : TableInterp() {}
@@ -296,6 +309,46 @@ float TableInterp2D::interp(float x, float y)
 {
   return (tab2(x, y, x_, y_, v_, n1_, n2_));  // clips
 }
+
+// Several x at one y, e.g. sigma points at one temperature.   The y bracket is found once; same result as interp
+void TableInterp2D::interp_n(const double *x, const float y, double *v, const uint8_t n)
+{
+  float dx1, dx2;
+  int high1, high2, low1, low2;
+  binsearch(y, y_, n2_, &high2, &low2, &dx2);  // clips
+  const float *lo = v_ + low2*n1_;
+  const float *hi = v_ + high2*n1_;
+  for ( uint8_t i=0; i<n; i++ )
+  {
+    binsearch(float(x[i]), x_, n1_, &high1, &low1, &dx1);  // clips
+    float r0 = lo[low1] + dx1*(lo[high1] - lo[low1]);
+    float r1 = hi[low1] + dx1*(hi[high1] - hi[low1]);
+    v[i] = r0 + dx2*(r1 - r0);
+  }
+}
+
+// Weights interp applies to the table values, as for TableInterp1D.  Four entries; clipped corners repeat.
+// slope_x is d(interp)/dx, zero when x is clipped
+int TableInterp2D::weights(const float x, const float y, int *k, float *w, float *slope_x)
+{
+  float dx1, dx2;
+  int high1, high2, low1, low2;
+  binsearch(x, x_, n1_, &high1, &low1, &dx1);
+  binsearch(y, y_, n2_, &high2, &low2, &dx2);
+  k[0] = low2*n1_ + low1;    w[0] = (1. - dx2) * (1. - dx1);
+  k[1] = low2*n1_ + high1;   w[1] = (1. - dx2) * dx1;
+  k[2] = high2*n1_ + low1;   w[2] = dx2 * (1. - dx1);
+  k[3] = high2*n1_ + high1;  w[3] = dx2 * dx1;
+  if ( slope_x )
+  {
+    if ( high1>low1 )
+      *slope_x = ( (1. - dx2)*(v_[k[1]] - v_[k[0]]) + dx2*(v_[k[3]] - v_[k[2]]) ) / (x_[high1] - x_[low1]);
+    else
+      *slope_x = 0.;
+  }
+  return 4;
+}
+
 //tab2(float x1, float x2, float *v1, float *v2, float *y, int n1, int n2);
 /*
 static float  xTbl[6]  =
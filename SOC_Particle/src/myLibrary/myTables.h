@@ -18,7 +18,10 @@ public:
   // operators
   // functions
   virtual float interp(void);
+  unsigned int n1() { return n1_; };
   void pretty_print(void);
+  float *v() { return v_; };    // Table values, for calibration
+  float *x() { return x_; };    // Breakpoints
 protected:
   unsigned int n1_;
   float *x_;
@@ -35,6 +38,7 @@ public:
   //operators
   //functions
   virtual float interp(float x);
+  int weights(const float x, int *k, float *w, float *slope=NULL);
 
 protected:
 };
@@ -64,7 +68,11 @@ public:
   //operators
   //functions
   virtual float interp(float x, float y);
+  void interp_n(const double *x, const float y, double *v, const uint8_t n);
+  unsigned int n2() { return n2_; };
   void pretty_print();
+  int weights(const float x, const float y, int *k, float *w, float *slope_x=NULL);
+  float *y() { return y_; };    // Second breakpoints
 
 protected:
   unsigned int n2_;
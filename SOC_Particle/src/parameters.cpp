@@ -26,17 +26,29 @@
 #include "parameters.h"
 #include "Sensors.h"
 #include "command.h"
+#include "Clock.h"
+#include "FltPack.h"
 
 extern CommandPars cp;
+extern SavedPars sp;
+
+// Word after the parameter block on the 47L16 naming the record layout:  'PK' and the packed record bits (FltPack.h)
+constexpr uint32_t EERAM_LAYOUT = 0x504B0000UL | FLT_PK_BITS;
 
 
 // class Parameters
 // Corruption test on bootup.  Needed because retained parameter memory is not managed by the compiler as it relies on
 // battery.  Small compilation changes can change where in this memory the program points, too
-Parameters::Parameters():n_(0) {};
+Parameters::Parameters():defs_(NULL), n_(0) {};
 
 Parameters::~Parameters(){};
 
+// Code lookup only, to check a command before it is queued
+boolean Parameters::find(const String &str)
+{
+    return ( par_find(defs_, n_, str.c_str())!=NULL );
+}
+
 boolean Parameters::find_adjust(const String &str)
 {
     uint8_t count = 0;
@@ -51,11 +63,11 @@ boolean Parameters::find_adjust(const String &str)
     }
     for ( uint8_t i=0; i<n_; i++ )
     {
-        if ( substr==V_[i]->code() )
+        if ( !strncmp(defs_[i].code, str.c_str(), 2) )
         {
             found = true;
             if ( !count ) success = V_[i]->print_adjust(value_str_);  // prints own error messages
-            else Serial.printf("RPT: %d %s success=%d\n", i, V_[i]->code().c_str(), success);
+            else Serial.printf("RPT: %d %s success=%d\n", i, defs_[i].code, success);
             count++;
         }
     }
@@ -89,7 +101,7 @@ boolean Parameters::is_corrupt()
 
 void Parameters::set_nominal()
 {
-    for ( uint16_t i=0; i<n_; i++ )  if ( V_[i]->code() != "UT" ) V_[i]->set_nominal();
+    for ( uint16_t i=0; i<n_; i++ )  if ( strcmp(defs_[i].code, "UT") ) V_[i]->set_nominal();
 }
 
 
@@ -104,50 +116,53 @@ VolatilePars::~VolatilePars(){}
 
 void  VolatilePars::initialize()
 {
-    #define NVOL 42
+    const ParDef *d = defs_ = VOL_DEFS;
     V_ = new Variable*[NVOL];
-    V_[n_++] =(cc_diff_slr_p    = new FloatV("  ", "Fc", NULL,"Slr cc_diff thr",      "slr",    0,    1000, &cc_diff_slr,       1));
-    V_[n_++] =(cycles_inj_p     = new FloatV("  ", "XC", NULL,"Number prog cycle",    "float",  0,    1000, &cycles_inj,        0));
-    V_[n_++] =(dc_dc_on_p     = new BooleanV("  ", "Xd", NULL,"DC-DC charger on",     "T=on",   0,    1,    &dc_dc_on,          false));
-    V_[n_++] =(disab_ib_fa_p  = new BooleanV("  ", "FI", NULL,"Disab hard range ib",  "T=disab",0,    1,    &disab_ib_fa,       false));
-    V_[n_++] =(disab_tb_fa_p  = new BooleanV("  ", "FT", NULL,"Disab hard range tb",  "T=disab",0,    1,    &disab_tb_fa,       false));
-    V_[n_++] =(disab_vb_fa_p  = new BooleanV("  ", "FV", NULL,"Disab hard range vb",  "T=disab",0,    1,    &disab_vb_fa,       false));
-    V_[n_++] =(ds_voc_soc_p     = new FloatV("  ", "Ds", NULL,"VOC(SOC) del soc",     "slr",    -0.5, 0.5,  &ds_voc_soc,        NOM_DS));
-    V_[n_++] =(dv_voc_soc_p     = new FloatV("  ", "Dy", NULL,"VOC(SOC) del v",       "v",      -50,  50,   &dv_voc_soc,        NOM_DY));
-    V_[n_++] =(eframe_mult_p   = new Uint8tV("  ", "DE", NULL,"EKF frame rate x Dr",  "uint",   0,    UINT8_MAX, &eframe_mult,  EKF_EFRAME_MULT));
-    V_[n_++] =(ewhi_slr_p       = new FloatV("  ", "Fi", NULL,"Slr wrap hi thr",      "slr",    0,    1000, &ewhi_slr,          1));
-    V_[n_++] =(ewlo_slr_p       = new FloatV("  ", "Fo", NULL,"Slr wrap lo thr",      "slr",    0,    1000, &ewlo_slr,          1));
-    V_[n_++] =(fail_tb_p      = new BooleanV("  ", "Xu", NULL,"Ignore Tb & fail",     "T=Fail", false,true, &fail_tb,           false));
-    V_[n_++] =(fake_faults_p  = new BooleanV("  ", "Ff", NULL,"Faults ignored",       "T=ign",  0,    1,    &fake_faults,       FAKE_FAULTS));
-    V_[n_++] =(hys_scale_p      = new FloatV("  ", "Sh", NULL,"Sim hys scale",        "slr",    0,    100,  &hys_scale,         HYS_SCALE));
-    V_[n_++] =(hys_state_p      = new FloatV("  ", "SH", NULL,"Sim hys state",        "v",      -10,  10,   &hys_state,         0));
-    V_[n_++] =(Ib_amp_noise_amp_p= new FloatV("  ","DM", NULL,"Amp amp noise",        "A",      0,    1000, &Ib_amp_noise_amp,  IB_AMP_NOISE));
-    V_[n_++] =(ib_amp_add_p     = new FloatV("  ", "Dm", NULL,"Amp signal add",       "A",      -1000,1000, &ib_amp_add,        0));
-    V_[n_++] =(ib_max_amp_p     = new FloatV("  ", "Mm", NULL,"Amp hdwe unit max",    "A",      0,    __FLT_MAX__, &ib_amp_max, (IB_ABS_MAX_AMP/NP/0.95)));
-    V_[n_++] =(ib_min_amp_p     = new FloatV("  ", "Mn", NULL,"Amp hdwe unit min",    "A",      -__FLT_MAX__,   0, &ib_amp_min, (-IB_ABS_MAX_AMP/NP/0.95)));
-    V_[n_++] =(ib_diff_slr_p    = new FloatV("  ", "Fd", NULL,"Slr ib_diff thr",      "A",      0,    1000, &ib_diff_slr,       1));
-    V_[n_++] =(Ib_noa_noise_amp_p= new FloatV("  ","DN", NULL,"Amp noa noise",        "A",      0,    1000, &Ib_noa_noise_amp,  IB_NOA_NOISE));
-    V_[n_++] =(ib_noa_add_p     = new FloatV("  ", "Dn", NULL,"No amp signal add",    "A",      -1000,1000, &ib_noa_add,        0));
-    V_[n_++] =(ib_max_noa_p     = new FloatV("  ", "Nm", NULL,"Noa hdwe signal max",  "A",      0,    __FLT_MAX__, &ib_noa_max, (IB_ABS_MAX_NOA/NP/0.95)));
-    V_[n_++] =(ib_min_noa_p     = new FloatV("  ", "Nn", NULL,"Noa hdwe signal min",  "A",      -__FLT_MAX__,   0, &ib_noa_min, (-IB_ABS_MAX_NOA/NP/0.95)));
-    V_[n_++] =(ib_quiet_slr_p   = new FloatV("  ", "Fq", NULL,"Ib quiet det slr",     "slr",    0,    1000, &ib_quiet_slr,      1));
-    V_[n_++] =(init_all_soc_p   = new FloatV("  ", "Ca", NULL,"Init all to this",     "soc",    -0.5, 1.1,  &init_all_soc,      1));
-    V_[n_++] =(init_sim_soc_p   = new FloatV("  ", "Cm", NULL,"Init sim to this",     "soc",    -0.5, 1.1,  &init_sim_soc,      1));
-    V_[n_++] =(print_mult_p    = new Uint8tV("  ", "DP", NULL,"Print mult x Dr",      "uint",   0,    UINT8_MAX, &print_mult,   DP_MULT));
-    V_[n_++] =(read_delay_p     = new ULongV("  ", "Dr", NULL,"Minor frame",          "ms",     0UL,  1000000UL,  &read_delay,  READ_DELAY));
-    V_[n_++] =(slr_res_p        = new FloatV("  ", "Sr", NULL,"Scalar Randles R0",    "slr",    0,    100,  &slr_res,           1));
-    V_[n_++] =(s_t_sat_p        = new FloatV("  ", "Xs", NULL,"Scalar on T_SAT",      "slr",    0,    100,  &s_t_sat,           1));
-    V_[n_++] =(sum_delay_p      = new ULongV("  ", "Dh", NULL,"Summary frame",        "ms",    1000UL,SUMMARY_DELAY,&sum_delay, SUMMARY_DELAY));
-    V_[n_++] =(tail_inj_p       = new ULongV("  ", "XT", NULL,"Tail end inj",         "ms",     0UL,  120000UL,&tail_inj,       0UL));
-    V_[n_++] =(talk_delay_p     = new ULongV("  ", "D>", NULL,"Talk frame",           "ms",     0UL,  120000UL,&talk_delay,     TALK_DELAY));
-    V_[n_++] =(Tb_bias_model_p  = new FloatV("  ", "D^", NULL,"Del model",            "dg C",   -120, 50,   &Tb_bias_model,     TEMP_BIAS));
-    V_[n_++] =(Tb_noise_amp_p   = new FloatV("  ", "DT", NULL,"Tb noise",             "dg C pk-pk", 0,50,   &Tb_noise_amp,      TB_NOISE));
-    V_[n_++] =(tb_stale_time_slr_p=new FloatV("  ","Xv", NULL,"Scale Tb 1-wire pers", "slr",    0,    100,  &tb_stale_time_slr,1));
-    V_[n_++] =(until_q_p        = new ULongV("  ", "XQ", NULL,"Time until vv0",       "ms",     0UL,  1000000UL,  &until_q,     0UL));
-    V_[n_++] =(vb_add_p         = new FloatV("  ", "Dv", NULL,"Bias on vb",           "v",      -15,  15,   &vb_add,            0));
-    V_[n_++] =(Vb_noise_amp_p   = new FloatV("  ", "DV", NULL,"Vb noise",             "v pk-pk",0,    10,   &Vb_noise_amp,      VB_NOISE));
-    V_[n_++] =(vc_add_p         = new FloatV("  ", "D3", NULL,"Bias on Vc/Vr",        "v",     -1.65, 0.85,  &vc_add,            0));
-    V_[n_++] =(wait_inj_p       = new ULongV("  ", "XW", NULL,"Wait start inj",       "ms",     0UL,  120000UL, &wait_inj,      0UL));
+    V_[n_++] =(cc_diff_slr_p    = new FloatV(d++, NULL, &cc_diff_slr));
+    V_[n_++] =(cycles_inj_p     = new FloatV(d++, NULL, &cycles_inj));
+    V_[n_++] =(dc_dc_on_p     = new BooleanV(d++, NULL, &dc_dc_on));
+    V_[n_++] =(disab_ib_fa_p  = new BooleanV(d++, NULL, &disab_ib_fa));
+    V_[n_++] =(disab_tb_fa_p  = new BooleanV(d++, NULL, &disab_tb_fa));
+    V_[n_++] =(disab_vb_fa_p  = new BooleanV(d++, NULL, &disab_vb_fa));
+    V_[n_++] =(dump_n_p        = new Uint8tV(d++, NULL, &dump_n));
+    V_[n_++] =(ds_voc_soc_p     = new FloatV(d++, NULL, &ds_voc_soc));
+    V_[n_++] =(dv_voc_soc_p     = new FloatV(d++, NULL, &dv_voc_soc));
+    V_[n_++] =(eframe_mult_p   = new Uint8tV(d++, NULL, &eframe_mult));
+    V_[n_++] =(ewhi_slr_p       = new FloatV(d++, NULL, &ewhi_slr));
+    V_[n_++] =(ewlo_slr_p       = new FloatV(d++, NULL, &ewlo_slr));
+    V_[n_++] =(fail_tb_p      = new BooleanV(d++, NULL, &fail_tb));
+    V_[n_++] =(fake_faults_p  = new BooleanV(d++, NULL, &fake_faults));
+    V_[n_++] =(hum_notch_hz_p   = new FloatV(d++, NULL, &hum_notch_hz));
+    V_[n_++] =(hys_scale_p      = new FloatV(d++, NULL, &hys_scale));
+    V_[n_++] =(hys_state_p      = new FloatV(d++, NULL, &hys_state));
+    V_[n_++] =(Ib_amp_noise_amp_p= new FloatV(d++, NULL, &Ib_amp_noise_amp));
+    V_[n_++] =(ib_amp_add_p     = new FloatV(d++, NULL, &ib_amp_add));
+    V_[n_++] =(ib_max_amp_p     = new FloatV(d++, NULL, &ib_amp_max));
+    V_[n_++] =(ib_min_amp_p     = new FloatV(d++, NULL, &ib_amp_min));
+    V_[n_++] =(ib_diff_slr_p    = new FloatV(d++, NULL, &ib_diff_slr));
+    V_[n_++] =(Ib_noa_noise_amp_p= new FloatV(d++, NULL, &Ib_noa_noise_amp));
+    V_[n_++] =(ib_noa_add_p     = new FloatV(d++, NULL, &ib_noa_add));
+    V_[n_++] =(ib_max_noa_p     = new FloatV(d++, NULL, &ib_noa_max));
+    V_[n_++] =(ib_min_noa_p     = new FloatV(d++, NULL, &ib_noa_min));
+    V_[n_++] =(ib_quiet_slr_p   = new FloatV(d++, NULL, &ib_quiet_slr));
+    V_[n_++] =(init_all_soc_p   = new FloatV(d++, NULL, &init_all_soc));
+    V_[n_++] =(init_sim_soc_p   = new FloatV(d++, NULL, &init_sim_soc));
+    V_[n_++] =(print_mult_p    = new Uint8tV(d++, NULL, &print_mult));
+    V_[n_++] =(read_delay_p     = new ULongV(d++, NULL, &read_delay));
+    V_[n_++] =(slr_res_p        = new FloatV(d++, NULL, &slr_res));
+    V_[n_++] =(s_t_sat_p        = new FloatV(d++, NULL, &s_t_sat));
+    V_[n_++] =(sum_delay_p      = new ULongV(d++, NULL, &sum_delay));
+    V_[n_++] =(tail_inj_p       = new ULongV(d++, NULL, &tail_inj));
+    V_[n_++] =(talk_delay_p     = new ULongV(d++, NULL, &talk_delay));
+    V_[n_++] =(Tb_bias_model_p  = new FloatV(d++, NULL, &Tb_bias_model));
+    V_[n_++] =(Tb_noise_amp_p   = new FloatV(d++, NULL, &Tb_noise_amp));
+    V_[n_++] =(tb_stale_time_slr_p=new FloatV(d++, NULL, &tb_stale_time_slr));
+    V_[n_++] =(ukf_p          = new BooleanV(d++, NULL, &ukf));
+    V_[n_++] =(until_q_p        = new ULongV(d++, NULL, &until_q));
+    V_[n_++] =(vb_add_p         = new FloatV(d++, NULL, &vb_add));
+    V_[n_++] =(Vb_noise_amp_p   = new FloatV(d++, NULL, &Vb_noise_amp));
+    V_[n_++] =(vc_add_p         = new FloatV(d++, NULL, &vc_add));
+    V_[n_++] =(wait_inj_p       = new ULongV(d++, NULL, &wait_inj));
 }
 
 // Print only the volatile paramters (non-eeram)
@@ -159,7 +174,7 @@ void VolatilePars::pretty_print(const boolean all)
             Serial.printf("volatile all:\n");
             for (uint8_t i=0; i<n_; i++ )
             {
-                if ( !(V_[i]->is_eeram()) )
+                if ( !defs_[i].saved )
                 {
                     V_[i]->print();
                 }
@@ -172,7 +187,7 @@ void VolatilePars::pretty_print(const boolean all)
         uint8_t count = 0;
         for (uint8_t i=0; i<n_; i++ )
         {
-            if ( !(V_[i]->is_eeram()) )
+            if ( !defs_[i].saved )
             {
                 if ( all || V_[i]->is_off() )
                 {
@@ -183,7 +198,7 @@ void VolatilePars::pretty_print(const boolean all)
         }
         if ( count==0 ) Serial.printf("**none**\n\n");
     }
-    while ( n_ != NVOL ) { delay(5000); Serial.printf("set NVOL=%d\n", n_); }
+    while ( n_ != NVOL ) { Clock::delay(5000); Serial.printf("set NVOL=%d\n", n_); }
 }
 
 
@@ -193,6 +208,10 @@ void VolatilePars::pretty_print(const boolean all)
 // class SavedPars 
 SavedPars::SavedPars(): Parameters()
 {
+    ps_ = NULL;
+    k_his_ = -1;
+    layout_addr_ = 0;
+    n_clip_ = 0;
     nflt_ = uint16_t( NFLT ); 
     nhis_ = uint16_t( NHIS );
     nsum_ = 0;
@@ -201,6 +220,10 @@ SavedPars::SavedPars(): Parameters()
 SavedPars::SavedPars(Flt_st *hist, const uint16_t nhis, Flt_st *faults, const uint16_t nflt): Parameters()
 {
     rP_ = NULL;
+    ps_ = NULL;
+    k_his_ = -1;
+    layout_addr_ = 0;
+    n_clip_ = 0;
     nflt_ = nflt;
     nhis_ = nhis;
     nsum_ = 0;
@@ -209,11 +232,19 @@ SavedPars::SavedPars(Flt_st *hist, const uint16_t nhis, Flt_st *faults, const ui
         fault_ = faults;
     #endif
     initialize();
+    iflt_p->new_maximum(nflt_+1);
+    iflt_p->new_default(nflt_);
+    ihis_p->new_maximum(nhis_+1);
+    ihis_p->new_default(nhis_);
 }
 
 SavedPars::SavedPars(SerialRAM *ram): Parameters()
 {
     rP_ = ram;
+    ps_ = NULL;
+    k_his_ = -1;
+    layout_addr_ = 0;
+    n_clip_ = 0;
     next_ = 0x000;
     nflt_ = uint16_t( NFLT ); 
     initialize();
@@ -222,10 +253,9 @@ SavedPars::SavedPars(SerialRAM *ram): Parameters()
     // for ( uint8_t i=0; i<n_; i++ ) if ( !V_[i]->is_eeram() ) V_[i]->set_nominal();  no!!
 
     #ifdef HDWE_47L16_EERAM
-        for ( int i=0; i<n_; i++ )
-        {
-            next_ = V_[i]->assign_addr(next_);
-        }
+        for ( int i=0; i<n_; i++ ) V_[i]->assign_addr(SAV_MAP.addr[i]);
+        next_ = SAV_MAP.addr[n_];
+        layout_addr_ = next_; next_ += sizeof(uint32_t);
 
         fault_ = new Flt_ram[nflt_];
         for ( uint16_t i=0; i<nflt_; i++ )
@@ -233,7 +263,7 @@ SavedPars::SavedPars(SerialRAM *ram): Parameters()
             fault_[i].instantiate(rP_, &next_);
         }
 
-        nhis_ = uint16_t( (MAX_EERAM - next_) / sizeof(Flt_st) ); 
+        nhis_ = uint16_t( (MAX_EERAM - next_) / FLT_PK_BYTES );
         history_ = new Flt_ram[nhis_];
         ihis_p->new_maximum(nhis_+1);
         ihis_p->new_default(nhis_);
@@ -249,53 +279,89 @@ SavedPars::~SavedPars() {}
 
 void SavedPars::initialize()
 {
-    #define NSAV 31
+    const ParDef *d = defs_ = SAV_DEFS;
     V_ = new Variable*[NSAV];
-    V_[n_++] =(amp_p            = new FloatV("* ", "Xa", rP_, "Inj amp",              "Amps pk",-1e6, 1e6,  &amp_z,         0));
-    V_[n_++] =(cutback_gain_slr_p=new FloatV("* ", "Sk", rP_, "Cutback gain scalar",  "slr",    -1e6, 1e6,  &cutback_gain_slr_z,1));
-    V_[n_++] =(debug_p            = new IntV("* ", "vv", rP_, "Verbosity",            "int",    -128, 128,  &debug_z,       0));
-    V_[n_++] =(delta_q_model_p = new DoubleV("* ", "qs", rP_, "Charge chg Sim",       "C",      -1e8, 1e5,  &delta_q_model_z, 0,                false));
-    V_[n_++] =(delta_q_p       = new DoubleV("* ", "qm", rP_, "Charge chg",           "C",      -1e8, 1e5,  &delta_q_z,     0,                  false ));
-    V_[n_++] =(Dw_p             = new FloatV("* ", "Dw", rP_, "Tab mon adj",          "v",      -1e2, 1e2,  &Dw_z,          VTAB_BIAS));
-    V_[n_++] =(freq_p           = new FloatV("* ", "Xf", rP_, "Inj freq",             "Hz",     0,    2,    &freq_z,        0));
-    V_[n_++] =(ib_bias_all_p    = new FloatV("* ", "DI", rP_, "Del all",              "A",      -1e5, 1e5,  &ib_bias_all_z, CURR_BIAS_ALL));
-    V_[n_++] =(ib_bias_amp_p    = new FloatV("* ", "DA", rP_, "Add amp",              "A",      -1e5, 1e5,  &ib_bias_amp_z, CURR_BIAS_AMP));
-    V_[n_++] =(ib_bias_noa_p    = new FloatV("* ", "DB", rP_, "Add noa",              "A",      -1e5, 1e5,  &ib_bias_noa_z, CURR_BIAS_NOA));
-    V_[n_++] =(ib_scale_amp_p   = new FloatV("* ", "SA", rP_, "Slr amp",              "A",      -1e5, 1e5,  &ib_scale_amp_z,CURR_SCALE_AMP));
-    V_[n_++] =(ib_scale_noa_p   = new FloatV("* ", "SB", rP_, "Slr noa",              "A",      -1e5, 1e5,  &ib_scale_noa_z,CURR_SCALE_NOA));
-    V_[n_++] =(ib_disch_slr_p   = new FloatV("* ", "SD", rP_, "Slr disch",            "slr",    -1e5, 1e5,  &ib_disch_slr_z,CURR_SCALE_DISCH));
-    #ifdef HDWE_IB_HI_LO
-        V_[n_++] =(ib_force_p      = new Int8tV("* ", "si", rP_, "curr sel mode",        "(-1, 0, 1)", -1, 1,  &ib_force_z, int8_t(0)));
-    #else
-        V_[n_++] =(ib_force_p      = new Int8tV("* ", "si", rP_, "curr sel mode",        "(-1, 0, 1)", -1, 1,  &ib_force_z, int8_t(FAKE_FAULTS)));
-    #endif
-    V_[n_++] =(iflt_p         = new Uint16tV("* ", "if", rP_, "Fault buffer indx",    "uint",   0,nflt_+1,  &iflt_z,        nflt_,              false));
-    V_[n_++] =(ihis_p         = new Uint16tV("* ", "ih", rP_, "Hist buffer indx",     "uint",   0,nhis_+1,  &ihis_z,        nhis_,              false));
-    V_[n_++] =(inj_bias_p       = new FloatV("* ", "Xb", rP_, "Injection bias",       "A",      -1e5, 1e5,  &inj_bias_z,    0.));
-    V_[n_++] =(isum_p         = new Uint16tV("* ", "is", rP_, "Summ buffer indx",     "uint",   0, NSUM+1,  &isum_z,        NSUM,               false));
-    V_[n_++] =(modeling_p      = new Uint8tV("* ", "Xm", rP_, "Modeling bitmap",      "[0x]",   0,    255,  &modeling_z,    MODELING));
-    V_[n_++] =(nP_p             = new FloatV("* ", "BP", rP_, "Number parallel",      "units",  1e-6, 100,  &nP_z,          NP));
-    V_[n_++] =(nS_p             = new FloatV("* ", "BS", rP_, "Number series",        "units",  1e-6, 100,  &nS_z,          NS));
-    V_[n_++] =(preserving_p    = new Uint8tV("* ", "X?", rP_, "Preserving fault",     "T=Preserve",0,   1,  &preserving_z,  0,                  false));
-    V_[n_++] =(s_cap_mon_p      = new FloatV("* ", "SQ", rP_, "Scalar cap Mon",       "slr",    0,    1000, &s_cap_mon_z,   1.));
-    V_[n_++] =(s_cap_sim_p      = new FloatV("* ", "Sq", rP_, "Scalar cap Sim",       "slr",    0,    1000, &s_cap_sim_z,   1.));
-    V_[n_++] =(Tb_bias_hdwe_p   = new FloatV("* ", "Dt", rP_, "Bias Tb sensor",       "dg C",   -500, 500,  &Tb_bias_hdwe_z,TEMP_BIAS));
-    V_[n_++] =(Time_now_p       = new ULongV("* ", "UT", rP_, "UNIX time epoch",      "sec",    0UL,  2100000000UL, &Time_now_z, 1669801880UL,  false));
-    V_[n_++] =(Type_p          = new Uint8tV("* ", "Xt", rP_, "Inj type",             "1sn 2sq 3tr 4 1C, 5 -1C, 8cs",  0,   10,  &type_z, 0));
-    V_[n_++] =(T_state_model_p  = new FloatV("* ", "ts", rP_, "Tb Sim rate lim mem",  "dg C",   -10,  70,   &T_state_model_z,RATED_TEMP,       false));
-    V_[n_++] =(T_state_p        = new FloatV("* ", "tm", rP_, "Tb rate lim mem",      "dg C",   -10,  70,   &T_state_z,     RATED_TEMP,         false));
-    V_[n_++] =(Vb_bias_hdwe_p   = new FloatV("* ", "Dc", rP_, "Bias Vb sensor",       "v",      -10,  70,   &Vb_bias_hdwe_z,VOLT_BIAS));
-    V_[n_++] =(Vb_scale_p       = new FloatV("* ", "SV", rP_, "Scale Vb sensor",      "v",      -1e5, 1e5,  &Vb_scale_z,    VB_SCALE));
+    V_[n_++] =(amp_p            = new FloatV(d++, rP_, &amp_z));
+    V_[n_++] =(cap_est_p        = new FloatV(d++, rP_, &cap_est_z));
+    V_[n_++] =(cap_n_p        = new Uint16tV(d++, rP_, &cap_n_z));
+    V_[n_++] =(cap_var_p        = new FloatV(d++, rP_, &cap_var_z));
+    V_[n_++] =(cutback_gain_slr_p=new FloatV(d++, rP_, &cutback_gain_slr_z));
+    V_[n_++] =(debug_p            = new IntV(d++, rP_, &debug_z));
+    V_[n_++] =(delta_q_model_p = new DoubleV(d++, rP_, &delta_q_model_z));
+    V_[n_++] =(delta_q_p       = new DoubleV(d++, rP_, &delta_q_z));
+    V_[n_++] =(Dw_p             = new FloatV(d++, rP_, &Dw_z));
+    V_[n_++] =(freq_p           = new FloatV(d++, rP_, &freq_z));
+    V_[n_++] =(ib_bias_all_p    = new FloatV(d++, rP_, &ib_bias_all_z));
+    V_[n_++] =(ib_bias_amp_p    = new FloatV(d++, rP_, &ib_bias_amp_z));
+    V_[n_++] =(ib_bias_noa_p    = new FloatV(d++, rP_, &ib_bias_noa_z));
+    V_[n_++] =(ib_scale_amp_p   = new FloatV(d++, rP_, &ib_scale_amp_z));
+    V_[n_++] =(ib_scale_noa_p   = new FloatV(d++, rP_, &ib_scale_noa_z));
+    V_[n_++] =(ib_disch_slr_p   = new FloatV(d++, rP_, &ib_disch_slr_z));
+    V_[n_++] =(ib_force_p      = new Int8tV(d++, rP_, &ib_force_z));
+    V_[n_++] =(iflt_p         = new Uint16tV(d++, rP_, &iflt_z));
+    V_[n_++] =(ihis_p         = new Uint16tV(d++, rP_, &ihis_z));
+    V_[n_++] =(inj_bias_p       = new FloatV(d++, rP_, &inj_bias_z));
+    V_[n_++] =(isum_p         = new Uint16tV(d++, rP_, &isum_z));
+    V_[n_++] =(modeling_p      = new Uint8tV(d++, rP_, &modeling_z));
+    V_[n_++] =(nP_p             = new FloatV(d++, rP_, &nP_z));
+    V_[n_++] =(nS_p             = new FloatV(d++, rP_, &nS_z));
+    V_[n_++] =(preserving_p    = new Uint8tV(d++, rP_, &preserving_z));
+    V_[n_++] =(s_cap_mon_p      = new FloatV(d++, rP_, &s_cap_mon_z));
+    V_[n_++] =(s_cap_sim_p      = new FloatV(d++, rP_, &s_cap_sim_z));
+    V_[n_++] =(Tb_bias_hdwe_p   = new FloatV(d++, rP_, &Tb_bias_hdwe_z));
+    V_[n_++] =(Time_now_p       = new ULongV(d++, rP_, &Time_now_z));
+    V_[n_++] =(Type_p          = new Uint8tV(d++, rP_, &type_z));
+    V_[n_++] =(T_state_model_p  = new FloatV(d++, rP_, &T_state_model_z));
+    V_[n_++] =(T_state_p        = new FloatV(d++, rP_, &T_state_z));
+    V_[n_++] =(Vb_bias_hdwe_p   = new FloatV(d++, rP_, &Vb_bias_hdwe_z));
+    V_[n_++] =(Vb_scale_p       = new FloatV(d++, rP_, &Vb_scale_z));
 }
 
 // Assign all save EERAM to RAM
 #ifdef HDWE_47L16_EERAM
+    // Parameter block in one bulk read, laid out by SAV_MAP
     void SavedPars::load_all()
     {
-        for (int i=0; i<n_; i++ ) V_[i]->get();
-        
-        for ( uint16_t i=0; i<nflt_; i++ ) fault_[i].get();
-        for ( uint16_t i=0; i<nhis_; i++ ) history_[i].get();
+        uint8_t *buf = new uint8_t[SAV_MAP.addr[NSAV]]();
+        rP_->read_bulk(0x000, buf, SAV_MAP.addr[NSAV]);
+        for ( int i=0; i<n_; i++ ) V_[i]->get_from(&buf[SAV_MAP.addr[i]]);
+        delete[] buf;
+
+        // Records written in another layout, by an older build or on a new chip, would unpack as garbage
+        uint32_t layout = 0;
+        rP_->read_bulk(layout_addr_, (uint8_t *)&layout, sizeof(layout));
+        if ( layout!=EERAM_LAYOUT )
+        {
+            Serial.printf("EERAM record layout 0x%lX not 0x%lX:  nominalizing faults and history\n", (unsigned long)layout,
+                (unsigned long)EERAM_LAYOUT);
+            reset_flt();
+            reset_his();
+            layout = EERAM_LAYOUT;
+            rP_->write_bulk(layout_addr_, (uint8_t *)&layout, sizeof(layout));
+            return;
+        }
+        get_flt_array(fault_, nflt_);
+        get_flt_array(history_, nhis_);
+    }
+
+    // Contiguous records in one bulk read
+    void SavedPars::get_flt_array(Flt_ram *recs, const uint16_t n)
+    {
+        if ( n==0 ) return;
+        uint8_t *buf = new uint8_t[n*FLT_PK_BYTES];
+        rP_->read_bulk(recs[0].eeram_addr(), buf, n*FLT_PK_BYTES);
+        flt_unpack_array(buf, n, recs);
+        delete[] buf;
+    }
+
+    // Contiguous records as RAM holds them in one bulk write
+    void SavedPars::put_flt_array(Flt_ram *recs, const uint16_t n)
+    {
+        if ( n==0 ) return;
+        uint8_t *buf = new uint8_t[n*FLT_PK_BYTES];
+        n_clip_ += flt_pack_array(recs, n, buf);
+        rP_->write_bulk(recs[0].eeram_addr(), buf, n*FLT_PK_BYTES);
+        delete[] buf;
     }
 #endif
 
@@ -355,7 +421,7 @@ void SavedPars::pretty_print(const boolean all)
         if ( count==0 ) Serial.printf("**none**\n\n");
 
         // Build integrity test
-        while ( n_ != NSAV ) { delay(5000); Serial.printf("set NSAV=%d\n", n_); }
+        while ( n_ != NSAV ) { Clock::delay(5000); Serial.printf("set NSAV=%d\n", n_); }
     }
 
     #ifdef HDWE_47L16_EERAM
@@ -400,10 +466,8 @@ void SavedPars::print_fault_array()
 // Print faults
 void SavedPars::print_fault_header(Publish *pubList)
 {
-    Serial.printf("Config:  %s \n", pubList->unit.c_str());
-    Serial1.printf("Config:  %s \n", pubList->unit.c_str());
-    Serial.printf ("fltb,  date,             time_ux,    Tb_h, vb_h, ibmh, ibnh, Tb, vb, ib, soc, soc_min, soc_ekf, voc, voc_stat, e_w_f, e_wm_f, e_wn_f, fltw, falw,\n");
-    Serial1.printf ("fltb,  date,             time_ux,    Tb_h, vb_h, ibmh, ibnh, Tb, vb, ib, soc, soc_min, soc_ekf, voc, voc_stat, e_w_f, e_wm_f, e_wn_f, fltw, falw,\n");
+    rt.printf(ROUTE_ALL, "Config:  %s \n", pubList->unit);
+    rt.printf(ROUTE_ALL, "fltb,  date,             time_ux,    Tb_h, vb_h, ibmh, ibnh, Tb, vb, ib, soc, soc_min, soc_ekf, voc, voc_stat, e_w_f, e_wm_f, e_wn_f, fltw, falw,\n");
 }
 
 // Print history
@@ -418,63 +482,95 @@ void SavedPars::print_history_array()
   }
 }
 
-// Dynamic parameters saved
-// This saves a lot of througput.   Without it, there are many put calls each 'read' minor frame at 1 ms each call
-void SavedPars::put_all_dynamic()
+// Scheduler stores the history record given it
+static uint16_t put_history_entry(const uint16_t i) { return sp.put_history_rec(i); }
+
+// Hand the dynamic parameters and the history records to the persistence scheduler.   Before, put_all_dynamic
+// wrote them on a fixed round-robin each display pass.   Without EERAM the Device OS saves the retained block
+void SavedPars::persist(PersistSched *ps)
 {
-    static uint8_t blink = 0;
-    switch ( blink++ )
-    {
-        case ( 0 ):
-            put_delta_q();
-            break;
-
-        case ( 1 ):
-            put_delta_q_model();
-            break;
-
-        case ( 2 ):
-            put_T_state();
-            break;
-
-        case ( 3 ):
-            put_T_state_model();
-            break;
-
-        case ( 4 ):
-            put_Time_now(max( Time_now_z, (unsigned long)Time.now()));  // If happen to connect to wifi (assume updated automatically), save new time
-            blink = 0;
-            break;
-
-        default:
-            blink = 0;
-            break;
-    }
+    ps_ = ps;
+    ps_->whole_block( rP_==NULL );
+    ps_->add("qm", delta_q_p, PS_TOL_DQ, PS_T_STALE_DQ);
+    ps_->add("qs", delta_q_model_p, PS_TOL_DQ, PS_T_STALE_DQ);
+    ps_->add("tm", T_state_p, PS_TOL_T, PS_T_STALE_T);
+    ps_->add("ts", T_state_model_p, PS_TOL_T, PS_T_STALE_T);
+    ps_->add("UT", Time_now_p, PS_TOL_UT, PS_T_STALE_UT);
+    k_his_ = ps_->add_rec("his", put_history_entry, PS_T_STALE_REC);
 }
- 
+
+// Records the stores hold as Flt_st and packed (FltPack.h).   The 47L16 already holds the history packed in what
+// is left past the fault records
+void SavedPars::print_pack_capacity()
+{
+    Serial.printf("Record %d bits, %d B packed, %d B as Flt_st:\n", FLT_PK_BITS, FLT_PK_BYTES, int(sizeof(Flt_st)));
+    flt_pack_capacity("flt", nflt_*sizeof(Flt_st), sizeof(Flt_st));
+    #ifdef HDWE_47L16_EERAM
+        flt_pack_capacity("his", MAX_EERAM - history_[0].eeram_addr(), sizeof(Flt_st));
+    #else
+        flt_pack_capacity("his", nhis_*sizeof(Flt_st), sizeof(Flt_st));
+    #endif
+    flt_pack_capacity("sum", nsum_*sizeof(Flt_st), sizeof(Flt_st));
+    Serial.printf(" fields clipped packing since boot %ld\n", (long)n_clip_);
+}
+
  // Bounce history elements
 Flt_st SavedPars::put_history(Flt_st input, const uint8_t i)
 {
     Flt_st bounced_sum;
     bounced_sum.copy_to_Flt_ram_from(history_[i]);
-    history_[i].put(input);
+    if ( ps_ )
+    {
+        history_[i].copy_to_Flt_ram_from(input);
+        ps_->mark_rec(k_his_, i, double(Clock::millis())/1000.);
+    }
+    else
+    {
+        #ifdef HDWE_47L16_EERAM
+            n_clip_ += history_[i].put(input);
+        #else
+            history_[i].put(input);
+        #endif
+    }
     return bounced_sum;
 }
 
+// Store history entry i as it is in RAM
+uint16_t SavedPars::put_history_rec(const uint16_t i)
+{
+    if ( i>=nhis_ ) return 0;
+    #ifdef HDWE_47L16_EERAM
+        n_clip_ += history_[i].put(history_[i]);
+        return FLT_PK_BYTES;
+    #else
+        return sizeof(Flt_st);
+    #endif
+}
+
 // Reset arrays
 void SavedPars::reset_flt()
 {
-    for ( uint16_t i=0; i<nflt_; i++ )
-    {
-        fault_[i].put_nominal();
-    }
+    #ifdef HDWE_47L16_EERAM
+        for ( uint16_t i=0; i<nflt_; i++ ) fault_[i].nominal();
+        put_flt_array(fault_, nflt_);
+    #else
+        for ( uint16_t i=0; i<nflt_; i++ )
+        {
+            fault_[i].put_nominal();
+        }
+    #endif
  }
 void SavedPars::reset_his()
 {
-    for ( uint16_t i=0; i<nhis_; i++ )
-    {
-        history_[i].put_nominal();
-    }
+    #ifdef HDWE_47L16_EERAM
+        for ( uint16_t i=0; i<nhis_; i++ ) history_[i].nominal();
+        put_flt_array(history_, nhis_);
+    #else
+        for ( uint16_t i=0; i<nhis_; i++ )
+        {
+            history_[i].put_nominal();
+        }
+    #endif
  }
 
 void SavedPars::set_nominal()
@@ -30,6 +30,7 @@
 #include "PrinterPars.h"
 #include "Variable.h"
 #include "Cloud.h"
+#include "PersistSched.h"
 
 void app_no();
 void app_mon_chem();
@@ -40,6 +41,7 @@ public:
     Parameters();
     ~Parameters();
     // Do everything
+    boolean find(const String &str);
     boolean find_adjust(const String &str);
     virtual void initialize() {}
     boolean is_corrupt();
@@ -47,6 +49,7 @@ public:
     void set_nominal();
     String value_str() { return value_str_; }
 protected:
+    const ParDef *defs_;    // Flash table V_ is built from, in order
     int8_t n_;
     Variable **V_;
     String value_str_;
@@ -65,6 +68,7 @@ public:
     // Declare
     float cc_diff_slr;          // Scale cc_diff detection thresh, scalar
     float cycles_inj;           // Number of injection cycles
+    uint8_t dump_n;             // History dump records per loop pass
     boolean dc_dc_on;           // DC-DC charger is on
     boolean disab_ib_fa;        // Disable hard fault range failures for ib
     boolean disab_tb_fa;        // Disable hard fault range failures for tb
@@ -76,6 +80,7 @@ public:
     float ewlo_slr;             // Scale wrap lo detection thresh, scalar
     boolean fail_tb;            // Make hardware bus read ignore Tb and fail it
     boolean fake_faults;        // Faults faked (ignored).  Used to evaluate a configuration, deploy it without disrupting use
+    float hum_notch_hz;         // Ib/Vb hum notch frequency, 0=off, Hz
     float hys_scale;            // Sim hysteresis scalar
     float hys_state;            // Sim hysteresis state
     float ib_amp_add;           // Fault injection bias on amp, A
@@ -100,6 +105,7 @@ public:
     float Tb_bias_model;        // Bias on Tb for model
     float Tb_noise_amp;         // Tb noise amplitude model only, deg C pk-pk
     float tb_stale_time_slr;    // Scalar on persistences of Tb hardware stale check
+    boolean ukf;                // Mon soc_ekf from the UKF instead of the EKF
     unsigned long int until_q;  // Time until set vv0, ms
     float vb_add;               // Fault injection bias, V
     float Vb_noise_amp;         // Vb bank noise amplitude model only, V pk-pk
@@ -107,6 +113,7 @@ public:
     unsigned long int wait_inj; // Wait before start injection, ms
     FloatV *cc_diff_slr_p;
     FloatV *cycles_inj_p;
+    Uint8tV *dump_n_p;
     BooleanV *dc_dc_on_p;
     BooleanV *disab_ib_fa_p;
     BooleanV *disab_tb_fa_p;
@@ -118,6 +125,8 @@ public:
     FloatV *ewlo_slr_p;
     BooleanV *fail_tb_p;
     BooleanV *fake_faults_p;
+    BooleanV *ukf_p;
+    FloatV *hum_notch_hz_p;
     FloatV *hys_scale_p;
     FloatV *hys_state_p;
     FloatV *ib_amp_add_p;
@@ -168,6 +177,10 @@ public:
  
     // parameter list
     float Amp() { return amp_z * nP_z; }
+    float amp() { return amp_z; }
+    float cap_est() { return cap_est_z; }
+    uint16_t cap_n() { return cap_n_z; }
+    float cap_var() { return cap_var_z; }
     float cutback_gain_slr() { return cutback_gain_slr_z; }
     int debug() { return debug_z;}
     double delta_q() { return delta_q_z;}
@@ -183,6 +196,8 @@ public:
     float ib_scale_amp() { return ib_scale_amp_z; }
     float ib_scale_noa() { return ib_scale_noa_z; }
     int8_t ib_force() { return ib_force_z; }
+    Flt_st *fault(const uint16_t i) { return &fault_[i]; }
+    Flt_st *history(const uint16_t i) { return &history_[i]; }
     uint16_t Iflt() { return iflt_z; }
     uint16_t Ihis() { return ihis_z; }
     float inj_bias() { return inj_bias_z; }
@@ -203,6 +218,7 @@ public:
     virtual void initialize();
     void large_reset() { set_nominal(); reset_flt(); reset_his(); }
     void mem_print();
+    uint32_t n_clip() { return n_clip_; }
     uint16_t nflt() { return nflt_; }
     uint16_t nhis() { return nhis_; }
     void nsum(const uint16_t in) { nsum_ = in; }
@@ -210,6 +226,8 @@ public:
     void nominalize_fault_array();
     void nominalize_history_array();
     int num_diffs();
+    void persist(PersistSched *ps);
+    void print_pack_capacity();
     virtual void pretty_print(const boolean all);
     void pretty_print_modeling();
     void print_fault_array();
@@ -218,8 +236,8 @@ public:
     void reset_flt();
     void reset_his();
     virtual void set_nominal();
-    float ib_hist_slr() { if ( abs(amp_z) > 40. ) return 30000./abs(amp_z); else return 600.; }
-    float vb_hist_slr() { if ( abs(amp_z) > 40. ) return 1500./abs(amp_z); else return 1200.; }
+    float ib_hist_slr() { if ( abs(amp_z) > 40. ) return 30000./abs(amp_z); else return HIST_SLR_IB; }
+    float vb_hist_slr() { if ( abs(amp_z) > 40. ) return 1500./abs(amp_z); else return HIST_SLR_VB; }
     boolean mod_all_dscn() { return ( 111<modeling() ); }                // Bare all
     boolean mod_any() { return ( mod_ib() || mod_tb() || mod_vb() ); }  // Modeling any
     boolean mod_any_dscn() { return ( 15<modeling() ); }                 // Bare any
@@ -237,20 +255,22 @@ public:
 
     #ifdef HDWE_47L16_EERAM
         void get_fault(const uint8_t i) { fault_[i].get(); }
+        void get_flt_array(Flt_ram *recs, const uint16_t n);
         void get_history(const uint8_t i) { history_[i].get(); }
         uint16_t next() { return next_; }
         void load_all();
+        void put_flt_array(Flt_ram *recs, const uint16_t n);
     #endif
 
     // put
-    void put_all_dynamic();
     void put_amp(const float input) { amp_p->check_set_put(input); }
+    void put_cap_est(const float input) { cap_est_p->check_set_put(input); }
+    void put_cap_n(const uint16_t input) { cap_n_p->check_set_put(input); }
+    void put_cap_var(const float input) { cap_var_p->check_set_put(input); }
     void put_cutback_gain_slr(const float input) { cutback_gain_slr_p->check_set_put(input); }
     void put_Debug(const int input) { debug_p->check_set_put(input); }
     void put_Delta_q(const double input) { delta_q_p->check_set_put(input); }
-    void put_delta_q() {}
     void put_delta_q_model(const double input) { delta_q_model_p->check_set_put(input); }
-    void put_delta_q_model() {}
     void put_Dw(const float input) { Dw_p->check_set_put(input); }
     void put_Freq(const float input) { freq_p->check_set_put(input); }
     void put_ib_bias_all(const float input) { ib_bias_all_p->check_set_put(input); }
@@ -278,20 +298,19 @@ public:
     void put_Vb_scale(const float input) { Vb_scale_p->check_set_put(input); }
     #ifndef HDWE_47L16_EERAM
         void put_modeling(const uint8_t input) { modeling_p->check_set_put(input); modeling_z = modeling();}
-        void put_T_state() {}
-        void put_T_state_model() {}
         void put_fault(const Flt_st input, const uint8_t i) { fault_[i].copy_to_Flt_ram_from(input); }
     #else
         void put_modeling(const uint8_t input) { modeling_p->check_set_put(input); }
-        void put_T_state() { T_state_p->check_set_put(T_state_z); }
-        void put_T_state_model() { T_state_p->check_set_put(T_state_model_z); }
-
-        void put_fault(const Flt_st input, const uint8_t i) { fault_[i].put(input); }
+        void put_fault(const Flt_st input, const uint8_t i) { n_clip_ += fault_[i].put(input); }
     #endif
     //
     Flt_st put_history(const Flt_st input, const uint8_t i);
+    uint16_t put_history_rec(const uint16_t i);
     boolean tweak_test() { return ( 1<<3 & modeling() ); } // Driving signal injection completely using software inj_bias 
     FloatV *amp_p;
+    FloatV *cap_est_p;
+    Uint16tV *cap_n_p;
+    FloatV *cap_var_p;
     FloatV *cutback_gain_slr_p;
     IntV *debug_p;
     DoubleV *delta_q_p;
@@ -325,6 +344,9 @@ public:
 
     // SRAM storage state "retained" in SOC_Particle.ino.  Very few elements
     float amp_z;
+    float cap_est_z;
+    uint16_t cap_n_z;
+    float cap_var_z;
     float cutback_gain_slr_z;
     int debug_z;
     double delta_q_z;
@@ -365,10 +387,14 @@ protected:
         Flt_ram *fault_;
         Flt_ram *history_;
     #endif
+    uint16_t layout_addr_;  // EERAM address of the record layout word, EERAM_LAYOUT
+    uint32_t n_clip_;       // Record fields saturated packing for the 47L16 since boot
     uint16_t next_;
     uint16_t nflt_;         // Length of Flt_ram array for fault snapshot
     uint16_t nhis_;         // Length of Flt_ram array for fault history
     uint16_t nsum_;         // Length of Sum array for history
+    PersistSched *ps_;      // Scheduler storing the dynamic parameters and history, NULL stores at once
+    int8_t k_his_;          // Scheduler field of the history records
 };
 
 
@@ -25,6 +25,7 @@
 #include "command.h"
 #include "constants.h"
 #include "debug.h"
+#include "Clock.h"
 
 extern CommandPars cp;  // Various parameters shared at system level
 
@@ -35,7 +36,7 @@ void create_rapid_string(Publish *pubList, Sensors *Sen, BatteryMonitor *Mon)
   double cTime = double(Sen->now)/1000;
   
   sprintf(pr.buff, "%s, %s,%13.3f,%6.3f, %d,%7.0f,%d, %d, %d, %d, %6.3f,%6.3f,%9.3f,%9.3f,%8.5f,  %7.5f,%8.5f,%8.5f,%8.5f,  %9.6f, %8.5f,%8.5f,%8.5f,%5.3f,", \
-    pubList->unit.c_str(), pubList->hm_string.c_str(), cTime, Sen->T,
+    pubList->unit, pubList->hm_string, cTime, Sen->T,
     CHEM, Mon->q_cap_rated_scaled(), pubList->sat, sp.ib_force(), sp.modeling(), Mon->bms_off(),
     Mon->Tb(), Mon->vb(), Mon->ib(), Mon->ib_charge(), Mon->voc_soc(), 
     Mon->vsat(), Mon->dv_dyn(), Mon->voc_stat(), Mon->hx(),
@@ -47,11 +48,15 @@ void create_rapid_string(Publish *pubList, Sensors *Sen, BatteryMonitor *Mon)
 // Non-blocking delay
 void delay_no_block(const unsigned long long interval)
 {
-  unsigned long long previousMillis = System.millis();
+  #ifdef SOFT_VIRTUAL_TIME
+    Clock::delay(interval);   // Nothing else moves the virtual clock
+    return;
+  #endif
+  unsigned long long previousMillis = Clock::millis();
   unsigned long long currentMillis = previousMillis;
   while( currentMillis - previousMillis < interval )
   {
-    currentMillis = System.millis();
+    currentMillis = Clock::millis();
   }
 }
 
@@ -163,9 +168,10 @@ void print_serial_header(void)
 {
   if ( ( sp.debug()==1 || sp.debug()==2 || sp.debug()==3 || sp.debug()==4 ) )
   {
-    Serial.printf ("unit,               hm,                  cTime,       dt,       chm,qcrs,sat,sel,mod,bmso, Tb,  vb,  ib,   ib_charge, voc_soc,    vsat,dv_dyn,voc_stat,voc_ekf,     y_ekf,    soc_s,soc_ekf,soc,soc_min,\n");
     #ifdef HDWE_ARGON
-      Serial1.printf("unit,               hm,                  cTime,       dt,       chm,qcrs,sat,sel,mod,bmso, Tb,  vb,  ib,   ib_charge, voc_soc,    vsat,dv_dyn,voc_stat,voc_ekf,     y_ekf,    soc_s,soc_ekf,soc,soc_min,\n");
+      rt.rapid(ROUTE_ALL, "unit,               hm,                  cTime,       dt,       chm,qcrs,sat,sel,mod,bmso, Tb,  vb,  ib,   ib_charge, voc_soc,    vsat,dv_dyn,voc_stat,voc_ekf,     y_ekf,    soc_s,soc_ekf,soc,soc_min,\n");
+    #else
+      rt.rapid(ROUTE_USB, "unit,               hm,                  cTime,       dt,       chm,qcrs,sat,sel,mod,bmso, Tb,  vb,  ib,   ib_charge, voc_soc,    vsat,dv_dyn,voc_stat,voc_ekf,     y_ekf,    soc_s,soc_ekf,soc,soc_min,\n");
     #endif
   }
 }
@@ -173,31 +179,34 @@ void print_serial_header(void)
 void print_serial_sim_header(void)
 {
   if ( sp.debug()==2  || sp.debug()==3 || sp.debug()==4 ) // print_serial_sim_header
-    Serial.printf("unit_m,  c_time,       chm_s, qcrs_s, bmso_s, Tb_s,Tbl_s,  vsat_s, voc_stat_s, dv_dyn_s, vb_s, ib_s, ib_in_s, ib_charge_s, ioc_s, sat_s, dq_s, soc_s, reset_s,\n");
+    rt.rapid(ROUTE_USB, "unit_m,  c_time,       chm_s, qcrs_s, bmso_s, Tb_s,Tbl_s,  vsat_s, voc_stat_s, dv_dyn_s, vb_s, ib_s, ib_in_s, ib_charge_s, ioc_s, sat_s, dq_s, soc_s, reset_s,\n");
 }
 
 void print_signal_sel_header(void)
 {
   if ( sp.debug()==2 || sp.debug()==4 ) // print_signal_sel_header
-    Serial.printf("unit_s,c_time,res,user_sel,   cc_dif,  ibmh,ibnh,ibmm,ibnm,ibm,   ib_diff, ib_diff_f,");
-    Serial.printf("    voc_soc,e_w,e_w_f,e_wm,e_wm_f,e_wn,e_wn_f,e_wm_t,  ib_sel_stat,vc_h,ib_h,ib_s,mib,ib, vb_sel,vb_h,vb_s,mvb,vb,  Tb_h,Tb_s,mtb,Tb_f, ");
-    Serial.printf("  fltw, falw, ib_rate, ib_quiet, tb_sel, ccd_thr, ewh_thr, ewl_thr, ibd_thr, ibq_thr, preserving,ff,y_ekf_f,ib_dec,\n");
+  {
+    rt.rapid(ROUTE_USB, "unit_s,c_time,res,user_sel,   cc_dif,  ibmh,ibnh,ibmm,ibnm,ibm,   ib_diff, ib_diff_f,");
+    rt.rapid(ROUTE_USB, "    voc_soc,e_w,e_w_f,e_wm,e_wm_f,e_wn,e_wn_f,e_wm_t,  ib_sel_stat,vc_h,ib_h,ib_s,mib,ib, vb_sel,vb_h,vb_s,mvb,vb,  Tb_h,Tb_s,mtb,Tb_f, ");
+    rt.rapid(ROUTE_USB, "  fltw, falw, ib_rate, ib_quiet, tb_sel, ccd_thr, ewh_thr, ewl_thr, ibd_thr, ibq_thr, preserving,ff,y_ekf_f,ib_dec,\n");
+  }
 }
 
 void print_serial_ekf_header(void)
 {
   if ( sp.debug()==3 || sp.debug()==4 ) // print_serial_ekf_header
-    Serial.printf("unit_e,c_time,dt,Fx_, Bu_, Q_, R_, P_, S_, K_, u_, x_, y_, z_, x_prior_, P_prior_, x_post_, P_post_, hx_, H_,\n");
+    rt.rapid(ROUTE_USB, "unit_e,c_time,dt,Fx_, Bu_, Q_, R_, P_, S_, K_, u_, x_, y_, z_, x_prior_, P_prior_, x_post_, P_post_, hx_, H_,\n");
 }
 
 
 // Inputs serial print
 void rapid_print(Sensors *Sen, BatteryMonitor *Mon)
 {
-  create_rapid_string(&pp.pubList, Sen, Mon);
-  Serial.printf("%s\n", pr.buff);
+  create_rapid_string(pp.front(), Sen, Mon);
   #ifdef HDWE_ARGON
-    Serial1.printf("%s\n", pr.buff);
+    rt.rapid(ROUTE_ALL, "%s\n", pr.buff);
+  #else
+    rt.rapid(ROUTE_USB, "%s\n", pr.buff);
   #endif
 }
 
@@ -327,9 +336,9 @@ void wait_on_user_input(Adafruit_SSD1306 *display)
     if ( answer=='\r')
     {
       count++;
-      if ( count>1 ) delay(4000);
+      if ( count>1 ) Clock::delay(4000);
     }
-    else delay(100);
+    else Clock::delay(100);
 
     if ( Serial.available() )
       answer=Serial.read();
@@ -358,7 +367,7 @@ void wait_on_user_input(Adafruit_SSD1306 *display)
         {
           Serial.printf("?");
           count++;
-          delay(1000);
+          Clock::delay(1000);
         }
       }
     }
@@ -393,9 +402,9 @@ void wait_on_user_input()
     if ( answer=='\r')
     {
       count++;
-      if ( count>1 ) delay(4000);
+      if ( count>1 ) Clock::delay(4000);
     }
-    else delay(100);
+    else Clock::delay(100);
 
     if ( Serial.available() )
       answer=Serial.read();
@@ -424,7 +433,7 @@ void wait_on_user_input()
         {
           Serial.printf("?");
           count++;
-          delay(1000);
+          Clock::delay(1000);
         }
       }
     }
@@ -10,6 +10,8 @@
 #define HDWE_PHOTON2
 #define HDWE_IB_HI_LO
 #define HDWE_DS2482_1WIRE
+// #define HDWE_DS2482_ARRAY               // Probe array on one or more DS2482 bridges, TA_BRIDGES (TempArray.h)
+// #define HDWE_STRINGS {{1, 1.0, SB_CH_SHARE}, {1, 0.8, SB_CH_SHARE}}  // Parallel strings {mod, s_cap, ch} (StringBank.h)
 // #define SOFT_DEBUG_QUEUE
 // #define DEBUG_DETAIL                    // Use this to debug initialization using 'v-1;'
 // #define LOGHANDLE
@@ -27,13 +27,20 @@
 #include <math.h>
 #include "debug.h"
 #include "Summary.h"
+#include "Usage.h"
 #include "talk/chitchat.h"
+#include "Clock.h"
 
 extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap; // Various adjustment parameters shared at system level
 extern CommandPars cp;  // Various parameters shared at system level
 extern PrinterPars pr;  // Print buffer
 extern PublishPars pp;  // For publishing
+extern UsageLog_st myUse;  // Day and week usage
+#ifdef HDWE_STRINGS
+  #include "StringBank.h"
+  extern StringBank myStrings;  // Parallel strings
+#endif
 
 // Harvest charge caused temperature change.   More charge becomes available as battery warms
 void harvest_temp_change(const float temp_c, BatteryMonitor *Mon, BatterySim *Sim)
@@ -203,6 +210,11 @@ void load_ib_vb(const boolean reset, const boolean reset_temp, Sensors *Sen, Pin
   else                      Sen->Flt->vb_check(Sen, Mon, -1.0, 1.0, reset);
   if ( sp.debug()==15 ) Sen->vb_print();
 
+  // Hum
+  Sen->Ib_amp_hum = Sen->ShuntAmp->Ishunt_hum();
+  Sen->Ib_noa_hum = Sen->ShuntNoAmp->Ishunt_hum();
+  Sen->Vb_hum = Sen->HumVb.hum();
+
   // Power calculation
   Sen->Wb = Sen->Vb*Sen->Ib;
 }
@@ -210,23 +222,45 @@ void load_ib_vb(const boolean reset, const boolean reset_temp, Sensors *Sen, Pin
 // Calculate Ah remaining for display to user
 // Inputs:  sp.mon_chm, Sen->Ib, Sen->Vb, Sen->Tb_filt
 // States:  Mon.soc, Mon.soc_ekf
-// Outputs: tcharge_wt, tcharge_ekf, Voc, Voc_filt
+// Outputs: tcharge_wt, tcharge_ekf, Voc, Voc_filt, forecast, myStrings
 void  monitor(const boolean reset, const boolean reset_temp, const unsigned long long now,
-  TFDelay *Is_sat_delay, BatteryMonitor *Mon, Sensors *Sen)
+  TFDelayT<double> &Is_sat_delay, BatteryMonitor *Mon, Sensors *Sen)
 {
   // EKF - calculates temp_c_, voc_stat_, voc_ as functions of sensed parameters vb & ib (not soc)
   Mon->calculate(Sen, reset_temp);
 
   // Debounce saturation calculation done in ekf using voc model
   boolean sat = Mon->is_sat(reset);
-  Sen->saturated = Is_sat_delay->calculate(sat, T_SAT*ap.s_t_sat, T_DESAT*ap.s_t_sat, min(Sen->T, T_SAT/2.), reset);
+  Sen->saturated = Is_sat_delay.calculate(sat, T_SAT*ap.s_t_sat, T_DESAT*ap.s_t_sat, min(Sen->T, T_SAT/2.), reset);
 
   // Memory store
   // Initialize to ekf when not saturated
+  boolean inf_reset = cp.inf_reset;
   Mon->count_coulombs(Sen->T, reset_temp, Sen->Tb_filt, Mon->ib_charge(), Sen->saturated, Mon->delta_q_ekf());
 
+  // Capacity estimate between saturation and EKF converged anchors.  Rated capacity at temperature without SQ
+  Mon->cap_est()->update(double(now)/1000., Mon->delta_q_inf(), Mon->q_capacity()*Mon->q_cap_rated()/Mon->q_cap_rated_scaled(),
+    Sen->saturated, Mon->converged_ekf(), Mon->soc_ekf(), Mon->ib(), reset_temp || inf_reset);
+
+  // Shadow chemistries
+  if ( Mon->chm_bank() ) Mon->chm_bank()->update(Mon->voc_stat(), Mon->soc(), Mon->temp_c(), sp.Dw(),
+    !Sen->saturated && !Mon->bms_off(), reset_temp);
+
+  // Parallel strings, each its own monitor.   No per-string shunts in the hardware, so capacity shares of Ib
+  #ifdef HDWE_STRINGS
+    if ( reset_temp ) myStrings.init_soc(Mon->soc(), Sen->Tb_filt);
+    myStrings.update(NULL, Sen->Ib, Sen->vb(), Sen->Tb_filt, Sen->T, reset_temp);
+  #endif
+
+  // Usage counters and histograms, real signals only
+  if ( !sp.mod_any() ) myUse.update(Clock::now(), Sen->T, Sen->Ib, Sen->Wb, Mon->soc(), Sen->Tb_filt, reset_temp);
+
   // Charge charge time for display
   Mon->calc_charge_time(Mon->q(), Mon->q_capacity(), Sen->ib(), Mon->soc());
+
+  // Load-aware time to full and to empty
+  Mon->forecast()->update(Sen->T, Mon->ib_charge(), Mon->q(), Mon->q_capacity(), Sen->Tb_filt, Mon->chem()->soc_min_T_,
+    Mon->coul_eff(), reset_temp);
 }
 
 /* OLED display drive
@@ -252,13 +286,13 @@ void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon)
 
   // ---------- Top Line of Display -------------------------------------------
   // Tb
-  sprintf(pr.buff, "%3.0f", pp.pubList.Tb);
+  sprintf(pr.buff, "%3.0f", pp.front()->Tb);
   disp_0 = pr.buff;
   if ( Sen->Flt->tb_fa() && (blink==0 || blink==1) )
     disp_0 = "***";
 
   // Voc
-  sprintf(pr.buff, "%5.2f", pp.pubList.Voc);
+  sprintf(pr.buff, "%5.2f", pp.front()->Voc);
   disp_1 = pr.buff;
   if ( Sen->Flt->vb_sel_stat()==0 && (blink==1 || blink==2) )
     disp_1 = "*fail";
@@ -266,7 +300,7 @@ void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon)
     disp_1 = " off ";
 
   // Ib
-  sprintf(pr.buff, "%6.1f", pp.pubList.Ib);
+  sprintf(pr.buff, "%6.1f", pp.front()->Ib);
   disp_2 = pr.buff;
   if ( blink==2 )
   {
@@ -305,7 +339,7 @@ void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon)
 
   // --------------------- Bottom line of Display ------------------------------
   // Hrs EHK
-  sprintf(pr.buff, "%3.0f", pp.pubList.Amp_hrs_remaining_ekf);
+  sprintf(pr.buff, "%3.0f", pp.front()->Amp_hrs_remaining_ekf);
   disp_0 = pr.buff;
   if ( blink==0 || blink==1 || blink==2 )
   {
@@ -315,9 +349,9 @@ void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon)
   display->print(disp_0.c_str());
 
   // t charge
-  if ( abs(pp.pubList.tcharge) < 24. )
+  if ( abs(pp.front()->tcharge) < 24. )
   {
-    sprintf(pr.buff, "%5.1f", pp.pubList.tcharge);
+    sprintf(pr.buff, "%5.1f", pp.front()->tcharge);
   }
   else
   {
@@ -330,7 +364,7 @@ void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon)
   display->setTextSize(2);             // Draw 2X-scale text
   if ( blink==1 || blink==3 || !Sen->saturated )
   {
-    sprintf(pr.buff, "%3.0f", min(pp.pubList.Amp_hrs_remaining_soc, 999.));
+    sprintf(pr.buff, "%3.0f", min(pp.front()->Amp_hrs_remaining_soc, 999.));
     disp_2 = pr.buff;
   }
   else if (Sen->saturated)
@@ -349,7 +383,7 @@ void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon)
   else if ( sp.debug()==98 ) // Calibration mode
     debug_98(Mon, Sen);
   else if ( sp.debug()!=-2 )  // Normal display
-    Serial1.printf("%s   Tb,C  VOC,V  Ib,A \n%s   EKF,Ah  chg,hrs  CC, Ah\nPf; for fails.  prints=%ld\n\n",
+    rt.printf(ROUTE_BLE, "%s   Tb,C  VOC,V  Ib,A \n%s   EKF,Ah  chg,hrs  CC, Ah\nPf; for fails.  prints=%ld\n\n",
       disp_Tbop.c_str(), dispBot.c_str(), cp.num_v_print);
 
   if ( sp.debug()==5 ) debug_5(Mon, Sen);  // Charge time display on UART
@@ -364,13 +398,13 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
 
   // ---------- Top Line of Display -------------------------------------------
   // Tb
-  sprintf(pr.buff, "%3.0f", pp.pubList.Tb);
+  sprintf(pr.buff, "%3.0f", pp.front()->Tb);
   disp_0 = pr.buff;  // Default
   if ( Sen->Flt->tb_fa() && (blink==0 || blink==1) )
     disp_0 = "***";
 
   // Voc
-  sprintf(pr.buff, "%5.2f", pp.pubList.Voc);
+  sprintf(pr.buff, "%5.2f", pp.front()->Voc);
   disp_1 = pr.buff;  // Default
   if ( Sen->Flt->vb_sel_stat()==0 && (blink==1 || blink==2) )
     disp_1 = "*fail";
@@ -378,7 +412,7 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
     disp_1 = " off ";
 
   // Ib
-  sprintf(pr.buff, "%6.1f", pp.pubList.Ib);
+  sprintf(pr.buff, "%6.1f", pp.front()->Ib);
   disp_2 = pr.buff;  // Default
   #ifdef HDWE_IB_HI_LO
     if ( blink==2 )
@@ -425,7 +459,7 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
 
   // --------------------- Bottom line of Display ------------------------------
   // Hrs EHK
-  sprintf(pr.buff, "%3.0f", pp.pubList.Amp_hrs_remaining_ekf);
+  sprintf(pr.buff, "%3.0f", pp.front()->Amp_hrs_remaining_ekf);
   disp_0 = pr.buff;  // Default
   #ifdef HDWE_IB_HI_LO
     if ( blink==0 || blink==1 || blink==2 )
@@ -442,9 +476,9 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
   #endif
 
   // t charge
-  if ( abs(pp.pubList.tcharge) < 24. )
+  if ( abs(pp.front()->tcharge) < 24. )
   {
-    sprintf(pr.buff, "%5.1f", pp.pubList.tcharge);
+    sprintf(pr.buff, "%5.1f", pp.front()->tcharge);
   }
   else
   {
@@ -454,7 +488,7 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
 
   // Hrs large
   #ifdef HDWE_IB_HI_LO
-    sprintf(pr.buff, "%3.0f", pp.pubList.Amp_hrs_remaining_soc);
+    sprintf(pr.buff, "%3.0f", pp.front()->Amp_hrs_remaining_soc);
     if ( Sen->saturated && blink==0 )
       disp_2 = "SAT";
     else if ( blink==2 )
@@ -473,7 +507,7 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
       disp_2 = pr.buff;
     }
   #else
-    sprintf(pr.buff, "%3.0f", min(pp.pubList.Amp_hrs_remaining_soc, 999.));
+    sprintf(pr.buff, "%3.0f", min(pp.front()->Amp_hrs_remaining_soc, 999.));
     if (Sen->saturated && blink==0)
       disp_2 = "SAT";
     else if ( blink==2 )
@@ -500,7 +534,7 @@ void oled_display(Sensors *Sen, BatteryMonitor *Mon)
   else if ( sp.debug()==98 ) // Calibration mode
     debug_98(Mon, Sen);
   else if ( sp.debug()!=-2 )  // Normal display
-    Serial1.printf("%s   Tb,C  VOC,V  Ib,A \n%s   EKF,Ah  chg,hrs  CC, Ah\nPf; for fails.  prints=%ld\n\n",
+    rt.printf(ROUTE_BLE, "%s   Tb,C  VOC,V  Ib,A \n%s   EKF,Ah  chg,hrs  CC, Ah\nPf; for fails.  prints=%ld\n\n",
       disp_Tbop.c_str(), dispBot.c_str(), cp.num_v_print);
 
   if ( sp.debug()==5 ) debug_5(Mon, Sen);  // Charge time display on UART
@@ -602,12 +636,12 @@ void sense_synth_select(const boolean reset, const boolean reset_temp, const uns
       sp.put_Iflt(sp.Iflt() + 1);
       if ( sp.Iflt()>sp.nflt() - 1 ) sp.put_Iflt(0);  // wrap buffer
       Flt_st fault_snap;
-      fault_snap.assign(Time.now(), Mon, Sen);
+      fault_snap.assign(Clock::now(), Mon, Sen);
       sp.put_fault(fault_snap, sp.Iflt());
     }
     else if ( fails_repeated < 4 )
     {
-      Serial.printf("preserving fault buffer\n");
+      rt.printf(ROUTE_USB, "preserving fault buffer\n");
       Sen->Flt->preserving(true);
     }
     if ( instant_of_failure ) last_snap = now;
@@ -628,7 +662,7 @@ void sense_synth_select(const boolean reset, const boolean reset_temp, const uns
       Sen->end_inj += Sen->now - Sen->start_inj;
       Sen->stop_inj += Sen->now - Sen->start_inj;
       Sen->start_inj = Sen->now;
-      Serial.printf("SYNC,%7.3f\n", double(Sen->now)/1000.);
+      rt.printf(ROUTE_USB, "SYNC,%7.3f\n", double(Sen->now)/1000.);
     }
 
     Sen->elapsed_inj = Sen->now - Sen->start_inj + 1UL; // Shift by 1 because using ==0 as reset button
@@ -643,7 +677,7 @@ void sense_synth_select(const boolean reset, const boolean reset_temp, const uns
 
   else if ( Sen->elapsed_inj && sp.tweak_test() )  // Done.  elapsed_inj set to 0 is the reset button
   {
-    Serial.printf("STOP echo\n");
+    rt.printf(ROUTE_USB, "STOP echo\n");
     Sen->elapsed_inj = 0ULL;
     chit("vv0;", ASAP);    // Turn off echo
     chit("Xp0;", SOON);    // Reset
@@ -651,17 +685,17 @@ void sense_synth_select(const boolean reset, const boolean reset_temp, const uns
   Sen->Sim->calc_inj(Sen->elapsed_inj, sp.type(), sp.Amp(), sp.freq());
 
   // Quiet logic.   Reset to ready state at soc=0.5; do not change Modeling.  Passes at least once before running chit.
-  static unsigned long long millis_past = System.millis();
+  static unsigned long long millis_past = Clock::millis();
   static unsigned long int until_q_past = ap.until_q;
   if ( ap.until_q>0UL && until_q_past==0UL ) until_q_past = ap.until_q;
-  ap.until_q = (unsigned long) max(0, (long) ap.until_q  - (long)(System.millis() - millis_past));
+  ap.until_q = (unsigned long) max(0, (long) ap.until_q  - (long)(Clock::millis() - millis_past));
   if ( ap.until_q==0UL && until_q_past>0UL )
   {
     chit("BZ;", SOON);
     cp.freeze = false;  // unfreeze the queues
   }
   until_q_past = ap.until_q;
-  millis_past = System.millis();
+  millis_past = Clock::millis();
 
 }
 
@@ -669,24 +703,24 @@ void sense_synth_select(const boolean reset, const boolean reset_temp, const uns
 // Time synchro for web information
 void sync_time(unsigned long long now, unsigned long long *last_sync, unsigned long long *millis_flip)
 {
-  *last_sync = System.millis();
+  *last_sync = Clock::millis();
 
   // Request time synchronization from the Particle Cloud
   if ( Particle.connected() ) Particle.syncTime();
 
   // Refresh millis() at turn of Time.now
   int count = 0;
-  long time_begin = Time.now();  // Seconds since start of epoch
-  while ( Time.now()==time_begin && ++count<1100 )  // Time.now() truncates to seconds
+  long time_begin = Clock::now();  // Seconds since start of epoch
+  while ( Clock::now()==time_begin && ++count<1100 )  // Clock::now() truncates to seconds
   {
-    delay(1);
-    *millis_flip = System.millis()%1000;
+    Clock::delay(1);
+    *millis_flip = Clock::millis()%1000;
   }
 }
 
 
-// For summary prints
-String time_long_2_str(const time_t time, char *tempStr)
+// For summary prints.   Formats into tempStr, 20 bytes with terminator, no heap
+void time_long_2_chr(const time_t time, char *tempStr)
 {
     // Serial.printf("Time.year:  time_t %d ul %d as-is %d\n", 
     //   Time.year((time_t) 1703267248), Time.year((unsigned long )1703267248), Time.year(time));
@@ -698,6 +732,9 @@ String time_long_2_str(const time_t time, char *tempStr)
     uint8_t seconds   = Time.second(time);
     sprintf(tempStr, "%4u-%02u-%02uT%02u:%02u:%02u", int(year), month, day, hours, minutes, seconds);
     // Serial.printf("time_long_2_str: %lld %ld %d %d %d %d %d\n", time, year, month, day, hours, minutes, seconds);
-    // sprintf(tempStr, "time_long_2_str");
+}
+String time_long_2_str(const time_t time, char *tempStr)
+{
+    time_long_2_chr(time, tempStr);
     return ( String(tempStr) );
 }
@@ -116,12 +116,13 @@ void harvest_temp_change(const float temp_c, BatteryMonitor *Mon, BatterySim *Si
 void initialize_all(BatteryMonitor *Mon, Sensors *Sen, const float soc_in, const boolean use_soc_in);
 void load_ib_vb(const boolean reset, const boolean reset_temp, Sensors *Sen, Pins *myPins, BatteryMonitor *Mon);
 void monitor(const boolean reset, const boolean reset_temp, const unsigned long long now,
-  TFDelay *Is_sat_delay, BatteryMonitor *Mon, Sensors *Sen);
+  TFDelayT<double> &Is_sat_delay, BatteryMonitor *Mon, Sensors *Sen);
 void oled_display(Adafruit_SSD1306 *display, Sensors *Sen, BatteryMonitor *Mon);
 void oled_display(Sensors *Sen, BatteryMonitor *Mon);
 void sense_synth_select(const boolean reset, const boolean reset_temp, const unsigned long long now, const unsigned long long elapsed,
   Pins *myPins, BatteryMonitor *Mon, Sensors *Sen);
 void sync_time(unsigned long long now, unsigned long long *last_sync, unsigned long long *millis_flip);
 String time_long_2_str(const time_t current_time, char *tempStr);
+void time_long_2_chr(const time_t current_time, char *tempStr);
 
 #endif
@@ -21,22 +21,27 @@
 // OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
 // SOFTWARE.
 #include "application.h"
+#include <ctype.h>
 #include "chitchat.h"
 #include "help.h"
 #include "../subs.h"
 #include "../command.h"
 #include "../parameters.h"
 #include "../debug.h"
+#include "../Summary.h"
 #include "recall_H.h"
 #include "recall_P.h"
 #include "recall_R.h"
 #include "recall_X.h"
 #include "followup.h"
+#include "program.h"
 
 extern SavedPars sp;       // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap;    // Various adjustment parameters shared at system level
 extern CommandPars cp;     // Various parameters shared at system level
 extern Flt_st mySum[NSUM]; // Summaries for saving charge history
+extern DumpCursor myDump;  // Resumable history dump
+extern ProgramRunner myProg;  // Test programs
 
 
 // Clear adjustments that should be benign if done instantly
@@ -79,6 +84,7 @@ void benign_zero(BatteryMonitor *Mon, Sensors *Sen) // BZ
 
   // Intervals
   ap.eframe_mult = max(min(EKF_EFRAME_MULT, UINT8_MAX), 0); // DE
+  ap.ukf = false;      // DK 0
  
   // Fault logic
   ap.cc_diff_slr = 1;  // Fc 1
@@ -350,11 +356,58 @@ void clear_queues()
   cp.soon_str = "";
   cp.asap_str = "";
   cp.freeze = false;
+  myProg.cancel();
   chit("XS;vv0;Dh;", ASAP);  // quiet with nominal chitchat rate
   Serial.printf("\nCLEARED queues\n");
 }
 
 
+// Commands describe() and the recall_* switches take by their first two letters.   Others are ap and sp codes
+static const char *describe_pairs[] = {"bd", "bh", "br", "bR", "BZ", "cc", "cf", "cu",
+  "Hd", "Hf", "Hk", "Hp", "HR", "Hs", "Hu",
+  "Pa", "Pb", "PB", "Pc", "PC", "Pe", "PF", "Pf", "Ph", "Pm", "PM", "PN", "Pp", "PR", "Pr", "Ps", "Pt", "PT", "Pu", "PV", "Pv", "Pw", "Px",
+  "Rb", "Rc", "RC", "Rf", "Ri", "Rr", "RR", "Rs", "RS", "RV",
+  "XB", "XD", "Xp", "XR", "XS", "Xt", "XY"};
+
+// Does the command print a long listing, h, P*, Q, Hp or Hu?   Keep in step with describe() and recall_*
+static boolean cmd_lists(const char letter_0, const char letter_1)
+{
+  if ( letter_0=='H' ) return ( letter_1=='p' || letter_1=='u' );
+  return ( letter_0=='h' || letter_0=='P' || letter_0=='Q' );
+}
+
+// Would describe() take cmd (no ';')?   Runs nothing.   Keep in step with describe() and recall_*
+boolean cmd_valid(const String &cmd)
+{
+  if ( !cmd.length() ) return false;
+  String pair = cmd.substring(0, 2);
+  String value = cmd.substring(2);
+  switch ( cmd.charAt(0) )
+  {
+    case ( 'h' ):  // h:  help
+    case ( 'Q' ):  // Q:  quick critical
+    #ifdef HDWE_PHOTON2
+    case ( 'w' ):  // w:  confirm write
+    #endif
+      return true;
+
+    case ( 'W' ):  // W<>:  wait
+      for ( unsigned i=1; i<cmd.length(); i++ ) if ( !isdigit(cmd.charAt(i)) ) return false;
+      return true;
+  }
+  for ( uint8_t i=0; i<sizeof(describe_pairs)/sizeof(describe_pairs[0]); i++ )
+  {
+    if ( pair==describe_pairs[i] )
+    {
+      if ( pair=="XB" ) return ( value=="1" || value=="2" );
+      if ( pair=="Xt" ) return ( value.length()==1 && strchr("nsqtcdo", value.charAt(0)) );
+      return true;
+    }
+  }
+  return ( ap.find(cmd) || sp.find(cmd) );
+}
+
+
 // Limited echoing of Serial1 commands available
 void cmd_echo(urgency request)
 {
@@ -388,6 +441,10 @@ void describe(BatteryMonitor *Mon, Sensors *Sen)
     letter_0 = cp.cmd_str.charAt(0);
     letter_1 = cp.cmd_str.charAt(1);
     value = cp.cmd_str.substring(2);
+
+    // Long listings print to Serial directly as well as through rt:  wait on the ports for these alone
+    boolean listing = cmd_lists(letter_0, letter_1);
+    if ( listing ) rt.listing(true);
     cmd_echo(INCOMING);
 
     switch ( letter_0 )
@@ -396,12 +453,12 @@ void describe(BatteryMonitor *Mon, Sensors *Sen)
       case ( 'b' ):  // Fault buffer
         switch ( letter_1 )
         {
-          case ( 'd' ):  // bd: fault buffer dump
-            Serial.printf("\n");
-            sp.print_history_array();
-            sp.print_fault_header(&pp.pubList);
-            sp.print_fault_array();
-            sp.print_fault_header(&pp.pubList);
+          case ( 'd' ):  // bd: fault buffer dump, paced by myDump in loop()
+            myDump.add(DUMP_NL);
+            myDump.add(DUMP_HIS);
+            myDump.add(DUMP_HDR);
+            myDump.add(DUMP_FLT);
+            myDump.add(DUMP_HDR);
             break;
 
           case ( 'h' ):  // bh: History buffer reset
@@ -522,6 +579,7 @@ void describe(BatteryMonitor *Mon, Sensors *Sen)
 
     // cmd_str has been applied.  Release the lock on cmd_str
     cp.cmd_str = "";
+    if ( listing ) rt.listing(false);
   }
 
 }
@@ -36,6 +36,7 @@ void chatter();
 void chit(const String cmd, const enum urgency when);
 void chitter(const boolean chitchat, BatteryMonitor *Mon, Sensors *Sen);
 String chit_nibble_ctl();
+boolean cmd_valid(const String &cmd);
 String chit_nibble_inp();
 void cmd_echo(urgency request);
 urgency chit_classify_nibble(String *nibble);
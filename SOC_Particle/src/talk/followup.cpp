@@ -25,6 +25,7 @@
 #include "../command.h"
 #include "../parameters.h"
 #include "../debug.h"
+#include "../Clock.h"
 
 extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap; // Various adjustment parameters shared at system level
@@ -107,7 +108,7 @@ boolean followup(const char letter_0, const char letter_1, BatteryMonitor *Mon,
 
                 case ( 'v' ):  //     Dv<>:  voltage signal adder for faults
                     if ( ap.vb_add_p->success() )
-                        ap.vb_add_p->print1();
+                        ap.vb_add_p->print(ROUTE_BLE);
                     break;
 
                 case ( '>' ):  //   D><>:  TALK sample time input
@@ -191,7 +192,7 @@ boolean followup(const char letter_0, const char letter_1, BatteryMonitor *Mon,
             {
 
                 case ( 'T' ):  //*  UT<>:  Unix time since epoch
-                Time.setTime(sp.Time_now_z);
+                Clock::set_time(sp.Time_now_z);
                 break;
 
             }
@@ -69,17 +69,15 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
   Serial.printf("  Cm=  model (& ekf if mod)- '(0-1.1)'\n"); 
 
   Serial.printf("\nD/S<?> Adj e.g.:\n");
-  sp.ib_bias_amp_p->print_help();  //* DA
-  sp.ib_bias_amp_p->print1_help();  //* DA
-  sp.ib_bias_noa_p->print_help();  //* DB
-  sp.ib_bias_noa_p->print1_help();  //* DB
-  sp.Vb_bias_hdwe_p->print_help();  //* Dc
-  sp.Vb_bias_hdwe_p->print1_help();  //* Dc
+  sp.ib_bias_amp_p->print_help(ROUTE_ALL);  //* DA
+  sp.ib_bias_noa_p->print_help(ROUTE_ALL);  //* DB
+  sp.Vb_bias_hdwe_p->print_help(ROUTE_ALL);  //* Dc
   ap.eframe_mult_p->print_help();  //  DE
+  ap.hum_notch_hz_p->print_help();  //  DF
+  ap.ukf_p->print_help();  //  DK
   ap.sum_delay_p->print_help();  //  Dh
   Serial.printf("    set 'Dh0;' for nominal\n");
-  sp.ib_bias_all_p->print_help();  //* DI
-  sp.ib_bias_all_p->print1_help();  //* DI
+  sp.ib_bias_all_p->print_help(ROUTE_ALL);  //* DI
   sp.ib_bias_amp_p->print_help();  //  Dm
   ap.ib_max_amp_p->print_help();  // Mm
   ap.ib_min_amp_p->print_help();  // Mn
@@ -92,37 +90,28 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
   ap.print_mult_p->print_help();  //  DP
   ap.read_delay_p->print_help();  //  Dr
   ap.ds_voc_soc_p->print_help();  //  Ds
-  sp.Tb_bias_hdwe_p->print_help();  //* Dt
-  sp.Tb_bias_hdwe_p->print1_help();  //* Dt
+  sp.Tb_bias_hdwe_p->print_help(ROUTE_ALL);  //* Dt
   ap.Tb_noise_amp_p->print_help();  // DT
   ap.vb_add_p->print_help();  // Dv
   ap.Vb_noise_amp_p->print_help();  // DV
-  sp.Dw_p->print_help();  //* Dw
-  sp.Dw_p->print1_help();  //* Dw
+  sp.Dw_p->print_help(ROUTE_ALL);  //* Dw
   ap.dv_voc_soc_p->print_help();  //  Dy
   ap.Tb_bias_model_p->print_help();  // D^
   ap.talk_delay_p->print_help();  //  D>
-  sp.ib_scale_amp_p->print_help();  //* SA
-  sp.ib_scale_amp_p->print1_help();  //* SA
-  sp.ib_scale_noa_p->print_help();  //* SB
-  sp.ib_scale_noa_p->print1_help();  //* SB
-  sp.ib_disch_slr_p->print_help();  //* SD
-  sp.ib_disch_slr_p->print1_help();  //* SD
+  sp.ib_scale_amp_p->print_help(ROUTE_ALL);  //* SA
+  sp.ib_scale_noa_p->print_help(ROUTE_ALL);  //* SB
+  sp.ib_disch_slr_p->print_help(ROUTE_ALL);  //* SD
   ap.hys_scale_p->print_help();  //  Sh
   ap.hys_state_p->print_help();  //  SH
   sp.cutback_gain_slr_p->print_help();  //* Sk
-  sp.s_cap_mon_p->print_help();  //* SQ
-  sp.s_cap_mon_p->print1_help();  //* SQ
-  sp.s_cap_sim_p->print_help();  //* Sq
-  sp.s_cap_sim_p->print1_help();  //* Sq
-  sp.Vb_scale_p->print_help();  //* SV
-  sp.Vb_scale_p->print1_help();  //* SV
+  sp.s_cap_mon_p->print_help(ROUTE_ALL);  //* SQ
+  sp.s_cap_sim_p->print_help(ROUTE_ALL);  //* Sq
+  sp.Vb_scale_p->print_help(ROUTE_ALL);  //* SV
 
   Serial.printf("\nF<?>   Faults\n");
   ap.cc_diff_slr_p->print_help();  // Fc
-  ap.ib_diff_slr_p->print1_help();  // Fd
-  ap.fake_faults_p->print_help();  // Ff
-  ap.fake_faults_p->print1_help();  // Ff
+  ap.ib_diff_slr_p->print_help(ROUTE_BLE);  // Fd
+  ap.fake_faults_p->print_help(ROUTE_ALL);  // Ff
   ap.ewhi_slr_p->print_help();  // Fi
   ap.ewlo_slr_p->print_help();  // Fo
   ap.ib_quiet_slr_p->print_help();  // Fq
@@ -132,22 +121,37 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
 
   Serial.printf("\nH<?>   Manage history\n");
   Serial.printf("  Hd= "); Serial.printf("dump summ log\n");
-  Serial.printf("  HR= "); Serial.printf("reset summ log\n");
+  Serial.printf("  Hf= "); Serial.printf("dump fault log\n");
+  Serial.printf("  Hk= "); Serial.printf("kill dump in progress\n");
+  Serial.printf("  Hp= "); Serial.printf("dump packed, sizes\n");
+  ap.dump_n_p->print_help();  // HN
+  Serial.printf("  HR= "); Serial.printf("reset summ log and usage\n");
   Serial.printf("  Hs= "); Serial.printf("save and print log\n");
+  Serial.printf("  Hu= "); Serial.printf("usage by day and week\n");
 
   Serial.printf("\nP<?>   Print values\n");
   Serial.printf("  Pa= "); Serial.printf("all\n");
   Serial.printf("  Pb= "); Serial.printf("vb details\n");
+  Serial.printf("  Pc= "); Serial.printf("capacity estimate\n");
+  Serial.printf("  PB= "); Serial.printf("parallel strings\n");
+  Serial.printf("  PC= "); Serial.printf("chemistry shadow bank\n");
   Serial.printf("  Pe= "); Serial.printf("ekf\n");
+  Serial.printf("  PF= "); Serial.printf("charge forecast\n");
   Serial.printf("  Pf= "); Serial.printf("faults\n");
+  Serial.printf("  Ph= "); Serial.printf("hum 50/60 Hz\n");
   Serial.printf("  Pm= "); Serial.printf("Mon\n");
+  Serial.printf("  Pp= "); Serial.printf("test programs\n");
   Serial.printf("  PM= "); Serial.printf("amp shunt\n");
   Serial.printf("  PN= "); Serial.printf("noa shunt\n");
   Serial.printf("  PR= "); Serial.printf("all retained adj\n");
   Serial.printf("  Pr= "); Serial.printf("off-nom ret adj\n");
+  Serial.printf("  PT= "); Serial.printf("temperature array\n");
+  Serial.printf("  Pt= "); Serial.printf("print router counts\n");
   Serial.printf("  Ps= "); Serial.printf("Sim\n");
+  Serial.printf("  Pu= "); Serial.printf("ukf\n");
   Serial.printf("  PV= "); Serial.printf("all vol adj\n");
   Serial.printf("  Pv= "); Serial.printf("off-nom vol adj\n");
+  Serial.printf("  Pw= "); Serial.printf("persistence wear, staleness\n");
   Serial.printf("  Px= "); Serial.printf("ib select\n");
 
   Serial.printf("\nQ      vital stats\n");
@@ -155,6 +159,8 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
   Serial.printf("\nR<?>   Reset\n");
   Serial.printf("  Ca=<val> "); Serial.printf("initialize_all to present inputs\n");
   Serial.printf("  Rb= "); Serial.printf("batteries to present inputs\n");
+  Serial.printf("  Rc= "); Serial.printf("capacity estimate to prior\n");
+  Serial.printf("  RC= "); Serial.printf("chemistry shadow bank likelihoods\n");
   Serial.printf("  Rf= "); Serial.printf("fault logic latches\n");
   Serial.printf("  Ri= "); Serial.printf("infinite counter\n");
   Serial.printf("  Rr= "); Serial.printf("saturate Mon and equalize Sim & Mon\n");
@@ -164,10 +170,8 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
   Serial.printf("  RV= "); Serial.printf("Renominalize volatile\n");
 
   sp.ib_force_p->print_help();  //* si
-  sp.Time_now_p->print_help();  //* UT
-  sp.Time_now_p->print1_help();  //* UT
-  sp.debug_p->print_help();  // v
-  sp.debug_p->print1_help();  // v
+  sp.Time_now_p->print_help(ROUTE_ALL);  //* UT
+  sp.debug_p->print_help(ROUTE_ALL);  // v
 
   Serial.printf("  -<>: Negative - Arduino plot compatible\n");
   Serial.printf(" vv-2: ADS counts for throughput meas\n");
@@ -219,7 +223,7 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
   sp.Type_p->print_help();  //* Xt
 
   #ifndef HELPLESS
-  Serial.printf(" Xp= <?>, scripted tests...\n"); 
+  Serial.printf(" Xp= <?>, scripted tests, 'Pp' lists...\n"); 
   Serial.printf("  Xp0: reset tests\n");
   Serial.printf("  Xp6: +/-500 A pulse EKF\n");
   Serial.printf("  Xp7: +/-500 A sw pulse SS\n");
@@ -230,6 +234,8 @@ void talkH(BatteryMonitor *Mon, Sensors *Sen)
   Serial.printf("  Xp13:tweak tri\n");
   Serial.printf("  Xp20:collect fast\n");
   Serial.printf("  Xp21:collect slow\n");
+  Serial.printf(" XB= <?>, benchmarks...\n");
+  Serial.printf("  XB2: hum sample cost with analog reads\n");
   ap.cycles_inj_p->print_help();  // XC
   Serial.printf(" XR  "); Serial.printf("RUN inj\n");
   Serial.printf(" XS  "); Serial.printf("STOP inj\n");
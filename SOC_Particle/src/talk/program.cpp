@@ -0,0 +1,306 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+#include "application.h"
+#include <ctype.h>
+#include "program.h"
+#include "chitchat.h"
+#include "../command.h"
+#include "../parameters.h"
+
+extern CommandPars cp;  // Various parameters shared at system level
+
+// The regression programs once built into recall_X.   'Xp0' (reset) stays there because 'XS' depends on it
+const char PROGRAMS_DEFAULT[] =
+  "# Xp6:  +/-500 A pulse EKF\n"
+  "program 6\n"
+  "  XS;Dm0;Dn0;Xm255;Ca.5;Pm;DP20;vv4;Rs;   # setup\n"
+  "  Dn.00001;XY;Dm500;Dm-500;Dm0;          # run\n"
+  "  W10;Pm;vv0;                            # finish\n"
+  "end\n"
+  "# Xp7:  +/-500 A sw pulse SS\n"
+  "program 7\n"
+  "  XS;Dm0;Dn0;Xm255;Ca.5;Pm;DP1;vv4;Rs;\n"
+  "  Dn.00001;W2;XY;Dm500;Dm-500;Dm0;W2;\n"
+  "end\n"
+  "# Xp8:  +/-500 A hw pulse SS\n"
+  "program 8\n"
+  "  XS;DI0;Xm255;Ca.5;Pm;DP1;vv4;Rs;    # was Di0, no such code\n"
+  "  W2;XY;DI500;DI-500;DI0;W2;\n"
+  "  W10;Pm;vv0;\n"
+  "end\n"
+  "# Xp9:  regression setup only\n"
+  "program 9\n"
+  "  Xp0;vv0;Xm255;Xts;Ca1;\n"
+  "  Rb;\n"
+  "end\n"
+  "# Xp10:  rapid tweak\n"
+  "program 10\n"
+  "  Xp0;vv0;Xm255;Xts;Ca1;\n"
+  "  Rb;\n"
+  "  Xf.02;Xa-2000;XW5000;XT5000;XC3;\n"
+  "  W2;W2;W2;vv4;W;Rs;XR;XQ180000;Xm247;\n"
+  "end\n"
+  "# Xp11:  slow tweak\n"
+  "program 11\n"
+  "  Xp0;vv0;Xm255;Xts;Ca1;\n"
+  "  Rb;\n"
+  "  Xf.002;Xa-60;XW60000;XT60000;XC1;\n"
+  "  W2;vv4;W;Rs;XR;XQ622000;Xm247;\n"
+  "end\n"
+  "# Xp12:  slow half tweak\n"
+  "program 12\n"
+  "  Xp0;vv0;Xm255;Xts;Ca1;\n"
+  "  Rb;\n"
+  "  Xf.0002;Xa-6;XW60000;XT240000;XC.5;\n"
+  "  W2;vv4;W;Rs;XR;XQ622000;Xm247;\n"
+  "end\n"
+  "# Xp13:  tri tweak\n"
+  "program 13\n"
+  "  Xp0;vv0;Xm255;Xts;Ca1;\n"
+  "  Rb;\n"
+  "  Xtt;Xf.02;Xa-29500;XW5000;XT5000;XC3;\n"
+  "  W2;vv4;W;Rs;XR;XQ180000;Xm247;\n"
+  "end\n"
+  "# Xp20:  collect fast.  0.5 s sample/2.0s print\n"
+  "program 20\n"
+  "  vv0;Pa;            # quiet while the record prints\n"
+  "  Dr500;DP4;vv2;     # 5x sample time, > ChargeTransfer_T_MAX\n"
+  "  Rb;\n"
+  "end\n"
+  "# Xp21:  collect slow.  2 s sample/8 s print\n"
+  "program 21\n"
+  "  vv0;Pa;\n"
+  "  DP20;vv2;\n"
+  "  Rb;\n"
+  "end\n";
+
+
+// class ProgramRunner
+ProgramRunner::ProgramRunner()
+  : len_(0), n_(0), prog_(-1), step_(0), t_prog_(0ULL), t_step_(0ULL)
+{
+  text_[0] = '\0';
+}
+ProgramRunner::~ProgramRunner() {}
+
+// Stop queuing steps.   What is already queued runs
+void ProgramRunner::cancel()
+{
+  if ( active() ) Serial.printf("Xp%s cancelled at step %d/%d\n", list_[prog_].name, step_, list_[prog_].steps);
+  prog_ = -1;
+  step_ = 0;
+}
+
+// Replace the programs with those of script, only if every line checks
+boolean ProgramRunner::load(const char *script)
+{
+  if ( !parse(script, false) ) return false;
+  cancel();
+  return parse(script, true);
+}
+
+// One pass over the script.   Checks only, or stores into list_ and text_
+boolean ProgramRunner::parse(const char *script, const boolean store)
+{
+  char line[PROG_LINE_MAX];
+  char names[PROG_MAX][PROG_NAME_LEN];
+  uint8_t n = 0;
+  uint16_t len = 0;
+  uint16_t line_num = 0;
+  boolean in_prog = false;
+  const char *p = script;
+  while ( *p )
+  {
+    // Next line, comment and blanks stripped
+    line_num++;
+    uint8_t k = 0;
+    boolean comment = false;
+    for ( ; *p && *p!='\n'; p++ )
+    {
+      if ( *p=='#' ) comment = true;
+      if ( comment || *p==' ' || *p=='\t' || *p=='\r' ) continue;
+      if ( k>=PROG_LINE_MAX-2 )
+      {
+        Serial.printf("prog line %d:  longer than %d\n", line_num, PROG_LINE_MAX-2);
+        return false;
+      }
+      line[k++] = *p;
+    }
+    if ( *p=='\n' ) p++;
+    line[k] = '\0';
+    if ( !k ) continue;
+
+    // Structure
+    if ( !strncmp(line, "program", 7) )
+    {
+      const char *name = line + 7;
+      boolean alnum = true;
+      for ( const char *c=name; *c; c++ ) alnum = alnum && isalnum(*c);
+      if ( in_prog || n>=PROG_MAX || !alnum || !strlen(name) || strlen(name)>=PROG_NAME_LEN || !strcmp(name, "0") )
+      {
+        Serial.printf("prog line %d:  bad 'program %s'.  Need 'end' first, <=%d programs, name 1-%d letters or digits not '0'\n",
+          line_num, name, PROG_MAX, PROG_NAME_LEN-1);
+        return false;
+      }
+      for ( uint8_t i=0; i<n; i++ ) if ( !strcmp(names[i], name) )
+      {
+        Serial.printf("prog line %d:  %s repeated\n", line_num, name);
+        return false;
+      }
+      strcpy(names[n], name);
+      if ( store )
+      {
+        strcpy(list_[n].name, name);
+        list_[n].begin = len;
+        list_[n].steps = 0;
+      }
+      in_prog = true;
+      continue;
+    }
+    if ( !strcmp(line, "end") )
+    {
+      if ( !in_prog )
+      {
+        Serial.printf("prog line %d:  'end' outside a program\n", line_num);
+        return false;
+      }
+      in_prog = false;
+      n++;
+      continue;
+    }
+    if ( !in_prog )
+    {
+      Serial.printf("prog line %d:  '%s' outside a program\n", line_num, line);
+      return false;
+    }
+
+    // Step.  Every command must be one describe() takes.   A program starting another would lose its place
+    if ( line[k-1]!=';' ) { line[k++] = ';'; line[k] = '\0'; }
+    if ( len + k + 1 >= PROG_TEXT_MAX )
+    {
+      Serial.printf("prog line %d:  script over %d chars of commands\n", line_num, PROG_TEXT_MAX);
+      return false;
+    }
+    char *cmd = line;
+    for ( char *semi=strchr(cmd, ';'); semi; cmd=semi+1, semi=strchr(cmd, ';') )
+    {
+      *semi = '\0';
+      String c(cmd);
+      if ( !c.length() ) continue;
+      if ( !cmd_valid(c) || ( c.substring(0, 2)=="Xp" && c.length()>2 && c.substring(2)!="0" ) )
+      {
+        Serial.printf("prog line %d:  '%s' %s\n", line_num, cmd, ( c.substring(0, 2)=="Xp" ) ? "nested" : "unknown");
+        return false;
+      }
+      *semi = ';';
+    }
+    if ( store )
+    {
+      memcpy(text_ + len, line, k);
+      text_[len + k] = '\n';
+      list_[n].steps++;
+    }
+    len += k + 1;
+  }
+  if ( in_prog )
+  {
+    Serial.printf("prog:  %s missing 'end'\n", names[n]);
+    return false;
+  }
+  if ( store )
+  {
+    n_ = n;
+    len_ = len;
+    text_[len_] = '\0';
+  }
+  return true;
+}
+
+// List
+void ProgramRunner::pretty_print()
+{
+#ifndef SOFT_DEPLOY_PHOTON
+  Serial.printf("ProgramRunner:\n");
+  for ( uint8_t i=0; i<n_; i++ )
+  {
+    Serial.printf("  program %s\n", list_[i].name);
+    for ( uint8_t j=0; j<list_[i].steps; j++ ) Serial.printf("    %s\n", step_line(i, j).c_str());
+    Serial.printf("  end\n");
+  }
+  Serial.printf("  %d programs, %d of %d chars\n", n_, len_, PROG_TEXT_MAX);
+  if ( active() ) Serial.printf("  running Xp%s step %d/%d\n", list_[prog_].name, step_, list_[prog_].steps);
+#else
+  Serial.printf("ProgramRunner: silent DEPLOY\n");
+#endif
+}
+
+// Queue the next step once the last has run.  Called once per loop pass
+void ProgramRunner::service(const unsigned long long now)
+{
+  if ( !active() ) return;
+  if ( cp.freeze || cp.cmd_str.length() || cp.ctl_str.length() || cp.asap_str.length() || cp.soon_str.length() ) return;
+  Program *prog = &list_[prog_];
+  if ( step_ ) Serial.printf("Xp%s step %d/%d %9.3f s\n", prog->name, step_, prog->steps, double(now - t_step_)/1000.);
+  if ( step_ < prog->steps )
+  {
+    chit(step_line(prog_, step_), SOON);
+    step_++;
+    t_step_ = now;
+  }
+  else
+  {
+    Serial.printf("Xp%s done %9.3f s\n", prog->name, double(now - t_prog_)/1000.);
+    prog_ = -1;
+    step_ = 0;
+  }
+}
+
+// Start a program by name.   Replaces any running
+boolean ProgramRunner::start(const String &name, const unsigned long long now)
+{
+  for ( uint8_t i=0; i<n_; i++ )
+  {
+    if ( name==list_[i].name )
+    {
+      cancel();
+      prog_ = i;
+      step_ = 0;
+      t_prog_ = t_step_ = now;
+      Serial.printf("Xp%s start %d steps\n", list_[i].name, list_[i].steps);
+      return true;
+    }
+  }
+  return false;
+}
+
+// Step j of program i
+String ProgramRunner::step_line(const uint8_t i, const uint8_t j)
+{
+  const char *p = text_ + list_[i].begin;
+  for ( uint8_t k=0; k<j; k++ ) p = strchr(p, '\n') + 1;
+  char buf[PROG_LINE_MAX];
+  uint8_t k = 0;
+  while ( p[k]!='\n' && k<PROG_LINE_MAX-1 ) { buf[k] = p[k]; k++; }
+  buf[k] = '\0';
+  return String(buf);
+}
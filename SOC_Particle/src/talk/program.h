@@ -0,0 +1,82 @@
+//
+// MIT License
+//
+// Copyright (C) 2024 - Dave Gutz
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef _PROGRAM
+#define _PROGRAM
+#include "application.h"
+
+#define PROG_MAX        16    // Programs in a script (16)
+#define PROG_NAME_LEN   9     // Longest program name + 1, char (9)
+#define PROG_LINE_MAX   128   // Longest script line, char (128)
+#define PROG_TEXT_MAX   1024  // Steps of all programs, char (1024)
+
+// The built-in script, Xp6 - Xp21
+extern const char PROGRAMS_DEFAULT[];
+
+// Test programs ('Xp<name>') from a text script, so changing a regression sequence does not mean reflashing:
+//
+//   # Xp6:  +/-500 A pulse EKF           '#' to end of line is comment
+//   program 6
+//     XS;Dm0;Dn0;Xm255;Ca.5;Pm;DP20;vv4;Rs;
+//     Dn.00001;XY;Dm500;Dm-500;Dm0;
+//     W10;Pm;vv0;
+//   end
+//
+// Each line is a step.   load() checks every command with cmd_valid() before it replaces the set in use, so
+// a bad script never queues anything.   A step is chit'd SOON once the step before, and whatever that chit'd
+// in turn, has run.   Each step reports its time as it finishes.
+class ProgramRunner
+{
+public:
+  ProgramRunner();
+  ~ProgramRunner();
+  // operators
+  // functions
+  boolean active() { return ( prog_ >= 0 ); }
+  void cancel();
+  boolean load(const char *script);
+  uint8_t n() { return n_; }
+  String name(const uint8_t i) { return ( i<n_ ? String(list_[i].name) : String("") ); }
+  void pretty_print();
+  void service(const unsigned long long now);
+  boolean start(const String &name, const unsigned long long now);
+protected:
+  struct Program
+  {
+    char name[PROG_NAME_LEN];   // 'Xp' argument
+    uint16_t begin;             // First step in text_
+    uint8_t steps;              // Lines
+  };
+  boolean parse(const char *script, const boolean store);
+  String step_line(const uint8_t i, const uint8_t j);
+  Program list_[PROG_MAX];    // Programs loaded
+  uint16_t len_;              // Chars used in text_
+  uint8_t n_;                 // Programs loaded
+  int8_t prog_;               // Program running, -1 if none
+  uint8_t step_;              // Steps queued of the program running
+  unsigned long long t_prog_; // Start of program running, ms
+  unsigned long long t_step_; // Start of step running, ms
+  char text_[PROG_TEXT_MAX];  // Steps of all programs, ';' terminated commands with '\n' after each step
+};
+
+#endif
@@ -24,6 +24,7 @@
 #include "recall_H.h"
 #include "../command.h"
 #include "../Summary.h"
+#include "../Usage.h"
 #include "../parameters.h"
 #include "chitchat.h"
 
@@ -31,35 +32,49 @@ extern SavedPars sp;    // Various parameters to be static at system level and s
 extern VolatilePars ap; // Various adjustment parameters shared at system level
 extern CommandPars cp;  // Various parameters shared at system level
 extern Flt_st mySum[NSUM];  // Summaries for saving charge history
+extern DumpCursor myDump;   // Resumable history dump
+extern UsageLog_st myUse;   // Day and week usage
 
 boolean recall_H(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
 {
     boolean found = true;
     switch ( letter_1 )
     {
-    case ( 'd' ):  // Hd: History dump
-        Serial.printf("\n");
-        print_all_fault_buffer("unit_u", mySum, sp.isum(), sp.nsum());
-        sp.print_fault_header(&pp.pubList);
-        chit("Pr;Q;", SOON);
-        Serial.printf("\n");
-        sp.print_history_array();
-        sp.print_fault_header(&pp.pubList);
-        sp.print_fault_array();
-        sp.print_fault_header(&pp.pubList);
+    case ( 'd' ):  // Hd: History dump, paced by myDump in loop()
+        myDump.add(DUMP_NL);
+        myDump.add(DUMP_SUM);
+        myDump.add(DUMP_HDR);
+        myDump.add(DUMP_CHIT);
+        myDump.add(DUMP_NL);
+        myDump.add(DUMP_HIS);
+        myDump.add(DUMP_HDR);
+        myDump.add(DUMP_FLT);
+        myDump.add(DUMP_HDR);
         break;
 
     case ( 'f' ):  // Hf: History dump faults only
-        Serial.printf("\n");
-        sp.print_fault_array();
-        sp.print_fault_header(&pp.pubList);
+        myDump.add(DUMP_NL);
+        myDump.add(DUMP_FLT);
+        myDump.add(DUMP_HDR);
+        break;
+
+    case ( 'k' ):  // Hk: History dump kill
+        myDump.cancel();
+        break;
+
+    case ( 'p' ):  // Hp: History dump packed, for the host decoder (soc_unpack), and what packing gains
+        sp.print_pack_capacity();
+        myDump.add(DUMP_PK_SUM);
+        myDump.add(DUMP_PK_HIS);
+        myDump.add(DUMP_PK_FLT);
         break;
 
     case ( 'R' ):  // HR: History reset
-        Serial.printf("Reset sum, his, flt...");
+        Serial.printf("Reset sum, his, flt, use...");
         reset_all_fault_buffer("unit_h", mySum, sp.isum(), sp.nsum());
         sp.reset_his();
         sp.reset_flt();
+        myUse.nominal();
         Serial.printf("done\n");
         break;
 
@@ -67,6 +82,10 @@ boolean recall_H(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
         cp.cmd_summarize();
         break;
 
+    case ( 'u' ):  // Hu: Usage by day and week
+        myUse.pretty_print();
+        break;
+
     default:
         found = ap.find_adjust(cp.cmd_str) || sp.find_adjust(cp.cmd_str);
         if (!found) Serial.printf("%s NOT FOUND\n", cp.cmd_str.substring(0,2).c_str());
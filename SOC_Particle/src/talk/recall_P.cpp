@@ -29,11 +29,26 @@
 #include "../parameters.h"
 #include <math.h>
 #include "../debug.h"
+#include "program.h"
+#ifdef HDWE_DS2482_ARRAY
+  #include "../TempArray.h"
+#endif
+#ifdef HDWE_STRINGS
+  #include "../StringBank.h"
+#endif
 
 extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap; // Various adjustment parameters shared at system level
 extern CommandPars cp;  // Various parameters shared at system level
 extern Flt_st mySum[NSUM];  // Summaries for saving charge history
+extern ProgramRunner myProg;  // Test programs
+extern PersistSched myPersist;  // Dynamic saved parameters and history to EERAM or backup RAM
+#ifdef HDWE_DS2482_ARRAY
+  extern TempArray myTemps;     // DS18B20 probes on the DS2482 bridges
+#endif
+#ifdef HDWE_STRINGS
+  extern StringBank myStrings;  // Parallel strings
+#endif
 
 boolean recall_P(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
 {
@@ -49,22 +64,48 @@ boolean recall_P(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
                 sp.Vb_bias_hdwe(), Sen->Vb_model, sp.modeling(), Sen->Vb);
             break;
 
+        case ( 'c' ):  // Pc:  Print capacity estimate
+            Serial.printf ("\nMon::"); Mon->cap_est()->pretty_print();
+            break;
+
+        case ( 'B' ):  // PB:  Print parallel strings
+            #ifdef HDWE_STRINGS
+                Serial.printf("\n"); myStrings.pretty_print();
+            #else
+                Serial.printf("no strings\n");
+            #endif
+            break;
+
+        case ( 'C' ):  // PC:  Print chemistry shadow bank
+            if ( Mon->chm_bank() ) { Serial.printf ("\nMon::"); Mon->chm_bank()->pretty_print(); }
+            else Serial.printf("no bank\n");
+            break;
+
         case ( 'e' ):  // Pe:  Print EKF
             Serial.printf ("\nMon::"); Mon->EKF_1x1::pretty_print();
             Serial1.printf("\nMon::"); Mon->EKF_1x1::pretty_print();
             break;
 
+        case ( 'F' ):  // PF:  Print charge forecast
+            Serial.printf ("\nMon::"); Mon->forecast()->pretty_print();
+            Serial.printf("tcharge%6.1f instantaneous, hr\n", Mon->tcharge());
+            break;
+
         case ( 'f' ):  // Pf:  Print faults
             // sp.print_history_array();
-            // sp.print_fault_header(&pp.pubList);
+            // sp.print_fault_header(pp.front());
             sp.print_fault_array();
-            sp.print_fault_header(&pp.pubList);
+            sp.print_fault_header(pp.front());
             Serial.printf ("\nSen::\n");
             Sen->Flt->pretty_print (Sen, Mon);
             Serial1.printf("\nSen::\n");
             Sen->Flt->pretty_print1(Sen, Mon);
             break;
 
+        case ( 'h' ):  // Ph:  Print hum
+            Serial.printf("\n"); Sen->hum_print();
+            break;
+
         case ( 'm' ):  // Pm:  Print mon
             Serial.printf ("\nM:"); Mon->pretty_print(Sen);
             Serial.printf ("M::"); Mon->EKF_1x1::pretty_print();
@@ -79,6 +120,10 @@ boolean recall_P(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
             Serial.printf ("\n"); Sen->ShuntNoAmp->pretty_print();
             break;
 
+        case ( 'p' ):  // Pp:  Print test programs
+            Serial.printf("\n"); myProg.pretty_print();
+            break;
+
         case ( 'R' ):  // PR:  Print retained
             Serial.printf("\n"); sp.pretty_print( true );
             Serial.printf("\n"); sp.pretty_print( false );
@@ -94,16 +139,38 @@ boolean recall_P(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
             // Serial.printf("S::"); Sen->Sim->Coulombs::pretty_print();
             break;
 
+        case ( 'u' ):  // Pu:  Print UKF
+            Serial.printf ("\nMon::"); Mon->UKF_1x1::pretty_print();
+            Serial.printf ("soc_ekf from %s\n", ap.ukf ? "UKF" : "EKF");
+            break;
+
         case ( 'V' ):  // PV:  Print all volatile
             Serial.printf("\n"); ap.pretty_print(true);
             Serial.printf("\n"); cp.pretty_print();
             Serial.printf("\n"); ap.pretty_print(false);
             break;
 
+        case ( 'T' ):  // PT:  Print temperature array
+            #ifdef HDWE_DS2482_ARRAY
+                Serial.printf("\n"); myTemps.pretty_print();
+            #else
+                Serial.printf("no array\n");
+            #endif
+            break;
+
+        case ( 't' ):  // Pt:  Print TX router counters
+            Serial.printf("\n"); rt.pretty_print();
+            break;
+
         case ( 'v' ):  // Pv:  Print only off-nominal volatile
             Serial.printf("\n"); ap.pretty_print(false);
             break;
 
+        case ( 'w' ):  // Pw:  Print persistence scheduler
+            Serial.printf("\n"); myPersist.pretty_print();
+            Serial.printf(" record fields clipped packing %ld\n", (long)sp.n_clip());
+            break;
+
         case ( 'x' ):  // Px:  Print shunt measure
             Serial.printf("\nAmp: "); Serial.printf("Vshunt_int,Vshunt,Vc,Vo,ib_tot_bias,Ishunt_cal=,%d,%7.3f,%7.3f,%7.3f,%7.3f,\n", 
                 Sen->ShuntAmp->vshunt_int(), Sen->ShuntAmp->vshunt(), Sen->ShuntAmp->Vc(), Sen->ShuntAmp->Vo(), Sen->ShuntAmp->Ishunt_cal());
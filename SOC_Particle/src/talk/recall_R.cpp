@@ -45,6 +45,16 @@ boolean recall_R(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
             Mon->init_battery_mon(true, Sen);       // Reset mon battery state
             break;
 
+        case ( 'c' ):  // Rc:  Reset capacity estimate
+            Serial.printf("Reset capacity estimate\n");
+            Mon->cap_est()->reset();
+            break;
+
+        case ( 'C' ):  // RC:  Reset chemistry shadow bank
+            Serial.printf("Reset chemistry bank\n");
+            if ( Mon->chm_bank() ) Mon->chm_bank()->reset();
+            break;
+
         case ( 'f' ):  // Rf:  Reset fault Rf
             Serial.printf("Reset latches\n");
             Sen->Flt->reset_all_faults(true);
@@ -30,11 +30,14 @@
 #include <math.h>
 #include "../debug.h"
 #include "print64.h"
+#include "program.h"
+#include "../Clock.h"
 
 extern SavedPars sp;    // Various parameters to be static at system level and saved through power cycle
 extern VolatilePars ap; // Various adjustment parameters shared at system level
 extern CommandPars cp;  // Various parameters shared at system level
 extern Flt_st mySum[NSUM];  // Summaries for saving charge history
+extern ProgramRunner myProg;  // Test programs
 
 boolean recall_X(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
 {
@@ -43,91 +46,33 @@ boolean recall_X(const char letter_1, BatteryMonitor *Mon, Sensors *Sen)
     String murmur;
     switch ( letter_1 )
     {
-        case ( 'D' ): // XD  display a message
-            Serial.printf("\n\n*** DONE***\n\n");
-            break;
-
-        case ( 'p' ): // Xp<>:  injection program
+        case ( 'B' ): // XB<>:  benchmark
             INT_in = cp.cmd_str.substring(2).toInt();
             switch ( INT_in )
             {
-
-                case ( 0 ):  // Xp0:  reset stop
-                    Serial.printf("**************Xp0\n");
-                    chit("Xf0;Xtn;", ASAP);
-                    if ( !sp.tweak_test() ) chit("Xb0;", ASAP);
-                    chit("BZ;", SOON);
-                    break;
-
-                case ( 6 ):  // Xp6:  Program a pulse for EKF test
-                    chit("XS;Dm0;Dn0;Xm255;Ca.5;Pm;DP20;vv4;Rs;", SOON);  // setup
-                    chit("Dn.00001;XY;Dm500;Dm-500;Dm0;", SOON);  // run
-                    chit("W10;Pm;vv0;", SOON);  // finish
-                    break;
-
-                case ( 7 ):  // Xp7:  Program a sensor pulse for State Space test
-                    chit("XS;Dm0;Dn0;Xm255;Ca.5;Pm;DP1;vv4;Rs;", SOON);  // setup
-                    chit("Dn.00001;W2;XY;Dm500;Dm-500;Dm0;W2;", SOON);  // run
-                    break;
-
-                case ( 8 ):  // Xp8:  Program a hardware pulse for State Space test
-                    chit("XS;Di0;Xm255;Ca.5;Pm;DP1;vv4;Rs;", SOON);  // setup
-                    chit("W2;XY;DI500;DI-500;DI0;W2;", SOON);  // run
-                    chit("W10;Pm;vv0;", SOON);  // finish
+                case ( 2 ):  // XB2:  hum sample cost
+                    bench_hum(Sen, 100UL);
                     break;
 
-                case ( 9 ): case( 10 ): case ( 11 ): case( 12 ): case( 13 ): // Xp9: Xp10: Xp11: Xp12: Xp13:  Program regression
-                    // Regression tests 9=tweak, 10=tweak w data, 11=cycle, 12 1/2 cycle
-
-                    chit("Xp0;vv0;Xm255;Xts;Ca1;", SOON);
-                    chit("Rb;", SOON); 
-
-                    if ( INT_in == 10 )  // Xp10:  rapid tweak
-                    {
-                        chit("Xf.02;Xa-2000;XW5000;XT5000;XC3;", SOON);
-                        chit("W2;W2;W2;vv4;W;Rs;XR;XQ180000;Xm247;", SOON);
-                    }
-
-                    else if ( INT_in == 11 )  // Xp11:  slow tweak
-                    {
-                        chit("Xf.002;Xa-60;XW60000;XT60000;XC1;", SOON);
-                        chit("W2;vv4;W;Rs;XR;XQ622000;Xm247;", SOON);
-                    }
-
-                    else if ( INT_in == 12 )  // Xp12:  slow half tweak
-                    {
-                        chit("Xf.0002;Xa-6;XW60000;XT240000;XC.5;", SOON);
-                        chit("W2;vv4;W;Rs;XR;XQ622000;Xm247;", SOON);
-                    }
-
-                    else if ( INT_in == 13 )  // Xp13:  tri tweak
-                    {
-                        chit("Xtt;Xf.02;Xa-29500;XW5000;XT5000;XC3;", SOON);
-                        chit("W2;vv4;W;Rs;XR;XQ180000;Xm247;", SOON);
-                    }
-                    
-                    break;
+                default:
+                    Serial.printf("%s NOT FOUND\n", cp.cmd_str.substring(0,3).c_str());
+            }
+            break;
 
-                case( 20 ): case ( 21 ):    // Xp20:  Xp21:  20= 0.5 s sample/2.0s print, 21= 2 s sample/8 s print
-                    chit("vv0;", SOON);       // Turn off debug temporarily so not snowed by data dumps
-                    chit("Pa;", SOON);       // Print all for record
-                    if ( INT_in == 20 )
-                    {
-                        chit("Dr500;", SOON);  // 5x sample time, > ChargeTransfer_T_MAX.  ChargeTransfer dynamics disabled in Python
-                        chit("DP4;", SOON);    // 4x data collection, > ChargeTransfer_T_MAX.  ChargeTransfer dynamics disabled in Python
-                        chit("vv2;", SOON);     // Large data set
-                    }
-                    else if ( INT_in == 21 )
-                    {
-                        chit("DP20;", SOON);   // 20x data collection
-                        chit("vv2;", SOON);     // Slow data collection
-                    }
-                    chit("Rb;", SOON);       // Large data set
-                    break;
+        case ( 'D' ): // XD  display a message
+            Serial.printf("\n\n*** DONE***\n\n");
+            break;
 
-                default:
-                    Serial.printf("Xp=%d unk.  see 'h'\n", INT_in);
+        case ( 'p' ): // Xp<>:  test program, see 'Pp'
+            if ( cp.cmd_str.substring(2)=="0" || cp.cmd_str.length()<3 )  // Xp0:  reset stop
+            {
+                Serial.printf("**************Xp0\n");
+                chit("Xf0;Xtn;", ASAP);
+                if ( !sp.tweak_test() ) chit("Xb0;", ASAP);
+                chit("BZ;", SOON);
             }
+            else if ( !myProg.start(cp.cmd_str.substring(2), Clock::millis()) )
+                Serial.printf("Xp%s unk.  see 'Pp'\n", cp.cmd_str.substring(2).c_str());
             break;
 
         case ( 'R' ): // XR:  Start injection now